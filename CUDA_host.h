@@ -0,0 +1,565 @@
+#ifndef RANDOM_RUNTIME_H
+#define RANDOM_RUNTIME_H
+
+// Host-side replacement for CUDA.h, included by kernels generated with
+// CUDASmith --host-target. It implements the device side of CUDA that the
+// kernels use on CPU threads, so that host_launcher.cpp can compute the
+// results of a kernel without a GPU.
+//
+// Thread blocks are shared out between worker threads (CUDA_HOST_WORKERS, one
+// per core by default). Each worker starts with a contiguous range of blocks
+// and, once it has run them, steals half of the remaining range of another
+// worker. A worker runs every thread of its block as a coroutine with its own
+// stack: __syncthreads() switches back to the worker, which resumes the
+// threads in turn until all of them are at the barrier or have returned.
+// When the threads of a kernel share no memory (no __shared__ buffers,
+// atomics or inter-thread communication, as in the BASIC and VECTOR modes),
+// the generator says so and a worker runs the threads of a block one after
+// the other on its own stack instead, ignoring __syncthreads().
+// __shared__ variables are thread_local, so each worker has its own copy for
+// the block it runs. Atomics on global memory are real atomics, as blocks run
+// at the same time.
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The vector types of CUDA, with their alignment.
+#define CUDA_HOST_VECTOR(name, type, align2, align4) \
+  struct name##1 { type x; }; \
+  struct alignas(align2) name##2 { type x, y; }; \
+  struct name##3 { type x, y, z; }; \
+  struct alignas(align4) name##4 { type x, y, z, w; }; \
+  static inline name##1 make_##name##1(type x) { \
+    name##1 v = { x }; return v; \
+  } \
+  static inline name##2 make_##name##2(type x, type y) { \
+    name##2 v = { x, y }; return v; \
+  } \
+  static inline name##3 make_##name##3(type x, type y, type z) { \
+    name##3 v = { x, y, z }; return v; \
+  } \
+  static inline name##4 make_##name##4(type x, type y, type z, type w) { \
+    name##4 v = { x, y, z, w }; return v; \
+  }
+CUDA_HOST_VECTOR(char, signed char, 2, 4)
+CUDA_HOST_VECTOR(uchar, unsigned char, 2, 4)
+CUDA_HOST_VECTOR(short, short, 4, 8)
+CUDA_HOST_VECTOR(ushort, unsigned short, 4, 8)
+CUDA_HOST_VECTOR(int, int, 8, 16)
+CUDA_HOST_VECTOR(uint, unsigned int, 8, 16)
+CUDA_HOST_VECTOR(long, long, 16, 16)
+CUDA_HOST_VECTOR(ulong, unsigned long, 16, 16)
+CUDA_HOST_VECTOR(longlong, long long, 16, 16)
+CUDA_HOST_VECTOR(ulonglong, unsigned long long, 16, 16)
+#undef CUDA_HOST_VECTOR
+
+struct dim3 {
+  unsigned int x, y, z;
+  dim3(unsigned int vx = 1, unsigned int vy = 1, unsigned int vz = 1)
+      : x(vx), y(vy), z(vz) {}
+};
+
+// The buffers passed to the kernel, in the types of the entry function's
+// parameters. Those the kernel does not take are NULL.
+struct cuda_host_buffers {
+  long *result;
+  volatile int *atomic_input;
+  volatile int *special_values;
+  volatile int *atomic_reduction;
+  int *tg_input;
+  int *emi_input;
+  int *sequence_input;
+  long *comm_values;
+};
+
+namespace cuda_host {
+
+// Switching between coroutines only has to save the registers that a call
+// preserves. On x86-64 that is done here; elsewhere the coroutines are
+// ucontexts, which also save the signal mask and so make a system call on
+// every switch.
+#if defined(__x86_64__) && defined(__ELF__)
+#define CUDA_HOST_FAST_SWITCH 1
+// Pushes the callee-saved registers, stores the stack pointer in *from and
+// pops the registers saved on the stack 'to'.
+extern "C" void cuda_host_switch(void **from, void *to);
+asm(".text\n"
+    ".globl cuda_host_switch\n"
+    ".type cuda_host_switch, @function\n"
+    "cuda_host_switch:\n"
+    "  pushq %rbp\n"
+    "  pushq %rbx\n"
+    "  pushq %r12\n"
+    "  pushq %r13\n"
+    "  pushq %r14\n"
+    "  pushq %r15\n"
+    "  movq %rsp, (%rdi)\n"
+    "  movq %rsi, %rsp\n"
+    "  popq %r15\n"
+    "  popq %r14\n"
+    "  popq %r13\n"
+    "  popq %r12\n"
+    "  popq %rbx\n"
+    "  popq %rbp\n"
+    "  ret\n"
+    ".size cuda_host_switch, .-cuda_host_switch\n");
+#endif
+
+struct Fiber {
+#ifdef CUDA_HOST_FAST_SWITCH
+  void *sp;
+#else
+  ucontext_t context;
+#endif
+  uint3 thread_idx;
+  char *stack;
+  bool done;
+};
+
+struct Worker {
+#ifdef CUDA_HOST_FAST_SWITCH
+  void *scheduler_sp;
+#else
+  ucontext_t scheduler;
+#endif
+  std::vector<Fiber> fibers;
+  uint3 block_idx;
+  // The blocks [begin, end) are left to run. Others take from the end.
+  std::mutex mutex;
+  unsigned int begin;
+  unsigned int end;
+};
+
+static uint3 grid_dim;
+static uint3 block_dim;
+static std::function<void()> kernel;
+static size_t stack_size;
+static bool sequential;
+static std::vector<std::unique_ptr<Worker> > workers;
+static thread_local Worker *current_worker;
+static thread_local Fiber *current_fiber;
+
+static size_t EnvOr(const char *name, size_t value) {
+  const char *env = getenv(name);
+  return env != NULL && atol(env) > 0 ? (size_t)atol(env) : value;
+}
+
+static inline void SwitchToWorker() {
+#ifdef CUDA_HOST_FAST_SWITCH
+  cuda_host_switch(&current_fiber->sp, current_worker->scheduler_sp);
+#else
+  swapcontext(&current_fiber->context, &current_worker->scheduler);
+#endif
+}
+
+static void FiberMain() {
+  kernel();
+  current_fiber->done = true;
+#ifdef CUDA_HOST_FAST_SWITCH
+  // Never resumed.
+  SwitchToWorker();
+  abort();
+#endif
+  // Returning resumes the worker, through uc_link.
+}
+
+static void StartFiber(Worker *worker, Fiber *fiber) {
+  fiber->done = false;
+#ifdef CUDA_HOST_FAST_SWITCH
+  // The registers cuda_host_switch pops, then FiberMain as the address it
+  // returns to, aligned as if FiberMain had been called.
+  (void)worker;
+  void **sp = (void **)(((uintptr_t)fiber->stack + stack_size) & ~15ul);
+  *--sp = NULL;
+  *--sp = (void *)FiberMain;
+  for (int reg = 0; reg < 6; ++reg) *--sp = NULL;
+  fiber->sp = sp;
+#else
+  getcontext(&fiber->context);
+  fiber->context.uc_stack.ss_sp = fiber->stack;
+  fiber->context.uc_stack.ss_size = stack_size;
+  fiber->context.uc_link = &worker->scheduler;
+  makecontext(&fiber->context, FiberMain, 0);
+#endif
+}
+
+static inline void SwitchToFiber(Worker *worker, Fiber *fiber) {
+  current_fiber = fiber;
+#ifdef CUDA_HOST_FAST_SWITCH
+  cuda_host_switch(&worker->scheduler_sp, fiber->sp);
+#else
+  swapcontext(&worker->scheduler, &fiber->context);
+#endif
+}
+
+static inline void SyncThreads() {
+  if (!sequential) SwitchToWorker();
+}
+
+static void RunBlock(Worker *worker, unsigned int block) {
+  worker->block_idx.x = block % grid_dim.x;
+  worker->block_idx.y = block / grid_dim.x % grid_dim.y;
+  worker->block_idx.z = block / grid_dim.x / grid_dim.y;
+  if (sequential) {
+    for (Fiber& fiber : worker->fibers) {
+      current_fiber = &fiber;
+      kernel();
+    }
+    return;
+  }
+  for (Fiber& fiber : worker->fibers) StartFiber(worker, &fiber);
+  // Each pass runs every thread up to its next barrier, or to its end.
+  size_t running = worker->fibers.size();
+  while (running > 0) {
+    for (Fiber& fiber : worker->fibers) {
+      if (fiber.done) continue;
+      SwitchToFiber(worker, &fiber);
+      if (fiber.done) --running;
+    }
+  }
+}
+
+// Takes the next block of 'self', or steals half of the blocks left to
+// another worker. Returns false once there are none left.
+static bool TakeBlock(size_t self, unsigned int *block) {
+  Worker *worker = workers[self].get();
+  {
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    if (worker->begin < worker->end) {
+      *block = worker->begin++;
+      return true;
+    }
+  }
+  for (size_t idx = 1; idx < workers.size(); ++idx) {
+    Worker *victim = workers[(self + idx) % workers.size()].get();
+    unsigned int begin, end;
+    {
+      std::lock_guard<std::mutex> lock(victim->mutex);
+      if (victim->begin >= victim->end) continue;
+      end = victim->end;
+      begin = end - (end - victim->begin + 1) / 2;
+      victim->end = begin;
+    }
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    *block = begin;
+    worker->begin = begin + 1;
+    worker->end = end;
+    return true;
+  }
+  return false;
+}
+
+static void RunWorker(size_t self) {
+  Worker *worker = workers[self].get();
+  const unsigned int threads = block_dim.x * block_dim.y * block_dim.z;
+  const size_t page = sysconf(_SC_PAGESIZE);
+  // One stack per thread of the block, each above a guard page. Threads
+  // that run one after the other use the worker's stack.
+  const size_t stacks_size = sequential ? 0 : threads * (stack_size + page);
+  char *stacks = NULL;
+  if (stacks_size) {
+    stacks = (char *)mmap(NULL, stacks_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (stacks == MAP_FAILED) {
+      perror("mmap");
+      exit(1);
+    }
+  }
+  worker->fibers.resize(threads);
+  for (unsigned int t = 0; t < threads; ++t) {
+    Fiber& fiber = worker->fibers[t];
+    if (stacks != NULL) {
+      char *guard = stacks + t * (stack_size + page);
+      mprotect(guard, page, PROT_NONE);
+      fiber.stack = guard + page;
+    }
+    fiber.thread_idx.x = t % block_dim.x;
+    fiber.thread_idx.y = t / block_dim.x % block_dim.y;
+    fiber.thread_idx.z = t / block_dim.x / block_dim.y;
+  }
+  current_worker = worker;
+  unsigned int block;
+  while (TakeBlock(self, &block))
+    RunBlock(worker, block);
+  current_worker = NULL;
+  if (stacks != NULL) munmap(stacks, stacks_size);
+}
+
+// Runs 'entry' for every thread of the grid, as <<<grid, block>>> would.
+// 'independent' says that the threads share no memory, so that those of a
+// block can run one after the other.
+static void Launch(const dim3& grid, const dim3& block, bool independent,
+    const std::function<void()>& entry) {
+  grid_dim.x = grid.x; grid_dim.y = grid.y; grid_dim.z = grid.z;
+  block_dim.x = block.x; block_dim.y = block.y; block_dim.z = block.z;
+  kernel = entry;
+  sequential = independent && !getenv("CUDA_HOST_COROUTINES");
+  stack_size = EnvOr("CUDA_HOST_STACK_KB", 1024) * 1024;
+  const unsigned int blocks = grid.x * grid.y * grid.z;
+  unsigned int count = EnvOr("CUDA_HOST_WORKERS",
+      std::max(std::thread::hardware_concurrency(), 1u));
+  if (count > blocks) count = blocks;
+
+  workers.clear();
+  for (unsigned int idx = 0; idx < count; ++idx) {
+    workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    workers.back()->begin = (unsigned long)blocks * idx / count;
+    workers.back()->end = (unsigned long)blocks * (idx + 1) / count;
+  }
+  std::vector<std::thread> pool;
+  for (unsigned int idx = 1; idx < count; ++idx)
+    pool.push_back(std::thread(RunWorker, idx));
+  RunWorker(0);
+  for (std::thread& thread : pool) thread.join();
+  workers.clear();
+}
+
+// Applies 'op' to *address atomically, returning the old value.
+template <typename T, typename Op>
+static inline T AtomicUpdate(volatile T *address, Op op) {
+  T *p = const_cast<T *>(address);
+  T old = __atomic_load_n(p, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(p, &old, op(old), true,
+                                      __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+  }
+  return old;
+}
+
+}  // namespace cuda_host
+
+#define __device__
+#define __global__
+#define __constant__
+#define __private
+#define __shared__ static thread_local
+
+#define threadIdx (cuda_host::current_fiber->thread_idx)
+#define blockIdx (cuda_host::current_worker->block_idx)
+#define blockDim (cuda_host::block_dim)
+#define gridDim (cuda_host::grid_dim)
+
+static inline void __syncthreads() {
+  cuda_host::SyncThreads();
+}
+
+// The atomic functions of CUDA that CUDA.h builds on.
+#define CUDA_HOST_ATOMICS(type) \
+  static inline type atomicAdd(volatile type *address, type val) { \
+    return __atomic_fetch_add(const_cast<type *>(address), val, \
+                              __ATOMIC_SEQ_CST); \
+  } \
+  static inline type atomicSub(volatile type *address, type val) { \
+    return __atomic_fetch_sub(const_cast<type *>(address), val, \
+                              __ATOMIC_SEQ_CST); \
+  } \
+  static inline type atomicExch(volatile type *address, type val) { \
+    return __atomic_exchange_n(const_cast<type *>(address), val, \
+                               __ATOMIC_SEQ_CST); \
+  } \
+  static inline type atomicMin(volatile type *address, type val) { \
+    return cuda_host::AtomicUpdate(address, \
+        [val](type old) { return val < old ? val : old; }); \
+  } \
+  static inline type atomicMax(volatile type *address, type val) { \
+    return cuda_host::AtomicUpdate(address, \
+        [val](type old) { return val > old ? val : old; }); \
+  } \
+  static inline type atomicAnd(volatile type *address, type val) { \
+    return __atomic_fetch_and(const_cast<type *>(address), val, \
+                              __ATOMIC_SEQ_CST); \
+  } \
+  static inline type atomicOr(volatile type *address, type val) { \
+    return __atomic_fetch_or(const_cast<type *>(address), val, \
+                             __ATOMIC_SEQ_CST); \
+  } \
+  static inline type atomicXor(volatile type *address, type val) { \
+    return __atomic_fetch_xor(const_cast<type *>(address), val, \
+                              __ATOMIC_SEQ_CST); \
+  } \
+  static inline type atomicCAS(volatile type *address, type compare, \
+      type val) { \
+    __atomic_compare_exchange_n(const_cast<type *>(address), &compare, val, \
+                                false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); \
+    return compare; \
+  }
+CUDA_HOST_ATOMICS(int)
+CUDA_HOST_ATOMICS(unsigned int)
+#undef CUDA_HOST_ATOMICS
+
+// From here on, as CUDA.h.
+typedef  unsigned char uchar;
+#define N 1024
+#define int64_t long
+#define uint64_t long
+#define int_least64_t long
+#define uint_least64_t long
+#define int_fast64_t long
+#define uint_fast64_t long
+#define intmax_t long
+#define uintmax_t long
+#define int32_t int
+#define uint32_t int
+#define int16_t short
+#define uint16_t short
+#define int8_t char
+#define uint8_t char
+#define uint int
+#define INT64_MIN LONG_MIN
+#define INT64_MAX LONG_MAX
+#define INT32_MIN INT_MIN
+#define INT32_MAX INT_MAX
+#define INT16_MIN SHRT_MIN
+#define INT16_MAX SHRT_MAX
+#define INT8_MIN CHAR_MIN
+#define INT8_MAX CHAR_MAX
+#define UINT64_MIN ULONG_MIN
+#define UINT64_MAX ULONG_MAX
+#define UINT32_MIN UINT_MIN
+#define UINT32_MAX UINT_MAX
+#define UINT16_MIN USHRT_MIN
+#define UINT16_MAX USHRT_MAX
+#define UINT8_MIN UCHAR_MIN
+#define UINT8_MAX UCHAR_MAX
+
+#define transparent_crc(X, Y, Z) transparent_crc_(&crc64_context, X, Y, Z)
+
+#define VECTOR(X , Y) VECTOR_(X, Y)
+#define VECTOR_(X, Y) X##Y
+#define VECTOR_MAKE(X , Y) VECTOR_MAKE_(X, Y)
+#define VECTOR_MAKE_(X, Y) make_##X##Y
+
+#include "cl_safe_math_macros.h"
+#include "safe_math_macros.h"
+
+#ifdef NO_ATOMICS
+#define atomic_inc(x) -1
+#define atomic_add(x,y) (1+1)
+#define atomic_sub(x,y) (1+1)
+#define atomic_min(x,y) (1+1)
+#define atomic_max(x,y) (1+1)
+#define atomic_and(x,y) (1+1)
+#define atomic_or(x,y)  (1+1)
+#define atomic_xor(x,y) (1+1)
+#define atomic_noop() /* for sanity checking */
+#endif
+
+__device__ unsigned int myAtomicInc(volatile unsigned int *address)
+{
+      return atomicAdd(address, 1u);
+}
+__device__ int myAtomicInc(volatile int *address)
+{
+      return atomicAdd(address, 1);
+}
+__device__ unsigned int myAtomicDec(volatile unsigned int *address)
+{
+      return atomicSub(address, 1u);
+}
+__device__ int myAtomicDec(volatile int *address)
+{
+      return atomicSub(address, 1);
+}
+#define CUDA_HOST_MY_ATOMIC(op) \
+  __device__ int myAtomic##op(volatile int *address, int val) \
+  { \
+        return atomic##op(address, val); \
+  } \
+  __device__ unsigned int myAtomic##op(volatile unsigned int *address, \
+      unsigned int val) \
+  { \
+        return atomic##op(address, val); \
+  }
+CUDA_HOST_MY_ATOMIC(Min)
+CUDA_HOST_MY_ATOMIC(Max)
+CUDA_HOST_MY_ATOMIC(Add)
+CUDA_HOST_MY_ATOMIC(Sub)
+CUDA_HOST_MY_ATOMIC(Exch)
+CUDA_HOST_MY_ATOMIC(And)
+CUDA_HOST_MY_ATOMIC(Or)
+CUDA_HOST_MY_ATOMIC(Xor)
+#undef CUDA_HOST_MY_ATOMIC
+
+__device__ int get_block_id(int a)
+{
+	switch (a)
+	{
+	case (0) : return blockIdx.x; break;
+	case (1) : return blockIdx.y; break;
+	case (2) : return blockIdx.z; break;
+	}
+	return 0;
+}
+
+__device__ inline void transparent_crc_no_string (uint64_t *crc64_context, uint64_t val)
+{
+  *crc64_context += val;
+}
+
+#define transparent_crc_(A, B, C, D) transparent_crc_no_string(A, B)
+
+// Component 'index' of a CUDA dim3 or uint3.
+#define CUDA_HOST_COMPONENT(v, index) \
+  ((index) == 0 ? (v).x : (index) == 1 ? (v).y : (index) == 2 ? (v).z : 0)
+
+__device__ inline uint32_t
+get_global_size(int index){
+      return CUDA_HOST_COMPONENT(gridDim, index) *
+             CUDA_HOST_COMPONENT(blockDim, index);
+}
+__device__ inline uint32_t
+get_global_id(int index){
+      return CUDA_HOST_COMPONENT(blockIdx, index) *
+             CUDA_HOST_COMPONENT(blockDim, index) +
+             CUDA_HOST_COMPONENT(threadIdx, index);
+}
+__device__ inline uint32_t
+get_local_size(int index){
+      return CUDA_HOST_COMPONENT(blockDim, index);
+}
+__device__ inline uint32_t
+get_local_id (int index)
+{
+      return CUDA_HOST_COMPONENT(threadIdx, index);
+}
+__device__  inline uint32_t
+get_num_groups(int index){
+      return CUDA_HOST_COMPONENT(gridDim, index);
+}
+__device__ inline uint32_t
+get_group_id(int index){
+      return CUDA_HOST_COMPONENT(blockIdx, index);
+}
+__device__ inline uint32_t
+get_linear_group_id (void)
+{
+          return (get_group_id(2) * get_num_groups(1) + get_group_id(1)) *
+                            get_num_groups(0) + get_group_id(0);
+}
+
+__device__ inline uint32_t
+get_linear_global_id (void)
+{
+          return (get_global_id(2) * get_global_size(1) + get_global_id(1)) *
+                            get_global_size(0) + get_global_id(0);
+}
+
+__device__ inline uint32_t
+get_linear_local_id (void)
+{
+          return (get_local_id(2) * get_local_size(1) + get_local_id(1)) *
+                            get_local_size(0) + get_local_id(0);
+}
+#endif /* RANDOM_RUNTIME_H */
@@ -35,10 +35,11 @@
 #include "DefaultProgramGenerator.h"
 #include "DFSProgramGenerator.h"
 #include "Probabilities.h"
+#include "NodeArena.h"
 
 using namespace std;
 
-AbsProgramGenerator *AbsProgramGenerator::current_generator_ = NULL;
+thread_local AbsProgramGenerator *AbsProgramGenerator::current_generator_ = NULL;
 
 OutputMgr *
 AbsProgramGenerator::GetOutputMgr()
@@ -50,6 +51,7 @@ AbsProgramGenerator::GetOutputMgr()
 AbsProgramGenerator *
 AbsProgramGenerator::CreateInstance(int argc, char *argv[], unsigned long seed)
 {
+	NodeArena::open();
 	if (CGOptions::dfs_exhaustive()) {
 		AbsProgramGenerator::current_generator_ = new DFSProgramGenerator(argc, argv, seed);
 	}
@@ -35,22 +35,17 @@
 
 #include "DefaultRndNumGenerator.h"
 #include "DFSRndNumGenerator.h"
+#include "RandomNumber.h"
 #include "SimpleDeltaRndNumGenerator.h"
 
 using namespace std;
 
-#ifdef WIN32
-extern "C" {
-	extern void srand48(long seed);
-	extern long lrand48(void);
-}
-#endif
-
 const char *AbsRndNumGenerator::hex1 = "0123456789ABCDEF";
 
 const char *AbsRndNumGenerator::dec1 = "0123456789";
 
 AbsRndNumGenerator::AbsRndNumGenerator()
+	: engine_(RandomNumber::GetInstance()->engine())
 {
 	//Nothing to do
 }
@@ -68,7 +63,8 @@ AbsRndNumGenerator::make_rndnum_generator(RNDNUM_GENERATOR impl, const unsigned
 {
 	AbsRndNumGenerator *rImpl = 0;
 
-	AbsRndNumGenerator::seedrand(seed);
+	// Every new generator restarts the sequence from the seed.
+	RandomNumber::GetInstance()->engine().seed(seed);
 	switch (impl) {
 		case rDefaultRndNumGenerator: 
 			rImpl = DefaultRndNumGenerator::make_rndnum_generator(seed);
@@ -87,12 +83,6 @@ AbsRndNumGenerator::make_rndnum_generator(RNDNUM_GENERATOR impl, const unsigned
 	return rImpl;
 }
 
-void
-AbsRndNumGenerator::seedrand(const unsigned long seed )
-{
-	srand48 (seed);
-}
-
 /*
  * Return random shuffled integers in set [0...n]
  * Note: deprecated.
@@ -122,7 +112,7 @@ AbsRndNumGenerator::rnd_shuffle(unsigned int n)
 unsigned long 
 AbsRndNumGenerator::genrand(void)
 {
-	return lrand48();
+	return engine_.next();
 }
 
 std::string
@@ -131,7 +121,7 @@ AbsRndNumGenerator::RandomHexDigits( int num )
 	std::string str;
 	while ( num-- )
 	{
-		str += hex1[genrand()%16];
+		str += hex1[genrand_upto(16)];
 	}
 
 	return str;
@@ -143,7 +133,7 @@ AbsRndNumGenerator::RandomDigits( int num )
 	std::string str;
 	while ( num-- )
 	{
-		str += dec1[genrand()%10];
+		str += dec1[genrand_upto(10)];
 	}
 
 	return str;
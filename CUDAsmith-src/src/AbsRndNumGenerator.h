@@ -32,6 +32,7 @@
 
 #include <string>
 #include "CommonMacros.h"
+#include "RandomEngine.h"
 
 class Filter;
 
@@ -50,8 +51,6 @@ class AbsRndNumGenerator
 public:
 	static AbsRndNumGenerator *make_rndnum_generator(RNDNUM_GENERATOR impl, const unsigned long seed);
 
-	static void seedrand(const unsigned long seed);
-
 	static const char* get_hex1();
 
 	static const char* get_dec1();
@@ -84,8 +83,14 @@ public:
 protected:
 	virtual unsigned long genrand(void) = 0;
 
+	// Return a random number in the range 0..(n-1).
+	unsigned int genrand_upto(const unsigned int n) { return engine_.upto(n); }
+
 	AbsRndNumGenerator();
 
+	// Owned by the RandomNumber instance this generator belongs to.
+	RandomEngine &engine_;
+
 private:
 	// ------------------------------------------------------------------------------------------
 	// "hex" and "dec" are reserved keywords in MSVC, we have to rename them
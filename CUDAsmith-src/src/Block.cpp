@@ -74,7 +74,7 @@ void GenBlockVars(Block *curr);
 }
 
 using namespace std;
-bool g_Mark = false;
+thread_local bool g_Mark = false;
 
 ///////////////////////////////////////////////////////////////////////////////
 Block *find_block_by_id(int blk_id)
@@ -237,6 +237,8 @@ Block::make_random(CGContext &cg_context, bool looping)
  */
 Block::Block(Block *b, int block_size)
 	: Statement(eBlock, b),
+	  looping(false),
+	  in_array_loop(false),
 	  need_revisit(false),
 	  depth_protect(false),
 	  block_size_(block_size)
@@ -309,7 +311,6 @@ OutputStatementList(const vector<Statement *> &stms, std::ostream &out, FactMgr
 {
 	
 	size_t i;
-	srand(g_Seed);
 	float magicPro = 0.5;
 	size_t len = stms.size();
 	for (i = 0; i < len; i++)
@@ -318,7 +319,7 @@ OutputStatementList(const vector<Statement *> &stms, std::ostream &out, FactMgr
 		const Statement *stm = stms[i];
 		//add by wxy 2018-03-26
         //避免插入到末尾
-		const Statement *stm_next = stms[i+1];
+		const Statement *stm_next = (i + 1 < len) ? stms[i+1] : NULL;
 	    if (i==len-1&&dynamic_cast<CUDASmith::StatementTG*>((Statement *)stm)!=NULL){
 			return;
 		}
@@ -608,18 +609,19 @@ Block::get_dereferenced_ptrs(void) const
 	return empty;
 }
 
-bool Block::visit_facts(vector<const Fact *> &inputs, CGContext &cg_context) const
+bool Block::visit_facts(FactVec &inputs, CGContext &cg_context) const
 {
 	int dummy;
 	FactMgr *fm = get_fact_mgr(&cg_context);
-	vector<const Fact *> dummy_facts;
-	Effect pre_effect = cg_context.get_accum_effect();
+	FactVec dummy_facts;
+	size_t pre_effect = cg_context.checkpoint_effect_accum();
 	if (!find_fixed_point(inputs, dummy_facts, cg_context, dummy, false))
 	{
-		cg_context.reset_effect_accum(pre_effect);
+		cg_context.rollback_effect_accum(pre_effect);
 		return false;
 	}
-	inputs = fm->map_facts_out[this];
+	cg_context.commit_effect_accum(pre_effect);
+	inputs = fm->map_facts_out.get(this);
 	fm->map_visited[this] = true;
 	return true;
 }
@@ -659,12 +661,12 @@ bool Block::contains_back_edge(void) const
  *    fail_index: records which statement in this block caused analyzer to fail
  *    visit_one: when is true, the statements in this block must be visited at least once
  ****************************************************************************************************/
-bool Block::find_fixed_point(vector<const Fact *> inputs, vector<const Fact *> &post_facts, CGContext &cg_context, int &fail_index, bool visit_once) const
+bool Block::find_fixed_point(FactVec inputs, FactVec &post_facts, CGContext &cg_context, int &fail_index, bool visit_once) const
 {
 	FactMgr *fm = get_fact_mgr(&cg_context);
 	// include outputs from all back edges leading to this block
 	size_t i;
-	static int g = 0;
+	static thread_local int g = 0;
 	vector<const CFGEdge *> edges;
 	int cnt = 0;
 	do
@@ -682,7 +684,7 @@ bool Block::find_fixed_point(vector<const Fact *> inputs, vector<const Fact *> &
 			{
 				const Statement *src = edges[i]->src;
 				//assert(fm->map_visited[src]);
-				merge_facts(inputs, fm->map_facts_out[src]);
+				merge_facts(inputs, fm->map_facts_out.get(src));
 			}
 		}
 		if (!visit_once)
@@ -864,7 +866,7 @@ void Block::post_creation_analysis(CGContext &cg_context, const Effect &pre_effe
 	// compute accumulated effect
 	set_accumulated_effect(cg_context);
 	//fm->print_facts(fm->global_facts);
-	vector<const Fact *> post_facts = fm->global_facts;
+	FactVec post_facts = fm->global_facts;
 	FactMgr::update_facts_for_oos_vars(local_vars, fm->global_facts);
 	fm->remove_rv_facts(fm->global_facts);
 	fm->set_fact_out(this, fm->global_facts);
@@ -879,7 +881,7 @@ void Block::post_creation_analysis(CGContext &cg_context, const Effect &pre_effe
 			self_back_edge = true;
 			fm->create_cfg_edge(this, this, false, true);
 		}
-		vector<const Fact *> facts_copy = fm->map_facts_in[this];
+		FactVec facts_copy = fm->map_facts_in.get(this);
 		// reset the accumulative effect
 		cg_context.reset_effect_accum(pre_effect);
 		while (!find_fixed_point(facts_copy, post_facts, cg_context, index, need_revisit))
@@ -905,7 +907,7 @@ void Block::post_creation_analysis(CGContext &cg_context, const Effect &pre_effe
 			// reset incoming effects
 			cg_context.reset_effect_accum(pre_effect);
 		}
-		fm->global_facts = fm->map_facts_out[this];
+		fm->global_facts = fm->map_facts_out.get(this);
 	}
 	// make sure we add back return statement for blocks that require it and had such statement deleted
 	// only do this for top-level block of a function which requires a return statement
@@ -913,7 +915,7 @@ void Block::post_creation_analysis(CGContext &cg_context, const Effect &pre_effe
 	{
 		fm->global_facts = post_facts;
 		Statement *sr = append_return_stmt(cg_context);
-		fm->set_fact_out(this, fm->map_facts_out[sr]);
+		fm->set_fact_out(this, fm->map_facts_out.get(sr));
 	}
 }
 
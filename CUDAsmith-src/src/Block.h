@@ -52,6 +52,7 @@ class CGContext;
 class Statement;
 class Variable;
 class Fact;
+class FactVec;
 class FactMgr;
 class Effect;
 
@@ -102,11 +103,11 @@ public:
 	bool need_nested_loop(const CGContext& cg_context);
 	Statement* append_nested_loop(CGContext& cg_context);
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	bool contains_back_edge(void) const;
 
-	bool find_fixed_point(vector<const Fact*> inputs, vector<const Fact*>& post_facts, CGContext& cg_context, int& fail_index, bool visit_once) const;
+	bool find_fixed_point(FactVec inputs, FactVec& post_facts, CGContext& cg_context, int& fail_index, bool visit_once) const;
 
 	void post_creation_analysis(CGContext& cg_context, const Effect& pre_effect);
 
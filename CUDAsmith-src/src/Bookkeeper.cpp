@@ -51,43 +51,43 @@ using namespace std;
 ///////////////////////////////////////////////////////////////////////////////
  
 // counter for all levels of struct depth
-std::vector<int> Bookkeeper::struct_depth_cnts; 
-int Bookkeeper::union_var_cnt = 0;
-std::vector<int> Bookkeeper::expr_depth_cnts;
-std::vector<int> Bookkeeper::blk_depth_cnts;
-std::vector<int> Bookkeeper::dereference_level_cnts;
-int Bookkeeper::address_taken_cnt = 0;
-std::vector<int> Bookkeeper::read_dereference_cnts;
-std::vector<int> Bookkeeper::write_dereference_cnts;
-int Bookkeeper::cmp_ptr_to_null = 0;
-int Bookkeeper::cmp_ptr_to_ptr = 0;
-int Bookkeeper::cmp_ptr_to_addr = 0; 
-int Bookkeeper::read_volatile_cnt = 0;
-int Bookkeeper::write_volatile_cnt = 0;
-int Bookkeeper::read_non_volatile_cnt = 0;
-int Bookkeeper::write_non_volatile_cnt = 0;
-int Bookkeeper::read_volatile_thru_ptr_cnt = 0;
-int Bookkeeper::write_volatile_thru_ptr_cnt = 0;
-int Bookkeeper::pointer_avail_for_dereference = 0;
-int Bookkeeper::volatile_avail = 0;
-int Bookkeeper::structs_with_bitfields = 0;
-std::vector<int> Bookkeeper::vars_with_bitfields;
-std::vector<int> Bookkeeper::vars_with_full_bitfields;
-int Bookkeeper::vars_with_bitfields_address_taken_cnt = 0;
-int Bookkeeper::bitfields_in_total = 0;
-int Bookkeeper::unamed_bitfields_in_total = 0;
-int Bookkeeper::const_bitfields_in_total = 0;
-int Bookkeeper::volatile_bitfields_in_total = 0;
-int Bookkeeper::lhs_bitfields_structs_vars_cnt = 0;
-int Bookkeeper::rhs_bitfields_structs_vars_cnt = 0;
-int Bookkeeper::lhs_bitfield_cnt = 0;
-int Bookkeeper::rhs_bitfield_cnt = 0;
-int Bookkeeper::forward_jump_cnt = 0;
-int Bookkeeper::backward_jump_cnt = 0;
-int Bookkeeper::use_new_var_cnt = 0;
-int Bookkeeper::use_old_var_cnt = 0;
-bool Bookkeeper::rely_on_int_size = false;
-bool Bookkeeper::rely_on_ptr_size = false;
+thread_local std::vector<int> Bookkeeper::struct_depth_cnts; 
+thread_local int Bookkeeper::union_var_cnt = 0;
+thread_local std::vector<int> Bookkeeper::expr_depth_cnts;
+thread_local std::vector<int> Bookkeeper::blk_depth_cnts;
+thread_local std::vector<int> Bookkeeper::dereference_level_cnts;
+thread_local int Bookkeeper::address_taken_cnt = 0;
+thread_local std::vector<int> Bookkeeper::read_dereference_cnts;
+thread_local std::vector<int> Bookkeeper::write_dereference_cnts;
+thread_local int Bookkeeper::cmp_ptr_to_null = 0;
+thread_local int Bookkeeper::cmp_ptr_to_ptr = 0;
+thread_local int Bookkeeper::cmp_ptr_to_addr = 0; 
+thread_local int Bookkeeper::read_volatile_cnt = 0;
+thread_local int Bookkeeper::write_volatile_cnt = 0;
+thread_local int Bookkeeper::read_non_volatile_cnt = 0;
+thread_local int Bookkeeper::write_non_volatile_cnt = 0;
+thread_local int Bookkeeper::read_volatile_thru_ptr_cnt = 0;
+thread_local int Bookkeeper::write_volatile_thru_ptr_cnt = 0;
+thread_local int Bookkeeper::pointer_avail_for_dereference = 0;
+thread_local int Bookkeeper::volatile_avail = 0;
+thread_local int Bookkeeper::structs_with_bitfields = 0;
+thread_local std::vector<int> Bookkeeper::vars_with_bitfields;
+thread_local std::vector<int> Bookkeeper::vars_with_full_bitfields;
+thread_local int Bookkeeper::vars_with_bitfields_address_taken_cnt = 0;
+thread_local int Bookkeeper::bitfields_in_total = 0;
+thread_local int Bookkeeper::unamed_bitfields_in_total = 0;
+thread_local int Bookkeeper::const_bitfields_in_total = 0;
+thread_local int Bookkeeper::volatile_bitfields_in_total = 0;
+thread_local int Bookkeeper::lhs_bitfields_structs_vars_cnt = 0;
+thread_local int Bookkeeper::rhs_bitfields_structs_vars_cnt = 0;
+thread_local int Bookkeeper::lhs_bitfield_cnt = 0;
+thread_local int Bookkeeper::rhs_bitfield_cnt = 0;
+thread_local int Bookkeeper::forward_jump_cnt = 0;
+thread_local int Bookkeeper::backward_jump_cnt = 0;
+thread_local int Bookkeeper::use_new_var_cnt = 0;
+thread_local int Bookkeeper::use_old_var_cnt = 0;
+thread_local bool Bookkeeper::rely_on_int_size = false;
+thread_local bool Bookkeeper::rely_on_ptr_size = false;
 
 /*
  *
@@ -128,7 +128,34 @@ Bookkeeper::doFinalization()
 	Bookkeeper::cmp_ptr_to_null = 0;
 	Bookkeeper::cmp_ptr_to_ptr = 0;
 	Bookkeeper::cmp_ptr_to_addr = 0;
-	
+	Bookkeeper::union_var_cnt = 0;
+	Bookkeeper::blk_depth_cnts.clear();
+	Bookkeeper::read_volatile_cnt = 0;
+	Bookkeeper::write_volatile_cnt = 0;
+	Bookkeeper::read_non_volatile_cnt = 0;
+	Bookkeeper::write_non_volatile_cnt = 0;
+	Bookkeeper::read_volatile_thru_ptr_cnt = 0;
+	Bookkeeper::write_volatile_thru_ptr_cnt = 0;
+	Bookkeeper::pointer_avail_for_dereference = 0;
+	Bookkeeper::volatile_avail = 0;
+	Bookkeeper::structs_with_bitfields = 0;
+	Bookkeeper::vars_with_bitfields.clear();
+	Bookkeeper::vars_with_full_bitfields.clear();
+	Bookkeeper::vars_with_bitfields_address_taken_cnt = 0;
+	Bookkeeper::bitfields_in_total = 0;
+	Bookkeeper::unamed_bitfields_in_total = 0;
+	Bookkeeper::const_bitfields_in_total = 0;
+	Bookkeeper::volatile_bitfields_in_total = 0;
+	Bookkeeper::lhs_bitfields_structs_vars_cnt = 0;
+	Bookkeeper::rhs_bitfields_structs_vars_cnt = 0;
+	Bookkeeper::lhs_bitfield_cnt = 0;
+	Bookkeeper::rhs_bitfield_cnt = 0;
+	Bookkeeper::forward_jump_cnt = 0;
+	Bookkeeper::backward_jump_cnt = 0;
+	Bookkeeper::use_new_var_cnt = 0;
+	Bookkeeper::use_old_var_cnt = 0;
+	Bookkeeper::rely_on_int_size = false;
+	Bookkeeper::rely_on_ptr_size = false;
 }
 
 int 
@@ -242,7 +242,7 @@ CGContext::read_var(const Variable *v)
  *
  */
 bool
-CGContext::check_read_var(const Variable *v, const std::vector<const Fact*>& facts)
+CGContext::check_read_var(const Variable *v, const FactVec& facts)
 {
 	if (!read_indices(v, facts)) {
 		return false;
@@ -267,10 +267,10 @@ CGContext::check_read_var(const Variable *v, const std::vector<const Fact*>& fac
 	return true;
 }
 
-bool CGContext::read_pointed(const ExpressionVariable* v, const std::vector<const Fact*>& facts)
+bool CGContext::read_pointed(const ExpressionVariable* v, const FactVec& facts)
 {
 	size_t i;
-	Effect effect_accum_copy = *effect_accum;
+	size_t effect_accum_cp = effect_accum->checkpoint();
 	int indirect = v->get_indirect_level(); 
 	assert(indirect > 0);
 	incr_counter(Bookkeeper::dereference_level_cnts, indirect);
@@ -278,6 +278,7 @@ bool CGContext::read_pointed(const ExpressionVariable* v, const std::vector<cons
 	bool allow_null_ptr = CGOptions::null_pointer_dereference_prob() > 0;
 	bool allow_dead_ptr = CGOptions::dead_pointer_dereference_prob() > 0;
 	if (!read_indices(v->get_var(), facts)) {
+		effect_accum->commit(effect_accum_cp);
 		return false;
 	}
 	vector<const Variable*> tmp;
@@ -289,7 +290,7 @@ bool CGContext::read_pointed(const ExpressionVariable* v, const std::vector<cons
 		if (tmp.size()==0 || 
 			(!allow_null_ptr && is_variable_in_set(tmp, FactPointTo::null_ptr)) || 
 			(!allow_dead_ptr && is_variable_in_set(tmp, FactPointTo::garbage_ptr))) {
-			*effect_accum = effect_accum_copy;
+			effect_accum->rollback(effect_accum_cp);
 			return false;
 		}
 		// make sure the remaining pointee are readable in context
@@ -297,24 +298,26 @@ bool CGContext::read_pointed(const ExpressionVariable* v, const std::vector<cons
 			const Variable* pointee = tmp[i];
 			if (!FactPointTo::is_special_ptr(pointee)) {
 				if (!check_read_var(pointee, facts)) {
-					*effect_accum = effect_accum_copy;
+					effect_accum->rollback(effect_accum_cp);
 					return false;
 				}
 			}
 		}
 	} 
+	effect_accum->commit(effect_accum_cp);
 	return true;
 }
 
-bool CGContext::write_pointed(const Lhs* v, const std::vector<const Fact*>& facts)
+bool CGContext::write_pointed(const Lhs* v, const FactVec& facts)
 {
 	size_t i;
-	Effect effect_accum_copy = *effect_accum;
+	size_t effect_accum_cp = effect_accum->checkpoint();
 	int indirect = v->get_indirect_level(); 
 	assert(indirect > 0);
 	incr_counter(Bookkeeper::dereference_level_cnts, indirect);
 	//vector<const Variable*> tmp = FactPointTo::merge_pointees_of_pointer(v->get_var(), indirect, facts);
 	if (!read_indices(v->get_var(), facts)) {
+		effect_accum->commit(effect_accum_cp);
 		return false;
 	}
 
@@ -330,7 +333,7 @@ bool CGContext::write_pointed(const Lhs* v, const std::vector<const Fact*>& fact
 		if (tmp.size()==0 || 
 			(!allow_null_ptr && is_variable_in_set(tmp, FactPointTo::null_ptr)) || 
 			(!allow_dead_ptr && is_variable_in_set(tmp, FactPointTo::garbage_ptr))) {
-			*effect_accum = effect_accum_copy;
+			effect_accum->rollback(effect_accum_cp);
 			return false;
 		}
 		// make sure the remaining pointee are readable or writable(if it is the ultimate pointee) in context
@@ -345,12 +348,13 @@ bool CGContext::write_pointed(const Lhs* v, const std::vector<const Fact*>& fact
 					succ = check_read_var(pointee, facts);
 				} 
 				if (!succ) {
-					*effect_accum = effect_accum_copy;
+					effect_accum->rollback(effect_accum_cp);
 					return false;
 				}
 			}
 		}
 	} 
+	effect_accum->commit(effect_accum_cp);
 	return true;
 }
 
@@ -376,7 +380,7 @@ CGContext::write_var(const Variable *v)
  *
  */
 bool
-CGContext::check_write_var(const Variable *v, const std::vector<const Fact*>& facts)
+CGContext::check_write_var(const Variable *v, const FactVec& facts)
 {
 	if (!read_indices(v, facts)) {
 		return false;
@@ -405,12 +409,12 @@ CGContext::check_write_var(const Variable *v, const std::vector<const Fact*>& fa
  * 
  */
 bool
-CGContext::read_indices(const Variable* v, const vector<const Fact*>& facts)
+CGContext::read_indices(const Variable* v, const FactVec& facts)
 {
 	size_t i;
 	vector<const Variable*> vars;
 	if (v->isArray) {
-		vector<const Fact*> facts_copy = facts;
+		FactVec facts_copy = facts;
 		const ArrayVariable* av = (const ArrayVariable*)v;
 		for (i=0; i<av->get_indices().size(); i++) {
 			const Expression* e = av->get_indices()[i];
@@ -685,7 +689,7 @@ CGContext::in_conflict(const Effect& eff) const
 }
 
 void
-CGContext::find_reachable_frame_vars(vector<const Fact*>& facts, VariableSet& frame_vars) const
+CGContext::find_reachable_frame_vars(FactVec& facts, VariableSet& frame_vars) const
 {
 	size_t i, j;
 	for (i=0; i<facts.size(); i++) {
@@ -768,6 +772,66 @@ CGContext::sanity_check(void)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+AttemptCheckpoint::AttemptCheckpoint(CGContext &cg_context, bool with_stm, FactMgr *fm)
+	: cg_context_(cg_context),
+	  with_stm_(with_stm),
+	  fm_(fm),
+	  accum_(0),
+	  stm_(0),
+	  facts_(0),
+	  open_(false)
+{
+	open();
+}
+
+void
+AttemptCheckpoint::open(void)
+{
+	assert(!open_);
+	accum_ = cg_context_.checkpoint_effect_accum();
+	if (with_stm_) {
+		stm_ = cg_context_.get_effect_stm().checkpoint();
+	}
+	if (fm_) {
+		facts_ = fm_->global_facts.checkpoint();
+	}
+	open_ = true;
+}
+
+void
+AttemptCheckpoint::commit(void)
+{
+	assert(open_);
+	cg_context_.commit_effect_accum(accum_);
+	if (with_stm_) {
+		cg_context_.get_effect_stm().commit(stm_);
+	}
+	if (fm_) {
+		fm_->global_facts.commit(facts_);
+	}
+	open_ = false;
+}
+
+/*
+ * the facts of variables created during the attempt are kept, see
+ * FactMgr::rollback_facts
+ */
+void
+AttemptCheckpoint::rollback(void)
+{
+	assert(open_);
+	cg_context_.rollback_effect_accum(accum_);
+	if (with_stm_) {
+		cg_context_.get_effect_stm().rollback(stm_);
+	}
+	if (fm_) {
+		fm_->rollback_facts(facts_);
+	}
+	open_ = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 // Local Variables:
 // c-basic-offset: 4
 // tab-width: 4
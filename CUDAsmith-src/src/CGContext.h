@@ -49,6 +49,7 @@ class Effect;
 class Function;
 class Variable;
 class Fact;
+class FactVec;
 class Block;
 class Type;
 class Lhs;
@@ -122,7 +123,7 @@ public:
 	Effect get_accum_effect(void) const				{ Effect e; return effect_accum ? *effect_accum : e; }
 	Effect& get_effect_stm(void) 					{ return effect_stm; }
 
-	void find_reachable_frame_vars(vector<const Fact*>& facts, VariableSet& frame_vars) const;
+	void find_reachable_frame_vars(FactVec& facts, VariableSet& frame_vars) const;
 	void get_external_no_reads_writes(VariableSet& no_reads, VariableSet& no_writes, const VariableSet& frame_vars) const;
 
 	bool is_nonreadable(const Variable *v) const;
@@ -131,11 +132,11 @@ public:
 	bool check_deref_volatile(const Variable *v, int deref_level);
 	void read_var(const Variable *v);
 	void write_var(const Variable *v);
-	bool check_read_var(const Variable *v, const std::vector<const Fact*>& facts);
-	bool check_write_var(const Variable *v, const std::vector<const Fact*>& facts);
-	bool read_indices(const Variable* v, const vector<const Fact*>& facts);
-	bool read_pointed(const ExpressionVariable* v, const std::vector<const Fact*>& facts);
-	bool write_pointed(const Lhs* v, const std::vector<const Fact*>& facts);
+	bool check_read_var(const Variable *v, const FactVec& facts);
+	bool check_write_var(const Variable *v, const FactVec& facts);
+	bool read_indices(const Variable* v, const FactVec& facts);
+	bool read_pointed(const ExpressionVariable* v, const FactVec& facts);
+	bool write_pointed(const Lhs* v, const FactVec& facts);
 	void add_effect(const Effect &e, bool include_lhs_effects=false);
 	void add_external_effect(const Effect &e);
 	void add_visible_effect(const Effect &e, const Block* b);
@@ -147,6 +148,11 @@ public:
 
 	void reset_effect_accum(const Effect& e) { if (effect_accum) *effect_accum = e;}
 	void reset_effect_stm(const Effect& e) { effect_stm = e;}
+
+	// see Effect::checkpoint, no-ops without an accumulated effect
+	size_t checkpoint_effect_accum(void) { return effect_accum ? effect_accum->checkpoint() : 0; }
+	void commit_effect_accum(size_t cp) { if (effect_accum) effect_accum->commit(cp); }
+	void rollback_effect_accum(size_t cp) { if (effect_accum) effect_accum->rollback(cp); }
  
 	bool allow_volatile() const;
 	bool allow_const(Effect::Access access) const;
@@ -200,6 +206,38 @@ private:
 	static const CGContext empty_context;
 };
 
+/*
+ * The checkpoints of one generation attempt: the accumulated effect of a
+ * context and, if asked for, its statement effect and the global facts of a
+ * FactMgr. Checkpoints still open when the guard goes out of scope (on an
+ * early return such as ERROR_GUARD) are committed, which keeps the changes
+ * as dropping a saved copy did, so the undo logs always close.
+ */
+class AttemptCheckpoint
+{
+public:
+	AttemptCheckpoint(CGContext &cg_context, bool with_stm, FactMgr *fm = 0);
+	~AttemptCheckpoint(void) { if (open_) commit(); }
+
+	void commit(void);
+	void rollback(void);
+	// roll back, and checkpoint again for the next attempt
+	void retry(void) { rollback(); open(); }
+
+private:
+	AttemptCheckpoint(const AttemptCheckpoint &);				// unimplementable
+	AttemptCheckpoint &operator=(const AttemptCheckpoint &);	// unimplementable
+	void open(void);
+
+	CGContext &cg_context_;
+	const bool with_stm_;
+	FactMgr * const fm_;
+	size_t accum_;
+	size_t stm_;
+	size_t facts_;
+	bool open_;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif // CGCONTEXT_H
@@ -41,6 +41,7 @@
 #include "PartialExpander.h"
 #include "DeltaMonitor.h"
 #include "Probabilities.h"
+#include "RandomEngine.h"
 #include "OutputMgr.h"
 #include "StringUtils.h"
 
@@ -113,6 +114,8 @@ DEFINE_GETTER_SETTER_BOOL(random_based)
 DEFINE_GETTER_SETTER_BOOL(dfs_exhaustive)
 DEFINE_GETTER_SETTER_STRING_REF(dfs_debug_sequence)
 DEFINE_GETTER_SETTER_INT(max_exhaustive_depth)
+DEFINE_GETTER_SETTER_INT(rng_engine)
+DEFINE_GETTER_SETTER_BOOL(direct_filter_sampling)
 DEFINE_GETTER_SETTER_BOOL(compact_output)
 DEFINE_GETTER_SETTER_BOOL(msp)
 DEFINE_GETTER_SETTER_INT(func1_max_params)
@@ -150,7 +153,6 @@ DEFINE_GETTER_SETTER_BOOL(arg_unions)
 DEFINE_GETTER_SETTER_BOOL(volatiles)
 DEFINE_GETTER_SETTER_BOOL(volatile_pointers)
 DEFINE_GETTER_SETTER_BOOL(const_pointers)
-DEFINE_GETTER_SETTER_BOOL(access_once)
 DEFINE_GETTER_SETTER_BOOL(strict_volatile_rule)
 DEFINE_GETTER_SETTER_BOOL(addr_taken_of_locals)
 DEFINE_GETTER_SETTER_BOOL(fresh_array_ctrl_var_names)
@@ -171,13 +173,64 @@ DEFINE_GETTER_SETTER_STRING_REF(dump_default_probabilities)
 DEFINE_GETTER_SETTER_STRING_REF(dump_random_probabilities)
 DEFINE_GETTER_SETTER_STRING_REF(probability_configuration)
 DEFINE_GETTER_SETTER_BOOL(const_as_condition)
-DEFINE_GETTER_SETTER_BOOL(match_exact_qualifiers)
 DEFINE_GETTER_SETTER_BOOL(blind_check_global)
 DEFINE_GETTER_SETTER_BOOL(no_return_dead_ptr)
 DEFINE_GETTER_SETTER_BOOL(hash_value_printf)
 DEFINE_GETTER_SETTER_BOOL(signed_char_index)
 DEFINE_GETTER_SETTER_BOOL(empty_blocks)
 DEFINE_GETTER_SETTER_INT(max_array_num_in_loop)
+
+/*
+ * The options are shared by all generating threads, so the two options that
+ * generation changes on the fly are overridden per thread instead.
+ */
+bool CGOptions::access_once_ = false;
+thread_local bool CGOptions::suppress_access_once_ = false;
+
+bool
+CGOptions::access_once(void)
+{
+	return access_once_ && !suppress_access_once_;
+}
+
+bool
+CGOptions::access_once(bool p)
+{
+	access_once_ = p;
+	return p;
+}
+
+bool
+CGOptions::suppress_access_once(bool p)
+{
+	bool prev = suppress_access_once_;
+	suppress_access_once_ = p;
+	return prev;
+}
+
+bool CGOptions::match_exact_qualifiers_ = false;
+thread_local bool CGOptions::force_exact_qualifiers_ = false;
+
+bool
+CGOptions::match_exact_qualifiers(void)
+{
+	return match_exact_qualifiers_ || force_exact_qualifiers_;
+}
+
+bool
+CGOptions::match_exact_qualifiers(bool p)
+{
+	match_exact_qualifiers_ = p;
+	return p;
+}
+
+bool
+CGOptions::force_exact_qualifiers(bool p)
+{
+	bool prev = force_exact_qualifiers_;
+	force_exact_qualifiers_ = p;
+	return prev;
+}
 DEFINE_GETTER_SETTER_BOOL(identify_wrappers)
 DEFINE_GETTER_SETTER_BOOL(mark_mutable_const)
 DEFINE_GETTER_SETTER_BOOL(force_globals_static)
@@ -223,6 +276,8 @@ void CGOptions::set_default_settings(void)
 	max_array_length_per_dimension(CGOPTIONS_DEFAULT_MAX_ARRAY_LENGTH_PER_DIMENSION);
 	max_array_length(CGOPTIONS_DEFAULT_MAX_ARRAY_LENGTH);
 	max_exhaustive_depth(CGOPTIONS_DEFAULT_MAX_EXHAUSTIVE_DEPTH);
+	rng_engine(rXoshiroEngine);
+	direct_filter_sampling(true);
 	max_indirect_level(CGOPTIONS_DEFAULT_MAX_INDIRECT_LEVEL);
 	output_file(CGOPTIONS_DEFAULT_OUTPUT_FILE);
 	interested_facts(ePointTo | eUnionWrite);
@@ -181,6 +181,15 @@ public:
 	static int max_exhaustive_depth(void);
 	static int max_exhaustive_depth(int p);
 
+	// One of RNG_ENGINE, see RandomEngine.h
+	static int rng_engine(void);
+	static int rng_engine(int p);
+
+	// Draw a value a filter accepts in one go, instead of redrawing until
+	// the filter accepts one. See DefaultRndNumGenerator::rnd_upto.
+	static bool direct_filter_sampling(void);
+	static bool direct_filter_sampling(bool p);
+
 	static bool compact_output(void);
 	static bool compact_output(bool p);
 
@@ -297,6 +306,9 @@ public:
 
 	static bool access_once(bool p);
 	static bool access_once(void);
+	// Temporarily turns access_once off for the calling thread only.
+	// Returns the previous setting of the override.
+	static bool suppress_access_once(bool p);
 
 	static bool strict_volatile_rule(bool p);
 	static bool strict_volatile_rule(void);
@@ -387,6 +399,9 @@ public:
 
 	static bool match_exact_qualifiers(void);
 	static bool match_exact_qualifiers(bool p);
+	// Temporarily turns match_exact_qualifiers on for the calling thread only.
+	// Returns the previous setting of the override.
+	static bool force_exact_qualifiers(bool p);
 
 	static int max_array_num_in_loop();
 	static int max_array_num_in_loop(int p);
@@ -521,6 +536,8 @@ private:
 	static bool	dfs_exhaustive_;
 	static std::string dfs_debug_sequence_;
 	static int	max_exhaustive_depth_;
+	static int	rng_engine_;
+	static bool	direct_filter_sampling_;
 	static bool	compact_output_;
 	static bool	msp_;
 	static int	func1_max_params_;
@@ -560,6 +577,7 @@ private:
 	static bool	const_pointers_;
 	static std::string	vol_tests_mach_;
 	static bool	access_once_;
+	static thread_local bool suppress_access_once_;
 	static bool	strict_volatile_rule_;
 	static bool	addr_taken_of_locals_;
 	static bool	fresh_array_ctrl_var_names_;
@@ -584,6 +602,7 @@ private:
 
 	static std::string conflict_msg_;
 	static bool match_exact_qualifiers_;
+	static thread_local bool force_exact_qualifiers_;
 
 	static int max_array_num_in_loop_;
 	static bool identify_wrappers_;
@@ -15,7 +15,7 @@ class CVQualifiers;
 
 namespace CUDASmith {
 namespace {
-DistributionTable *cuda_expr_table = NULL;
+thread_local DistributionTable *cuda_expr_table = NULL;
 }  // namespace
 
 /*CL*/Expression *CUDAExpression::make_random(CGContext &cg_context, const Type *type,
@@ -74,6 +74,8 @@ void CUDAExpression::InitProbabilityTable() {
   // is because the probability of picking a CUDAExpression is fixed in
   // Expression, so not adding them would artificially increase the
   // probabilities of other CLExpressions much more than desired.
+  // The table is fixed, so it is only built once per process.
+  if (cuda_expr_table != NULL) return;
   cuda_expr_table = new DistributionTable();
   cuda_expr_table->add_entry(kID, 5);
   cuda_expr_table->add_entry(kVector, 10);
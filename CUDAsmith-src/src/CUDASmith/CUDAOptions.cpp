@@ -22,6 +22,7 @@ DEFINE_CUDAFLAG(emi_p_compound, int, 50)
 DEFINE_CUDAFLAG(emi_p_lift, int, 10)
 DEFINE_CUDAFLAG(fake_divergence, bool, false)
 DEFINE_CUDAFLAG(group_divergence, bool, false)
+DEFINE_CUDAFLAG(host_target, bool, false)
 DEFINE_CUDAFLAG(inter_thread_comm, bool, false)
 DEFINE_CUDAFLAG(message_passing, bool, false)
 //Guai 20160912 Start
@@ -51,6 +52,7 @@ void CUDAOptions::set_default_settings() {
   emi_p_lift_ = 10;
   fake_divergence_ = false;
   group_divergence_ = false;
+  host_target_ = false;
   inter_thread_comm_ = false;
   message_passing_ = false;
   output_ = "CUDAProg.cu";
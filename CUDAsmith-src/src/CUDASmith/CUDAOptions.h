@@ -28,6 +28,7 @@ class CUDAOptions {
   DEFINE_CUDAFLAG(emi_p_lift, int)
   DEFINE_CUDAFLAG(fake_divergence, bool)
   DEFINE_CUDAFLAG(group_divergence, bool)
+  DEFINE_CUDAFLAG(host_target, bool)
   DEFINE_CUDAFLAG(inter_thread_comm, bool)
   DEFINE_CUDAFLAG(message_passing, bool)
   DEFINE_CUDAFLAG(output, const char*)
@@ -19,8 +19,10 @@
 
 namespace CUDASmith
 {
-int atomic_ID, g_ID[3], l_ID[3];
-CUDAOutputMgr::CUDAOutputMgr() : out_(CUDAOptions::output())
+thread_local int atomic_ID, g_ID[3], l_ID[3];
+CUDAOutputMgr::CUDAOutputMgr()
+    : emitter_(CUDAOptions::output()), out_(&emitter_), finished_(false),
+      written_(false)
 {
 }
 
@@ -132,7 +134,11 @@ void CUDAOutputMgr::OutputHeader(int argc, char *argv[], unsigned long seed)
     out << "// Seed: " << seed << std::endl;
     out << std::endl;
     //Guai 20160905 Start
-    out << "#include \"CUDA.h\"" << std::endl;
+    // CUDA_host.h runs the kernel on the CPU, see host_launcher.cpp.
+    if (CUDAOptions::host_target())
+	out << "#include \"CUDA_host.h\"" << std::endl;
+    else
+	out << "#include \"CUDA.h\"" << std::endl;
     out << std::endl;
     /*ifstream fin0("/home/wxy/jc/main_0.txt");
     if (!fin0)
@@ -250,5 +256,41 @@ void CUDAOutputMgr::OutputEntryFunction(Globals &globals)
     //Guai 20160905 Start
     out << "   result[get_linear_global_id()] = crc64_context ^ 0xFFFFFFFFFFFFFFFFUL;" << std::endl;
     out << "}" << std::endl;
-} // namespace CUDASmith
+    if (CUDAOptions::host_target())
+	OutputHostEntryFunction();
 }
+
+void CUDAOutputMgr::OutputHostEntryFunction()
+{
+    // Passes the buffers set up by host_launcher.cpp to entry, in the order
+    // of its parameters above.
+    std::ostream &out = get_main_out();
+    out << std::endl;
+    out << "extern \"C\" void entry_host(struct cuda_host_buffers *buffers) {"
+	<< std::endl;
+    output_tab(out, 1);
+    out << "entry(buffers->result";
+    if (CUDAOptions::atomics())
+	out << ", buffers->atomic_input, buffers->special_values";
+    if (CUDAOptions::atomic_reductions())
+	out << ", buffers->atomic_reduction";
+    if (CUDAOptions::TG())
+	out << ", buffers->tg_input";
+    if (CUDAOptions::emi())
+	out << ", buffers->emi_input";
+    if (CUDAOptions::fake_divergence())
+	out << ", buffers->sequence_input";
+    if (CUDAOptions::inter_thread_comm())
+	out << ", buffers->comm_values";
+    out << ");" << std::endl;
+    out << "}" << std::endl;
+    // Without shared buffers or atomics the threads of a block cannot see
+    // each other, so the launcher may run them one after the other.
+    bool independent = !CUDAOptions::atomics() &&
+	!CUDAOptions::atomic_reductions() &&
+	!CUDAOptions::inter_thread_comm() && !CUDAOptions::barriers() &&
+	!CUDAOptions::message_passing();
+    out << "static const bool entry_host_independent = "
+	<< (independent ? "true" : "false") << ";" << std::endl;
+}
+} // namespace CUDASmith
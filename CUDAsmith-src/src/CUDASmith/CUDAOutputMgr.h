@@ -7,9 +7,10 @@
 #ifndef _CUDASMITH_CLOUTPUTMGR_H_
 #define _CUDASMITH_CLOUTPUTMGR_H_
 
-#include <fstream>
+#include <ostream>
 #include <string>
 
+#include "CodeEmitter.h"
 #include "CommonMacros.h"
 #include "OutputMgr.h"
 
@@ -20,9 +21,29 @@ class Globals;
 class CUDAOutputMgr : public OutputMgr {
  public:
   CUDAOutputMgr();
-  explicit CUDAOutputMgr(const std::string& filename) : out_(filename.c_str()) {}
-  explicit CUDAOutputMgr(const char *filename) : out_(filename) {}
-  ~CUDAOutputMgr() { out_.close(); }
+  explicit CUDAOutputMgr(const std::string& filename)
+      : emitter_(filename.c_str()), out_(&emitter_), finished_(false),
+        written_(false) {}
+  explicit CUDAOutputMgr(const char *filename)
+      : emitter_(filename), out_(&emitter_), finished_(false),
+        written_(false) {}
+  // Keeps the kernel in memory instead of writing it to a file; it is then
+  // taken with TakeOutput().
+  struct InMemory {};
+  explicit CUDAOutputMgr(InMemory)
+      : out_(&emitter_), finished_(false), written_(false) {}
+  ~CUDAOutputMgr() { Finish(); }
+
+  // Writes the buffered kernel out to the file, if there is one. Nothing
+  // should be output after this. Returns false if the file could not be
+  // opened or written, and the same again on later calls.
+  bool Finish() {
+    if (!finished_) {
+      finished_ = true;
+      written_ = emitter_.is_open() && emitter_.finish();
+    }
+    return written_;
+  }
   
   // Outputs information regarding the runtime to be read by the host code
   void OutputRuntimeInfo(const std::vector<unsigned int>& threads,
@@ -42,8 +63,19 @@ class CUDAOutputMgr : public OutputMgr {
   // so we can't override it.
   void OutputEntryFunction(Globals& globals);
 
+  // Outputs entry_host, through which host_launcher.cpp calls the entry
+  // function of a --host-target kernel.
+  void OutputHostEntryFunction();
+
+  // The kernel text, when constructed with InMemory.
+  std::string TakeOutput() { return emitter_.take(); }
+
  private:
-  std::ofstream out_;
+  // The whole kernel is buffered, and only written out on destruction.
+  CodeEmitter emitter_;
+  std::ostream out_;
+  bool finished_;
+  bool written_;
 
   DISALLOW_COPY_AND_ASSIGN(CUDAOutputMgr);
 };
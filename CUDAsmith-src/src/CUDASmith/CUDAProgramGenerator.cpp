@@ -34,13 +34,14 @@ static const unsigned int max_threads = 10000;
 static const unsigned int max_thr_per_dim = 100;
 static const unsigned int max_threads_per_group = 256;
 static const unsigned int no_dims = 3;
-static unsigned int noThreads = 1;
-static unsigned int noGroups = 1;
-static std::vector<unsigned int> *globalDim;
-static std::vector<unsigned int> *localDim;
+static thread_local unsigned int noThreads = 1;
+static thread_local unsigned int noGroups = 1;
+static thread_local std::vector<unsigned int> *globalDim = NULL;
+static thread_local std::vector<unsigned int> *localDim = NULL;
 }  // namespace
 
 void CUDAProgramGenerator::goGenerator() {
+  StartPhase("init");
   // Initialise probabilies.
   CUDAExpression::InitProbabilityTable();
   CUDAStatement::InitProbabilityTable();
@@ -65,17 +66,21 @@ void CUDAProgramGenerator::goGenerator() {
 
   // This creates the random program, the rest handles post-processing and
   // outputting the program.
+  StartPhase("types");
   GenerateAllTypes();
+  StartPhase("functions");
   GenerateFunctions();
 
   // If tracking divergence is set, perform the tracking now.
   std::unique_ptr<Divergence> div;
   if (CUDAOptions::track_divergence()) {
+    StartPhase("divergence");
     div.reset(new Divergence());
     div->ProcessEntryFunction(GetFirstFunction());
   }
 
   // If EMI block generation is set, prune them.
+  StartPhase("prune");
   if (CUDAOptions::emi())
     EMIController::GetEMIController()->PruneEMISections();
 
@@ -86,6 +91,7 @@ void CUDAProgramGenerator::goGenerator() {
   
 
   // If atomic blocks are generated, add operations for the special values
+  StartPhase("special_values");
   if (CUDAOptions::atomics())
     StatementAtomicResult::GenSpecialVals();
 
@@ -101,6 +107,7 @@ void CUDAProgramGenerator::goGenerator() {
   // program generation should have been created. Any global variables added to
   // VariableSelector's global list after this point must be added to globals
   // manually, or the name will not be prepended with the global struct.
+  StartPhase("globals");
   Globals *globals = Globals::GetGlobals();
 
   // Once the global struct is created, we add the global memory buffers.
@@ -140,15 +147,24 @@ void CUDAProgramGenerator::goGenerator() {
 
   // If barriers have been set, use the divergence information to place them.
   if (CUDAOptions::barriers()) {
+    StartPhase("barriers");
     if (CUDAOptions::divergence()) GenerateBarriers(div.get(), globals);
     else { /*TODO Non-div barriers*/ }
   }
 
-  if (CUDAOptions::small())
+  if (CUDAOptions::small()) {
+    StartPhase("unused_vars");
     CUDASmith::CUDAVariable::ParseUnusedVars();
+  }
 
   // Output the whole program.
+  // The phase includes the write of the buffered kernel.
+  StartPhase("output");
   output_mgr_->Output();
+  if (CUDAOutputMgr *cuda_output_mgr =
+      dynamic_cast<CUDAOutputMgr *>(output_mgr_.get()))
+    cuda_output_mgr->Finish();
+  if (profile_) profile_->EndPhase();
 
   // Release any singleton instances used.
   Globals::ReleaseGlobals();
@@ -156,9 +172,21 @@ void CUDAProgramGenerator::goGenerator() {
 
   //add by wxy 2018-03-20
   TGController::ReleaseTGController();
+
+  // Reset the remaining per-program state, so that another program can be
+  // generated in the same process (see --seed-range).
+  ExpressionAtomic::ReleaseAtomics();
+  StatementAtomicReduction::ReleaseBuffers();
+  StatementComm::ReleaseBuffers();
+  ExpressionID::Release();
+  MessagePassing::Release();
 }
 
 void CUDAProgramGenerator::InitRuntimeParameters() {
+  noThreads = 1;
+  noGroups = 1;
+  delete globalDim;
+  delete localDim;
   globalDim = new std::vector<unsigned int>(no_dims, 1);
   localDim = new std::vector<unsigned int>(no_dims, 1);
   std::vector<unsigned int>& globalDim = *CUDASmith::globalDim;
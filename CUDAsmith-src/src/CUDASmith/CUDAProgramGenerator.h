@@ -8,6 +8,7 @@
 
 #include "AbsProgramGenerator.h"
 #include "CUDASmith/CUDAOutputMgr.h"
+#include "CUDASmith/GenerationProfile.h"
 #include "CommonMacros.h"
 
 #include <memory>
@@ -18,13 +19,17 @@ namespace CUDASmith {
 class CUDAProgramGenerator : public AbsProgramGenerator {
  public:
   explicit CUDAProgramGenerator(unsigned long seed)
-      : output_mgr_(new CUDAOutputMgr()), seed_(seed) {
+      : output_mgr_(new CUDAOutputMgr()), seed_(seed), profile_(NULL) {
   }
   // Transfer pointer ownership.
   CUDAProgramGenerator(unsigned long seed, OutputMgr *output_mgr)
-      : output_mgr_(output_mgr), seed_(seed) {
+      : output_mgr_(output_mgr), seed_(seed), profile_(NULL) {
   }
 
+  // Records the phases of goGenerator in the given profile. Does not take
+  // ownership.
+  void set_profile(GenerationProfile *profile) { profile_ = profile; }
+
   // Inherited from AbsProgramGenerator. Creates the random program.
   void goGenerator();
 
@@ -54,6 +59,12 @@ class CUDAProgramGenerator : public AbsProgramGenerator {
  private:
   std::unique_ptr<OutputMgr> output_mgr_;
   unsigned long seed_;
+  GenerationProfile *profile_;
+
+  // Starts the named phase of goGenerator in the profile, if there is one.
+  void StartPhase(const char *name) {
+    if (profile_) profile_->StartPhase(name);
+  }
   
   // To be called at the beginning of the program generation; sets the 
   // runtime parameters of the program, such as number of groups or threads
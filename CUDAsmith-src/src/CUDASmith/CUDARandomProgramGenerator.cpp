@@ -1,23 +1,51 @@
-// Entry point to the program.
+// Command line of the generator, see CUDARandomProgramGenerator.h.
 
+#include "CUDASmith/CUDARandomProgramGenerator.h"
+
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "AbsProgramGenerator.h"
 #include "CGOptions.h"
+#include "DrawProfiler.h"
 #include "CUDASmith/CUDAOptions.h"
 #include "CUDASmith/CUDAOutputMgr.h"
 #include "CUDASmith/CUDAProgramGenerator.h"
+#include "CUDASmith/GenerationProfile.h"
+#include "CUDASmith/KernelArchive.h"
+#include "CUDASmith/KernelInterpreter.h"
+#include "Probabilities.h"
+#include "RandomEngine.h"
 #include "platform.h"
 
+#ifndef WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 extern bool g_Tgoff;
 extern bool g_FCBoff;
 
 // Generator seed.
 // static unsigned long g_Seed = 0;
 extern unsigned long g_Seed;
+
+// Set by --profile-json.
+static bool g_ProfileJSON = false;
+
+// Set by --expected-results.
+static bool g_ExpectedResults = false;
+
 bool CheckArgExists(int idx, int argc) {
   if (idx >= argc) std::cout << "Expected another argument" << std::endl;
   return idx < argc;
@@ -29,11 +57,266 @@ bool ParseIntArg(const char *arg, unsigned long *value) {
   return res;
 }
 
-int main(int argc, char **argv) {
+bool ParseSeedRange(const char *arg, unsigned long *first,
+    unsigned long *last) {
+  bool res = sscanf(arg, "%lu:%lu", first, last) == 2 && *first <= *last;
+  if (!res) std::cout << "Expected seed range A:B with A <= B" << std::endl;
+  return res;
+}
+
+// In batch mode each program is written to the output file with the seed
+// inserted before the extension, e.g. CUDAProg.cu -> CUDAProg_42.cu.
+std::string BatchOutputName(const std::string& output, unsigned long seed) {
+  std::string::size_type dot = output.rfind('.');
+  std::string::size_type slash = output.rfind('/');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    dot = output.size();
+  return output.substr(0, dot) + '_' + std::to_string(seed) +
+      output.substr(dot);
+}
+
+// Sidecars of a program go next to it, with the extension replaced, e.g.
+// CUDAProg_42.cu -> CUDAProg_42.profile.json.
+std::string SidecarName(const std::string& output, const char *extension) {
+  std::string::size_type dot = output.rfind('.');
+  std::string::size_type slash = output.rfind('/');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    dot = output.size();
+  return output.substr(0, dot) + extension;
+}
+
+std::string ProfileOutputName(const std::string& output) {
+  return SidecarName(output, ".profile.json");
+}
+
+// Writes the profile of the program generated for a seed to its sidecar.
+bool WriteProfile(int argc, char **argv, unsigned long seed,
+    const std::string& output, const CUDASmith::GenerationProfile& profile) {
+  std::string args;
+  for (int idx = 1; idx < argc; ++idx) {
+    if (idx > 1) args += ' ';
+    args += argv[idx];
+  }
+  std::ofstream out(ProfileOutputName(output).c_str());
+  profile.WriteJSON(out, seed, args);
+  return (bool)out;
+}
+
+// Interprets the program generated for a seed and writes the result of every
+// thread to its sidecar, e.g. CUDAProg_42.expected, in the format of
+// cuda_launcher's output. A kernel that is not interpreted gets no sidecar;
+// why is reported instead.
+bool WriteExpectedResults(unsigned long seed, const std::string& output,
+    const std::string& kernel) {
+  std::vector<int64_t> results;
+  std::string error;
+  if (!CUDASmith::InterpretKernel(kernel, &results, &error)) {
+    std::cout << "seed " << seed << ": no expected results (" << error << ")"
+              << std::endl;
+    return true;
+  }
+  std::ofstream out(SidecarName(output, ".expected").c_str());
+  CUDASmith::WriteKernelResults(out, results);
+  return (bool)out;
+}
+
+// Generates a single program for the given seed. All the state set up during
+// generation is torn down again, so this may be called repeatedly. The
+// generator state is thread local, so different threads may call this at the
+// same time. If an archive is given, the program is appended to it instead of
+// being written to the output file. With --expected-results the program is
+// also interpreted, so it is kept in memory until then.
+int GenerateProgram(int argc, char **argv, unsigned long seed,
+    const std::string& output,
+    CUDASmith::KernelArchiveWriter *archive = NULL) {
+  // AbsProgramGenerator does other initialisation stuff, besides itself. So we
+  // call it, disregarding the returned object. Still need to delete it.
+  AbsProgramGenerator *generator =
+      AbsProgramGenerator::CreateInstance(argc, argv, seed);
+  if (!generator) {
+    cout << "error: can't create AbsProgramGenerator. csmith init failed!"
+         << std::endl;
+    return -1;
+  }
+
+  // Now create our program generator for OpenCL.
+  const bool in_memory = archive || g_ExpectedResults;
+  CUDASmith::CUDAOutputMgr *output_mgr = in_memory ?
+      new CUDASmith::CUDAOutputMgr(CUDASmith::CUDAOutputMgr::InMemory()) :
+      new CUDASmith::CUDAOutputMgr(output);
+  CUDASmith::CUDAProgramGenerator cl_generator(seed, output_mgr);
+  CUDASmith::GenerationProfile profile;
+  if (g_ProfileJSON) cl_generator.set_profile(&profile);
+  cl_generator.goGenerator();
+  if (g_ProfileJSON && !WriteProfile(argc, argv, seed, output, profile)) {
+    cout << "error: can't write the profile for seed " << seed << std::endl;
+    delete generator;
+    return -1;
+  }
+  const std::string kernel = in_memory ? output_mgr->TakeOutput() : "";
+  if (archive && !archive->Append(seed, kernel)) {
+    cout << "error: can't append the program for seed " << seed
+         << " to the archive" << std::endl;
+    delete generator;
+    return -1;
+  }
+  if (!in_memory && !output_mgr->Finish()) {
+    cout << "error: can't write the program for seed " << seed << std::endl;
+    delete generator;
+    return -1;
+  }
+  if (!archive && in_memory) {
+    std::ofstream out(output.c_str(), std::ios::binary);
+    if (!out.write(kernel.data(), kernel.size())) {
+      cout << "error: can't write the program for seed " << seed << std::endl;
+      delete generator;
+      return -1;
+    }
+  }
+  if (g_ExpectedResults && !WriteExpectedResults(seed, output, kernel)) {
+    cout << "error: can't write the expected results for seed " << seed
+         << std::endl;
+    delete generator;
+    return -1;
+  }
+
+  // Calls Finalization::doFinalization(), which deletes everything, so must be
+  // called after program generation.
+  delete generator;
+  return 0;
+}
+
+#ifndef WIN32
+// Fork server: the seed independent setup is done once, then every seed read
+// from stdin is generated in a child forked from this process. Children share
+// the initialised tables copy-on-write, and a seed that crashes or trips an
+// assert only takes its own child down. One line is reported per seed:
+//   <seed> ok <ms>
+//   <seed> exit <status> <ms>
+//   <seed> signal <signal> <ms>
+// Up to 'jobs' children run at the same time.
+int RunForkServer(int argc, char **argv, const std::string& output,
+    unsigned long jobs) {
+  typedef std::chrono::steady_clock Clock;
+  struct Child {
+    unsigned long seed;
+    Clock::time_point start;
+  };
+  std::map<pid_t, Child> children;
+  bool failed = false;
+
+  // The probabilities only depend on the options, unless they are themselves
+  // randomised, in which case they must be drawn from each seed's generator.
+  // (The simple types are not created here: the order in which types enter
+  // Type::AllTypes during generation affects the output.)
+  if (!CGOptions::random_random()) Probabilities::GetInstance();
+
+  // Reaps one child and reports on it.
+  auto reap = [&]() {
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) return;
+    std::map<pid_t, Child>::iterator it = children.find(pid);
+    if (it == children.end()) return;
+    long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - it->second.start).count();
+    std::cout << it->second.seed;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      std::cout << " ok ";
+    } else if (WIFEXITED(status)) {
+      std::cout << " exit " << WEXITSTATUS(status) << ' ';
+      failed = true;
+    } else {
+      std::cout << " signal " << WTERMSIG(status) << ' ';
+      failed = true;
+    }
+    std::cout << ms << std::endl;
+    children.erase(it);
+  };
+
+  unsigned long seed;
+  while (std::cin >> seed) {
+    while (children.size() >= jobs) reap();
+    // Anything still buffered would otherwise be written by the child too.
+    std::cout.flush();
+    Child child = { seed, Clock::now() };
+    pid_t pid = fork();
+    if (pid < 0) {
+      std::cout << "error: fork failed for seed " << seed << std::endl;
+      failed = true;
+      break;
+    }
+    if (pid == 0) {
+      int res = GenerateProgram(argc, argv, seed, BatchOutputName(output, seed));
+      std::cout.flush();
+      _exit(res ? 1 : 0);
+    }
+    children[pid] = child;
+  }
+  if (!std::cin.eof()) {
+    std::cout << "Expected integer seeds on stdin" << std::endl;
+    failed = true;
+  }
+  while (!children.empty()) reap();
+  return failed ? -1 : 0;
+}
+#endif
+
+// Generates the programs for the seeds [first_seed, last_seed].
+int GenerateBatch(int argc, char **argv, const std::string& output,
+    CUDASmith::KernelArchiveWriter *archive, unsigned long first_seed,
+    unsigned long last_seed, unsigned long jobs) {
+  if (jobs == 1) {
+    for (unsigned long seed = first_seed; ; ++seed) {
+      if (GenerateProgram(argc, argv, seed, BatchOutputName(output, seed),
+                          archive))
+        return -1;
+      if (seed == last_seed) break;
+    }
+    return 0;
+  }
+
+  // Each worker takes the next seed until the range is exhausted.
+  std::atomic<unsigned long> remaining(last_seed - first_seed + 1);
+  std::atomic<bool> failed(false);
+  std::vector<std::thread> workers;
+  for (unsigned long job = 0; job < jobs; ++job)
+    workers.emplace_back([&]() {
+      unsigned long left;
+      while ((left = remaining.load()) > 0 && !failed) {
+        if (!remaining.compare_exchange_weak(left, left - 1)) continue;
+        unsigned long seed = last_seed - (left - 1);
+        if (GenerateProgram(argc, argv, seed, BatchOutputName(output, seed),
+                            archive))
+          failed = true;
+      }
+    });
+  for (std::thread& worker : workers) worker.join();
+  return failed ? -1 : 0;
+}
+
+int RunCUDASmith(int argc, char **argv) {
   g_Seed = platform_gen_seed();
   CGOptions::set_default_settings();
   CUDASmith::CUDAOptions::set_default_settings();
+  g_Tgoff = false;
+  g_FCBoff = false;
+  g_ProfileJSON = false;
+  CUDASmith::GenerationProfile::CountAllocations(false);
+  g_ExpectedResults = false;
   std::string output_filename = "";
+  // Batch mode: generate seeds [first_seed, last_seed] in this process.
+  bool batch = false;
+  bool seed_range = false;
+  unsigned long first_seed = 0;
+  unsigned long last_seed = 0;
+  unsigned long count = 0;
+  unsigned long jobs = 1;
+  bool fork_server = false;
+  std::string archive_path;
+  unsigned long archive_shards = 1;
+  // --filter-sampling, if given: 1 for direct, 0 for rejection.
+  int direct_filter_sampling = -1;
 
   // Parse command line arguments.
   for (int idx = 1; idx < argc; ++idx) {
@@ -45,6 +328,112 @@ int main(int argc, char **argv) {
       continue;
     }
 
+    if (!strcmp(argv[idx], "--seed-range")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      if (!ParseSeedRange(argv[idx], &first_seed, &last_seed)) return -1;
+      batch = seed_range = true;
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--count")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      if (!ParseIntArg(argv[idx], &count)) return -1;
+      if (count == 0) {
+        std::cout << "Expected a positive count" << std::endl;
+        return -1;
+      }
+      batch = true;
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--fork-server")) {
+#ifdef WIN32
+      std::cout << "--fork-server is not supported on this platform"
+                << std::endl;
+      return -1;
+#endif
+      fork_server = true;
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--archive")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      archive_path = argv[idx];
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--archive-shards")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      if (!ParseIntArg(argv[idx], &archive_shards)) return -1;
+      if (archive_shards == 0) {
+        std::cout << "Expected a positive number of shards" << std::endl;
+        return -1;
+      }
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--profile-json")) {
+      g_ProfileJSON = true;
+      CUDASmith::GenerationProfile::CountAllocations(true);
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--expected-results")) {
+      g_ExpectedResults = true;
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--profile-draws")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      DrawProfiler::enable(argv[idx]);
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--jobs") ||
+        !strcmp(argv[idx], "-j")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      if (!ParseIntArg(argv[idx], &jobs)) return -1;
+      if (jobs == 0) jobs = std::thread::hardware_concurrency();
+      if (jobs == 0) jobs = 1;
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--rng")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      if (!strcmp(argv[idx], "xoshiro")) {
+        CGOptions::rng_engine(rXoshiroEngine);
+      } else if (!strcmp(argv[idx], "lrand48")) {
+        CGOptions::rng_engine(rLrand48Engine);
+      } else {
+        std::cout << "Invalid RNG \"" << argv[idx]
+                  << "\", accept xoshiro or lrand48" << std::endl;
+        return -1;
+      }
+      continue;
+    }
+
+    if (!strcmp(argv[idx], "--filter-sampling")) {
+      ++idx;
+      if (!CheckArgExists(idx, argc)) return -1;
+      if (!strcmp(argv[idx], "direct")) {
+        direct_filter_sampling = 1;
+      } else if (!strcmp(argv[idx], "rejection")) {
+        direct_filter_sampling = 0;
+      } else {
+        std::cout << "Invalid filter sampling \"" << argv[idx]
+                  << "\", accept direct or rejection" << std::endl;
+        return -1;
+      }
+      continue;
+    }
+
     if (!strcmp(argv[idx], "--atomic_reductions")) {
       CUDASmith::CUDAOptions::atomic_reductions(true);
       continue;
@@ -121,6 +510,11 @@ int main(int argc, char **argv) {
       continue;
     }
 
+    if (!strcmp(argv[idx], "--host-target")) {
+      CUDASmith::CUDAOptions::host_target(true);
+      continue;
+    }
+
     if (!strcmp(argv[idx], "--inter_thread_comm")) {
       CUDASmith::CUDAOptions::inter_thread_comm(true);
       continue;
@@ -177,29 +571,74 @@ int main(int argc, char **argv) {
   }
   // End parsing.
 
+  // The lrand48 engine is there to regenerate historic seeds, which were
+  // drawn by rejection.
+  if (direct_filter_sampling < 0)
+    direct_filter_sampling = CGOptions::rng_engine() != rLrand48Engine;
+  CGOptions::direct_filter_sampling(direct_filter_sampling);
+
   // Resolve any options in CGOptions that must change as a result of options
   // that the user has set.
   CUDASmith::CUDAOptions::ResolveCGOptions();
   // Check for conflicting options
   if (CUDASmith::CUDAOptions::Conflict()) return -1;
 
-  // AbsProgramGenerator does other initialisation stuff, besides itself. So we
-  // call it, disregarding the returned object. Still need to delete it.
-  AbsProgramGenerator *generator =
-      AbsProgramGenerator::CreateInstance(argc, argv, g_Seed);
-  if (!generator) {
-    cout << "error: can't create AbsProgramGenerator. csmith init failed!"
-         << std::endl;
-    return -1;
+  const std::string output = CUDASmith::CUDAOptions::output();
+  if (fork_server) {
+    if (batch) {
+      std::cout << "--fork-server reads its seeds from stdin, it cannot be "
+                << "combined with --seed-range or --count" << std::endl;
+      return -1;
+    }
+    if (!archive_path.empty()) {
+      std::cout << "--fork-server writes one file per seed, it cannot be "
+                << "combined with --archive" << std::endl;
+      return -1;
+    }
+    if (DrawProfiler::is_enabled()) {
+      std::cout << "--profile-draws counts the draws of this process, it "
+                << "cannot be combined with --fork-server" << std::endl;
+      return -1;
+    }
+#ifndef WIN32
+    return RunForkServer(argc, argv, output, jobs);
+#endif
   }
 
-  // Now create our program generator for OpenCL.
-  CUDASmith::CUDAProgramGenerator cl_generator(g_Seed);
-  cl_generator.goGenerator();
-
-  // Calls Finalization::doFinalization(), which deletes everything, so must be
-  // called after program generation.
-  delete generator;
-
-  return 0;
+  // All the programs go to one archive (or a few shards of one) instead of
+  // one file each.
+  std::unique_ptr<CUDASmith::KernelArchiveWriter> archive;
+  if (!archive_path.empty()) {
+    archive.reset(
+        new CUDASmith::KernelArchiveWriter(archive_path, archive_shards));
+    if (!archive->IsOpen()) {
+      std::cout << "error: can't create the archive " << archive_path
+                << std::endl;
+      return -1;
+    }
+  }
+  // --count N alone generates N programs starting at --seed (or a random
+  // seed); together with --seed-range it limits the size of the range.
+  if (!batch) {
+    first_seed = last_seed = g_Seed;
+  } else if (!seed_range) {
+    first_seed = g_Seed;
+    last_seed = g_Seed + count - 1;
+  } else if (count && count - 1 < last_seed - first_seed) {
+    last_seed = first_seed + count - 1;
+  }
+  int res = batch ? GenerateBatch(argc, argv, output, archive.get(),
+      first_seed, last_seed, jobs) :
+      GenerateProgram(argc, argv, g_Seed, output, archive.get());
+  if (archive && !archive->Close()) {
+    std::cout << "error: can't write the archive " << archive_path
+              << std::endl;
+    return -1;
+  }
+  if (DrawProfiler::is_enabled() &&
+      !DrawProfiler::report(last_seed - first_seed + 1)) {
+    std::cout << "error: can't write the draw profile" << std::endl;
+    return -1;
+  }
+  return res;
 }
@@ -0,0 +1,13 @@
+// The generator's command line. The CUDASmith executable is a thin wrapper
+// around it, and tools that generate kernels in process (e.g. the generation
+// benchmark) call it directly.
+
+#ifndef _CUDASMITH_CUDARANDOMPROGRAMGENERATOR_H_
+#define _CUDASMITH_CUDARANDOMPROGRAMGENERATOR_H_
+
+// Parses the options and generates the programs they ask for. All the options
+// are reset to their defaults first, so this may be called repeatedly with
+// different options. Returns 0 on success.
+int RunCUDASmith(int argc, char **argv);
+
+#endif  // _CUDASMITH_CUDARANDOMPROGRAMGENERATOR_H_
@@ -16,7 +16,7 @@
 const int Total_Prob = 5+15+5+5+5+10+50;
 namespace CUDASmith {
 namespace {
-DistributionTable *cl_stmt_table = NULL;
+thread_local DistributionTable *cl_stmt_table = NULL;
 }  // namespace
 
 CUDAStatement *CUDAStatement::make_random(CGContext& cg_context,
@@ -116,6 +116,7 @@ CUDAStatement *CUDAStatement::make_random(CGContext& cg_context,
 }*/
 
 void CUDAStatement::InitProbabilityTable() {
+  if (cl_stmt_table != NULL) return;
   cl_stmt_table = new DistributionTable();
   cl_stmt_table->add_entry(kBarrier, 5);
   cl_stmt_table->add_entry(kEMI, 15);
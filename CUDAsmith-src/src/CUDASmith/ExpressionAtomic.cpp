@@ -31,33 +31,33 @@ namespace CUDASmith {
 
 namespace {
 // Max number of atomic blocks that the generated program should contains
-static int no_atomic_blocks = 0;
+static thread_local int no_atomic_blocks = 0;
 
 // Corresponds to the global array parameter passed to the kernel
-static MemoryBuffer* global_in_buf = NULL;
-static MemoryBuffer* local_in_buf = NULL;
+static thread_local MemoryBuffer* global_in_buf = NULL;
+static thread_local MemoryBuffer* local_in_buf = NULL;
 
 // Corresponds to the special value array in the global struct
-static MemoryBuffer* global_sv_buf = NULL;
-static MemoryBuffer* local_sv_buf = NULL;
+static thread_local MemoryBuffer* global_sv_buf = NULL;
+static thread_local MemoryBuffer* local_sv_buf = NULL;
 
 // Holds the global array parameter reference and all references to it;
 // these need to be added to the global struct when it is created.
 // (in CUDAProgramGenerator::goGenerator())
-static std::vector<MemoryBuffer*>* global_in = NULL;
-static std::vector<MemoryBuffer*>* local_in = NULL;
+static thread_local std::vector<MemoryBuffer*>* global_in = NULL;
+static thread_local std::vector<MemoryBuffer*>* local_in = NULL;
 
 // The global parameter for special values; also to be declared in the global
 // struct.
-static std::vector<MemoryBuffer*>* global_sv = NULL;
-static std::vector<MemoryBuffer*>* local_sv = NULL;
+static thread_local std::vector<MemoryBuffer*>* global_sv = NULL;
+static thread_local std::vector<MemoryBuffer*>* local_sv = NULL;
 
 // To be used during code generation; holds the variables generated in an
 // atomic block and uses them to compute a special value used for checking
-static std::stack<std::map<int, std::vector<Variable *>*>*>* block_vars = NULL;
-static std::stack<Block*>* atomic_parent = NULL;
+static thread_local std::stack<std::map<int, std::vector<Variable *>*>*>* block_vars = NULL;
+static thread_local std::stack<Block*>* atomic_parent = NULL;
 
-static std::vector<int>* free_counters = NULL;
+static thread_local std::vector<int>* free_counters = NULL;
 } // namespace
 
 void ExpressionAtomic::InitAtomics() {
@@ -69,6 +69,29 @@ void ExpressionAtomic::InitAtomics() {
   StatementAtomicResult::InitResults();
 }
 
+void ExpressionAtomic::ReleaseAtomics() {
+  no_atomic_blocks = 0;
+  global_in_buf = NULL;
+  local_in_buf = NULL;
+  global_sv_buf = NULL;
+  local_sv_buf = NULL;
+  delete global_in;
+  global_in = NULL;
+  delete local_in;
+  local_in = NULL;
+  delete global_sv;
+  global_sv = NULL;
+  delete local_sv;
+  local_sv = NULL;
+  delete block_vars;
+  block_vars = NULL;
+  delete atomic_parent;
+  atomic_parent = NULL;
+  delete free_counters;
+  free_counters = NULL;
+  StatementAtomicResult::ReleaseResults();
+}
+
 // TODO make if from switch (+ other functions too)
 ExpressionAtomic* ExpressionAtomic::make_random(CGContext &cg_context, const Type *type) {
   assert(type->eType == eSimple && type->simple_type == eInt);
@@ -117,6 +117,10 @@ class ExpressionAtomic : public CUDAExpression {
   
   // Initialize various parameters related to atomic blocks
   static void InitAtomics(void);
+
+  // Reset the atomic parameters and buffers so another program can be
+  // generated; the buffers themselves are owned by the variable selector.
+  static void ReleaseAtomics(void);
   
   // Return the number of maximum atomic blocks for the current program
   static int get_atomic_blocks_no(void);
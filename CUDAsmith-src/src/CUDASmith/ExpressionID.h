@@ -52,6 +52,10 @@ class ExpressionID : public CUDAExpression {
   // Initialise the static data used for divergence faking.
   static void Initialise();
 
+  // Drop the data created by Initialise(), so it is recreated for the next
+  // program.
+  static void Release();
+
   // Add any variables referred to throughout the program to the globals struct.
   static void AddVarsToGlobals(Globals *globals);
 
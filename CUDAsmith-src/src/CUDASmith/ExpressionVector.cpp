@@ -1,5 +1,6 @@
 #include "CUDASmith/ExpressionVector.h"
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -22,8 +23,41 @@ extern unsigned long g_Seed;
 
 namespace CUDASmith {
 namespace {
-DistributionTable *vector_expr_table = NULL;
-DistributionTable *suffix_table = NULL;
+thread_local DistributionTable *vector_expr_table = NULL;
+thread_local DistributionTable *suffix_table = NULL;
+
+// The literal values used to come from libc srand()/rand(), which share one
+// global state between threads. This reproduces the glibc rand() sequence for
+// a given seed (the TYPE_3 additive feedback generator) as a local object, so
+// the output is unchanged.
+class LiteralRandom {
+ public:
+  explicit LiteralRandom(unsigned int seed) : idx_(kDegree + 3) {
+    int32_t word = seed ? seed : 1;
+    r_[0] = word;
+    for (int i = 1; i < kDegree; ++i) {
+      const int32_t hi = word / 127773, lo = word % 127773;
+      word = 16807 * lo - 2836 * hi;
+      if (word < 0) word += 2147483647;
+      r_[i] = word;
+    }
+    for (int i = kDegree; i < kDegree + 3; ++i) r_[i] = r_[i - kDegree];
+    for (int i = 0; i < 10 * kDegree; ++i) Next();
+  }
+
+  int Next() {
+    uint32_t value = r_[(idx_ + 3) % kSize] + r_[(idx_ + kDegree) % kSize];
+    r_[idx_ % kSize] = value;
+    ++idx_;
+    return value >> 1;
+  }
+
+ private:
+  static const int kDegree = 31;
+  static const int kSize = kDegree + 3;
+  uint32_t r_[kSize];
+  unsigned long idx_;
+};
 }  // namespace
 
 ExpressionVector *ExpressionVector::make_random(CGContext &cg_context,
@@ -128,6 +162,7 @@ ExpressionVector *ExpressionVector::make_constant(const Type *type, int value) {
 }
 
 void ExpressionVector::InitProbabilityTable() {
+  if (vector_expr_table != NULL) return;
   vector_expr_table = new DistributionTable();
   vector_expr_table->add_entry(kLiteral, 10);
   vector_expr_table->add_entry(kVariable, 10);
@@ -204,7 +239,7 @@ void ExpressionVector::Output(std::ostream& out) const {
   */
 	//int flag = 0;
 	unsigned int rannum  = 0;
-  srand(g_Seed);
+  LiteralRandom literal_random(g_Seed);
   const int MOSHU = 10000;// control the scale of vector
   for (int idx = 0; idx < size_; ++idx) {
     	//exprs_[idx]->Output(out);
@@ -217,7 +252,7 @@ void ExpressionVector::Output(std::ostream& out) const {
 	// }
 	// else 
 	//   srand (rannum );
-	rannum = rand () % MOSHU;
+	rannum = literal_random.Next() % MOSHU;
 	out << rannum;
     if (size_ - idx > 1) out << ", ";
   }
@@ -13,9 +13,9 @@
 namespace CUDASmith {
 namespace {
 // Integer function tables.
-DistributionTable *integer_func_table = NULL;
+thread_local DistributionTable *integer_func_table = NULL;
 // Internal::ParameterType::ParameterTypeMap<enum FunctionInvocationIntegerBuiltIn::BuiltIn> *integer_param_map;
-std::map<enum FunctionInvocationIntegerBuiltIn::BuiltIn,
+thread_local std::map<enum FunctionInvocationIntegerBuiltIn::BuiltIn,
          std::vector<Internal::ParameterType::TypeConversion>> *
     integer_param_map = NULL;
 
@@ -35,9 +35,9 @@ const Type& ConvertParameterType(
   // Only convert scalar and vector types. Other types should never get here.
   assert(type.eType == eSimple || type.eType == eVector);
   // For kFlipSignChance2.
-  static int flip_next = 0;
+  static thread_local int flip_next = 0;
   // For kDemoteChance2.
-  static int demote_next = 0;
+  static thread_local int demote_next = 0;
 
   const Type *t = NULL;
   switch (conversion) {
@@ -194,6 +194,7 @@ enum FunctionInvocationIntegerBuiltIn::BuiltIn
 }
 
 void FunctionInvocationIntegerBuiltIn::InitTables() {
+  if (integer_func_table != NULL) return;
   integer_func_table = new DistributionTable();
   for (int func = kAbs; func <= kMul24; ++func)
     integer_func_table->add_entry(func, 10);
@@ -0,0 +1,115 @@
+#include "CUDASmith/GenerationProfile.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "NodeArena.h"
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+// Counted by the replacement operator new below, while counting is on.
+std::atomic<bool> count_allocations(false);
+thread_local uint64_t allocation_count = 0;
+thread_local uint64_t allocation_bytes = 0;
+}  // namespace
+
+// The global operator new counts the allocations of the calling thread, for
+// GenerationProfile, when asked to. The other forms of new and delete in the
+// standard library forward to these two.
+void *operator new(size_t size) {
+  if (count_allocations.load(std::memory_order_relaxed)) {
+    ++allocation_count;
+    allocation_bytes += size;
+  }
+  if (size == 0) size = 1;
+  void *p;
+  while ((p = malloc(size)) == NULL) {
+    std::new_handler handler = std::get_new_handler();
+    if (handler == NULL) throw std::bad_alloc();
+    handler();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+namespace CUDASmith {
+
+void GenerationProfile::StartPhase(const char *name) {
+  EndPhase();
+  current_ = name;
+  start_allocations_ = allocations() + NodeArena::allocations();
+  start_bytes_ = allocated_bytes();
+  start_ = Clock::now();
+}
+
+void GenerationProfile::EndPhase() {
+  if (current_ == NULL) return;
+  Phase phase;
+  phase.name = current_;
+  phase.ms = std::chrono::duration<double, std::milli>(
+      Clock::now() - start_).count();
+  phase.allocations =
+      allocations() + NodeArena::allocations() - start_allocations_;
+  phase.bytes = allocated_bytes() - start_bytes_;
+  phase.max_rss_kb = max_rss_kb();
+  phases_.push_back(phase);
+  current_ = NULL;
+}
+
+void GenerationProfile::WriteJSON(std::ostream& out, unsigned long seed,
+    const std::string& args) const {
+  double total_ms = 0;
+  uint64_t total_allocations = 0;
+  for (const Phase& phase : phases_) {
+    total_ms += phase.ms;
+    total_allocations += phase.allocations;
+  }
+
+  out << "{\n  \"seed\": " << seed << ",\n  \"args\": \"";
+  for (char c : args) {
+    if (c == '"' || c == '\\') out << '\\';
+    out << c;
+  }
+  out << "\",\n  \"total_ms\": " << total_ms
+      << ",\n  \"total_allocations\": " << total_allocations
+      << ",\n  \"max_rss_kb\": " << max_rss_kb()
+      << ",\n  \"phases\": [";
+  for (size_t idx = 0; idx < phases_.size(); ++idx) {
+    const Phase& phase = phases_[idx];
+    out << (idx ? "," : "") << "\n    {\"name\": \"" << phase.name
+        << "\", \"ms\": " << phase.ms
+        << ", \"allocations\": " << phase.allocations
+        << ", \"bytes\": " << phase.bytes
+        << ", \"max_rss_kb\": " << phase.max_rss_kb << '}';
+  }
+  out << "\n  ]\n}\n";
+}
+
+void GenerationProfile::CountAllocations(bool on) {
+  count_allocations.store(on, std::memory_order_relaxed);
+}
+
+uint64_t GenerationProfile::allocations() {
+  return allocation_count;
+}
+
+uint64_t GenerationProfile::allocated_bytes() {
+  return allocation_bytes;
+}
+
+long GenerationProfile::max_rss_kb() {
+#ifndef WIN32
+  struct rusage usage;
+  if (!getrusage(RUSAGE_SELF, &usage)) return usage.ru_maxrss;
+#endif
+  return 0;
+}
+
+}  // namespace CUDASmith
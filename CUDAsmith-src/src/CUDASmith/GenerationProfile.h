@@ -0,0 +1,71 @@
+// Records how long each phase of CUDAProgramGenerator::goGenerator takes, how
+// many allocations it makes and the peak RSS after it, for --profile-json.
+//
+// Allocations are counted per thread by the global operator new, so the counts
+// are those of the kernel being generated even when several are generated at
+// once with --jobs. They are only counted once CountAllocations(true) has been
+// called, so that runs without --profile-json do not pay for it. The peak RSS
+// is that of the whole process.
+
+#ifndef _CUDASMITH_GENERATIONPROFILE_H_
+#define _CUDASMITH_GENERATIONPROFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CommonMacros.h"
+
+namespace CUDASmith {
+
+class GenerationProfile {
+ public:
+  GenerationProfile() : current_(NULL) {}
+
+  // Ends the current phase, if any, and starts the named one.
+  void StartPhase(const char *name);
+
+  // Ends the current phase.
+  void EndPhase();
+
+  // Writes the phases as a JSON object. 'args' are the generator options.
+  void WriteJSON(std::ostream& out, unsigned long seed,
+      const std::string& args) const;
+
+  // Turns the counting of allocations on or off, for all threads. Off by
+  // default.
+  static void CountAllocations(bool on);
+
+  // Allocations made, and bytes requested, by the calling thread while
+  // counting was on.
+  static uint64_t allocations();
+  static uint64_t allocated_bytes();
+
+  // Peak resident set size of the process so far, in KiB.
+  static long max_rss_kb();
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Phase {
+    const char *name;
+    double ms;
+    uint64_t allocations;
+    uint64_t bytes;
+    long max_rss_kb;
+  };
+
+  std::vector<Phase> phases_;
+  const char *current_;
+  Clock::time_point start_;
+  uint64_t start_allocations_;
+  uint64_t start_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(GenerationProfile);
+};
+
+}  // namespace CUDASmith
+
+#endif  // _CUDASMITH_GENERATIONPROFILE_H_
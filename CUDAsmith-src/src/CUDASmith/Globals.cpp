@@ -5,6 +5,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "ArrayVariable.h"
@@ -26,7 +27,7 @@ namespace CUDASmith
 {
 namespace
 {
-Globals *globals_inst = NULL; // Singleton instance.
+thread_local Globals *globals_inst = NULL; // Singleton instance.
 } // namespace
 
 void Globals::AddLocalMemoryBuffer(MemoryBuffer *buffer)
@@ -430,12 +431,10 @@ void Globals::ModifyGlobalVariableReferences()
     CreateGlobalStruct();
   // Append the name of our newly created struct to the front of every global
   // variable (eugghhh).
-  std::vector<std::string> names;
+  const std::string prefix = struct_var_->name + "->";
   for (Variable *var : global_vars_)
   {
-    names.push_back(var->name);
-    *const_cast<std::string *>(&var->name) =
-        struct_var_->name + "->" + var->name;
+    *const_cast<std::string *>(&var->name) = prefix + var->name;
     if (var->is_aggregate())
       ModifyGlobalAggregateVariableReferences(var);
   }
@@ -445,16 +444,16 @@ void Globals::ModifyGlobalVariableReferences()
   // fix, we add a method in the VariableSelector that give us the list of all
   // variables.
   // Variable::is_global() is unreliable.
+  std::unordered_set<const Variable *> buffers(buffers_.begin(), buffers_.end());
   for (Variable *var : *VariableSelector::GetAllVariables())
   {
-    if (var->name.find("g_") == 0 && std::find(buffers_.begin(), buffers_.end(), var) == buffers_.end())
+    if (var->name.compare(0, 2, "g_") == 0 && !buffers.count(var))
     {
-      *const_cast<std::string *>(&var->name) =
-          struct_var_->name + "->" + var->name;
+      *const_cast<std::string *>(&var->name) = prefix + var->name;
       if (var->is_aggregate())
         ModifyGlobalAggregateVariableReferences(var);
     }
-    if (var->name.find("l_") == 0 && var->is_aggregate())
+    if (var->name.compare(0, 2, "l_") == 0 && var->is_aggregate())
     {
       for (Variable *field_var : var->field_vars)
       {
@@ -469,8 +468,7 @@ void Globals::ModifyGlobalVariableReferences()
   // Now add to the buffers.
   for (MemoryBuffer *buffer : buffers_)
   {
-    *const_cast<std::string *>(&buffer->name) =
-        struct_var_->name + "->" + buffer->name;
+    *const_cast<std::string *>(&buffer->name) = prefix + buffer->name;
     if (buffer->is_aggregate())
       ModifyGlobalAggregateVariableReferences(buffer);
   }
@@ -0,0 +1,243 @@
+#include "CUDASmith/KernelArchive.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace CUDASmith {
+namespace {
+
+const char kArchiveMagic[] = "CUDAARC1";
+const size_t kArchiveMagicSize = 8;
+const char kRecordMagic[] = "KRNL";
+const size_t kRecordMagicSize = 4;
+// Magic, seed, info length and kernel length.
+const size_t kRecordHeaderSize = 4 + 8 + 4 + 8;
+
+void PutInt(std::string *out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; ++i) out->push_back((char)(value >> (8 * i)));
+}
+
+uint64_t GetInt(const unsigned char *in, int bytes) {
+  uint64_t value = 0;
+  for (int i = bytes - 1; i >= 0; --i) value = (value << 8) | in[i];
+  return value;
+}
+
+bool WriteAll(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    ssize_t n = write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+// The runtime info line of a kernel, e.g. "--atomics 66 -g 85,94,1 -l 1,47,1".
+std::string KernelInfo(const std::string& kernel) {
+  if (kernel.compare(0, 2, "//")) return "";
+  size_t begin = kernel.find_first_not_of(' ', 2);
+  size_t end = kernel.find('\n');
+  if (end == std::string::npos) end = kernel.size();
+  if (begin == std::string::npos || begin > end) begin = end;
+  return kernel.substr(begin, end - begin);
+}
+
+}  // namespace
+
+struct KernelArchiveWriter::Shard {
+  std::mutex mutex;
+  std::string path;  // Empty for stdout.
+  int fd;
+  bool failed;
+  uint64_t offset;
+  std::vector<std::pair<uint64_t, uint64_t> > index;  // Seed and offset.
+};
+
+KernelArchiveWriter::KernelArchiveWriter(const std::string& path,
+    unsigned shards) {
+  if (path == "-") shards = 1;
+  if (shards == 0) shards = 1;
+  for (unsigned idx = 0; idx < shards; ++idx) {
+    std::unique_ptr<Shard> shard(new Shard());
+    if (path == "-") {
+      shard->fd = STDOUT_FILENO;
+    } else {
+      shard->path = shards == 1 ? path : path + '.' + std::to_string(idx);
+      shard->fd = open(shard->path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    }
+    shard->failed = shard->fd < 0 ||
+        !WriteAll(shard->fd, kArchiveMagic, kArchiveMagicSize);
+    shard->offset = kArchiveMagicSize;
+    shards_.push_back(std::move(shard));
+  }
+}
+
+KernelArchiveWriter::~KernelArchiveWriter() {
+  Close();
+}
+
+bool KernelArchiveWriter::IsOpen() const {
+  for (const std::unique_ptr<Shard>& shard : shards_)
+    if (shard->fd < 0) return false;
+  return true;
+}
+
+bool KernelArchiveWriter::Append(uint64_t seed, const std::string& kernel) {
+  std::string info = KernelInfo(kernel);
+  std::string record;
+  record.reserve(kRecordHeaderSize + info.size() + kernel.size());
+  record.append(kRecordMagic, kRecordMagicSize);
+  PutInt(&record, seed, 8);
+  PutInt(&record, info.size(), 4);
+  PutInt(&record, kernel.size(), 8);
+  record += info;
+  record += kernel;
+
+  Shard& shard = *shards_[seed % shards_.size()];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.fd < 0 || shard.failed) return false;
+  if (!WriteAll(shard.fd, record.data(), record.size())) {
+    shard.failed = true;
+    return false;
+  }
+  shard.index.push_back(std::make_pair(seed, shard.offset));
+  shard.offset += record.size();
+  return true;
+}
+
+bool KernelArchiveWriter::Close() {
+  bool ok = true;
+  for (std::unique_ptr<Shard>& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    if (shard->fd < 0) {
+      ok = ok && !shard->failed;
+      continue;
+    }
+    if (!shard->path.empty()) {
+      std::ofstream index((shard->path + ".idx").c_str());
+      for (const std::pair<uint64_t, uint64_t>& entry : shard->index)
+        index << entry.first << ' ' << entry.second << '\n';
+      if (!index) shard->failed = true;
+      if (close(shard->fd)) shard->failed = true;
+    }
+    shard->fd = -1;
+    ok = ok && !shard->failed;
+  }
+  return ok;
+}
+
+KernelArchiveReader::KernelArchiveReader(const std::string& path)
+    : path_(path), file_(NULL), valid_(false), failed_(false), offset_(0) {
+  file_ = path == "-" ? stdin : fopen(path.c_str(), "rb");
+  if (file_ == NULL) return;
+  char magic[kArchiveMagicSize];
+  valid_ = fread(magic, 1, kArchiveMagicSize, file_) == kArchiveMagicSize &&
+      !memcmp(magic, kArchiveMagic, kArchiveMagicSize);
+  offset_ = kArchiveMagicSize;
+}
+
+KernelArchiveReader::~KernelArchiveReader() {
+  if (file_ != NULL && file_ != stdin) fclose(file_);
+}
+
+bool KernelArchiveReader::Next(KernelRecord *record, bool with_kernel) {
+  if (!IsOpen() || failed_) return false;
+  unsigned char header[kRecordHeaderSize];
+  size_t got = fread(header, 1, kRecordHeaderSize, file_);
+  if (got == 0 && feof(file_)) return false;
+  if (got != kRecordHeaderSize ||
+      memcmp(header, kRecordMagic, kRecordMagicSize)) {
+    failed_ = true;
+    return false;
+  }
+  record->offset = offset_;
+  record->seed = GetInt(header + 4, 8);
+  uint64_t info_size = GetInt(header + 12, 4);
+  uint64_t kernel_size = GetInt(header + 16, 8);
+  if (!Read(info_size, &record->info)) {
+    failed_ = true;
+    return false;
+  }
+  record->kernel.clear();
+  if (with_kernel) {
+    if (!Read(kernel_size, &record->kernel)) {
+      failed_ = true;
+      return false;
+    }
+  } else if (!Skip(kernel_size)) {
+    failed_ = true;
+    return false;
+  }
+  offset_ += kRecordHeaderSize + info_size + kernel_size;
+  return true;
+}
+
+bool KernelArchiveReader::ReadAt(uint64_t offset, KernelRecord *record) {
+  if (!IsOpen() || fseeko(file_, (off_t)offset, SEEK_SET)) return false;
+  offset_ = offset;
+  failed_ = false;
+  return Next(record, true);
+}
+
+bool KernelArchiveReader::Find(uint64_t seed, KernelRecord *record) {
+  if (!IsOpen()) return false;
+  if (path_ != "-") {
+    std::ifstream index((path_ + ".idx").c_str());
+    uint64_t index_seed, offset;
+    while (index >> index_seed >> offset)
+      if (index_seed == seed) return ReadAt(offset, record);
+  }
+  // No index (or the seed is not in it): go through the records. A stream
+  // cannot seek back, so the kernels are read as we go.
+  bool seekable = file_ != stdin;
+  while (Next(record, !seekable))
+    if (record->seed == seed)
+      return seekable ? ReadAt(record->offset, record) : true;
+  return false;
+}
+
+// The sizes come from the record header, so a corrupt one may be anything:
+// the text grows a chunk at a time, only as far as the file goes.
+bool KernelArchiveReader::Read(uint64_t length, std::string *text) {
+  const uint64_t kChunk = 1 << 20;
+  text->clear();
+  while (length > 0) {
+    const size_t chunk = (size_t)(length < kChunk ? length : kChunk);
+    const size_t size = text->size();
+    text->resize(size + chunk);
+    if (fread(&(*text)[size], 1, chunk, file_) != chunk) return false;
+    length -= chunk;
+  }
+  return true;
+}
+
+bool KernelArchiveReader::Skip(uint64_t length) {
+  if (file_ != stdin) {
+    // Seeking past the end succeeds, so check that the last byte is there.
+    if (length == 0) return true;
+    return !fseeko(file_, (off_t)(length - 1), SEEK_CUR) &&
+        fgetc(file_) != EOF;
+  }
+  char buffer[4096];
+  while (length > 0) {
+    size_t chunk = length < sizeof(buffer) ? length : sizeof(buffer);
+    if (fread(buffer, 1, chunk, file_) != chunk) return false;
+    length -= chunk;
+  }
+  return true;
+}
+
+}  // namespace CUDASmith
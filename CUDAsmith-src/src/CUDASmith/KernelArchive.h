@@ -0,0 +1,107 @@
+// Archive of generated kernels, so that a batch run produces a few large files
+// instead of one file per seed.
+//
+// An archive starts with the 8 byte magic "CUDAARC1", followed by one record
+// per kernel. All integers are little endian.
+//
+//   "KRNL"            4 bytes
+//   seed              u64
+//   info length       u32
+//   kernel length     u64
+//   info              the runtime info line of the kernel, without the
+//                     leading "//" (mode flags and the -g/-l dimensions)
+//   kernel            the kernel, byte for byte what would be in the .cu file
+//
+// Records are self delimiting, so an archive can be streamed (e.g. to stdout)
+// and read back sequentially. When written to a file, an index is written next
+// to it (<archive>.idx, one "<seed> <offset>" line per record), which lets a
+// reader go straight to the record of a seed.
+
+#ifndef _CUDASMITH_KERNELARCHIVE_H_
+#define _CUDASMITH_KERNELARCHIVE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CommonMacros.h"
+
+namespace CUDASmith {
+
+struct KernelRecord {
+  uint64_t seed;
+  uint64_t offset;  // Of the record in the archive.
+  std::string info;
+  std::string kernel;
+};
+
+// Appends kernels to an archive, or to several shards of one. Safe to use from
+// several threads at once; each record is written with a single write.
+class KernelArchiveWriter {
+ public:
+  // With more than one shard, the kernel for a seed goes to shard
+  // seed % shards, which is called <path>.<shard>. A path of "-" streams the
+  // archive to stdout (only one shard, and no index).
+  KernelArchiveWriter(const std::string& path, unsigned shards);
+  ~KernelArchiveWriter();
+
+  // False if any of the shards could not be created.
+  bool IsOpen() const;
+
+  // Appends the kernel text generated for the given seed. The info is taken
+  // from the first line of the kernel.
+  bool Append(uint64_t seed, const std::string& kernel);
+
+  // Writes the indices and closes the shards. Returns false if anything could
+  // not be written.
+  bool Close();
+
+ private:
+  struct Shard;
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  DISALLOW_COPY_AND_ASSIGN(KernelArchiveWriter);
+};
+
+// Reads an archive written by KernelArchiveWriter (a single shard).
+class KernelArchiveReader {
+ public:
+  // A path of "-" reads the archive from stdin.
+  explicit KernelArchiveReader(const std::string& path);
+  ~KernelArchiveReader();
+
+  // False if the file could not be opened or is not an archive.
+  bool IsOpen() const { return file_ != NULL && valid_; }
+
+  // Reads the next record, returns false at the end of the archive. Unless
+  // with_kernel is set, the kernel text is skipped.
+  bool Next(KernelRecord *record, bool with_kernel);
+
+  // Reads the record at the given offset.
+  bool ReadAt(uint64_t offset, KernelRecord *record);
+
+  // Finds the record for a seed, using the index if there is one.
+  bool Find(uint64_t seed, KernelRecord *record);
+
+  // Set when a record was cut short or is malformed.
+  bool failed() const { return failed_; }
+
+ private:
+  bool Read(uint64_t length, std::string *text);
+  bool Skip(uint64_t length);
+
+  std::string path_;
+  FILE *file_;
+  bool valid_;
+  bool failed_;
+  uint64_t offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(KernelArchiveReader);
+};
+
+}  // namespace CUDASmith
+
+#endif  // _CUDASMITH_KERNELARCHIVE_H_
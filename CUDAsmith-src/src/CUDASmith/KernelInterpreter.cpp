@@ -0,0 +1,3029 @@
+#include "CUDASmith/KernelInterpreter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace CUDASmith {
+namespace {
+
+// Scalars.
+
+// The integer types of a kernel. CUDA.h maps both intN_t and uintN_t to the
+// signed type of that width, so the unsigned types only come from literals and
+// from the limits that the safe math macros use.
+enum Scalar { kChar, kShort, kInt, kLong, kUChar, kUShort, kUInt, kULong };
+
+int ScalarSize(Scalar scalar) {
+  static const int kSizes[] = { 1, 2, 4, 8, 1, 2, 4, 8 };
+  return kSizes[scalar];
+}
+
+bool IsSigned(Scalar scalar) {
+  return scalar <= kLong;
+}
+
+// Values are held in 64 bits, sign or zero extended from their type, so that
+// a conversion is a truncation followed by an extension.
+uint64_t Normalize(Scalar scalar, uint64_t value) {
+  switch (scalar) {
+    case kChar: return (uint64_t)(int64_t)(int8_t)value;
+    case kShort: return (uint64_t)(int64_t)(int16_t)value;
+    case kInt: return (uint64_t)(int64_t)(int32_t)value;
+    case kUChar: return (uint8_t)value;
+    case kUShort: return (uint16_t)value;
+    case kUInt: return (uint32_t)value;
+    default: return value;
+  }
+}
+
+// Whether converting a value from one type to another can change its
+// representation.
+bool ConversionChangesBits(Scalar from, Scalar to) {
+  if (ScalarSize(to) == 8) return false;
+  if (ScalarSize(to) > ScalarSize(from))
+    return IsSigned(from) && !IsSigned(to);
+  if (ScalarSize(to) == ScalarSize(from))
+    return IsSigned(from) != IsSigned(to);
+  return true;
+}
+
+Scalar Promote(Scalar scalar) {
+  return ScalarSize(scalar) < 4 ? kInt : scalar;
+}
+
+// The usual arithmetic conversions.
+Scalar CommonType(Scalar a, Scalar b) {
+  a = Promote(a);
+  b = Promote(b);
+  if (a == b) return a;
+  if (IsSigned(a) == IsSigned(b))
+    return ScalarSize(a) >= ScalarSize(b) ? a : b;
+  const Scalar u = IsSigned(a) ? b : a;
+  const Scalar s = IsSigned(a) ? a : b;
+  if (ScalarSize(u) >= ScalarSize(s)) return u;
+  return s;
+}
+
+enum BinaryOp {
+  kAdd, kSub, kMul, kDiv, kMod, kShl, kShr, kAnd, kOr, kXor,
+  kEq, kNe, kLt, kLe, kGt, kGe
+};
+
+bool IsComparison(BinaryOp op) {
+  return op >= kEq;
+}
+
+// Applies op to a and b, both of type scalar (for a shift, that of the left
+// operand). Returns false where the operation traps or is undefined in a way
+// that a compiled kernel cannot be relied on to reproduce: division by zero,
+// the minimum value divided by -1, and shifts by the width or more.
+bool EvalBinary(BinaryOp op, Scalar scalar, uint64_t a, uint64_t b,
+    uint64_t *out) {
+  const bool is_signed = IsSigned(scalar);
+  const int64_t sa = (int64_t)a, sb = (int64_t)b;
+  uint64_t result;
+  switch (op) {
+    case kAdd: result = a + b; break;
+    case kSub: result = a - b; break;
+    case kMul: result = a * b; break;
+    case kDiv:
+    case kMod:
+      if (b == 0) return false;
+      if (is_signed) {
+        const uint64_t min =
+            Normalize(scalar, (uint64_t)1 << (ScalarSize(scalar) * 8 - 1));
+        if (sb == -1 && a == min) return false;
+        result = op == kDiv ? (uint64_t)(sa / sb) : (uint64_t)(sa % sb);
+      } else {
+        result = op == kDiv ? a / b : a % b;
+      }
+      break;
+    case kShl:
+      if (b >= (uint64_t)ScalarSize(scalar) * 8) return false;
+      result = a << b;
+      break;
+    case kShr:
+      if (b >= (uint64_t)ScalarSize(scalar) * 8) return false;
+      result = is_signed ? (uint64_t)(sa >> b) : a >> b;
+      break;
+    case kAnd: result = a & b; break;
+    case kOr: result = a | b; break;
+    case kXor: result = a ^ b; break;
+    case kEq: *out = a == b; return true;
+    case kNe: *out = a != b; return true;
+    case kLt: *out = is_signed ? sa < sb : a < b; return true;
+    case kLe: *out = is_signed ? sa <= sb : a <= b; return true;
+    case kGt: *out = is_signed ? sa > sb : a > b; return true;
+    case kGe: *out = is_signed ? sa >= sb : a >= b; return true;
+    default: return false;
+  }
+  *out = Normalize(scalar, result);
+  return true;
+}
+
+// Safe math.
+
+// The macros of safe_math_macros.h, for the types that CUDA.h maps the fixed
+// width types to. The expressions are those of the macros, so that operands
+// are promoted and results typed as they are in a compiled kernel. The
+// unsigned variants work on signed types and may overflow them, which wraps on
+// the GPU; Wrap does such operations in the unsigned type of the same width.
+typedef signed char SChar;
+typedef unsigned int UInt;
+
+// The operations of the macros that may overflow a signed (promoted) type P,
+// wrapping around as they do in a compiled kernel.
+template <typename P> struct Wrap {
+  typedef typename std::make_unsigned<P>::type U;
+  static P Neg(P a) { return (P)(0 - (U)a); }
+  static P Add(P a, P b) { return (P)((U)a + (U)b); }
+  static P Sub(P a, P b) { return (P)((U)a - (U)b); }
+  static P Shl(P a, unsigned int b) { return (P)((U)a << b); }
+};
+
+// INTn_MIN and INTn_MAX, which have the promoted type.
+template <typename T> struct SignedLimits {
+  typedef decltype(+T()) P;
+  static P Min() { return std::numeric_limits<T>::min(); }
+  static P Max() { return std::numeric_limits<T>::max(); }
+};
+
+// UINTn_MAX, and the type U a left operand is compared with it in. The
+// multiplication of the unsigned variants is done in W.
+template <typename T> struct UnsignedLimits;
+template <> struct UnsignedLimits<SChar> {
+  typedef int U;
+  typedef unsigned int W;
+  static U Max() { return UCHAR_MAX; }
+};
+template <> struct UnsignedLimits<short> {
+  typedef int U;
+  typedef unsigned int W;
+  static U Max() { return USHRT_MAX; }
+};
+template <> struct UnsignedLimits<int> {
+  typedef unsigned int U;
+  typedef unsigned int W;
+  static U Max() { return UINT_MAX; }
+};
+template <> struct UnsignedLimits<long> {
+  typedef unsigned long U;
+  typedef unsigned long W;
+  static U Max() { return ULONG_MAX; }
+};
+
+template <typename T>
+auto SafeUnaryMinusS(T si) -> decltype(true ? si : -si) {
+  return (si == SignedLimits<T>::Min()) ? si : -si;
+}
+
+template <typename T>
+auto SafeAddSS(T si1, T si2) -> decltype(true ? si1 : si1 + si2) {
+  typedef SignedLimits<T> L;
+  return (((si1 > (T)0) && (si2 > (T)0) && (si1 > (L::Max() - si2))) ||
+          ((si1 < (T)0) && (si2 < (T)0) && (si1 < (L::Min() - si2))))
+      ? si1 : (si1 + si2);
+}
+
+template <typename T>
+auto SafeSubSS(T si1, T si2) -> decltype(true ? si1 : si1 - si2) {
+  typedef Wrap<decltype(si1 - si2)> W;
+  return (((si1 ^ si2) &
+           (W::Sub(si1 ^ ((si1 ^ si2) & W::Shl(1, sizeof(T) * CHAR_BIT - 1)),
+                   si2) ^ si2)) < (T)0)
+      ? si1 : (si1 - si2);
+}
+
+template <typename T>
+auto SafeMulSS(T si1, T si2) -> decltype(true ? si1 : si1 * si2) {
+  typedef SignedLimits<T> L;
+  return (((si1 > (T)0) && (si2 > (T)0) && (si1 > (L::Max() / si2))) ||
+          ((si1 > (T)0) && (si2 <= (T)0) && (si2 < (L::Min() / si1))) ||
+          ((si1 <= (T)0) && (si2 > (T)0) && (si1 < (L::Min() / si2))) ||
+          ((si1 <= (T)0) && (si2 <= (T)0) && (si1 != (T)0) &&
+           (si2 < (L::Max() / si1))))
+      ? si1 : si1 * si2;
+}
+
+template <typename T>
+auto SafeModSS(T si1, T si2) -> decltype(true ? si1 : si1 % si2) {
+  return ((si2 == (T)0) || ((si1 == SignedLimits<T>::Min()) && (si2 == (T)-1)))
+      ? si1 : (si1 % si2);
+}
+
+template <typename T>
+auto SafeDivSS(T si1, T si2) -> decltype(true ? si1 : si1 / si2) {
+  return ((si2 == (T)0) || ((si1 == SignedLimits<T>::Min()) && (si2 == (T)-1)))
+      ? si1 : (si1 / si2);
+}
+
+template <typename T>
+auto SafeLshiftSS(T left, int right) -> decltype(true ? left : left << right) {
+  return ((left < (T)0) || (right < (T)0) ||
+          ((unsigned long)right >= sizeof(T) * CHAR_BIT) ||
+          (left > (SignedLimits<T>::Max() >> right)))
+      ? left : (left << right);
+}
+
+template <typename T>
+auto SafeLshiftSU(T left, UInt right) -> decltype(true ? left : left << right) {
+  return ((left < (T)0) || (right >= sizeof(T) * CHAR_BIT) ||
+          (left > (SignedLimits<T>::Max() >> right)))
+      ? left : (left << right);
+}
+
+template <typename T>
+auto SafeRshiftSS(T left, int right) -> decltype(true ? left : left >> right) {
+  return ((left < (T)0) || (right < (T)0) ||
+          ((unsigned long)right >= sizeof(T) * CHAR_BIT))
+      ? left : (left >> right);
+}
+
+template <typename T>
+auto SafeRshiftSU(T left, UInt right) -> decltype(true ? left : left >> right) {
+  return ((left < (T)0) || (right >= sizeof(T) * CHAR_BIT))
+      ? left : (left >> right);
+}
+
+template <typename T>
+auto SafeUnaryMinusU(T ui) -> decltype(-ui) {
+  return Wrap<decltype(-ui)>::Neg(ui);
+}
+
+template <typename T>
+auto SafeAddUU(T ui1, T ui2) -> decltype(ui1 + ui2) {
+  return Wrap<decltype(ui1 + ui2)>::Add(ui1, ui2);
+}
+
+template <typename T>
+auto SafeSubUU(T ui1, T ui2) -> decltype(ui1 - ui2) {
+  return Wrap<decltype(ui1 - ui2)>::Sub(ui1, ui2);
+}
+
+template <typename T>
+T SafeMulUU(T ui1, T ui2) {
+  typedef typename UnsignedLimits<T>::W W;
+  return (T)(((W)ui1) * ((W)ui2));
+}
+
+template <typename T>
+auto SafeModUU(T ui1, T ui2) -> decltype(true ? ui1 : ui1 % ui2) {
+  return (ui2 == (T)0) ? ui1 : (ui1 % ui2);
+}
+
+template <typename T>
+auto SafeDivUU(T ui1, T ui2) -> decltype(true ? ui1 : ui1 / ui2) {
+  return (ui2 == (T)0) ? ui1 : (ui1 / ui2);
+}
+
+template <typename T>
+auto SafeLshiftUS(T left, int right) -> decltype(true ? left : left << right) {
+  typedef UnsignedLimits<T> L;
+  return ((right < (T)0) || ((unsigned long)right >= sizeof(T) * CHAR_BIT) ||
+          ((typename L::U)left > (L::Max() >> right)))
+      ? left : Wrap<decltype(left << right)>::Shl(left, right);
+}
+
+template <typename T>
+auto SafeLshiftUU(T left, UInt right) -> decltype(true ? left : left << right) {
+  typedef UnsignedLimits<T> L;
+  return ((right >= sizeof(T) * CHAR_BIT) ||
+          ((typename L::U)left > (L::Max() >> right)))
+      ? left : Wrap<decltype(left << right)>::Shl(left, right);
+}
+
+template <typename T>
+auto SafeRshiftUS(T left, int right) -> decltype(true ? left : left >> right) {
+  return ((right < (T)0) || ((unsigned long)right >= sizeof(T) * CHAR_BIT))
+      ? left : (left >> right);
+}
+
+template <typename T>
+auto SafeRshiftUU(T left, UInt right) -> decltype(true ? left : left >> right) {
+  return (right >= sizeof(T) * CHAR_BIT) ? left : (left >> right);
+}
+
+template <typename T> struct ScalarOf;
+template <> struct ScalarOf<SChar> { static const Scalar value = kChar; };
+template <> struct ScalarOf<short> { static const Scalar value = kShort; };
+template <> struct ScalarOf<int> { static const Scalar value = kInt; };
+template <> struct ScalarOf<long> { static const Scalar value = kLong; };
+template <> struct ScalarOf<UInt> { static const Scalar value = kUInt; };
+template <> struct ScalarOf<unsigned long> {
+  static const Scalar value = kULong;
+};
+
+// A safe math macro applied to arguments of any type. Returns false if it
+// traps.
+typedef bool (*SafeFn)(uint64_t a, uint64_t b, uint64_t *out);
+
+template <typename A, typename R, R (*F)(A)>
+bool SafeUnary(uint64_t a, uint64_t, uint64_t *out) {
+  *out = (uint64_t)F((A)a);
+  return true;
+}
+
+template <typename A, typename B, typename R, R (*F)(A, B)>
+bool SafeBinary(uint64_t a, uint64_t b, uint64_t *out) {
+  *out = (uint64_t)F((A)a, (B)b);
+  return true;
+}
+
+// The unsigned division and modulo only guard against zero, so on int and
+// long the minimum value divided by -1 traps.
+template <typename A, typename R, R (*F)(A, A)>
+bool SafeDivision(uint64_t a, uint64_t b, uint64_t *out) {
+  if (sizeof(A) >= sizeof(int) && (A)a == std::numeric_limits<A>::min() &&
+      (A)b == (A)-1)
+    return false;
+  *out = (uint64_t)F((A)a, (A)b);
+  return true;
+}
+
+struct SafeOp {
+  const char *name;
+  SafeFn fn;
+  Scalar result;
+  int args;
+};
+
+#define SAFE_UNARY(F, T) \
+  &SafeUnary<T, decltype(F<T>(T())), &F<T> >, \
+  ScalarOf<decltype(F<T>(T()))>::value, 1
+#define SAFE_BINARY(F, T, B) \
+  &SafeBinary<T, B, decltype(F<T>(T(), B())), &F<T> >, \
+  ScalarOf<decltype(F<T>(T(), B()))>::value, 2
+#define SAFE_DIVISION(F, T) \
+  &SafeDivision<T, decltype(F<T>(T(), T())), &F<T> >, \
+  ScalarOf<decltype(F<T>(T(), T()))>::value, 2
+#define SAFE_OPS(T, S, U) \
+  { "safe_unary_minus_func_" S "_s", SAFE_UNARY(SafeUnaryMinusS, T) }, \
+  { "safe_add_func_" S "_s_s", SAFE_BINARY(SafeAddSS, T, T) }, \
+  { "safe_sub_func_" S "_s_s", SAFE_BINARY(SafeSubSS, T, T) }, \
+  { "safe_mul_func_" S "_s_s", SAFE_BINARY(SafeMulSS, T, T) }, \
+  { "safe_mod_func_" S "_s_s", SAFE_BINARY(SafeModSS, T, T) }, \
+  { "safe_div_func_" S "_s_s", SAFE_BINARY(SafeDivSS, T, T) }, \
+  { "safe_lshift_func_" S "_s_s", SAFE_BINARY(SafeLshiftSS, T, int) }, \
+  { "safe_lshift_func_" S "_s_u", SAFE_BINARY(SafeLshiftSU, T, UInt) }, \
+  { "safe_rshift_func_" S "_s_s", SAFE_BINARY(SafeRshiftSS, T, int) }, \
+  { "safe_rshift_func_" S "_s_u", SAFE_BINARY(SafeRshiftSU, T, UInt) }, \
+  { "safe_unary_minus_func_" U "_u", SAFE_UNARY(SafeUnaryMinusU, T) }, \
+  { "safe_add_func_" U "_u_u", SAFE_BINARY(SafeAddUU, T, T) }, \
+  { "safe_sub_func_" U "_u_u", SAFE_BINARY(SafeSubUU, T, T) }, \
+  { "safe_mul_func_" U "_u_u", SAFE_BINARY(SafeMulUU, T, T) }, \
+  { "safe_mod_func_" U "_u_u", SAFE_DIVISION(SafeModUU, T) }, \
+  { "safe_div_func_" U "_u_u", SAFE_DIVISION(SafeDivUU, T) }, \
+  { "safe_lshift_func_" U "_u_s", SAFE_BINARY(SafeLshiftUS, T, int) }, \
+  { "safe_lshift_func_" U "_u_u", SAFE_BINARY(SafeLshiftUU, T, UInt) }, \
+  { "safe_rshift_func_" U "_u_s", SAFE_BINARY(SafeRshiftUS, T, int) }, \
+  { "safe_rshift_func_" U "_u_u", SAFE_BINARY(SafeRshiftUU, T, UInt) },
+
+const SafeOp kSafeOps[] = {
+  SAFE_OPS(SChar, "int8_t", "uint8_t")
+  SAFE_OPS(short, "int16_t", "uint16_t")
+  SAFE_OPS(int, "int32_t", "uint32_t")
+  SAFE_OPS(long, "int64_t", "uint64_t")
+};
+
+#undef SAFE_OPS
+#undef SAFE_DIVISION
+#undef SAFE_BINARY
+#undef SAFE_UNARY
+
+// Types.
+
+struct Record;
+
+struct Type {
+  enum Kind { kVoid, kScalar, kPointer, kArray, kRecord };
+  Kind kind;
+  Scalar scalar;         // kScalar.
+  const Type *base;      // The pointee of a pointer, the element of an array.
+  uint64_t count;        // The elements of an array.
+  const Record *record;  // kRecord.
+  uint64_t size;
+  uint64_t align;
+
+  uint64_t Size() const;
+  uint64_t Align() const;
+  bool IsValue() const { return kind == kScalar || kind == kPointer; }
+};
+
+struct Field {
+  std::string name;
+  const Type *type;
+  uint64_t offset;
+};
+
+// A struct, a union or a vector.
+struct Record {
+  std::string name;
+  bool is_union;
+  bool complete;
+  std::vector<Field> fields;
+  uint64_t size;
+  uint64_t align;
+
+  const Field *Find(const std::string& field) const {
+    for (size_t i = 0; i < fields.size(); ++i)
+      if (fields[i].name == field) return &fields[i];
+    return NULL;
+  }
+};
+
+uint64_t Type::Size() const {
+  return kind == kRecord ? record->size : size;
+}
+
+uint64_t Type::Align() const {
+  return kind == kRecord ? record->align : align;
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t align) {
+  return (value + align - 1) / align * align;
+}
+
+// Owns the types of a kernel. Types are interned, so they can be compared by
+// address.
+class TypeTable {
+ public:
+  TypeTable() {
+    void_ = New(Type::kVoid, 0, 1);
+    for (int i = 0; i <= kULong; ++i) {
+      const Scalar scalar = (Scalar)i;
+      Type *type = New(Type::kScalar, ScalarSize(scalar), ScalarSize(scalar));
+      type->scalar = scalar;
+      scalars_[i] = type;
+    }
+  }
+
+  const Type *Void() const { return void_; }
+  const Type *Get(Scalar scalar) const { return scalars_[scalar]; }
+
+  const Type *PointerTo(const Type *base) {
+    const Type *& pointer = pointers_[base];
+    if (!pointer) {
+      Type *type = New(Type::kPointer, 8, 8);
+      type->base = base;
+      pointer = type;
+    }
+    return pointer;
+  }
+
+  const Type *ArrayOf(const Type *element, uint64_t count) {
+    const Type *& array = arrays_[std::make_pair(element, count)];
+    if (!array) {
+      Type *type = New(Type::kArray, element->Size() * count, element->Align());
+      type->base = element;
+      type->count = count;
+      array = type;
+    }
+    return array;
+  }
+
+  // The struct or union with the given tag, which is incomplete until it is
+  // defined.
+  Record *GetRecord(const std::string& name, bool is_union) {
+    std::unique_ptr<Record>& record = records_[name];
+    if (!record) {
+      record.reset(new Record);
+      record->name = name;
+      record->is_union = is_union;
+      record->complete = false;
+      record->size = 0;
+      record->align = 1;
+    }
+    return record.get();
+  }
+
+  const Type *RecordType(const Record *record) {
+    const Type *& result = record_types_[record];
+    if (!result) {
+      Type *type = New(Type::kRecord, 0, 1);
+      type->record = record;
+      result = type;
+    }
+    return result;
+  }
+
+  static void AddField(Record *record, const std::string& name,
+      const Type *type) {
+    Field field;
+    field.name = name;
+    field.type = type;
+    field.offset = record->is_union ? 0 : AlignUp(record->size, type->Align());
+    record->fields.push_back(field);
+    record->size = std::max(record->size, field.offset + type->Size());
+    record->align = std::max(record->align, type->Align());
+  }
+
+  static void Complete(Record *record) {
+    record->size = AlignUp(record->size, record->align);
+    record->complete = true;
+  }
+
+  // The vector type VECTOR(scalar, n), with the layout of CUDA_host.h.
+  const Type *Vector(Scalar scalar, int n) {
+    std::ostringstream name;
+    name << "VECTOR(" << scalar << ", " << n << ")";
+    Record *record = GetRecord(name.str(), false);
+    if (!record->complete) {
+      static const char *const kFields[] = { "x", "y", "z", "w" };
+      for (int i = 0; i < n; ++i)
+        AddField(record, kFields[i], Get(scalar));
+      if (n == 2 || n == 4)
+        record->align = std::min<uint64_t>(16, ScalarSize(scalar) * n);
+      Complete(record);
+    }
+    return RecordType(record);
+  }
+
+ private:
+  Type *New(Type::Kind kind, uint64_t size, uint64_t align) {
+    Type *type = new Type();
+    type->kind = kind;
+    type->scalar = kInt;
+    type->base = NULL;
+    type->count = 0;
+    type->record = NULL;
+    type->size = size;
+    type->align = align;
+    types_.push_back(std::unique_ptr<Type>(type));
+    return type;
+  }
+
+  const Type *void_;
+  const Type *scalars_[kULong + 1];
+  std::vector<std::unique_ptr<Type> > types_;
+  std::map<const Type *, const Type *> pointers_;
+  std::map<std::pair<const Type *, uint64_t>, const Type *> arrays_;
+  std::map<std::string, std::unique_ptr<Record> > records_;
+  std::map<const Record *, const Type *> record_types_;
+};
+
+// Lexer.
+
+struct Token {
+  enum Kind { kEnd, kIdent, kNumber, kString, kPunct };
+  Kind kind;
+  std::string text;
+  int line;
+};
+
+struct CompileError {
+  std::string message;
+};
+
+// Splits the kernel into tokens, skipping comments and preprocessor lines.
+void Tokenize(const std::string& src, std::vector<Token> *tokens) {
+  static const char *const kPuncts[] = {
+    "<<=", ">>=", "...", "->", "++", "--", "<<", ">>", "<=", ">=", "==", "!=",
+    "&&", "||", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "::"
+  };
+  const size_t n = src.size();
+  size_t i = 0;
+  int line = 1;
+  bool line_start = true;
+  while (i < n) {
+    const char c = src[i];
+    if (c == '\n') {
+      ++line;
+      line_start = true;
+      ++i;
+      continue;
+    }
+    if (isspace((unsigned char)c)) {
+      ++i;
+      continue;
+    }
+    if (c == '#' && line_start) {
+      while (i < n && src[i] != '\n') {
+        if (src[i] == '\\' && i + 1 < n && src[i + 1] == '\n') {
+          ++line;
+          ++i;
+        }
+        ++i;
+      }
+      continue;
+    }
+    line_start = false;
+    if (c == '/' && i + 1 < n && src[i + 1] == '/') {
+      while (i < n && src[i] != '\n') ++i;
+      continue;
+    }
+    if (c == '/' && i + 1 < n && src[i + 1] == '*') {
+      i += 2;
+      while (i < n && !(src[i] == '*' && i + 1 < n && src[i + 1] == '/')) {
+        if (src[i] == '\n') ++line;
+        ++i;
+      }
+      i += 2;
+      continue;
+    }
+    Token token;
+    token.line = line;
+    const size_t start = i;
+    if (isalpha((unsigned char)c) || c == '_') {
+      while (i < n && (isalnum((unsigned char)src[i]) || src[i] == '_')) ++i;
+      token.kind = Token::kIdent;
+    } else if (isdigit((unsigned char)c)) {
+      while (i < n && isalnum((unsigned char)src[i])) ++i;
+      token.kind = Token::kNumber;
+    } else if (c == '"') {
+      for (++i; i < n && src[i] != '"'; ++i)
+        if (src[i] == '\\') ++i;
+      if (i >= n)
+        throw CompileError{"line " + std::to_string(line) +
+                           ": unterminated string"};
+      ++i;
+      token.kind = Token::kString;
+    } else {
+      token.kind = Token::kPunct;
+      i = start + 1;
+      for (size_t p = 0; p < sizeof(kPuncts) / sizeof(kPuncts[0]); ++p) {
+        const std::string punct = kPuncts[p];
+        if (src.compare(start, punct.size(), punct) == 0) {
+          i = start + punct.size();
+          break;
+        }
+      }
+    }
+    token.text = src.substr(start, i - start);
+    tokens->push_back(token);
+  }
+}
+
+// Programs.
+
+enum Opcode {
+  kMove,     // dst = a
+  kConvert,  // dst = a converted to type
+  kBinary,   // dst = a sub b, in type
+  kUnary,    // dst = sub a, in type
+  kSafe,     // dst = safe math macro imm (a, b)
+  kLoad,     // dst = *(type *)(a + imm)
+  kStore,    // *(type *)(a + imm) = b
+  kCopy,     // memcpy(a, b, imm)
+  kInit,     // memcpy(a, image imm, size of the image)
+  kJump,     // goto imm
+  kBranch,   // if ((a != 0) == sub) goto imm
+  kCall,     // call the function at imm
+  kReturn,   // return to the caller
+  kHalt,     // end the thread
+  kAtomic,   // dst = *(type *)a, then atomic sub of it with b
+  kBarrier   // __syncthreads()
+};
+
+enum UnaryOp { kNeg, kBitNot };
+
+// The atomic functions of CUDA.h, myAtomicInc and so on.
+enum AtomicOp {
+  kAtomicInc, kAtomicDec, kAtomicAdd, kAtomicSub, kAtomicMin, kAtomicMax,
+  kAtomicExch, kAtomicAnd, kAtomicOr, kAtomicXor
+};
+
+const char *const kAtomicNames[] = {
+  "Inc", "Dec", "Add", "Sub", "Min", "Max", "Exch", "And", "Or", "Xor"
+};
+
+// The value an atomic operation leaves in memory that held old, both of type
+// scalar.
+uint64_t ApplyAtomic(AtomicOp op, Scalar scalar, uint64_t old,
+    uint64_t value) {
+  const bool is_signed = IsSigned(scalar);
+  const bool less = is_signed ? (int64_t)value < (int64_t)old : value < old;
+  const bool greater = is_signed ? (int64_t)value > (int64_t)old : value > old;
+  switch (op) {
+    case kAtomicInc: return old + 1;
+    case kAtomicDec: return old - 1;
+    case kAtomicAdd: return old + value;
+    case kAtomicSub: return old - value;
+    case kAtomicMin: return less ? value : old;
+    case kAtomicMax: return greater ? value : old;
+    case kAtomicExch: return value;
+    case kAtomicAnd: return old & value;
+    case kAtomicOr: return old | value;
+    case kAtomicXor: return old ^ value;
+  }
+  return old;
+}
+
+// Registers are numbered from 0 in a program; kNoReg marks an unused operand.
+const int kNoReg = INT_MIN;
+
+struct Instr {
+  Opcode op;
+  Scalar type;
+  int sub;
+  // Whether threads can arrive here other than from the previous
+  // instruction, so that threads which diverged may meet again.
+  bool merge;
+  int dst, a, b;
+  int64_t imm;
+  int line;
+};
+
+// The registers that hold the ids of each thread, first among the fixed
+// registers of a program.
+enum LaneReg {
+  kGlobalId0, kGlobalId1, kGlobalId2,
+  kLocalId0, kLocalId1, kLocalId2,
+  kGroupId0, kGroupId1, kGroupId2,
+  kLinearGlobalId, kLinearLocalId, kLinearGroupId,
+  kLaneRegs
+};
+
+// Addresses below this trap, as null pointers.
+const uint64_t kFirstAddress = 16;
+
+// The number of threads run together, as many as a block may hold.
+const int kLanes = 1024;
+
+// The memory of a thread is below kSharedBase. The __shared__ variables of a
+// block are from kSharedBase on, and the buffers that all threads share from
+// kGlobalBase on.
+const uint64_t kSharedBase = (uint64_t)1 << 40;
+const uint64_t kGlobalBase = (uint64_t)1 << 41;
+
+// The size of the buffers that cuda_launcher passes to emi_input and
+// tg_input.
+const uint64_t kInputValues = 1024;
+
+struct Program {
+  std::vector<Instr> code;
+  int64_t entry;
+  // Registers [0, temps) are temporaries; those from temps on are fixed, with
+  // the initial values in fixed (but for the lane registers).
+  int temps;
+  std::vector<uint64_t> fixed;
+  std::vector<std::vector<uint8_t> > images;
+  // The memory of a thread, as it starts. Only the result parameter of the
+  // entry function differs between threads.
+  std::vector<uint8_t> memory;
+  uint64_t result_param;
+  uint64_t result_slot;
+  // The size of the __shared__ variables of a block, and the buffers shared by
+  // all threads as they start.
+  uint64_t shared_size;
+  std::vector<uint8_t> global_memory;
+  // Whether threads share memory, so that the threads of a block must run
+  // together.
+  bool shares_memory;
+  int max_depth;
+  uint64_t global[3];
+  uint64_t local[3];
+};
+
+// Compiler.
+
+struct Variable {
+  const Type *type;
+  uint64_t address;
+};
+
+struct Function {
+  std::string name;
+  const Type *ret;
+  std::vector<Variable> params;
+  bool defined;
+  int64_t pc;
+  int ret_reg;        // The fixed register a scalar or pointer is returned in.
+  uint64_t ret_area;  // Where a record is returned.
+};
+
+// An expression, as it is compiled.
+struct Value {
+  enum Kind { kConst, kReg, kLvalue };
+  Kind kind;
+  const Type *type;
+  // A constant, or the base address of an lvalue without a base register.
+  uint64_t constant;
+  // The register holding the value, or the base address of an lvalue.
+  int reg;
+  // Added to the base address of an lvalue.
+  int64_t offset;
+};
+
+// Compiles a kernel to a Program in one pass. Functions never recurse, so all
+// variables (parameters, results and records that only live in an
+// expression included) have a fixed address in the memory of a thread, and
+// taking their address is a constant. Expressions are folded as they are
+// compiled, and only what is not constant is emitted.
+class Compiler {
+ public:
+  Compiler(const std::string& kernel, Program *program)
+      : program_(program), pos_(0), atomic_counters_(0), func_(NULL),
+        temps_(0), max_temps_(0), total_temps_(0), dead_(0) {
+    Tokenize(kernel, &tokens_);
+    end_.kind = Token::kEnd;
+    end_.line = tokens_.empty() ? 1 : tokens_.back().line;
+    for (size_t i = 0; i < sizeof(kSafeOps) / sizeof(kSafeOps[0]); ++i)
+      safe_ops_[kSafeOps[i].name] = (int)i;
+    program_->fixed.assign(kLaneRegs, 0);
+    program_->entry = -1;
+    program_->shared_size = 0;
+    program_->shares_memory = false;
+    program_->max_depth = 1;
+    ReadLaunch(kernel.substr(0, kernel.find('\n')));
+  }
+
+  void Compile();
+
+ private:
+  // Launch and layout.
+  void ReadLaunch(const std::string& info);
+  static bool ParseDims(const std::string& text, std::vector<uint64_t> *dims);
+  uint64_t Allocate(const Type *type);
+  uint64_t AllocateBuffer(uint64_t values, int first, int step);
+  uint64_t AllocateShared(const Type *type);
+  uint64_t AllocateGlobal(uint64_t values, int size, uint64_t value);
+  void WriteMemory(uint64_t address, uint64_t value, int size);
+
+  // Tokens.
+  const Token& Peek(size_t ahead = 0) const {
+    return pos_ + ahead < tokens_.size() ? tokens_[pos_ + ahead] : end_;
+  }
+  bool Is(const char *text, size_t ahead = 0) const {
+    const Token& token = Peek(ahead);
+    return (token.kind == Token::kIdent || token.kind == Token::kPunct) &&
+        token.text == text;
+  }
+  bool Accept(const char *text) {
+    if (!Is(text)) return false;
+    ++pos_;
+    return true;
+  }
+  void Expect(const char *text) {
+    if (!Accept(text))
+      Fail(std::string("expected '") + text + "' before '" + Peek().text + "'");
+  }
+  std::string Ident() {
+    if (Peek().kind != Token::kIdent)
+      Fail("expected an identifier before '" + Peek().text + "'");
+    return tokens_[pos_++].text;
+  }
+  uint64_t Count();
+  void SkipPast(const char *text);
+  void Fail(const std::string& message) const {
+    throw CompileError{"line " + std::to_string(Peek().line) + ": " + message};
+  }
+
+  // Declarations.
+  bool IsTypeStart(size_t ahead = 0) const;
+  Scalar ScalarName();
+  const Type *TypeSpecifier();
+  const Type *Pointers(const Type *type);
+  const Type *ArrayDims(const Type *type);
+  void DefineRecord();
+  Function *DeclareFunction(const std::string& name, const Type *ret);
+  void DefineFunction(Function *function);
+  void BindEntryParams(Function *function, const std::vector<std::string>& names);
+  const Variable *Lookup(const std::string& name) const;
+  const Variable *Declare(const std::string& name, const Type *type,
+      bool shared = false);
+
+  // Statements.
+  void Block();
+  void Statement();
+  void Declaration();
+  void Constant();
+  void Initialize(const Variable *variable);
+  void InitializeAggregate(const Type *type, uint64_t address,
+      std::vector<uint8_t> *image, uint64_t offset);
+  void InitializeElement(const Type *type, uint64_t address,
+      std::vector<uint8_t> *image, uint64_t offset);
+  void If();
+  void For();
+  void While();
+  void Return();
+
+  // Expressions.
+  Value Expression();
+  Value Assignment();
+  Value Conditional();
+  Value Logical(bool is_and);
+  Value Binary(int level);
+  Value Unary();
+  Value Postfix(Value value);
+  Value Primary();
+  Value Number(const std::string& text);
+  Value VectorLiteral();
+  Value Call(Function *function);
+  Value Builtin(const std::string& name);
+  Value Id(LaneReg first);
+  Value Atomic(AtomicOp op);
+
+  // Values.
+  Value Const(const Type *type, uint64_t constant) const;
+  Value Reg(const Type *type, int reg) const;
+  Value Lvalue(const Type *type, uint64_t address) const;
+  Value Void() const { return Const(types_.Void(), 0); }
+  Scalar ScalarOfType(const Type *type) const;
+  int RegOf(const Value& value);
+  int BaseReg(const Value& lvalue);
+  Value Rvalue(const Value& value);
+  Value AddressOf(const Value& lvalue, const Type *type);
+  Value Deref(const Value& pointer);
+  Value Member(const Value& record, const std::string& name);
+  Value Index(const Value& pointer, const Value& index);
+  Value Convert(const Value& value, Scalar scalar);
+  Value ConvertTo(const Value& value, const Type *type);
+  Value Arith(BinaryOp op, Value a, Value b);
+  Value Negate(Value value, UnaryOp op);
+  Value Truth(const Value& value);
+  Value Assign(const Value& lhs, const Value& rhs);
+  Value CompoundAssign(BinaryOp op, const Value& lhs, const Value& rhs);
+  Value Step(const Value& lvalue, bool increment, bool prefix);
+  void Store(const Value& lvalue, const Value& value);
+  void Copy(const Value& dst, const Value& src);
+
+  // Code.
+  int64_t Here() const { return program_->code.size(); }
+  int64_t Emit(Opcode op, Scalar type, int dst, int a, int b, int64_t imm = 0,
+      int sub = 0);
+  int64_t EmitJump() { return Emit(kJump, kInt, kNoReg, kNoReg, kNoReg); }
+  int64_t EmitBranch(bool if_true, int reg) {
+    return Emit(kBranch, kInt, kNoReg, reg, kNoReg, 0, if_true);
+  }
+  void Patch(int64_t at, int64_t target) {
+    if (at >= 0) program_->code[at].imm = target;
+  }
+  int NewTemp() {
+    max_temps_ = std::max(max_temps_, temps_ + 1);
+    return temps_++;
+  }
+  int FixedReg(uint64_t value) {
+    program_->fixed.push_back(value);
+    return -(int)program_->fixed.size();
+  }
+  int ConstReg(uint64_t value) {
+    std::map<uint64_t, int>::const_iterator it = consts_.find(value);
+    if (it != consts_.end()) return it->second;
+    return consts_[value] = FixedReg(value);
+  }
+  void Link();
+
+  struct Loop {
+    std::vector<int64_t> breaks;
+    std::vector<int64_t> continues;
+  };
+
+  Program *program_;
+  TypeTable types_;
+  std::vector<Token> tokens_;
+  Token end_;
+  size_t pos_;
+  std::map<std::string, int> safe_ops_;
+  std::map<uint64_t, int> consts_;
+  std::vector<std::unique_ptr<Function> > functions_;
+  std::map<std::string, Function *> function_names_;
+  std::vector<std::unique_ptr<Variable> > variables_;
+  std::vector<std::map<std::string, const Variable *> > scopes_;
+  std::map<std::string, const Variable *> constants_;  // At file scope.
+  uint64_t buffers_[3];  // sequence_input, emi_input and tg_input.
+  int atomic_counters_;  // Per block, as --atomics gives them.
+
+  // The function being compiled.
+  Function *func_;
+  int temps_;
+  int max_temps_;
+  int total_temps_;
+  std::map<std::string, int64_t> labels_;
+  std::vector<std::pair<int64_t, std::string> > gotos_;
+  std::vector<Loop> loops_;
+  // Nonzero while compiling code that never runs (an unused macro argument or
+  // the right of a decided && or ||), which is parsed but not emitted.
+  int dead_;
+};
+
+// Launch and layout.
+
+// Reads the dimensions cuda_launcher would run the kernel with, and the number
+// of atomic counters, from the info line, and lays out the memory every thread
+// starts with: a null page, the slot the thread's result goes to and the input
+// buffers.
+void Compiler::ReadLaunch(const std::string& info) {
+  std::vector<uint64_t> global(1, 1024), local(1, 32);
+  std::istringstream words(info);
+  std::string word;
+  while (words >> word) {
+    if (word == "--atomics") {
+      if (!(words >> atomic_counters_) || atomic_counters_ < 0)
+        throw CompileError{"cannot parse the atomic counters of the info line"};
+      continue;
+    }
+    if (word == "-g" || word == "--groups" || word == "-l" ||
+        word == "--locals") {
+      std::string dims;
+      std::vector<uint64_t> *out =
+          word == "-g" || word == "--groups" ? &global : &local;
+      if (!(words >> dims) || !ParseDims(dims, out))
+        throw CompileError{"cannot parse the dimensions of the info line"};
+    }
+  }
+  if (global.size() != local.size())
+    throw CompileError{"the global and local sizes of the info line differ"};
+  while (global.size() < 3) {
+    global.push_back(1);
+    local.push_back(1);
+  }
+  for (int d = 0; d < 3; ++d) {
+    if (local[d] == 0 || global[d] % local[d])
+      throw CompileError{"a global dimension is not a multiple of the local"};
+    program_->global[d] = global[d];
+    program_->local[d] = local[d];
+  }
+
+  program_->memory.assign(kFirstAddress, 0);
+  program_->result_param = 0;
+  program_->result_slot = Allocate(types_.Get(kLong));
+  const uint64_t max_global =
+      std::max(global[0], std::max(global[1], global[2]));
+  buffers_[0] = AllocateBuffer(max_global, 10, 1);
+  buffers_[1] = AllocateBuffer(kInputValues, 0, 1);
+  buffers_[2] = AllocateBuffer(kInputValues, (int)kInputValues, -1);
+}
+
+bool Compiler::ParseDims(const std::string& text, std::vector<uint64_t> *dims) {
+  dims->clear();
+  std::istringstream in(text);
+  std::string dim;
+  while (std::getline(in, dim, ',')) {
+    char *end;
+    const unsigned long value = strtoul(dim.c_str(), &end, 10);
+    if (dim.empty() || *end || value == 0) return false;
+    dims->push_back(value);
+  }
+  return !dims->empty() && dims->size() <= 3;
+}
+
+uint64_t Compiler::Allocate(const Type *type) {
+  const uint64_t address =
+      AlignUp(program_->memory.size(), std::max<uint64_t>(type->Align(), 8));
+  program_->memory.resize(address + std::max<uint64_t>(type->Size(), 1), 0);
+  return address;
+}
+
+uint64_t Compiler::AllocateBuffer(uint64_t values, int first, int step) {
+  const uint64_t address =
+      Allocate(types_.ArrayOf(types_.Get(kInt), values));
+  for (uint64_t i = 0; i < values; ++i)
+    WriteMemory(address + 4 * i, (uint64_t)(int64_t)(first + step * (int)i), 4);
+  return address;
+}
+
+uint64_t Compiler::AllocateShared(const Type *type) {
+  const uint64_t address =
+      AlignUp(program_->shared_size, std::max<uint64_t>(type->Align(), 8));
+  program_->shared_size = address + std::max<uint64_t>(type->Size(), 1);
+  program_->shares_memory = true;
+  return kSharedBase + address;
+}
+
+// A buffer of values of the given size that all threads share, each set to
+// value. An empty buffer is null, as cuda_launcher passes it.
+uint64_t Compiler::AllocateGlobal(uint64_t values, int size, uint64_t value) {
+  if (values == 0) return 0;
+  std::vector<uint8_t>& memory = program_->global_memory;
+  const uint64_t address = AlignUp(memory.size(), 8);
+  memory.resize(address + values * size, 0);
+  for (uint64_t i = 0; i < values; ++i)
+    for (int b = 0; b < size; ++b)
+      memory[address + i * size + b] = (uint8_t)(value >> (8 * b));
+  program_->shares_memory = true;
+  return kGlobalBase + address;
+}
+
+void Compiler::WriteMemory(uint64_t address, uint64_t value, int size) {
+  for (int i = 0; i < size; ++i)
+    program_->memory[address + i] = (uint8_t)(value >> (8 * i));
+}
+
+// Tokens.
+
+// A number in a declarator, such as an array dimension.
+uint64_t Compiler::Count() {
+  if (Peek().kind != Token::kNumber)
+    Fail("expected a number before '" + Peek().text + "'");
+  const Value value = Number(tokens_[pos_++].text);
+  return value.constant;
+}
+
+// Skips to just after the next text outside parentheses.
+void Compiler::SkipPast(const char *text) {
+  int depth = 0;
+  while (Peek().kind != Token::kEnd) {
+    if (depth == 0 && Is(text)) {
+      ++pos_;
+      return;
+    }
+    if (Is("(")) ++depth;
+    if (Is(")")) --depth;
+    ++pos_;
+  }
+  Fail(std::string("expected '") + text + "'");
+}
+
+// Declarations.
+
+struct NamedScalar {
+  const char *name;
+  Scalar scalar;
+};
+
+const NamedScalar kScalarNames[] = {
+  { "int8_t", kChar }, { "uint8_t", kChar },
+  { "int16_t", kShort }, { "uint16_t", kShort },
+  { "int32_t", kInt }, { "uint32_t", kInt },
+  { "int64_t", kLong }, { "uint64_t", kLong },
+  { "char", kChar }, { "short", kShort }, { "int", kInt }, { "uint", kInt },
+  { "long", kLong },
+};
+
+bool Compiler::IsTypeStart(size_t ahead) const {
+  static const char *const kStarts[] = {
+    "struct", "union", "VECTOR", "const", "volatile", "signed", "unsigned",
+    "void", "__shared__", "__constant__"
+  };
+  for (size_t i = 0; i < sizeof(kStarts) / sizeof(kStarts[0]); ++i)
+    if (Is(kStarts[i], ahead)) return true;
+  for (size_t i = 0; i < sizeof(kScalarNames) / sizeof(kScalarNames[0]); ++i)
+    if (Is(kScalarNames[i].name, ahead)) return true;
+  return false;
+}
+
+Scalar Compiler::ScalarName() {
+  const bool is_unsigned = Accept("unsigned");
+  const bool is_signed = !is_unsigned && Accept("signed");
+  for (size_t i = 0; i < sizeof(kScalarNames) / sizeof(kScalarNames[0]); ++i) {
+    if (Accept(kScalarNames[i].name)) {
+      Scalar scalar = kScalarNames[i].scalar;
+      if (scalar == kLong) Accept("long");
+      if (scalar == kShort || scalar == kLong) Accept("int");
+      return is_unsigned ? (Scalar)(scalar + kUChar) : scalar;
+    }
+  }
+  if (is_unsigned) return kUInt;
+  if (is_signed) return kInt;
+  Fail("expected a type before '" + Peek().text + "'");
+  return kInt;
+}
+
+const Type *Compiler::TypeSpecifier() {
+  while (Accept("const") || Accept("volatile")) {}
+  if (Is("__shared__") || Is("__constant__"))
+    Fail("uses " + Peek().text + " memory");
+  const Type *type;
+  if (Accept("void")) {
+    type = types_.Void();
+  } else if (Is("struct") || Is("union")) {
+    const bool is_union = Accept("union");
+    if (!is_union) Expect("struct");
+    type = types_.RecordType(types_.GetRecord(Ident(), is_union));
+  } else if (Accept("VECTOR")) {
+    Expect("(");
+    const Scalar scalar = ScalarName();
+    Expect(",");
+    const uint64_t n = Count();
+    Expect(")");
+    if (n < 1 || n > 4) Fail("uses a vector of " + std::to_string(n));
+    type = types_.Vector(scalar, (int)n);
+  } else {
+    type = types_.Get(ScalarName());
+  }
+  while (Accept("const") || Accept("volatile")) {}
+  return type;
+}
+
+const Type *Compiler::Pointers(const Type *type) {
+  while (Accept("*")) {
+    type = types_.PointerTo(type);
+    while (Accept("const") || Accept("volatile")) {}
+  }
+  return type;
+}
+
+const Type *Compiler::ArrayDims(const Type *type) {
+  std::vector<uint64_t> dims;
+  while (Accept("[")) {
+    dims.push_back(Count());
+    Expect("]");
+  }
+  for (size_t i = dims.size(); i-- > 0;) {
+    if (type->kind == Type::kRecord && !type->record->complete)
+      Fail("uses an incomplete type");
+    type = types_.ArrayOf(type, dims[i]);
+  }
+  return type;
+}
+
+void Compiler::DefineRecord() {
+  const bool is_union = Accept("union");
+  if (!is_union) Expect("struct");
+  Record *record = types_.GetRecord(Ident(), is_union);
+  if (record->complete) Fail("redefines " + record->name);
+  Expect("{");
+  while (!Accept("}")) {
+    const Type *base = TypeSpecifier();
+    do {
+      const Type *type = Pointers(base);
+      const std::string name = Ident();
+      type = ArrayDims(type);
+      if (Is(":")) Fail("uses bit-fields");
+      if (type->kind == Type::kVoid ||
+          (type->kind == Type::kRecord && !type->record->complete))
+        Fail("uses an incomplete type");
+      TypeTable::AddField(record, name, type);
+    } while (Accept(","));
+    Expect(";");
+  }
+  TypeTable::Complete(record);
+}
+
+Function *Compiler::DeclareFunction(const std::string& name, const Type *ret) {
+  Expect("(");
+  std::vector<std::string> names;
+  std::vector<const Type *> params;
+  if (Is("void") && Is(")", 1)) ++pos_;
+  if (!Is(")")) {
+    do {
+      const Type *type = Pointers(TypeSpecifier());
+      names.push_back(Ident());
+      params.push_back(type);
+    } while (Accept(","));
+  }
+  Expect(")");
+
+  Function *& function = function_names_[name];
+  if (!function) {
+    functions_.push_back(std::unique_ptr<Function>(new Function));
+    function = functions_.back().get();
+    function->name = name;
+    function->ret = ret;
+    function->defined = false;
+    function->pc = -1;
+    function->ret_reg = kNoReg;
+    function->ret_area = 0;
+    if (ret->kind == Type::kRecord)
+      function->ret_area = Allocate(ret);
+    else if (ret->IsValue())
+      function->ret_reg = FixedReg(0);
+    for (size_t i = 0; i < params.size(); ++i) {
+      if (params[i]->kind == Type::kVoid ||
+          (params[i]->kind == Type::kRecord && !params[i]->record->complete))
+        Fail("has a parameter of an incomplete type");
+      Variable param;
+      param.type = params[i];
+      param.address = Allocate(params[i]);
+      function->params.push_back(param);
+    }
+  } else if (function->params.size() != params.size() ||
+             function->ret != ret) {
+    Fail("redeclares " + name + " differently");
+  }
+
+  if (Is("{")) {
+    if (function->defined) Fail("redefines " + name);
+    scopes_.assign(1, std::map<std::string, const Variable *>());
+    for (size_t i = 0; i < names.size(); ++i)
+      scopes_.back()[names[i]] = &function->params[i];
+    if (name == "entry") BindEntryParams(function, names);
+    DefineFunction(function);
+  } else {
+    Expect(";");
+  }
+  return function;
+}
+
+// The entry function is given the buffers of cuda_launcher, set up as it does.
+// Those of message passing are not interpreted.
+void Compiler::BindEntryParams(Function *function,
+    const std::vector<std::string>& names) {
+  static const char *const kBuffers[] = {
+    "sequence_input", "emi_input", "tg_input"
+  };
+  uint64_t threads = 1, blocks = 1;
+  for (int d = 0; d < 3; ++d) {
+    threads *= program_->global[d];
+    blocks *= program_->global[d] / program_->local[d];
+  }
+  // The buffers all threads share: the atomic counters and special values of
+  // each block, the target of each block's atomic reductions, and a value of
+  // each thread for inter-thread communication, which starts as 1.
+  const struct {
+    const char *name;
+    uint64_t values;
+    int size;
+    uint64_t value;
+  } kShared[] = {
+    { "g_atomic_input", atomic_counters_ * blocks, 4, 0 },
+    { "g_special_values", atomic_counters_ * blocks, 4, 0 },
+    { "g_atomic_reduction", blocks, 4, 0 },
+    { "g_comm_values", threads, 8, 1 },
+  };
+  for (size_t i = 0; i < names.size(); ++i) {
+    const Variable& param = function->params[i];
+    if (param.type->kind != Type::kPointer) Fail("takes " + names[i]);
+    if (names[i] == "result") {
+      program_->result_param = param.address;
+      continue;
+    }
+    bool found = false;
+    for (size_t b = 0; b < sizeof(kShared) / sizeof(kShared[0]); ++b) {
+      if (names[i] == kShared[b].name) {
+        WriteMemory(param.address, AllocateGlobal(kShared[b].values,
+            kShared[b].size, kShared[b].value), 8);
+        found = true;
+      }
+    }
+    for (int b = 0; b < 3; ++b) {
+      if (names[i] == kBuffers[b]) {
+        WriteMemory(param.address, buffers_[b], 8);
+        found = true;
+      }
+    }
+    if (!found) Fail("uses " + names[i]);
+  }
+  if (!program_->result_param) Fail("has no result parameter");
+}
+
+void Compiler::DefineFunction(Function *function) {
+  func_ = function;
+  function->defined = true;
+  function->pc = Here();
+  const int64_t start = Here();
+  temps_ = max_temps_ = 0;
+  labels_.clear();
+  gotos_.clear();
+  loops_.clear();
+
+  Block();
+  if (function->name == "entry")
+    Emit(kHalt, kInt, kNoReg, kNoReg, kNoReg);
+  else
+    Emit(kReturn, kInt, kNoReg, kNoReg, kNoReg);
+
+  for (size_t i = 0; i < gotos_.size(); ++i) {
+    std::map<std::string, int64_t>::const_iterator label =
+        labels_.find(gotos_[i].second);
+    if (label == labels_.end()) Fail("jumps to no label " + gotos_[i].second);
+    Patch(gotos_[i].first, label->second);
+  }
+  // The temporaries of every function get registers of their own, as a
+  // caller's are live across the call.
+  for (int64_t pc = start; pc < Here(); ++pc) {
+    Instr& instr = program_->code[pc];
+    int *regs[] = { &instr.dst, &instr.a, &instr.b };
+    for (int i = 0; i < 3; ++i)
+      if (*regs[i] >= 0) *regs[i] += total_temps_;
+  }
+  total_temps_ += max_temps_;
+  func_ = NULL;
+}
+
+const Variable *Compiler::Lookup(const std::string& name) const {
+  for (size_t i = scopes_.size(); i-- > 0;) {
+    std::map<std::string, const Variable *>::const_iterator it =
+        scopes_[i].find(name);
+    if (it != scopes_[i].end()) return it->second;
+  }
+  std::map<std::string, const Variable *>::const_iterator it =
+      constants_.find(name);
+  return it != constants_.end() ? it->second : NULL;
+}
+
+// A variable of the current scope, in the memory of the block if shared.
+const Variable *Compiler::Declare(const std::string& name, const Type *type,
+    bool shared) {
+  if (type->kind == Type::kVoid ||
+      (type->kind == Type::kRecord && !type->record->complete))
+    Fail("declares " + name + " of an incomplete type");
+  variables_.push_back(std::unique_ptr<Variable>(new Variable));
+  Variable *variable = variables_.back().get();
+  variable->type = type;
+  variable->address = shared ? AllocateShared(type) : Allocate(type);
+  scopes_.back()[name] = variable;
+  return variable;
+}
+
+void Compiler::Compile() {
+  while (Peek().kind != Token::kEnd) {
+    if ((Is("struct") || Is("union")) && Is("{", 2)) {
+      DefineRecord();
+      Expect(";");
+      continue;
+    }
+    if (Accept("__constant__")) {
+      Constant();
+      continue;
+    }
+    if (Accept("extern") && Peek().kind == Token::kString) ++pos_;
+    while (Accept("__device__") || Accept("__global__") || Accept("static") ||
+           Accept("inline") || Accept("__forceinline__")) {}
+    const Type *type = Pointers(TypeSpecifier());
+    const std::string name = Ident();
+    if (!Is("(")) Fail("declares the global variable " + name);
+    Function *function = DeclareFunction(name, type);
+    if (function->name == "entry" && function->defined) {
+      // What follows the entry function only runs it on the host.
+      Link();
+      return;
+    }
+  }
+  Fail("has no entry function");
+}
+
+// Resolves calls and numbers the registers, and marks where threads can meet.
+void Compiler::Link() {
+  std::vector<Instr>& code = program_->code;
+  program_->temps = total_temps_;
+  program_->entry = function_names_["entry"]->pc;
+  program_->max_depth = (int)functions_.size() + 1;
+  for (size_t pc = 0; pc < code.size(); ++pc) {
+    Instr& instr = code[pc];
+    int *regs[] = { &instr.dst, &instr.a, &instr.b };
+    for (int i = 0; i < 3; ++i)
+      if (*regs[i] != kNoReg && *regs[i] < 0)
+        *regs[i] = total_temps_ + (-*regs[i] - 1);
+    if (instr.op == kCall) {
+      const Function *callee = functions_[instr.imm].get();
+      if (!callee->defined)
+        throw CompileError{"calls " + callee->name + ", which is not defined"};
+      instr.imm = callee->pc;
+    }
+  }
+  for (size_t pc = 0; pc < code.size(); ++pc) {
+    const Instr& instr = code[pc];
+    if (instr.op == kJump || instr.op == kBranch || instr.op == kCall)
+      code[instr.imm].merge = true;
+    if (instr.op == kCall) code[pc + 1].merge = true;
+    // Threads wait at a barrier for the others of their block.
+    if (instr.op == kBarrier) code[pc].merge = true;
+  }
+  const uint64_t block = program_->local[0] * program_->local[1] *
+      program_->local[2];
+  if (program_->shares_memory && block > kLanes)
+    throw CompileError{"shares memory between more than " +
+                       std::to_string(kLanes) + " threads of a block"};
+}
+
+// Statements.
+
+void Compiler::Block() {
+  Expect("{");
+  scopes_.push_back(std::map<std::string, const Variable *>());
+  while (!Accept("}")) {
+    if (Peek().kind == Token::kEnd) Fail("expected '}'");
+    Statement();
+  }
+  scopes_.pop_back();
+}
+
+void Compiler::Statement() {
+  temps_ = 0;
+  if (Is("{")) {
+    Block();
+  } else if (Peek().kind == Token::kIdent && Is(":", 1)) {
+    const std::string label = Ident();
+    Expect(":");
+    if (labels_.count(label)) Fail("redefines the label " + label);
+    labels_[label] = Here();
+  } else if (Accept(";")) {
+  } else if (Accept("if")) {
+    If();
+  } else if (Accept("for")) {
+    For();
+  } else if (Accept("while")) {
+    While();
+  } else if (Accept("return")) {
+    Return();
+  } else if (Is("break") || Is("continue")) {
+    const bool is_break = Accept("break");
+    if (!is_break) Expect("continue");
+    if (loops_.empty()) Fail("breaks out of no loop");
+    const int64_t jump = EmitJump();
+    (is_break ? loops_.back().breaks : loops_.back().continues).push_back(jump);
+    Expect(";");
+  } else if (Accept("goto")) {
+    gotos_.push_back(std::make_pair(EmitJump(), Ident()));
+    Expect(";");
+  } else if (Is("do") || Is("switch")) {
+    Fail("uses " + Peek().text);
+  } else if (IsTypeStart()) {
+    Declaration();
+  } else {
+    Expression();
+    Expect(";");
+  }
+}
+
+void Compiler::Declaration() {
+  const bool shared = Accept("__shared__");
+  const Type *base = TypeSpecifier();
+  // The loop counters of array initialization are declared as "int ;" when
+  // there are none.
+  if (Accept(";")) return;
+  do {
+    const Type *type = Pointers(base);
+    const std::string name = Ident();
+    type = ArrayDims(type);
+    const Variable *variable = Declare(name, type, shared);
+    if (shared && Is("=")) Fail("initializes the __shared__ " + name);
+    if (Accept("=")) Initialize(variable);
+    temps_ = 0;
+  } while (Accept(","));
+  Expect(";");
+}
+
+// A __constant__ variable, which the threads of the grid share and only read.
+// It is kept with the buffers of the grid, and its initializer must be
+// constant.
+void Compiler::Constant() {
+  const Type *type = Pointers(TypeSpecifier());
+  const std::string name = Ident();
+  type = ArrayDims(type);
+  if (type->kind == Type::kVoid ||
+      (type->kind == Type::kRecord && !type->record->complete))
+    Fail("declares " + name + " of an incomplete type");
+  std::vector<uint8_t>& memory = program_->global_memory;
+  const uint64_t offset =
+      AlignUp(memory.size(), std::max<uint64_t>(type->Align(), 8));
+  memory.resize(offset + type->Size(), 0);
+  variables_.push_back(std::unique_ptr<Variable>(new Variable));
+  Variable *variable = variables_.back().get();
+  variable->type = type;
+  variable->address = kGlobalBase + offset;
+  if (Accept("=")) {
+    std::vector<uint8_t> image(type->Size(), 0);
+    if (type->IsValue()) {
+      const bool braced = Accept("{");
+      InitializeElement(type, variable->address, &image, 0);
+      if (braced) {
+        Accept(",");
+        Expect("}");
+      }
+    } else {
+      InitializeAggregate(type, variable->address, &image, 0);
+    }
+    std::copy(image.begin(), image.end(), memory.begin() + offset);
+  }
+  constants_[name] = variable;
+  Expect(";");
+}
+
+// A brace enclosed initializer is stored as an image of its constant
+// elements, over which the others are then stored.
+void Compiler::Initialize(const Variable *variable) {
+  if (!Is("{")) {
+    Assign(Lvalue(variable->type, variable->address), Assignment());
+    return;
+  }
+  const int64_t init = Emit(kInit, kInt, kNoReg, ConstReg(variable->address),
+                            kNoReg, program_->images.size());
+  program_->images.push_back(std::vector<uint8_t>());
+  std::vector<uint8_t> image(variable->type->Size(), 0);
+  if (variable->type->IsValue()) {
+    Expect("{");
+    InitializeElement(variable->type, variable->address, &image, 0);
+    Accept(",");
+    Expect("}");
+  } else {
+    InitializeAggregate(variable->type, variable->address, &image, 0);
+  }
+  if (init >= 0) program_->images[program_->code[init].imm].swap(image);
+}
+
+void Compiler::InitializeAggregate(const Type *type, uint64_t address,
+    std::vector<uint8_t> *image, uint64_t offset) {
+  Expect("{");
+  for (size_t i = 0; !Is("}"); ++i) {
+    if (type->kind == Type::kArray) {
+      if (i >= type->count) Fail("has too many initializers");
+      InitializeElement(type->base, address, image,
+                        offset + i * type->base->Size());
+    } else {
+      const Record *record = type->record;
+      if (i >= record->fields.size() || (record->is_union && i > 0))
+        Fail("has too many initializers");
+      InitializeElement(record->fields[i].type, address, image,
+                        offset + record->fields[i].offset);
+    }
+    if (!Accept(",")) break;
+  }
+  Expect("}");
+}
+
+void Compiler::InitializeElement(const Type *type, uint64_t address,
+    std::vector<uint8_t> *image, uint64_t offset) {
+  if (Is("{")) {
+    if (!type->IsValue()) {
+      InitializeAggregate(type, address, image, offset);
+      return;
+    }
+    Expect("{");
+    InitializeElement(type, address, image, offset);
+    Accept(",");
+    Expect("}");
+    return;
+  }
+  if (type->kind == Type::kArray) Fail("elides the braces of an initializer");
+  const Value element = Lvalue(type, address + offset);
+  // Outside a function only constants can be stored in the image.
+  if (!func_) ++dead_;
+  const Value value = Assignment();
+  if (!func_) {
+    --dead_;
+    if (type->kind == Type::kRecord ||
+        ConvertTo(Rvalue(value), type).kind != Value::kConst)
+      Fail("initializes a __constant__ variable with other than a constant");
+  }
+  if (type->kind == Type::kRecord) {
+    Copy(element, value);
+  } else {
+    const Value converted = ConvertTo(Rvalue(value), type);
+    if (converted.kind == Value::kConst) {
+      for (uint64_t i = 0; i < type->Size(); ++i)
+        (*image)[offset + i] = (uint8_t)(converted.constant >> (8 * i));
+    } else {
+      Store(element, converted);
+    }
+  }
+  temps_ = 0;
+}
+
+void Compiler::If() {
+  Expect("(");
+  const Value condition = Rvalue(Expression());
+  Expect(")");
+  const int64_t branch = EmitBranch(false, RegOf(condition));
+  Statement();
+  if (Accept("else")) {
+    const int64_t jump = EmitJump();
+    Patch(branch, Here());
+    Statement();
+    Patch(jump, Here());
+  } else {
+    Patch(branch, Here());
+  }
+}
+
+// A loop is laid out as the body, the step and then the condition, which
+// branches back to the body, so that an iteration only jumps once. The step
+// and the condition are compiled out of the order of the source.
+void Compiler::For() {
+  Expect("(");
+  if (!Is(";")) Expression();
+  Expect(";");
+  const size_t condition = pos_;
+  SkipPast(";");
+  const size_t step = pos_;
+  SkipPast(")");
+  const int64_t enter = EmitJump();
+
+  const int64_t body = Here();
+  loops_.push_back(Loop());
+  Statement();
+  const size_t end = pos_;
+
+  const int64_t continues = Here();
+  pos_ = step;
+  temps_ = 0;
+  if (!Is(")")) Expression();
+  Expect(")");
+
+  Patch(enter, Here());
+  pos_ = condition;
+  temps_ = 0;
+  if (Is(";")) {
+    Patch(EmitJump(), body);
+  } else {
+    const Value value = Rvalue(Expression());
+    Patch(EmitBranch(true, RegOf(value)), body);
+  }
+  Expect(";");
+  pos_ = end;
+
+  for (size_t i = 0; i < loops_.back().breaks.size(); ++i)
+    Patch(loops_.back().breaks[i], Here());
+  for (size_t i = 0; i < loops_.back().continues.size(); ++i)
+    Patch(loops_.back().continues[i], continues);
+  loops_.pop_back();
+}
+
+void Compiler::While() {
+  Expect("(");
+  const size_t condition = pos_;
+  SkipPast(")");
+  const int64_t enter = EmitJump();
+
+  const int64_t body = Here();
+  loops_.push_back(Loop());
+  Statement();
+  const size_t end = pos_;
+
+  const int64_t continues = Here();
+  Patch(enter, Here());
+  pos_ = condition;
+  temps_ = 0;
+  const Value value = Rvalue(Expression());
+  Patch(EmitBranch(true, RegOf(value)), body);
+  Expect(")");
+  pos_ = end;
+
+  for (size_t i = 0; i < loops_.back().breaks.size(); ++i)
+    Patch(loops_.back().breaks[i], Here());
+  for (size_t i = 0; i < loops_.back().continues.size(); ++i)
+    Patch(loops_.back().continues[i], continues);
+  loops_.pop_back();
+}
+
+void Compiler::Return() {
+  if (!Is(";")) {
+    const Value value = Expression();
+    if (func_->ret->kind == Type::kRecord) {
+      Copy(Lvalue(func_->ret, func_->ret_area), value);
+    } else if (func_->ret->IsValue()) {
+      const Value converted = ConvertTo(Rvalue(value), func_->ret);
+      Emit(kMove, kLong, func_->ret_reg, RegOf(converted), kNoReg);
+    }
+  }
+  Expect(";");
+  if (func_->name == "entry")
+    Emit(kHalt, kInt, kNoReg, kNoReg, kNoReg);
+  else
+    Emit(kReturn, kInt, kNoReg, kNoReg, kNoReg);
+}
+
+// Expressions.
+
+Value Compiler::Expression() {
+  Value value = Assignment();
+  while (Accept(",")) value = Assignment();
+  return value;
+}
+
+Value Compiler::Assignment() {
+  static const struct { const char *text; BinaryOp op; } kCompound[] = {
+    { "+=", kAdd }, { "-=", kSub }, { "*=", kMul }, { "/=", kDiv },
+    { "%=", kMod }, { "<<=", kShl }, { ">>=", kShr }, { "&=", kAnd },
+    { "|=", kOr }, { "^=", kXor }
+  };
+  const Value lhs = Conditional();
+  if (Accept("=")) return Assign(lhs, Assignment());
+  for (size_t i = 0; i < sizeof(kCompound) / sizeof(kCompound[0]); ++i)
+    if (Accept(kCompound[i].text))
+      return CompoundAssign(kCompound[i].op, lhs, Assignment());
+  return lhs;
+}
+
+// Both arms convert to the type of the result in a placeholder, which is
+// fixed once the type is known.
+Value Compiler::Conditional() {
+  const Value condition = Logical(false);
+  if (!Accept("?")) return condition;
+  const int result = NewTemp();
+  const int64_t branch = EmitBranch(false, RegOf(Rvalue(condition)));
+  const Value a = Rvalue(Expression());
+  const int64_t convert_a = Emit(kConvert, kLong, result, RegOf(a), kNoReg);
+  const int64_t jump = EmitJump();
+  Expect(":");
+  Patch(branch, Here());
+  const Value b = Rvalue(Conditional());
+  const int64_t convert_b = Emit(kConvert, kLong, result, RegOf(b), kNoReg);
+  Patch(jump, Here());
+  if (!a.type->IsValue() || !b.type->IsValue())
+    Fail("uses ?: on records");
+  const Type *type = a.type->kind == Type::kPointer ? a.type
+      : b.type->kind == Type::kPointer ? b.type
+      : types_.Get(CommonType(a.type->scalar, b.type->scalar));
+  if (convert_a >= 0) {
+    program_->code[convert_a].type = ScalarOfType(type);
+    program_->code[convert_b].type = ScalarOfType(type);
+  }
+  return Reg(type, result);
+}
+
+// || (or && if is_and), evaluating the right only if it decides the result.
+Value Compiler::Logical(bool is_and) {
+  Value value = is_and ? Binary(0) : Logical(true);
+  while (Accept(is_and ? "&&" : "||")) {
+    const Value left = Truth(Rvalue(value));
+    if (left.kind == Value::kConst) {
+      if ((left.constant != 0) == is_and) {
+        value = Truth(Rvalue(is_and ? Binary(0) : Logical(true)));
+      } else {
+        ++dead_;
+        is_and ? Binary(0) : Logical(true);
+        --dead_;
+        value = left;
+      }
+      continue;
+    }
+    const int result = NewTemp();
+    Emit(kMove, kInt, result, RegOf(left), kNoReg);
+    const int64_t branch = EmitBranch(!is_and, result);
+    const Value right = Truth(Rvalue(is_and ? Binary(0) : Logical(true)));
+    Emit(kMove, kInt, result, RegOf(right), kNoReg);
+    Patch(branch, Here());
+    value = Reg(types_.Get(kInt), result);
+  }
+  return value;
+}
+
+Value Compiler::Binary(int level) {
+  static const struct { const char *text; BinaryOp op; } kLevels[][4] = {
+    { { "|", kOr } },
+    { { "^", kXor } },
+    { { "&", kAnd } },
+    { { "==", kEq }, { "!=", kNe } },
+    { { "<", kLt }, { "<=", kLe }, { ">", kGt }, { ">=", kGe } },
+    { { "<<", kShl }, { ">>", kShr } },
+    { { "+", kAdd }, { "-", kSub } },
+    { { "*", kMul }, { "/", kDiv }, { "%", kMod } },
+  };
+  const int kBinaryLevels = sizeof(kLevels) / sizeof(kLevels[0]);
+  if (level == kBinaryLevels) return Unary();
+  Value value = Binary(level + 1);
+  for (;;) {
+    int i = 0;
+    while (i < 4 && kLevels[level][i].text && !Is(kLevels[level][i].text)) ++i;
+    if (i == 4 || !kLevels[level][i].text) return value;
+    ++pos_;
+    const Value left = Rvalue(value);
+    value = Arith(kLevels[level][i].op, left, Rvalue(Binary(level + 1)));
+  }
+}
+
+Value Compiler::Unary() {
+  if (Is("++") || Is("--")) {
+    const bool increment = Accept("++");
+    if (!increment) Expect("--");
+    return Step(Unary(), increment, true);
+  }
+  if (Accept("&")) {
+    const Value value = Unary();
+    if (value.kind != Value::kLvalue) Fail("takes the address of a value");
+    return AddressOf(value, types_.PointerTo(value.type));
+  }
+  if (Accept("*")) return Deref(Rvalue(Unary()));
+  if (Accept("-")) return Negate(Rvalue(Unary()), kNeg);
+  if (Accept("~")) return Negate(Rvalue(Unary()), kBitNot);
+  if (Accept("+")) {
+    const Value value = Rvalue(Unary());
+    return Convert(value, Promote(ScalarOfType(value.type)));
+  }
+  if (Accept("!")) {
+    const Value value = Rvalue(Unary());
+    return Arith(kEq, value, Const(types_.Get(kInt), 0));
+  }
+  if (Is("(") && IsTypeStart(1)) {
+    Expect("(");
+    const Type *type = Pointers(TypeSpecifier());
+    Expect(")");
+    const Value value = Rvalue(Unary());
+    if (type->kind == Type::kVoid) return Void();
+    return ConvertTo(value, type);
+  }
+  return Postfix(Primary());
+}
+
+Value Compiler::Postfix(Value value) {
+  for (;;) {
+    if (Accept("[")) {
+      const Value pointer = Rvalue(value);
+      const Value index = Rvalue(Expression());
+      Expect("]");
+      value = Index(pointer, index);
+    } else if (Accept(".")) {
+      value = Member(value, Ident());
+    } else if (Accept("->")) {
+      value = Member(Deref(Rvalue(value)), Ident());
+    } else if (Is("++") || Is("--")) {
+      const bool increment = Accept("++");
+      if (!increment) Expect("--");
+      value = Step(value, increment, false);
+    } else {
+      return value;
+    }
+  }
+}
+
+Value Compiler::Primary() {
+  if (Peek().kind == Token::kNumber) return Number(tokens_[pos_++].text);
+  if (Accept("(")) {
+    if (Is("VECTOR_MAKE")) return VectorLiteral();
+    const Value value = Expression();
+    Expect(")");
+    return value;
+  }
+  const std::string name = Ident();
+  if (const Variable *variable = Lookup(name))
+    return Lvalue(variable->type, variable->address);
+  std::map<std::string, Function *>::const_iterator function =
+      function_names_.find(name);
+  if (function != function_names_.end()) return Call(function->second);
+  return Builtin(name);
+}
+
+// An integer literal, typed as in C++11 on an LP64 target.
+Value Compiler::Number(const std::string& text) {
+  int base = 10;
+  if (text.size() > 1 && text[0] == '0')
+    base = (text[1] == 'x' || text[1] == 'X') ? 16 : 8;
+  errno = 0;
+  char *end;
+  const uint64_t value = strtoull(text.c_str(), &end, base);
+  if (errno == ERANGE) Fail("has the literal " + text + ", which is too large");
+  bool is_unsigned = false;
+  for (; *end; ++end) {
+    if (*end == 'u' || *end == 'U')
+      is_unsigned = true;
+    else if (*end != 'l' && *end != 'L')
+      Fail("has the literal " + text);
+  }
+  const bool is_long = text.find_first_of("lL") != std::string::npos;
+  Scalar scalar;
+  if (!is_unsigned && !is_long && value <= INT_MAX)
+    scalar = kInt;
+  else if (!is_long && value <= UINT_MAX && (is_unsigned || base != 10))
+    scalar = kUInt;
+  else if (!is_unsigned && value <= LONG_MAX)
+    scalar = kLong;
+  else
+    scalar = kULong;
+  return Const(types_.Get(scalar), value);
+}
+
+// (VECTOR_MAKE(T, n))(x, y, ...), of which the "(" has been read.
+Value Compiler::VectorLiteral() {
+  Expect("VECTOR_MAKE");
+  Expect("(");
+  const Scalar scalar = ScalarName();
+  Expect(",");
+  const uint64_t n = Count();
+  Expect(")");
+  Expect(")");
+  if (n < 1 || n > 4) Fail("uses a vector of " + std::to_string(n));
+  const Type *type = types_.Vector(scalar, (int)n);
+  const Value vector = Lvalue(type, Allocate(type));
+  Expect("(");
+  for (uint64_t i = 0; i < n; ++i) {
+    if (i) Expect(",");
+    Store(Lvalue(types_.Get(scalar), vector.constant + i * ScalarSize(scalar)),
+          Convert(Rvalue(Assignment()), scalar));
+  }
+  Expect(")");
+  return vector;
+}
+
+// The arguments are all evaluated before any is passed, as the parameters of
+// a function are its own and a call in an argument may be to the same one.
+Value Compiler::Call(Function *function) {
+  Expect("(");
+  std::vector<Value> args;
+  for (size_t i = 0; i < function->params.size(); ++i) {
+    if (i) Expect(",");
+    const Type *type = function->params[i].type;
+    const Value arg = Assignment();
+    args.push_back(type->kind == Type::kRecord ? arg
+                   : ConvertTo(Rvalue(arg), type));
+  }
+  Expect(")");
+  for (size_t i = 0; i < args.size(); ++i) {
+    const Variable& param = function->params[i];
+    if (param.type->kind == Type::kRecord)
+      Copy(Lvalue(param.type, param.address), args[i]);
+    else
+      Store(Lvalue(param.type, param.address), args[i]);
+  }
+  int64_t index = 0;
+  while (functions_[index].get() != function) ++index;
+  Emit(kCall, kInt, kNoReg, kNoReg, kNoReg, index);
+  const Type *ret = function->ret;
+  if (ret->kind == Type::kRecord) {
+    const Value result = Lvalue(ret, Allocate(ret));
+    Copy(result, Lvalue(ret, function->ret_area));
+    return result;
+  }
+  if (!ret->IsValue()) return Void();
+  const int result = NewTemp();
+  Emit(kMove, kLong, result, function->ret_reg, kNoReg);
+  return Reg(ret, result);
+}
+
+Value Compiler::Id(LaneReg first) {
+  Expect("(");
+  const Value index = Rvalue(Assignment());
+  Expect(")");
+  if (index.kind != Value::kConst) Fail("uses a work-item id of a variable");
+  if (index.constant > 2) return Const(types_.Get(kInt), 0);
+  return Reg(types_.Get(kInt), -(int)(first + index.constant) - 1);
+}
+
+// The functions and macros of CUDA.h that generated kernels use.
+Value Compiler::Builtin(const std::string& name) {
+  const Type *int_type = types_.Get(kInt);
+  if (name == "get_global_id") return Id(kGlobalId0);
+  if (name == "get_local_id") return Id(kLocalId0);
+  if (name == "get_group_id" || name == "get_block_id") return Id(kGroupId0);
+  if (name == "get_linear_global_id" || name == "get_linear_local_id" ||
+      name == "get_linear_group_id") {
+    Expect("(");
+    Expect(")");
+    const LaneReg reg = name == "get_linear_global_id" ? kLinearGlobalId
+        : name == "get_linear_local_id" ? kLinearLocalId : kLinearGroupId;
+    return Reg(int_type, -(int)reg - 1);
+  }
+  if (name == "get_global_size" || name == "get_local_size" ||
+      name == "get_num_groups") {
+    Expect("(");
+    const Value index = Rvalue(Assignment());
+    Expect(")");
+    if (index.kind != Value::kConst) Fail("uses a size of a variable");
+    if (index.constant > 2) return Const(int_type, 0);
+    const uint64_t d = index.constant;
+    const uint64_t size = name == "get_global_size" ? program_->global[d]
+        : name == "get_local_size" ? program_->local[d]
+        : program_->global[d] / program_->local[d];
+    return Const(int_type, Normalize(kInt, size));
+  }
+  if (name == "__syncthreads") {
+    Expect("(");
+    Expect(")");
+    Emit(kBarrier, kInt, kNoReg, kNoReg, kNoReg);
+    return Void();
+  }
+  if (name.compare(0, 8, "myAtomic") == 0) {
+    for (size_t op = 0; op < sizeof(kAtomicNames) / sizeof(kAtomicNames[0]);
+         ++op)
+      if (name.compare(8, std::string::npos, kAtomicNames[op]) == 0)
+        return Atomic((AtomicOp)op);
+  }
+  if (name == "FAKE_DIVERGE") {
+    Expect("(");
+    const Value x = Rvalue(Assignment());
+    Expect(",");
+    const Value y = Rvalue(Assignment());
+    Expect(",");
+    ++dead_;
+    Assignment();
+    --dead_;
+    Expect(")");
+    return Arith(kSub, x, y);
+  }
+  if (name == "GROUP_DIVERGE") {
+    Expect("(");
+    const Value index = Rvalue(Assignment());
+    Expect(",");
+    ++dead_;
+    Assignment();
+    --dead_;
+    Expect(")");
+    if (index.kind != Value::kConst) Fail("uses a block id of a variable");
+    if (index.constant > 2) return Const(int_type, 0);
+    return Reg(int_type, -(int)(kGroupId0 + index.constant) - 1);
+  }
+  if (name == "transparent_crc") {
+    Expect("(");
+    const Value value = Rvalue(Assignment());
+    Expect(",");
+    if (Peek().kind != Token::kString) Fail("expected a string");
+    ++pos_;
+    Expect(",");
+    ++dead_;
+    Assignment();
+    --dead_;
+    Expect(")");
+    const Variable *crc = Lookup("crc64_context");
+    if (!crc || !crc->type->IsValue()) Fail("has no crc64_context");
+    const Value context = Lvalue(crc->type, crc->address);
+    Store(context, ConvertTo(Arith(kAdd, Rvalue(context),
+                                   Convert(value, kLong)), crc->type));
+    return Void();
+  }
+  std::map<std::string, int>::const_iterator safe = safe_ops_.find(name);
+  if (safe != safe_ops_.end()) {
+    const SafeOp& op = kSafeOps[safe->second];
+    Expect("(");
+    const Value a = Rvalue(Assignment());
+    Value b = a;
+    if (op.args == 2) {
+      Expect(",");
+      b = Rvalue(Assignment());
+    }
+    Expect(")");
+    ScalarOfType(a.type);
+    ScalarOfType(b.type);
+    const Type *type = types_.Get(op.result);
+    uint64_t result;
+    if (a.kind == Value::kConst && b.kind == Value::kConst &&
+        op.fn(a.constant, b.constant, &result))
+      return Const(type, result);
+    const int dst = NewTemp();
+    Emit(kSafe, op.result, dst, RegOf(a), RegOf(b), safe->second);
+    return Reg(type, dst);
+  }
+  Fail("uses " + name);
+  return Void();
+}
+
+// myAtomicInc(p), myAtomicAdd(p, v) and so on, which CUDA.h defines for
+// pointers to int and unsigned int and which return the old value of *p.
+Value Compiler::Atomic(AtomicOp op) {
+  Expect("(");
+  const Value pointer = Rvalue(Assignment());
+  Value value = Const(types_.Get(kInt), 1);
+  if (op != kAtomicInc && op != kAtomicDec) {
+    Expect(",");
+    value = Rvalue(Assignment());
+  }
+  Expect(")");
+  const Type *type = pointer.type->kind == Type::kPointer
+      ? pointer.type->base : NULL;
+  if (!type || type->kind != Type::kScalar ||
+      (type->scalar != kInt && type->scalar != kUInt))
+    Fail(std::string("uses myAtomic") + kAtomicNames[op] +
+         " on other than an int");
+  const int dst = NewTemp();
+  Emit(kAtomic, type->scalar, dst, RegOf(pointer),
+       RegOf(ConvertTo(value, type)), 0, op);
+  return Reg(type, dst);
+}
+
+// Values.
+
+Value Compiler::Const(const Type *type, uint64_t constant) const {
+  Value value;
+  value.kind = Value::kConst;
+  value.type = type;
+  value.constant = type->kind == Type::kScalar
+      ? Normalize(type->scalar, constant) : constant;
+  value.reg = kNoReg;
+  value.offset = 0;
+  return value;
+}
+
+Value Compiler::Reg(const Type *type, int reg) const {
+  Value value;
+  value.kind = Value::kReg;
+  value.type = type;
+  value.constant = 0;
+  value.reg = reg;
+  value.offset = 0;
+  return value;
+}
+
+Value Compiler::Lvalue(const Type *type, uint64_t address) const {
+  Value value;
+  value.kind = Value::kLvalue;
+  value.type = type;
+  value.constant = address;
+  value.reg = kNoReg;
+  value.offset = 0;
+  return value;
+}
+
+Scalar Compiler::ScalarOfType(const Type *type) const {
+  if (type->kind == Type::kScalar) return type->scalar;
+  if (type->kind == Type::kPointer) return kULong;
+  Fail(type->kind == Type::kVoid ? "uses a void value"
+       : "uses an aggregate as a scalar");
+  return kInt;
+}
+
+int Compiler::RegOf(const Value& value) {
+  if (value.kind == Value::kConst) return ConstReg(value.constant);
+  if (value.kind == Value::kReg) return value.reg;
+  Fail("uses an aggregate as a scalar");
+  return kNoReg;
+}
+
+int Compiler::BaseReg(const Value& lvalue) {
+  return lvalue.reg != kNoReg ? lvalue.reg : ConstReg(lvalue.constant);
+}
+
+Value Compiler::Rvalue(const Value& value) {
+  if (value.kind != Value::kLvalue) return value;
+  if (value.type->kind == Type::kArray)
+    return AddressOf(value, types_.PointerTo(value.type->base));
+  if (value.type->kind == Type::kRecord) return value;
+  const int dst = NewTemp();
+  Emit(kLoad, ScalarOfType(value.type), dst, BaseReg(value), kNoReg,
+       value.offset);
+  return Reg(value.type, dst);
+}
+
+Value Compiler::AddressOf(const Value& lvalue, const Type *type) {
+  if (lvalue.reg == kNoReg) return Const(type, lvalue.constant + lvalue.offset);
+  if (lvalue.offset == 0) return Reg(type, lvalue.reg);
+  const int dst = NewTemp();
+  Emit(kBinary, kULong, dst, lvalue.reg, ConstReg(lvalue.offset), 0, kAdd);
+  return Reg(type, dst);
+}
+
+Value Compiler::Deref(const Value& pointer) {
+  if (pointer.type->kind != Type::kPointer) Fail("dereferences a non-pointer");
+  const Type *type = pointer.type->base;
+  if (type->kind == Type::kVoid ||
+      (type->kind == Type::kRecord && !type->record->complete))
+    Fail("dereferences a pointer to an incomplete type");
+  Value value = Lvalue(type, pointer.constant);
+  if (pointer.kind == Value::kReg) value.reg = pointer.reg;
+  return value;
+}
+
+Value Compiler::Member(const Value& record, const std::string& name) {
+  if (record.kind != Value::kLvalue || record.type->kind != Type::kRecord)
+    Fail("takes ." + name + " of a non-record");
+  const Field *field = record.type->record->Find(name);
+  if (!field) Fail("takes ." + name + ", which is not a field");
+  Value value = record;
+  value.type = field->type;
+  value.offset += field->offset;
+  return value;
+}
+
+Value Compiler::Index(const Value& pointer, const Value& index) {
+  if (pointer.type->kind != Type::kPointer) Fail("indexes a non-pointer");
+  const Value element = Deref(pointer);
+  const uint64_t size = element.type->Size();
+  const Value i = Convert(index, kLong);
+  if (i.kind == Value::kConst) {
+    Value value = element;
+    value.offset += (int64_t)(i.constant * size);
+    return value;
+  }
+  const int scaled = NewTemp();
+  Emit(kBinary, kLong, scaled, i.reg, ConstReg(size), 0, kMul);
+  const int address = NewTemp();
+  Emit(kBinary, kLong, address, RegOf(pointer), scaled, 0, kAdd);
+  Value value = Lvalue(element.type, 0);
+  value.reg = address;
+  return value;
+}
+
+Value Compiler::Convert(const Value& value, Scalar scalar) {
+  const Scalar from = ScalarOfType(value.type);
+  const Type *type = types_.Get(scalar);
+  if (value.kind == Value::kConst) return Const(type, value.constant);
+  Value result = value;
+  result.type = type;
+  if (!ConversionChangesBits(from, scalar)) return result;
+  const int dst = NewTemp();
+  Emit(kConvert, scalar, dst, value.reg, kNoReg);
+  return Reg(type, dst);
+}
+
+// Converts a scalar or pointer to the type of something it is stored in.
+Value Compiler::ConvertTo(const Value& value, const Type *type) {
+  if (type->kind == Type::kScalar) return Convert(value, type->scalar);
+  if (type->kind != Type::kPointer) Fail("converts to an aggregate");
+  ScalarOfType(value.type);
+  Value result = value;
+  result.type = type;
+  return result;
+}
+
+Value Compiler::Arith(BinaryOp op, Value a, Value b) {
+  const Scalar sa = ScalarOfType(a.type), sb = ScalarOfType(b.type);
+  if (!IsComparison(op) &&
+      (a.type->kind == Type::kPointer || b.type->kind == Type::kPointer))
+    Fail("uses pointer arithmetic");
+  Scalar scalar, result;
+  if (op == kShl || op == kShr) {
+    scalar = result = Promote(sa);
+    b = Convert(b, Promote(sb));
+  } else {
+    scalar = CommonType(sa, sb);
+    result = IsComparison(op) ? kInt : scalar;
+    b = Convert(b, scalar);
+  }
+  a = Convert(a, scalar);
+  uint64_t folded;
+  if (a.kind == Value::kConst && b.kind == Value::kConst &&
+      EvalBinary(op, scalar, a.constant, b.constant, &folded))
+    return Const(types_.Get(result), folded);
+  const int dst = NewTemp();
+  Emit(kBinary, scalar, dst, RegOf(a), RegOf(b), 0, op);
+  return Reg(types_.Get(result), dst);
+}
+
+Value Compiler::Negate(Value value, UnaryOp op) {
+  if (value.type->kind != Type::kScalar) Fail("negates a non-integer");
+  const Scalar scalar = Promote(value.type->scalar);
+  value = Convert(value, scalar);
+  if (value.kind == Value::kConst)
+    return Const(value.type,
+                 op == kNeg ? 0 - value.constant : ~value.constant);
+  const int dst = NewTemp();
+  Emit(kUnary, scalar, dst, value.reg, kNoReg, 0, op);
+  return Reg(value.type, dst);
+}
+
+// 0 or 1, as an int.
+Value Compiler::Truth(const Value& value) {
+  return Arith(kNe, value, Const(types_.Get(kInt), 0));
+}
+
+Value Compiler::Assign(const Value& lhs, const Value& rhs) {
+  if (lhs.kind != Value::kLvalue) Fail("assigns to a value");
+  if (lhs.type->kind == Type::kRecord) {
+    Copy(lhs, rhs);
+    return lhs;
+  }
+  const Value value = ConvertTo(Rvalue(rhs), lhs.type);
+  Store(lhs, value);
+  return value;
+}
+
+Value Compiler::CompoundAssign(BinaryOp op, const Value& lhs,
+    const Value& rhs) {
+  if (lhs.kind != Value::kLvalue || !lhs.type->IsValue())
+    Fail("assigns to a value");
+  const Value right = Rvalue(rhs);
+  const Value value =
+      ConvertTo(Arith(op, Rvalue(lhs), right), lhs.type);
+  Store(lhs, value);
+  return value;
+}
+
+Value Compiler::Step(const Value& lvalue, bool increment, bool prefix) {
+  if (lvalue.kind != Value::kLvalue || lvalue.type->kind != Type::kScalar)
+    Fail("increments a non-integer");
+  const Value old = Rvalue(lvalue);
+  const Value value = Convert(
+      Arith(increment ? kAdd : kSub, old, Const(types_.Get(kInt), 1)),
+      lvalue.type->scalar);
+  Store(lvalue, value);
+  return prefix ? value : old;
+}
+
+void Compiler::Store(const Value& lvalue, const Value& value) {
+  Emit(kStore, ScalarOfType(lvalue.type), kNoReg, BaseReg(lvalue),
+       RegOf(value), lvalue.offset);
+}
+
+void Compiler::Copy(const Value& dst, const Value& src) {
+  if (src.kind != Value::kLvalue || src.type != dst.type)
+    Fail("assigns a record of another type");
+  const Type *type = types_.PointerTo(dst.type);
+  Emit(kCopy, kInt, kNoReg, RegOf(AddressOf(dst, type)),
+       RegOf(AddressOf(src, type)), dst.type->Size());
+}
+
+int64_t Compiler::Emit(Opcode op, Scalar type, int dst, int a, int b,
+    int64_t imm, int sub) {
+  if (dead_) return -1;
+  Instr instr;
+  instr.op = op;
+  instr.type = type;
+  instr.sub = sub;
+  instr.merge = false;
+  instr.dst = dst;
+  instr.a = a;
+  instr.b = b;
+  instr.imm = imm;
+  instr.line = pos_ > 0 ? tokens_[pos_ - 1].line : 1;
+  program_->code.push_back(instr);
+  return program_->code.size() - 1;
+}
+
+// Machine.
+
+// Instructions a batch may run before the kernel is taken not to terminate.
+const uint64_t kMaxSteps = (uint64_t)1 << 28;
+
+// Runs batches of threads of a program. Registers and memory are arrays over
+// the threads of the batch, so that an instruction runs over all the threads
+// at it in one loop; memory is interleaved by 8 byte words, with word w of
+// lane l at mem_[w * kLanes + l]. The memory threads share is not: a batch
+// holds the __shared__ variables of each of its blocks in turn, and the
+// buffers shared by the grid are kept from one batch to the next.
+//
+// Most values of a generated kernel are the same in every thread, so
+// registers and words of memory are marked uniform when they are: only lane
+// 0 then holds the value, and an instruction over uniform operands that all
+// the threads run is done once. A register that an instruction leaves equal
+// in every lane becomes uniform again.
+class Machine {
+ public:
+  explicit Machine(const Program& program)
+      : program_(program),
+        regs_((size_t)(program.temps + program.fixed.size()) * kLanes),
+        uniform_regs_(program.temps + program.fixed.size(), true),
+        words_((program.memory.size() + 7) / 8),
+        initial_(words_, 0),
+        mem_(words_ * kLanes),
+        uniform_words_(words_),
+        block_threads_(program.local[0] * program.local[1] * program.local[2]),
+        shared_words_((program.shared_size + 7) / 8),
+        shared_(program.shares_memory
+                    ? kLanes / block_threads_ * shared_words_ : 0),
+        global_((program.global_memory.size() + 7) / 8, 0),
+        ids_(kLanes), block_(kLanes, 0),
+        pc_(kLanes), depth_(kLanes),
+        stack_((size_t)program.max_depth * kLanes) {
+    for (size_t i = kLaneRegs; i < program.fixed.size(); ++i)
+      Reg(program.temps + (int)i)[0] = program.fixed[i];
+    for (size_t i = 0; i < program.memory.size(); ++i)
+      initial_[i / 8] |= (uint64_t)program.memory[i] << (8 * (i % 8));
+    for (size_t i = 0; i < program.global_memory.size(); ++i)
+      global_[i / 8] |= (uint64_t)program.global_memory[i] << (8 * (i % 8));
+    for (size_t i = 0; i < program.images.size(); ++i) {
+      const std::vector<uint8_t>& image = program.images[i];
+      images_.push_back(std::vector<uint64_t>((image.size() + 7) / 8, 0));
+      for (size_t b = 0; b < image.size(); ++b)
+        images_.back()[b / 8] |= (uint64_t)image[b] << (8 * (b % 8));
+    }
+  }
+
+  // Runs the threads [first, first + count) and stores their results. If
+  // they share memory, threads are numbered block by block, and count is a
+  // multiple of the size of a block.
+  bool Run(uint64_t first, int count, std::vector<int64_t> *results,
+      std::string *error);
+
+ private:
+  // An operand of an instruction, which reads the same in every lane if it
+  // is uniform.
+  class Operand {
+   public:
+    Operand(const uint64_t *values, bool uniform)
+        : values_(values), uniform_(uniform),
+          first_(values ? values[0] : 0) {}
+    uint64_t operator[](int lane) const {
+      return uniform_ ? first_ : values_[lane];
+    }
+    bool uniform() const { return uniform_; }
+   private:
+    const uint64_t *values_;
+    bool uniform_;
+    uint64_t first_;
+  };
+
+  uint64_t *Reg(int reg) { return &regs_[(size_t)reg * kLanes]; }
+  Operand Read(int reg) {
+    if (reg == kNoReg) return Operand(NULL, true);
+    return Operand(Reg(reg), uniform_regs_[reg] != 0);
+  }
+  // The register an instruction writes, given every lane its own value if
+  // only some lanes run.
+  uint64_t *Write(int reg) {
+    uint64_t *values = Reg(reg);
+    if (!all_ && uniform_regs_[reg])
+      std::fill(values + 1, values + kLanes, values[0]);
+    uniform_regs_[reg] = false;
+    return values;
+  }
+  void CheckUniform(int reg) {
+    const uint64_t *values = Reg(reg);
+    for (int l = 1; l < kLanes; ++l)
+      if (values[l] != values[0]) return;
+    uniform_regs_[reg] = true;
+  }
+
+  // The word of shared memory at address, for a lane: that of the lane's
+  // block below kGlobalBase, that of every thread from it on.
+  uint64_t& SharedWord(uint64_t address, int lane) {
+    if (address >= kGlobalBase) return global_[(address - kGlobalBase) >> 3];
+    return shared_[block_[lane] * shared_words_ +
+                   ((address - kSharedBase) >> 3)];
+  }
+  uint64_t ReadWord(uint64_t address, int lane) {
+    if (address >= kSharedBase) return SharedWord(address, lane);
+    const size_t word = address >> 3;
+    return mem_[word * kLanes + (uniform_words_[word] ? 0 : lane)];
+  }
+  uint64_t& LaneWord(uint64_t address, int lane) {
+    if (address >= kSharedBase) return SharedWord(address, lane);
+    const size_t word = address >> 3;
+    uint64_t *values = &mem_[word * kLanes];
+    if (uniform_words_[word]) {
+      std::fill(values + 1, values + kLanes, values[0]);
+      uniform_words_[word] = false;
+    }
+    return values[lane];
+  }
+  uint8_t ReadByte(uint64_t address, int lane) {
+    return (uint8_t)(ReadWord(address, lane) >> (8 * (address & 7)));
+  }
+  static void Insert(uint64_t *word, uint64_t value, uint64_t mask, int shift) {
+    *word = (*word & ~(mask << shift)) | ((value & mask) << shift);
+  }
+  // Writes the same value to part of a word of private memory in every lane.
+  void WriteAll(uint64_t address, uint64_t value, uint64_t mask) {
+    const size_t word = address >> 3;
+    const int shift = 8 * (address & 7);
+    uint64_t *values = &mem_[word * kLanes];
+    if (uniform_words_[word] || mask == ~(uint64_t)0) {
+      Insert(values, value, mask, shift);
+      uniform_words_[word] = true;
+    } else {
+      for (int l = 0; l < kLanes; ++l) Insert(values + l, value, mask, shift);
+    }
+  }
+  static bool Private(uint64_t address) { return address < kSharedBase; }
+  bool Valid(uint64_t address, uint64_t size) const {
+    if (address >= kGlobalBase)
+      return Within(address - kGlobalBase, size, global_.size() * 8);
+    if (address >= kSharedBase)
+      return Within(address - kSharedBase, size, shared_words_ * 8);
+    return address >= kFirstAddress && address <= words_ * 8 - size;
+  }
+  static bool Within(uint64_t offset, uint64_t size, uint64_t limit) {
+    return offset <= limit && size <= limit - offset;
+  }
+
+  template <typename F> void ForLanes(const F& f) {
+    if (all_) {
+      for (int l = 0; l < kLanes; ++l) f(l);
+    } else {
+      for (size_t i = 0; i < active_.size(); ++i) f(active_[i]);
+    }
+  }
+
+  bool Before(int a, int b) const;
+  bool Barrier();
+  bool Execute(const Instr& instr, int64_t *pc);
+  template <typename F> bool Compute(const Instr& instr, const F& f);
+  bool Copy(const Operand& to, const Operand& from, uint64_t size);
+  bool Init(const Operand& to, int image);
+
+  const Program& program_;
+  std::vector<uint64_t> regs_;
+  std::vector<char> uniform_regs_;
+  size_t words_;
+  // The memory every thread starts with.
+  std::vector<uint64_t> initial_;
+  std::vector<uint64_t> mem_;
+  std::vector<char> uniform_words_;
+  std::vector<std::vector<uint64_t> > images_;
+  const uint64_t block_threads_;
+  const size_t shared_words_;
+  // The __shared__ variables of each block of the batch, one after the
+  // other, and the buffers shared by all threads.
+  std::vector<uint64_t> shared_;
+  std::vector<uint64_t> global_;
+  // The linear global id of each lane, and the block of the batch it is in.
+  std::vector<uint64_t> ids_;
+  std::vector<int> block_;
+  // The lanes [count_, kLanes) copy lane count_ - 1.
+  int count_;
+  std::vector<int64_t> pc_;
+  std::vector<int> depth_;
+  // The return addresses of each lane, by call depth.
+  std::vector<int64_t> stack_;
+  // Calls made while all the lanes run, above those in stack_.
+  std::vector<int64_t> calls_;
+  // The lanes being run, all of them if all_.
+  std::vector<int> active_;
+  bool all_;
+};
+
+// Whether lane a should run before lane b: by the return addresses from the
+// outermost call in, then by pc, with a lane in a call before one that has
+// returned from it. Threads that diverge so meet again at the first point
+// they both reach.
+bool Machine::Before(int a, int b) const {
+  const int depth = std::min(depth_[a], depth_[b]);
+  for (int d = 0; d < depth; ++d) {
+    const int64_t ra = stack_[(size_t)d * kLanes + a];
+    const int64_t rb = stack_[(size_t)d * kLanes + b];
+    if (ra != rb) return ra < rb;
+  }
+  const int64_t pa = depth_[a] > depth ? stack_[(size_t)depth * kLanes + a]
+                                       : pc_[a];
+  const int64_t pb = depth_[b] > depth ? stack_[(size_t)depth * kLanes + b]
+                                       : pc_[b];
+  if (pa != pb) return pa < pb;
+  return depth_[a] > depth_[b];
+}
+
+// Threads past the end of the grid run as copies of the last one, so that a
+// batch is always full. A copy does what the thread it copies does, and gets
+// the same results from atomic operations, so that it leaves shared memory as
+// the thread alone would.
+bool Machine::Run(uint64_t first, int count, std::vector<int64_t> *results,
+    std::string *error) {
+  const Program& p = program_;
+  const uint64_t gx = p.global[0], gy = p.global[1];
+  const uint64_t groups[3] = {
+    gx / p.local[0], gy / p.local[1], p.global[2] / p.local[2]
+  };
+  for (size_t w = 0; w < words_; ++w) mem_[w * kLanes] = initial_[w];
+  std::fill(uniform_words_.begin(), uniform_words_.end(), true);
+  std::fill(shared_.begin(), shared_.end(), 0);
+  count_ = count;
+  all_ = true;
+  for (int l = 0; l < kLanes; ++l) {
+    const uint64_t index = first + std::min(l, count - 1);
+    uint64_t global[3], local[3], group[3];
+    if (p.shares_memory) {
+      uint64_t block = index / block_threads_, thread = index % block_threads_;
+      for (int d = 0; d < 3; ++d) {
+        local[d] = thread % p.local[d];
+        thread /= p.local[d];
+        group[d] = block % groups[d];
+        block /= groups[d];
+        global[d] = group[d] * p.local[d] + local[d];
+      }
+      block_[l] = std::min(l, count - 1) / block_threads_;
+    } else {
+      global[0] = index % gx;
+      global[1] = index / gx % gy;
+      global[2] = index / (gx * gy);
+      for (int d = 0; d < 3; ++d) {
+        local[d] = global[d] % p.local[d];
+        group[d] = global[d] / p.local[d];
+      }
+    }
+    for (int d = 0; d < 3; ++d) {
+      Reg(p.temps + kGlobalId0 + d)[l] = Normalize(kInt, global[d]);
+      Reg(p.temps + kLocalId0 + d)[l] = Normalize(kInt, local[d]);
+      Reg(p.temps + kGroupId0 + d)[l] = Normalize(kInt, group[d]);
+    }
+    const uint64_t id = (global[2] * gy + global[1]) * gx + global[0];
+    ids_[l] = id;
+    Reg(p.temps + kLinearGlobalId)[l] = Normalize(kInt, id);
+    Reg(p.temps + kLinearLocalId)[l] = Normalize(kInt,
+        (local[2] * p.local[1] + local[1]) * p.local[0] + local[0]);
+    Reg(p.temps + kLinearGroupId)[l] = Normalize(kInt,
+        (group[2] * groups[1] + group[1]) * groups[0] + group[0]);
+    // result[get_linear_global_id()] is the thread's result slot.
+    LaneWord(p.result_param, l) = p.result_slot - 8 * Normalize(kInt, id);
+    pc_[l] = p.entry;
+    depth_[l] = 0;
+  }
+  for (int r = 0; r < kLaneRegs; ++r) {
+    uniform_regs_[p.temps + r] = false;
+    CheckUniform(p.temps + r);
+  }
+
+  uint64_t steps = 0;
+  for (;;) {
+    int best = -1;
+    for (int l = 0; l < kLanes; ++l)
+      if (pc_[l] >= 0 && (best < 0 || Before(l, best))) best = l;
+    if (best < 0) break;
+    active_.clear();
+    for (int l = 0; l < kLanes; ++l)
+      if (pc_[l] == pc_[best] && depth_[l] == depth_[best]) active_.push_back(l);
+    all_ = active_.size() == (size_t)kLanes;
+
+    // Run up to where other threads may join, or on while all run.
+    int64_t pc = pc_[best];
+    for (;;) {
+      const Instr& instr = p.code[pc];
+      if (++steps > kMaxSteps) {
+        *error = "runs for too long";
+        return false;
+      }
+      if (!Execute(instr, &pc)) {
+        *error = (instr.op == kBarrier ? "diverges at the barrier at line "
+                                       : "faults at line ") +
+            std::to_string(instr.line);
+        return false;
+      }
+      if (pc < 0) break;
+      if (!all_ && p.code[pc].merge) {
+        ForLanes([&](int l) { pc_[l] = pc; });
+        break;
+      }
+    }
+    for (size_t i = 0; i < calls_.size(); ++i)
+      for (int l = 0; l < kLanes; ++l)
+        stack_[(size_t)depth_[l]++ * kLanes + l] = calls_[i];
+    calls_.clear();
+  }
+
+  for (int l = 0; l < count; ++l)
+    (*results)[ids_[l]] = (int64_t)ReadWord(p.result_slot, l);
+  return true;
+}
+
+// The threads of a block that share memory run in one batch, and the threads
+// behind the others run first, so all of them reach a barrier together unless
+// it is in code that only some of them run. Returns false then, as the kernel
+// is undefined.
+bool Machine::Barrier() {
+  if (all_ || !program_.shares_memory) return true;
+  std::vector<int> waiting(kLanes / block_threads_, 0);
+  for (int l = 0; l < kLanes; ++l)
+    if (pc_[l] >= 0) ++waiting[block_[l]];
+  ForLanes([&](int l) { --waiting[block_[l]]; });
+  bool ok = true;
+  ForLanes([&](int l) { ok = ok && waiting[block_[l]] == 0; });
+  return ok;
+}
+
+// Computes dst from a and b with f, which returns false if it traps.
+template <typename F>
+bool Machine::Compute(const Instr& instr, const F& f) {
+  const Operand a = Read(instr.a), b = Read(instr.b);
+  if (all_ && a.uniform() && b.uniform()) {
+    uniform_regs_[instr.dst] = true;
+    return f(a[0], b[0], &Reg(instr.dst)[0]);
+  }
+  uint64_t *dst = Write(instr.dst);
+  bool ok = true;
+  ForLanes([&](int l) {
+    if (!f(a[l], b[l], &dst[l])) ok = false;
+  });
+  CheckUniform(instr.dst);
+  return ok;
+}
+
+bool Machine::Copy(const Operand& to, const Operand& from, uint64_t size) {
+  bool ok = true;
+  if (all_ && to.uniform() && from.uniform() && Private(to[0]) &&
+      Private(from[0])) {
+    if (!Valid(to[0], size) || !Valid(from[0], size)) return false;
+    for (uint64_t i = 0; i < size;) {
+      const uint64_t t = to[0] + i, f = from[0] + i;
+      const uint64_t n = ((t | f) & 7) == 0 && i + 8 <= size ? 8 : 1;
+      const uint64_t mask = n == 8 ? ~(uint64_t)0 : 0xFF;
+      if (uniform_words_[f >> 3]) {
+        WriteAll(t, ReadWord(f, 0) >> (8 * (f & 7)), mask);
+      } else {
+        for (int l = 0; l < kLanes; ++l)
+          Insert(&LaneWord(t, l), ReadWord(f, l) >> (8 * (f & 7)), mask,
+                 8 * (t & 7));
+      }
+      i += n;
+    }
+    return true;
+  }
+  ForLanes([&](int l) {
+    const uint64_t t = to[l], f = from[l];
+    if (!Valid(t, size) || !Valid(f, size)) {
+      ok = false;
+      return;
+    }
+    if (((t | f | size) & 7) == 0) {
+      for (uint64_t i = 0; i < size; i += 8)
+        LaneWord(t + i, l) = ReadWord(f + i, l);
+    } else {
+      for (uint64_t i = 0; i < size; ++i)
+        Insert(&LaneWord(t + i, l), ReadByte(f + i, l), 0xFF,
+               8 * ((t + i) & 7));
+    }
+  });
+  return ok;
+}
+
+bool Machine::Init(const Operand& to, int image) {
+  const std::vector<uint8_t>& bytes = program_.images[image];
+  const std::vector<uint64_t>& words = images_[image];
+  const uint64_t size = bytes.size();
+  bool ok = true;
+  if (all_ && to.uniform() && Private(to[0])) {
+    if (!Valid(to[0], size)) return false;
+    uint64_t i = 0;
+    if ((to[0] & 7) == 0)
+      for (; i + 8 <= size; i += 8)
+        WriteAll(to[0] + i, words[i / 8], ~(uint64_t)0);
+    for (; i < size; ++i) WriteAll(to[0] + i, bytes[i], 0xFF);
+    return true;
+  }
+  ForLanes([&](int l) {
+    const uint64_t t = to[l];
+    if (!Valid(t, size)) {
+      ok = false;
+      return;
+    }
+    uint64_t i = 0;
+    if ((t & 7) == 0)
+      for (; i + 8 <= size; i += 8) LaneWord(t + i, l) = words[i / 8];
+    for (; i < size; ++i)
+      Insert(&LaneWord(t + i, l), bytes[i], 0xFF, 8 * ((t + i) & 7));
+  });
+  return ok;
+}
+
+// Runs an instruction over the active lanes. *pc becomes the next
+// instruction, or -1 if the lanes have gone their own ways. Returns false if
+// a lane faults.
+bool Machine::Execute(const Instr& instr, int64_t *pc) {
+  const Scalar type = instr.type;
+  const int64_t next = *pc + 1;
+  *pc = next;
+  switch (instr.op) {
+    case kMove:
+      return Compute(instr, [](uint64_t a, uint64_t, uint64_t *out) {
+        *out = a;
+        return true;
+      });
+    case kConvert:
+      return Compute(instr, [type](uint64_t a, uint64_t, uint64_t *out) {
+        *out = Normalize(type, a);
+        return true;
+      });
+    case kBinary: {
+      const BinaryOp op = (BinaryOp)instr.sub;
+      return Compute(instr, [op, type](uint64_t a, uint64_t b, uint64_t *out) {
+        return EvalBinary(op, type, a, b, out);
+      });
+    }
+    case kUnary:
+      if (instr.sub == kNeg)
+        return Compute(instr, [type](uint64_t a, uint64_t, uint64_t *out) {
+          *out = Normalize(type, 0 - a);
+          return true;
+        });
+      return Compute(instr, [type](uint64_t a, uint64_t, uint64_t *out) {
+        *out = Normalize(type, ~a);
+        return true;
+      });
+    case kSafe:
+      return Compute(instr, kSafeOps[instr.imm].fn);
+    case kLoad: {
+      const uint64_t size = ScalarSize(type);
+      const Operand base = Read(instr.a);
+      const int64_t offset = instr.imm;
+      if (all_ && base.uniform() && Private(base[0] + offset)) {
+        const uint64_t address = base[0] + offset;
+        if (!Valid(address, size) || address % size) return false;
+        if (uniform_words_[address >> 3]) {
+          uniform_regs_[instr.dst] = true;
+          Reg(instr.dst)[0] =
+              Normalize(type, ReadWord(address, 0) >> (8 * (address & 7)));
+          return true;
+        }
+      }
+      uint64_t *dst = Write(instr.dst);
+      bool ok = true;
+      ForLanes([&](int l) {
+        const uint64_t address = base[l] + offset;
+        if (!Valid(address, size) || address % size) {
+          ok = false;
+          return;
+        }
+        dst[l] = Normalize(type, ReadWord(address, l) >> (8 * (address & 7)));
+      });
+      CheckUniform(instr.dst);
+      return ok;
+    }
+    case kStore: {
+      const uint64_t size = ScalarSize(type);
+      const uint64_t mask =
+          size == 8 ? ~(uint64_t)0 : ((uint64_t)1 << (8 * size)) - 1;
+      const Operand base = Read(instr.a), value = Read(instr.b);
+      const int64_t offset = instr.imm;
+      if (all_ && base.uniform() && value.uniform() &&
+          Private(base[0] + offset)) {
+        const uint64_t address = base[0] + offset;
+        if (!Valid(address, size) || address % size) return false;
+        WriteAll(address, value[0], mask);
+        return true;
+      }
+      bool ok = true;
+      ForLanes([&](int l) {
+        const uint64_t address = base[l] + offset;
+        if (!Valid(address, size) || address % size) {
+          ok = false;
+          return;
+        }
+        Insert(&LaneWord(address, l), value[l], mask, 8 * (address & 7));
+      });
+      return ok;
+    }
+    case kCopy:
+      return Copy(Read(instr.a), Read(instr.b), instr.imm);
+    case kInit:
+      return Init(Read(instr.a), (int)instr.imm);
+    case kJump:
+      *pc = instr.imm;
+      return true;
+    case kBranch: {
+      const Operand condition = Read(instr.a);
+      const bool if_true = instr.sub != 0;
+      if (condition.uniform()) {
+        *pc = ((condition[0] != 0) == if_true) ? instr.imm : next;
+        return true;
+      }
+      int taken = 0;
+      ForLanes([&](int l) {
+        pc_[l] = ((condition[l] != 0) == if_true) ? instr.imm : next;
+        taken += pc_[l] == instr.imm;
+      });
+      if (taken == 0 || taken == (int)(all_ ? kLanes : active_.size()))
+        *pc = taken ? instr.imm : next;
+      else
+        *pc = -1;
+      return true;
+    }
+    case kCall: {
+      if (all_) {
+        if (depth_[0] + (int)calls_.size() == program_.max_depth) return false;
+        calls_.push_back(next);
+        *pc = instr.imm;
+        return true;
+      }
+      bool ok = true;
+      ForLanes([&](int l) {
+        if (depth_[l] == program_.max_depth) {
+          ok = false;
+          return;
+        }
+        stack_[(size_t)depth_[l]++ * kLanes + l] = next;
+      });
+      *pc = instr.imm;
+      return ok;
+    }
+    case kReturn: {
+      if (!calls_.empty()) {
+        *pc = calls_.back();
+        calls_.pop_back();
+        return true;
+      }
+      int64_t target = -2;
+      ForLanes([&](int l) {
+        pc_[l] = stack_[(size_t)--depth_[l] * kLanes + l];
+        target = target == -2 || target == pc_[l] ? pc_[l] : -1;
+      });
+      *pc = target;
+      return true;
+    }
+    case kHalt:
+      ForLanes([&](int l) { pc_[l] = -1; });
+      *pc = -1;
+      return true;
+    case kAtomic: {
+      // The lanes take turns, in order.
+      const Operand pointer = Read(instr.a), value = Read(instr.b);
+      uint64_t *dst = Write(instr.dst);
+      bool ok = true;
+      ForLanes([&](int l) {
+        if (l >= count_) {
+          dst[l] = dst[count_ - 1];
+          return;
+        }
+        const uint64_t address = pointer[l];
+        if (!Valid(address, 4) || address % 4) {
+          ok = false;
+          return;
+        }
+        uint64_t& word = LaneWord(address, l);
+        const int shift = 8 * (address & 7);
+        dst[l] = Normalize(type, word >> shift);
+        Insert(&word, ApplyAtomic((AtomicOp)instr.sub, type, dst[l], value[l]),
+               0xFFFFFFFF, shift);
+      });
+      CheckUniform(instr.dst);
+      return ok;
+    }
+    case kBarrier:
+      return Barrier();
+  }
+  return true;
+}
+
+}  // namespace
+
+bool InterpretKernel(const std::string& kernel, std::vector<int64_t> *results,
+    std::string *error) {
+  std::unique_ptr<Program> program(new Program);
+  try {
+    Compiler(kernel, program.get()).Compile();
+  } catch (const CompileError& e) {
+    *error = e.message;
+    return false;
+  }
+  const uint64_t threads =
+      program->global[0] * program->global[1] * program->global[2];
+  results->assign(threads, 0);
+  Machine machine(*program);
+  // Blocks that share memory are not split between batches.
+  const uint64_t block =
+      program->local[0] * program->local[1] * program->local[2];
+  const uint64_t batch =
+      program->shares_memory ? kLanes / block * block : kLanes;
+  for (uint64_t first = 0; first < threads; first += batch) {
+    const int count = (int)std::min<uint64_t>(batch, threads - first);
+    if (!machine.Run(first, count, results, error)) return false;
+  }
+  return true;
+}
+
+void WriteKernelResults(std::ostream& out,
+    const std::vector<int64_t>& results) {
+  char line[32];
+  for (size_t i = 0; i < results.size(); ++i) {
+    snprintf(line, sizeof(line), "%016x\n", (unsigned int)results[i]);
+    out << line;
+  }
+}
+
+}  // namespace CUDASmith
@@ -0,0 +1,49 @@
+// Interpreter for generated kernels, which computes the result every thread
+// leaves in result[] without a CUDA (or any other) compiler in the loop.
+//
+// The interpreter reads the kernel as it is written to the .cu file, after the
+// output time pruning of the generator, so it runs exactly the program a
+// compiler would see. It understands the subset of C that the generator
+// emits, with the types, the safe math macros and the builtins as CUDA.h
+// defines them, and launches the kernel as cuda_launcher does, with the
+// dimensions of the info line on the first line of the kernel.
+//
+// The kernel is compiled once to a register bytecode, with constant
+// subexpressions folded as they are compiled. Threads then run in batches:
+// registers and memory are laid out as arrays over the threads of a batch,
+// and every instruction is applied to all the threads of the batch that are
+// at it, so that threads which do not diverge run together. Values that are
+// the same in every thread of a batch, as most are, are held and computed
+// once.
+//
+// Threads interact through __shared__ memory, the buffers of the grid,
+// atomics and barriers. Blocks that share memory run whole in a batch, and
+// threads that lag behind the others run first, so that a block meets at
+// every __syncthreads() it does not diverge at; atomics apply in thread
+// order. Well-formed kernels, which do not race, give the same results in any
+// order. Kernels that pass messages are not interpreted.
+
+#ifndef _CUDASMITH_KERNELINTERPRETER_H_
+#define _CUDASMITH_KERNELINTERPRETER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace CUDASmith {
+
+// Runs the kernel and stores in *results the value each thread writes to
+// result[], by linear global id. Returns false, with the reason in *error, if
+// the kernel uses something that is not interpreted, or if a thread faults
+// (e.g. divides INT_MIN by -1) or runs for too long.
+bool InterpretKernel(const std::string& kernel, std::vector<int64_t> *results,
+    std::string *error);
+
+// Writes the results as cuda_launcher prints them, one line per thread, so
+// that the output of a run can be compared with them directly.
+void WriteKernelResults(std::ostream& out, const std::vector<int64_t>& results);
+
+}  // namespace CUDASmith
+
+#endif  // _CUDASMITH_KERNELINTERPRETER_H_
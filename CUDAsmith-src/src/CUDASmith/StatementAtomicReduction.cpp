@@ -15,12 +15,12 @@ namespace CUDASmith {
   
 namespace {
 // Variable to store the value of a modified variable.
-Variable* hash_buffer = NULL;
+thread_local Variable* hash_buffer = NULL;
 
 // Variable representing the reduction target (either local or global);
 // if global, must be a buffer, indexing at the current linear group id.
-MemoryBuffer* local_reduction = NULL;
-MemoryBuffer* global_reduction = NULL;
+thread_local MemoryBuffer* local_reduction = NULL;
+thread_local MemoryBuffer* global_reduction = NULL;
 }
   
 StatementAtomicReduction* StatementAtomicReduction::make_random(CGContext &cg_context) {
@@ -68,6 +68,12 @@ void StatementAtomicReduction::RecordBuffer() {
     VariableSelector::GetGlobalVariables()->push_back(buf);
 }
 
+void StatementAtomicReduction::ReleaseBuffers() {
+  hash_buffer = NULL;
+  local_reduction = NULL;
+  global_reduction = NULL;
+}
+
 
 void StatementAtomicReduction::AddVarsToGlobals(Globals* globals) {
   MemoryBuffer* local_red = get_local_rvar();
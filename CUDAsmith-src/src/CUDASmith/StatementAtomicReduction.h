@@ -49,6 +49,9 @@ class StatementAtomicReduction : public CUDAStatement {
   
   static void AddVarsToGlobals(Globals* globals);
   static void RecordBuffer();
+
+  // Forget the reduction buffers so the next program creates its own.
+  static void ReleaseBuffers();
         
   // Pure virtual methods from Statement
   void get_blocks(std::vector<const Block*>& blks) const {};
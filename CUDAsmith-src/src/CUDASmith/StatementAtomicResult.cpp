@@ -16,12 +16,17 @@
 namespace CUDASmith {
   
 namespace {
-static std::map<int, const ExpressionAtomicAccess*>* atomic_blocks = NULL;
+static thread_local std::map<int, const ExpressionAtomicAccess*>* atomic_blocks = NULL;
 }
 
 void StatementAtomicResult::InitResults() {
   atomic_blocks = new std::map<int, const ExpressionAtomicAccess*>();
 }
+
+void StatementAtomicResult::ReleaseResults() {
+  delete atomic_blocks;
+  atomic_blocks = NULL;
+}
   
 void StatementAtomicResult::GenSpecialVals() {
   for (Function* f : get_all_functions()) {
@@ -61,7 +66,7 @@ void StatementAtomicResult::GenSpecialVals() {
                 do {
                   curr_index[index] = accesses[index];
                   index--;
-                } while (curr_index[index] == 0);
+                } while (index >= 0 && curr_index[index] == 0);
                 if (index < 0) break;
                 curr_index[index]--;
                 index = curr_index.size() - 1;
@@ -39,6 +39,7 @@ class StatementAtomicResult : public CUDAStatement {
     var_(NULL), av_(NULL), access_(NULL), result_type_(kDecl), type_(Type::get_simple_type(eInt)) {}
   
   static void InitResults(void);
+  static void ReleaseResults(void);
   static void DefineLocalResultVar(std::ostream& out);
   static void GenSpecialVals(void);
   static void RecordIfID(int id, Expression* expr);
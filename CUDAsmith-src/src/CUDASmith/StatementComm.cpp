@@ -30,19 +30,19 @@ namespace {
 const int kPermCount = 10;
 
 // Const buffer that holds the random permutations of [0..31].
-MemoryBuffer *permutations;
+thread_local MemoryBuffer *permutations;
 // Each permutation.
-std::vector<int> *permute_values[kPermCount];
+thread_local std::vector<int> *permute_values[kPermCount];
 // Local buffer that holds the intermediate values.
-MemoryBuffer *local_values;
+thread_local MemoryBuffer *local_values;
 // Global buffer that holds the intermediate values.
-MemoryBuffer *global_values;
+thread_local MemoryBuffer *global_values;
 // Variable that holds the random thread ID.
-Variable *tid;
+thread_local Variable *tid;
 // Local Variable used in random expressions throughout the program.
-MemoryBuffer *local_var;
+thread_local MemoryBuffer *local_var;
 // Global Variable used in random expressions throughout the program.
-MemoryBuffer *global_var;
+thread_local MemoryBuffer *global_var;
 }  // namespace
 
 StatementComm *StatementComm::make_random(CGContext& cg_context) {
@@ -93,7 +93,7 @@ void StatementComm::InitBuffers() {
       "g_comm_values", &Type::get_simple_type(eLongLong), Constant::make_int(1),
       {CUDAProgramGenerator::get_total_threads()});
   // The initial value of the tid will come from the first permutation.
-  // Lots of memory leaks here, probably not worth cleaning.
+  // These nodes are never freed; NodeArena reclaims them with the program.
   // get_linear_group_id() * group_size
   Expression *expr = new ExpressionFuncall(*new FunctionInvocationBinary(eMul,
       new ExpressionID(ExpressionID::kLinearGroup),
@@ -123,6 +123,19 @@ void StatementComm::InitBuffers() {
   }
 }
 
+void StatementComm::ReleaseBuffers() {
+  for (int idx = 0; idx < kPermCount; ++idx) {
+    delete permute_values[idx];
+    permute_values[idx] = NULL;
+  }
+  permutations = NULL;
+  local_values = NULL;
+  global_values = NULL;
+  tid = NULL;
+  local_var = NULL;
+  global_var = NULL;
+}
+
 void StatementComm::OutputPermutations(std::ostream& out) {
   permutations->OutputDecl(out);
   out << " = {" << std::endl;
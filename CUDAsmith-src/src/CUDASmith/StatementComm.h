@@ -41,6 +41,9 @@ class StatementComm : public CUDAStatement {
   // Creates the buffers used to hold thread IDs and intermediate values.
   static void InitBuffers();
 
+  // Frees the permutations and forgets the buffers created by InitBuffers().
+  static void ReleaseBuffers();
+
   // Outputs the memory buffer holding the permutations.
   // TODO move to globals.h.
   static void OutputPermutations(std::ostream& out);
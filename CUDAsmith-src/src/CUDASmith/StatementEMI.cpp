@@ -21,12 +21,12 @@ bool g_FCBoff = false;
 
 namespace CUDASmith {
 namespace {
-EMIController *emi_controller_inst = NULL;  // Singleton instance.
+thread_local EMIController *emi_controller_inst = NULL;  // Singleton instance.
+thread_local int item_count = 0;  // Next unused element of the EMI input buffer.
 }  // namespace
 
 StatementEMI *StatementEMI::make_random(CGContext& cg_context) {
   // TODO, better exprs, for now, just do 0>1, 2>3, etc.
-  static int item_count = 0;
   assert(item_count < 1024);
   MemoryBuffer *emi_input = EMIController::GetEMIController()->GetEMIInput();
 //   MemoryBuffer *item1 = emi_input->itemize({item_count++});
@@ -206,6 +206,7 @@ EMIController *EMIController::GetEMIController() {
 void EMIController::ReleaseEMIController() {
   delete emi_controller_inst;
   emi_controller_inst = NULL;
+  item_count = 0;
 }
 
 EMIController *EMIController::CreateEMIController() {
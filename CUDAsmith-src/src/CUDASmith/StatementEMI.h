@@ -27,7 +27,7 @@
 class Block;
 class FactMgr;
 
-extern bool g_Mark;
+extern thread_local bool g_Mark;
 extern bool g_FCBoff;
 
 namespace CUDASmith {
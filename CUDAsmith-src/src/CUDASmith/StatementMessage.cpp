@@ -35,11 +35,11 @@ namespace CUDASmith {
 namespace MessagePassing {
 namespace {
 // Local memory buffer for the messages.
-MemoryBuffer *message_buf;
+thread_local MemoryBuffer *message_buf;
 // Holds all the messages used in the program. Will probably never deallocate.
-std::vector<Message *> *messages;
+thread_local std::vector<Message *> *messages;
 // The message type of all the messages.
-Type *message_type;
+thread_local Type *message_type;
 }  // namespace
 
 void Initialise() {
@@ -48,6 +48,13 @@ void Initialise() {
   // has occured. // TODO
 }
 
+void Release() {
+  delete messages;
+  messages = NULL;
+  message_buf = NULL;
+  message_type = NULL;
+}
+
 void OutputMessageType(std::ostream& out) {
   if (message_type != NULL) OutputStructUnion(message_type, out);
 }
@@ -47,6 +47,9 @@ inline Constraint MakeConstraint(Variable *flag, int value) {
 // Initialises the message passing data.
 void Initialise();
 
+// Releases the message passing data, ready for the next Initialise().
+void Release();
+
 // Print the type of message_t.
 void OutputMessageType(std::ostream& out);
 
@@ -23,14 +23,14 @@ namespace CUDASmith
 {
 namespace
 {
-TGController *tg_controller_inst = NULL; // Singleton instance.
+thread_local TGController *tg_controller_inst = NULL; // Singleton instance.
+thread_local int item_count = 0; // Next unused element of the TG input buffer.
 } // namespace
 
 StatementTG *StatementTG::make_random(CGContext &cg_context)
 {
  //   cout<<"make random for StatementTG"<<endl;
     // TODO, better exprs, for now, just do 0>1, 2>3, etc.
-    static int item_count = 0;
     assert(item_count < 1024);
     MemoryBuffer *tg_input = TGController::GetTGController()->GetTGInput();
     //   MemoryBuffer *item1 = emi_input->itemize({item_count++});
@@ -117,46 +117,46 @@ void StatementTG::PruneBlock(Block *block)
         if (!do_lift)
             continue;
         lift_stms.push_back(st);
+    }
 
-        // Remove all the selected statements from the block.
-        for (Statement *st : del_stms)
-            block->remove_stmt(st);
-        // First check if we are in a for loop before any lifting.
-        bool in_loop = false;
-        for (Block *nest = block; nest != NULL && !in_loop; nest = nest->parent)
-            if (nest->looping)
-                in_loop = true;
-        // Lift marked statements.
-        std::vector<Statement *>::iterator position = block->stms.begin();
-        for (Statement *st : lift_stms)
+    // Remove all the selected statements from the block.
+    for (Statement *st : del_stms)
+        block->remove_stmt(st);
+    // First check if we are in a for loop before any lifting.
+    bool in_loop = false;
+    for (Block *nest = block; nest != NULL && !in_loop; nest = nest->parent)
+        if (nest->looping)
+            in_loop = true;
+    // Lift marked statements.
+    std::vector<Statement *>::iterator position = block->stms.begin();
+    for (Statement *st : lift_stms)
+    {
+        eStatementType st_type = st->eType;
+        assert(st_type == eIfElse || st_type == eFor);
+        for (; *position != st; ++position)
+            assert(position != block->stms.end());
+        if (st_type == eIfElse)
+        {
+            StatementIf *st_if = dynamic_cast<StatementIf *>(st);
+            assert(st_if != NULL);
+            position = MergeBlock(position, block,
+                                  const_cast<Block *>(st_if->get_true_branch()));
+            position = MergeBlock(position, block,
+                                  const_cast<Block *>(st_if->get_false_branch()));
+        }
+        else
         {
-            eStatementType st_type = st->eType;
-            assert(st_type == eIfElse || st_type == eFor);
-            for (; *position != st; ++position)
-                assert(position != block->stms.end());
-            if (st_type == eIfElse)
-            {
-                StatementIf *st_if = dynamic_cast<StatementIf *>(st);
-                assert(st_if != NULL);
-                position = MergeBlock(position, block,
-                                      const_cast<Block *>(st_if->get_true_branch()));
-                position = MergeBlock(position, block,
-                                      const_cast<Block *>(st_if->get_false_branch()));
-            }
-            else
-            {
-                StatementFor *st_for = dynamic_cast<StatementFor *>(st);
-                assert(st_for != NULL);
-                if (!in_loop)
-                    RemoveBreakContinue(const_cast<Block *>(st_for->get_body()));
-                position = MergeBlock(position, block,
-                                      const_cast<Block *>(st_for->get_body()));
-            }
+            StatementFor *st_for = dynamic_cast<StatementFor *>(st);
+            assert(st_for != NULL);
+            if (!in_loop)
+                RemoveBreakContinue(const_cast<Block *>(st_for->get_body()));
+            position = MergeBlock(position, block,
+                                  const_cast<Block *>(st_for->get_body()));
         }
-        // Now remove all lifted statements.
-        for (Statement *st : lift_stms)
-            block->remove_stmt(st);
     }
+    // Now remove all lifted statements.
+    for (Statement *st : lift_stms)
+        block->remove_stmt(st);
 }
 std::vector<Statement *>::iterator StatementTG::MergeBlock(std::vector<Statement *>::iterator position, Block *former, Block *merger)
 {
@@ -216,6 +216,7 @@ void TGController::ReleaseTGController()
 {
     delete tg_controller_inst;
     tg_controller_inst = NULL;
+    item_count = 0;
 }
 
 TGController *TGController::CreateTGController()
@@ -26,7 +26,7 @@
 
 class Block;
 class FactMgr;
-extern bool g_Mark;
+extern thread_local bool g_Mark;
 extern bool g_Tgoff;
 
 namespace CUDASmith
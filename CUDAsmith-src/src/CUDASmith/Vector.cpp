@@ -47,8 +47,7 @@ const char *const kOddStr = "y";
 
 }  // namespace
 
-std::map<std::pair<enum eSimpleType, unsigned>, const Type *>
-    Vector::vector_types_;
+thread_local std::vector<const Type *> Vector::vector_types_;
 
 Vector *Vector::CreateVectorVariable(const CGContext& cg_context, Block *blk,
     const std::string& name, const Type *type, const Expression *init,
@@ -219,9 +218,10 @@ int Vector::GetRandomVectorLength(int max) {
 const Type *Vector::PromoteTypeToVectorType(const Type *type, int size) {
   if (!size) size = GetRandomVectorLength(0);
   if (type->eType == eVector && type->vector_length_ == size) return type;
-  auto it = vector_types_.find(std::make_pair(type->simple_type, size));
-  assert(it != vector_types_.end() && "Unknown vector type.");
-  return it->second;
+  unsigned size_idx = 0;
+  while (size_idx < kSizesCount && kSizes[size_idx] != (unsigned)size) ++size_idx;
+  assert(size_idx < kSizesCount && "Unknown vector type.");
+  return vector_types_[type->simple_type * kSizesCount + size_idx];
 }
 
 const Type &Vector::DemoteVectorTypeToType(const Type *type) {
@@ -258,13 +258,16 @@ void Vector::OutputVectorType_Make(std::ostream& out, const Type *type,
 }
 
 void Vector::GenerateVectorTypes() {
+  // The vector types do not depend on the seed, so are created only once.
+  if (!vector_types_.empty()) return;
+  vector_types_.resize(MAX_SIMPLE_TYPES * kSizesCount);
   for (enum eSimpleType simple = eChar; simple < MAX_SIMPLE_TYPES;
       simple = (eSimpleType)(simple + 1)) {
     for (unsigned size_idx = 0; size_idx < kSizesCount; ++size_idx) {
       Type *t = new Type(simple);
       t->eType = eVector;
       t->vector_length_ = kSizes[size_idx];
-      vector_types_[std::make_pair(simple, kSizes[size_idx])] = t;
+      vector_types_[simple * kSizesCount + size_idx] = t;
     }
   }
 }
@@ -126,8 +126,8 @@ class Vector : public ArrayVariable
     // All vector types. These will be pre-generated, as many of the functions
     // that check for type compatibilities between variables rely on the types
     // being identical.
-    static std::map<std::pair<enum eSimpleType, unsigned>, const Type *>
-        vector_types_;
+    // Indexed by simple type, then by position of the length in kSizes.
+    static thread_local std::vector<const Type *> vector_types_;
 };
 
 } // namespace CUDASmith
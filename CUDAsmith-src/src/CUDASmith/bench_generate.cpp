@@ -0,0 +1,302 @@
+// Measures how fast kernels are generated in each of the documented modes.
+//
+//   generation_bench [--seeds A:B] [--mode NAME]... [--rng ENGINE] [-o FILE]
+//
+// Every mode generates the kernels for the seeds A to B (1 to 100 by default)
+// in process, one kernel at a time, so neither process startup nor moving
+// files around is measured. The seeds are drawn with the generator's default
+// engine, xoshiro, with direct sampling of filtered choices. --rng lrand48
+// measures the historic engine instead, which also samples by rejection; its
+// programs are fixed, so results from different versions of the generator
+// can be compared with it. For each mode the throughput in kernels and output bytes per
+// second, the median and 99th percentile time per kernel and the peak RSS are
+// printed, and written as JSON to FILE (bench_generate.json by default).
+//
+// Each mode runs in a child process, so that its peak RSS is its own. If a
+// seed crashes the generator, it is reported and the mode carries on with the
+// next seed in a new child.
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "CUDASmith/CUDARandomProgramGenerator.h"
+
+namespace {
+
+struct Mode {
+  const char *name;
+  const char *flags;
+};
+
+// The modes of the README.
+const Mode kModes[] = {
+  { "basic", "--fake_divergence --group_divergence" },
+  { "vector", "--fake_divergence --group_divergence --vectors" },
+  { "barrier", "--fake_divergence --group_divergence --vectors "
+               "--inter_thread_comm" },
+  { "atomic", "--fake_divergence --group_divergence --vectors --atomics" },
+  { "atomic_reduction", "--fake_divergence --group_divergence --vectors "
+                        "--atomic_reductions" },
+  { "all", "--fake_divergence --group_divergence --vectors "
+           "--inter_thread_comm --atomics --atomic_reductions" },
+  { "fg", "--fake_divergence --group_divergence --vectors "
+          "--inter_thread_comm --atomics --atomic_reductions --emi 1" },
+  { "tg", "--fake_divergence --group_divergence --vectors "
+          "--inter_thread_comm --atomics --atomic_reductions --TG 1" },
+  { "tg_off", "--fake_divergence --group_divergence --vectors "
+              "--inter_thread_comm --atomics --atomic_reductions --TG 0" },
+};
+
+struct ModeResult {
+  std::string name;
+  std::string flags;
+  std::vector<double> ms;  // Per kernel.
+  unsigned long long bytes;
+  std::vector<unsigned long> failed_seeds;
+  long peak_rss_kb;
+};
+
+std::vector<std::string> SplitFlags(const std::string& flags) {
+  std::vector<std::string> words;
+  std::string::size_type pos = 0;
+  while ((pos = flags.find_first_not_of(' ', pos)) != std::string::npos) {
+    std::string::size_type end = flags.find(' ', pos);
+    if (end == std::string::npos) end = flags.size();
+    words.push_back(flags.substr(pos, end - pos));
+    pos = end;
+  }
+  return words;
+}
+
+// Generates the kernels for the seeds [first, last] and reports
+// "<seed> <status> <ms> <bytes>" on fd for each. Runs in the child, in the
+// directory of the output, where the generator also writes platform.info.
+void GenerateSeeds(const Mode& mode, const std::string& rng,
+    unsigned long first, unsigned long last, const std::string& output,
+    int fd) {
+  typedef std::chrono::steady_clock Clock;
+  if (chdir(output.substr(0, output.rfind('/')).c_str()) != 0) {
+    perror("chdir");
+    _exit(1);
+  }
+  // The generator reports errors on stdout.
+  int null_fd = open("/dev/null", O_WRONLY);
+  if (null_fd >= 0) dup2(null_fd, STDOUT_FILENO);
+
+  std::vector<std::string> words = SplitFlags(mode.flags);
+  words.insert(words.begin(), "CUDASmith");
+  words.push_back("--rng");
+  words.push_back(rng);
+  words.push_back("-o");
+  words.push_back(output);
+  words.push_back("--seed");
+  words.push_back("");
+  for (unsigned long seed = first; ; ++seed) {
+    words.back() = std::to_string(seed);
+    std::vector<char *> argv;
+    for (std::string& word : words) argv.push_back(&word[0]);
+    argv.push_back(NULL);
+
+    Clock::time_point start = Clock::now();
+    int res = RunCUDASmith(argv.size() - 1, argv.data());
+    double ms = std::chrono::duration<double, std::milli>(
+        Clock::now() - start).count();
+    struct stat st;
+    long long bytes = stat(output.c_str(), &st) ? 0 : st.st_size;
+    dprintf(fd, "%lu %d %f %lld\n", seed, res, ms, bytes);
+    if (seed == last) break;
+  }
+}
+
+// Runs a mode over the seeds, restarting the child after a crash.
+ModeResult RunMode(const Mode& mode, const std::string& rng,
+    unsigned long first, unsigned long last, const std::string& output) {
+  ModeResult result;
+  result.name = mode.name;
+  result.flags = mode.flags;
+  result.bytes = 0;
+  result.peak_rss_kb = 0;
+
+  unsigned long next = first;
+  bool done = false;
+  while (!done) {
+    int fds[2];
+    if (pipe(fds)) {
+      perror("pipe");
+      exit(1);
+    }
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      exit(1);
+    }
+    if (pid == 0) {
+      close(fds[0]);
+      GenerateSeeds(mode, rng, next, last, output, fds[1]);
+      _exit(0);
+    }
+    close(fds[1]);
+
+    FILE *in = fdopen(fds[0], "r");
+    unsigned long seed;
+    int res;
+    double ms;
+    long long bytes;
+    while (fscanf(in, "%lu %d %lf %lld", &seed, &res, &ms, &bytes) == 4) {
+      if (res) {
+        result.failed_seeds.push_back(seed);
+      } else {
+        result.ms.push_back(ms);
+        result.bytes += bytes;
+      }
+      done = seed == last;
+      next = seed + 1;
+    }
+    fclose(in);
+
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    result.peak_rss_kb = std::max(result.peak_rss_kb, (long)usage.ru_maxrss);
+    if (!done && !(WIFEXITED(status) && WEXITSTATUS(status) == 0)) {
+      // The child died generating 'next'.
+      result.failed_seeds.push_back(next);
+      done = next == last;
+      ++next;
+    } else {
+      done = true;
+    }
+  }
+  return result;
+}
+
+// Nearest rank percentile of sorted values.
+double Percentile(const std::vector<double>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t rank = (size_t)std::ceil(p / 100 * sorted.size());
+  return sorted[rank ? rank - 1 : 0];
+}
+
+void WriteJSON(std::ostream& out, const std::string& rng, unsigned long first,
+    unsigned long last, const std::vector<ModeResult>& results) {
+  out << "{\n  \"generator\": \"" << GIT_VERSION << "\",\n"
+      << "  \"seeds\": \"" << first << ':' << last << "\",\n"
+      << "  \"rng\": \"" << rng << "\",\n  \"modes\": [";
+  for (size_t idx = 0; idx < results.size(); ++idx) {
+    const ModeResult& r = results[idx];
+    std::vector<double> sorted = r.ms;
+    std::sort(sorted.begin(), sorted.end());
+    double seconds = 0;
+    for (double ms : sorted) seconds += ms / 1000;
+    out << (idx ? "," : "") << "\n    {\n"
+        << "      \"name\": \"" << r.name << "\",\n"
+        << "      \"flags\": \"" << r.flags << "\",\n"
+        << "      \"kernels\": " << sorted.size() << ",\n"
+        << "      \"failed_seeds\": [";
+    for (size_t f = 0; f < r.failed_seeds.size(); ++f)
+      out << (f ? ", " : "") << r.failed_seeds[f];
+    out << "],\n"
+        << "      \"seconds\": " << seconds << ",\n"
+        << "      \"kernels_per_sec\": "
+        << (seconds > 0 ? sorted.size() / seconds : 0) << ",\n"
+        << "      \"p50_ms\": " << Percentile(sorted, 50) << ",\n"
+        << "      \"p99_ms\": " << Percentile(sorted, 99) << ",\n"
+        << "      \"output_bytes\": " << r.bytes << ",\n"
+        << "      \"bytes_per_sec\": " << (seconds > 0 ? r.bytes / seconds : 0)
+        << ",\n"
+        << "      \"peak_rss_kb\": " << r.peak_rss_kb << "\n    }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+int Usage() {
+  std::cerr << "usage: generation_bench [--seeds A:B] [--mode NAME]... "
+            << "[--rng xoshiro|lrand48] [-o FILE]\nmodes:";
+  for (const Mode& mode : kModes) std::cerr << ' ' << mode.name;
+  std::cerr << std::endl;
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  unsigned long first = 1, last = 100;
+  std::vector<const Mode *> modes;
+  std::string rng = "xoshiro";
+  std::string json = "bench_generate.json";
+  for (int idx = 1; idx < argc; ++idx) {
+    if (!strcmp(argv[idx], "--seeds") && idx + 1 < argc) {
+      if (sscanf(argv[++idx], "%lu:%lu", &first, &last) != 2 || first > last)
+        return Usage();
+    } else if (!strcmp(argv[idx], "--mode") && idx + 1 < argc) {
+      const char *name = argv[++idx];
+      const Mode *mode = NULL;
+      for (const Mode& m : kModes)
+        if (!strcmp(m.name, name)) mode = &m;
+      if (mode == NULL) return Usage();
+      modes.push_back(mode);
+    } else if (!strcmp(argv[idx], "--rng") && idx + 1 < argc) {
+      rng = argv[++idx];
+      if (rng != "xoshiro" && rng != "lrand48") return Usage();
+    } else if (!strcmp(argv[idx], "-o") && idx + 1 < argc) {
+      json = argv[++idx];
+    } else {
+      return Usage();
+    }
+  }
+  if (modes.empty())
+    for (const Mode& mode : kModes) modes.push_back(&mode);
+
+  char dir[] = "/tmp/generation_bench.XXXXXX";
+  if (mkdtemp(dir) == NULL) {
+    perror("mkdtemp");
+    return 1;
+  }
+  const std::string output = std::string(dir) + "/CUDAProg.cu";
+
+  std::vector<ModeResult> results;
+  printf("%-18s %8s %10s %9s %9s %10s %10s %s\n", "mode", "kernels",
+         "kernels/s", "p50 ms", "p99 ms", "KiB/s", "peak KiB", "failed");
+  for (const Mode *mode : modes) {
+    results.push_back(RunMode(*mode, rng, first, last, output));
+    const ModeResult& r = results.back();
+    std::vector<double> sorted = r.ms;
+    std::sort(sorted.begin(), sorted.end());
+    double seconds = 0;
+    for (double ms : sorted) seconds += ms / 1000;
+    printf("%-18s %8zu %10.1f %9.2f %9.2f %10.0f %10ld %zu\n", r.name.c_str(),
+           sorted.size(), seconds > 0 ? sorted.size() / seconds : 0,
+           Percentile(sorted, 50), Percentile(sorted, 99),
+           seconds > 0 ? r.bytes / seconds / 1024 : 0, r.peak_rss_kb,
+           r.failed_seeds.size());
+    fflush(stdout);
+  }
+  unlink(output.c_str());
+  unlink((std::string(dir) + "/platform.info").c_str());
+  rmdir(dir);
+
+  std::ofstream out(json.c_str());
+  WriteJSON(out, rng, first, last, results);
+  if (!out) {
+    std::cerr << "error: can't write " << json << std::endl;
+    return 1;
+  }
+  std::cout << "Results written to " << json << std::endl;
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Reads the archives written by CUDASmith --archive.
+//
+//   kernel_archive list ARCHIVE
+//     prints "<seed> <offset> <info>" for every kernel in the archive.
+//   kernel_archive extract ARCHIVE SEED [-o FILE]
+//     writes the kernel for SEED to FILE, or to stdout.
+//   kernel_archive unpack ARCHIVE [DIR]
+//     writes every kernel to DIR/CUDAProg_<seed>.cu, as a batch run without
+//     --archive would have.
+//
+// An ARCHIVE of "-" is read from stdin.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "CUDASmith/KernelArchive.h"
+
+namespace {
+
+int Usage() {
+  std::cerr << "usage: kernel_archive list ARCHIVE\n"
+            << "       kernel_archive extract ARCHIVE SEED [-o FILE]\n"
+            << "       kernel_archive unpack ARCHIVE [DIR]" << std::endl;
+  return 2;
+}
+
+bool WriteFile(const std::string& filename, const std::string& text) {
+  std::ofstream out(filename.c_str(), std::ios::binary);
+  out.write(text.data(), text.size());
+  if (!out) std::cerr << "error: can't write " << filename << std::endl;
+  return (bool)out;
+}
+
+int List(CUDASmith::KernelArchiveReader& reader) {
+  CUDASmith::KernelRecord record;
+  while (reader.Next(&record, false))
+    std::cout << record.seed << ' ' << record.offset << ' ' << record.info
+              << '\n';
+  return reader.failed() ? 1 : 0;
+}
+
+int Extract(CUDASmith::KernelArchiveReader& reader, unsigned long seed,
+    const std::string& output) {
+  CUDASmith::KernelRecord record;
+  if (!reader.Find(seed, &record)) {
+    std::cerr << "error: no kernel for seed " << seed << std::endl;
+    return 1;
+  }
+  if (!output.empty()) return WriteFile(output, record.kernel) ? 0 : 1;
+  std::cout.write(record.kernel.data(), record.kernel.size());
+  return std::cout ? 0 : 1;
+}
+
+int Unpack(CUDASmith::KernelArchiveReader& reader, const std::string& dir) {
+  CUDASmith::KernelRecord record;
+  while (reader.Next(&record, true))
+    if (!WriteFile(dir + "/CUDAProg_" + std::to_string(record.seed) + ".cu",
+                   record.kernel))
+      return 1;
+  return reader.failed() ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) return Usage();
+  const std::string command = argv[1];
+  CUDASmith::KernelArchiveReader reader(argv[2]);
+  if (!reader.IsOpen()) {
+    std::cerr << "error: " << argv[2] << " is not a kernel archive"
+              << std::endl;
+    return 1;
+  }
+
+  int res;
+  if (command == "list" && argc == 3) {
+    res = List(reader);
+  } else if (command == "extract" && (argc == 4 || argc == 6)) {
+    unsigned long seed;
+    if (sscanf(argv[3], "%lu", &seed) != 1) return Usage();
+    if (argc == 6 && strcmp(argv[4], "-o")) return Usage();
+    res = Extract(reader, seed, argc == 6 ? argv[5] : "");
+  } else if (command == "unpack" && (argc == 3 || argc == 4)) {
+    res = Unpack(reader, argc == 4 ? argv[3] : ".");
+  } else {
+    return Usage();
+  }
+  if (reader.failed())
+    std::cerr << "error: " << argv[2] << " is truncated or corrupt"
+              << std::endl;
+  return res;
+}
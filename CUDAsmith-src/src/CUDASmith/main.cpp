@@ -0,0 +1,7 @@
+// Entry point to the program.
+
+#include "CUDASmith/CUDARandomProgramGenerator.h"
+
+int main(int argc, char **argv) {
+  return RunCUDASmith(argc, argv);
+}
@@ -0,0 +1,170 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "CodeEmitter.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Keep the text in memory; the buffer grows as needed.
+ */
+CodeEmitter::CodeEmitter(void)
+	: buf_(BUFFER_SIZE),
+	  in_memory_(true),
+	  fd_(-1),
+	  owns_fd_(false),
+	  failed_(false)
+{
+	setp(&buf_[0], &buf_[0] + buf_.size());
+}
+
+CodeEmitter::CodeEmitter(int fd, bool owns_fd)
+	: buf_(BUFFER_SIZE),
+	  in_memory_(false),
+	  fd_(fd),
+	  owns_fd_(owns_fd),
+	  failed_(fd < 0)
+{
+	setp(&buf_[0], &buf_[0] + buf_.size());
+}
+
+CodeEmitter::CodeEmitter(const char *filename)
+	: buf_(BUFFER_SIZE),
+	  in_memory_(false),
+	  fd_(::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666)),
+	  owns_fd_(true),
+	  failed_(fd_ < 0)
+{
+	setp(&buf_[0], &buf_[0] + buf_.size());
+}
+
+CodeEmitter::~CodeEmitter(void)
+{
+	finish();
+}
+
+/*
+ * Write out whatever is pending and close the descriptor if we opened it.
+ * Return false if anything could not be written.
+ */
+bool
+CodeEmitter::finish(void)
+{
+	if (in_memory_) {
+		return true;
+	}
+	drain();
+	if (owns_fd_ && fd_ >= 0) {
+		if (::close(fd_) != 0) {
+			failed_ = true;
+		}
+	}
+	fd_ = -1;
+	return !failed_;
+}
+
+/*
+ * Hand the text collected so far back to the caller, and start over.
+ */
+string
+CodeEmitter::take(void)
+{
+	string s(pbase(), pptr());
+	setp(&buf_[0], &buf_[0] + buf_.size());
+	return s;
+}
+
+CodeEmitter::int_type
+CodeEmitter::overflow(int_type c)
+{
+	if (in_memory_) {
+		size_t used = size();
+		buf_.resize(buf_.size() * 2);
+		setp(&buf_[0], &buf_[0] + buf_.size());
+		// pbump takes an int
+		while (used > 0) {
+			int n = used > (1u << 30) ? (1 << 30) : static_cast<int>(used);
+			pbump(n);
+			used -= n;
+		}
+	}
+	else if (!drain()) {
+		return traits_type::eof();
+	}
+	if (!traits_type::eq_int_type(c, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+/*
+ * Flushes are deliberately ignored; see finish().
+ */
+int
+CodeEmitter::sync(void)
+{
+	return 0;
+}
+
+bool
+CodeEmitter::drain(void)
+{
+	const char *p = pbase();
+	size_t left = size();
+	while (left > 0 && fd_ >= 0) {
+		ssize_t n = ::write(fd_, p, left);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			failed_ = true;
+			break;
+		}
+		p += n;
+		left -= n;
+	}
+	setp(&buf_[0], &buf_[0] + buf_.size());
+	return !failed_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
@@ -0,0 +1,95 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CODE_EMITTER_H
+#define CODE_EMITTER_H
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/*
+ * Stream buffer for the text of a generated program. The output managers
+ * write through a std::ostream on top of it, as before.
+ *
+ * The text is collected in one large contiguous buffer. Flushes
+ * (std::endl, std::flush) do not reach the file: the buffer is only
+ * written out when it is full and on finish(), so a kernel normally costs
+ * a single write. Text either goes to a file descriptor, or stays in
+ * memory until the caller takes it.
+ */
+class CodeEmitter : public std::streambuf
+{
+public:
+	static const size_t BUFFER_SIZE = 1 << 20;
+
+	CodeEmitter(void);
+	explicit CodeEmitter(int fd, bool owns_fd = false);
+	explicit CodeEmitter(const char *filename);
+	virtual ~CodeEmitter(void);
+
+	bool is_open(void) const { return in_memory_ || fd_ >= 0; }
+	bool finish(void);
+
+	// in memory only
+	const char *data(void) const { return pbase(); }
+	size_t size(void) const { return pptr() - pbase(); }
+	std::string take(void);
+
+protected:
+	virtual int_type overflow(int_type c);
+	virtual int sync(void);
+
+private:
+	bool drain(void);
+
+	std::vector<char> buf_;
+	bool in_memory_;
+	int fd_;
+	bool owns_fd_;
+	bool failed_;
+
+	// not copyable
+	CodeEmitter(const CodeEmitter &);
+	CodeEmitter &operator=(const CodeEmitter &);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // CODE_EMITTER_H
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
@@ -38,7 +38,7 @@
 
 using namespace std;
 
-DFSOutputMgr *DFSOutputMgr::instance_ = NULL;
+thread_local DFSOutputMgr *DFSOutputMgr::instance_ = NULL;
 
 DFSOutputMgr::DFSOutputMgr()
 {
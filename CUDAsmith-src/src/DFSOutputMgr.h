@@ -57,7 +57,7 @@ private:
 
 	virtual std::ostream &get_main_out();
 
-	static DFSOutputMgr *instance_;
+	static thread_local DFSOutputMgr *instance_;
 
 	std::string struct_output_;
 };
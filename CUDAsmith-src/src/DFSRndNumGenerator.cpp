@@ -128,7 +128,7 @@ void DFSRndNumGenerator::SearchState::dump(const string &)
 #endif
 // ----------------------------------------------------------------------------------------------
 
-DFSRndNumGenerator *DFSRndNumGenerator::impl_ = 0;
+thread_local DFSRndNumGenerator *DFSRndNumGenerator::impl_ = 0;
 
 DFSRndNumGenerator::DFSRndNumGenerator(Sequence *concrete_seq)
 	: trace_string_(""),
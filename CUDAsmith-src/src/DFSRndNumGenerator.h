@@ -100,7 +100,7 @@ private:
 	void log_depth(int d, const std::string *where = NULL, const char *log = NULL);
 
 	// ----------------------------------------------------------------------------------------
-	static DFSRndNumGenerator *impl_;
+	static thread_local DFSRndNumGenerator *impl_;
 
 	//static std::string name_prefix;
 
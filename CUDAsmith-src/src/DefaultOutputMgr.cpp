@@ -56,7 +56,7 @@ static std::string dir_sep = "\\";
 
 using namespace std;
 
-DefaultOutputMgr *DefaultOutputMgr::instance_ = NULL;
+thread_local DefaultOutputMgr *DefaultOutputMgr::instance_ = NULL;
 
 DefaultOutputMgr *
 DefaultOutputMgr::CreateInstance()
@@ -283,5 +283,7 @@ DefaultOutputMgr::~DefaultOutputMgr()
 	if (ofile_)
 		ofile_->close();
 	delete ofile_;
+	if (instance_ == this)
+		instance_ = NULL;
 }
 
@@ -79,7 +79,7 @@ private:
 
 	void RandomOutputFuncDefs();
 
-	static DefaultOutputMgr *instance_;
+	static thread_local DefaultOutputMgr *instance_;
 
 	std::vector<std::ofstream* > outs;
 
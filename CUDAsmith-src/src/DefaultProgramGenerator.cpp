@@ -41,6 +41,7 @@
 #include "CGOptions.h"
 #include "SafeOpFlags.h"
 #include "ExtensionMgr.h"
+#include "PartialExpander.h"
 
 DefaultProgramGenerator::DefaultProgramGenerator(int argc, char *argv[], unsigned long seed)
 	: argc_(argc),
@@ -73,6 +74,10 @@ DefaultProgramGenerator::initialize()
 	}
 	assert(output_mgr_);
 
+	// The expansion state is per thread and changes during generation, so
+	// start every program from the configured values.
+	PartialExpander::restore_init_values();
+
 	ExtensionMgr::CreateExtension();
 }
 
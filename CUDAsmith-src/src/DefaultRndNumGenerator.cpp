@@ -34,21 +34,16 @@
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <typeinfo>
 
 #include "Filter.h"
 #include "SequenceFactory.h"
 #include "Sequence.h"
 #include "CGOptions.h"
 #include "DeltaMonitor.h"
+#include "DrawProfiler.h"
 
-#ifdef WIN32
-extern "C" {
-	extern void srand48(long seed);
-	extern long lrand48(void);
-}
-#endif
-
-DefaultRndNumGenerator *DefaultRndNumGenerator::impl_ = 0;
+thread_local DefaultRndNumGenerator *DefaultRndNumGenerator::impl_ = 0;
 
 /*
  *
@@ -67,6 +62,7 @@ DefaultRndNumGenerator::DefaultRndNumGenerator(const unsigned long, Sequence *co
 DefaultRndNumGenerator::~DefaultRndNumGenerator()
 {
 	SequenceFactory::destroy_sequences();
+	impl_ = 0;
 }
 
 /*
@@ -117,26 +113,52 @@ DefaultRndNumGenerator::add_number(int v, int bound, int k)
 unsigned int
 DefaultRndNumGenerator::rnd_upto(const unsigned int n, const Filter *f, const std::string *where)
 {
-	static int g = 0;
+	static thread_local int g = 0;
 	int h = g;
 	if (h == 440)
 		BREAK_NOP;   // for debugging
-	unsigned int v = genrand() % n;
+	unsigned int v = genrand_upto(n);
 	unsigned INT64 local_depth = rand_depth_;
 	rand_depth_++;
 	//ofstream out("rnd.log", ios_base::app);
 	//out << g++ << ": " << v << "(" << n << ")" << endl;
 
-	if (f) {
-		while (f->filter(v)) {
-			// We could add numbers into sequence inside the previous filter.
-			// If the previous filter failed, we need to roll back the rand_depth_ here.
-			// This will also overwrite the value added in the map.
-			rand_depth_ = local_depth+1;
-			v = genrand() % n;
-			/*out << g++ << ": " << v << "(" << n << ")" << endl;*/
+	unsigned int rejected = 0;
+	if (f && f->filter(v)) {
+		// We could add numbers into sequence inside the previous filter.
+		// If the previous filter failed, we need to roll back the rand_depth_ here.
+		// This will also overwrite the value added in the map.
+		rand_depth_ = local_depth+1;
+		rejected++;
+		if (CGOptions::direct_filter_sampling() && f->accepted_values(n, accepted_)) {
+			// Draw one of the accepted values instead of redrawing until the
+			// filter accepts one. Accepted values are still equally likely
+			// (the first draw picked each with 1/n, the second makes up the
+			// rest), but the draw takes at most two numbers.
+			if (accepted_.empty()) {
+				// redrawing would never end either
+				std::cerr << "error: the filter " << typeid(*f).name()
+						  << " rejects every value below " << n << std::endl;
+				abort();
+			}
+			v = accepted_[genrand_upto(accepted_.size())];
+			// filters may remember the value they accepted last
+			bool rejected_again = f->filter(v);
+			assert(!rejected_again);
+			(void)rejected_again;
+		}
+		else {
+			v = genrand_upto(n);
+			while (f->filter(v)) {
+				rand_depth_ = local_depth+1;
+				v = genrand_upto(n);
+				rejected++;
+				/*out << g++ << ": " << v << "(" << n << ")" << endl;*/
+			}
 		}
 	}
+	if (DrawProfiler::is_enabled())
+		DrawProfiler::record(f, rejected);
 	//out.close();
 	if (where) {
 	std::ostringstream ss;
@@ -156,6 +178,8 @@ DefaultRndNumGenerator::rnd_flipcoin(const unsigned int p, const Filter *f, cons
 	assert(p <= 100);
 	unsigned INT64 local_depth = rand_depth_;
 	rand_depth_++;
+	if (DrawProfiler::is_enabled())
+		DrawProfiler::record(f, 0);
 	if (f) {
 		if (f->filter(0)) {
 			add_number(1, 2, local_depth);
@@ -167,7 +191,7 @@ DefaultRndNumGenerator::rnd_flipcoin(const unsigned int p, const Filter *f, cons
 		}
 	}
 
-	bool rv = (genrand() % 100) < p;
+	bool rv = genrand_upto(100) < p;
 	if (rv) {
 		add_number(1, 2, local_depth);
 	}
@@ -206,7 +230,7 @@ DefaultRndNumGenerator::RandomHexDigits( int num )
 	std::string str;
 	const char* hex1 = AbsRndNumGenerator::get_hex1();
 	while (num--) {
-		int x = genrand() % 16;
+		int x = genrand_upto(16);
 		str += hex1[x];
 		seq_->add_number(x, 16, rand_depth_);
 		rand_depth_++;
@@ -223,7 +247,7 @@ DefaultRndNumGenerator::RandomDigits( int num )
 	std::string str;
 	const char* dec1 = AbsRndNumGenerator::get_dec1();
 	while (num--) {
-		int x = genrand() % 10;
+		int x = genrand_upto(10);
 		str += dec1[x];
 		seq_->add_number(x, 10, rand_depth_);
 		rand_depth_++;
@@ -70,7 +70,7 @@ private:
 
 	void add_number(int v, int bound, int k);
 
-	static DefaultRndNumGenerator *impl_;
+	static thread_local DefaultRndNumGenerator *impl_;
 
 	unsigned INT64 rand_depth_;
 
@@ -78,6 +78,9 @@ private:
 
 	Sequence *seq_;
 
+	// values accepted by the filter of a draw, see rnd_upto
+	std::vector<unsigned int> accepted_;
+
 	virtual unsigned long genrand(void);
 
 	//void seedrand(unsigned long seed);
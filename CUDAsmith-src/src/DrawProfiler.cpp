@@ -0,0 +1,263 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "DrawProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef WIN32
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+#include "Filter.h"
+
+using namespace std;
+
+bool DrawProfiler::enabled_ = false;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+struct SiteKey {
+	const void *site;
+	const type_info *filter;	// 0 if the draw has no filter
+
+	bool operator==(const SiteKey &k) const {
+		return site == k.site && filter == k.filter;
+	}
+};
+
+struct SiteKeyHash {
+	size_t operator()(const SiteKey &k) const {
+		return hash<const void*>()(k.site) * 31 + hash<const void*>()(k.filter);
+	}
+};
+
+struct SiteStats {
+	SiteStats(void) : draws(0), rejected(0), max_rejected(0), gap_ns(0) {}
+
+	unsigned long draws;
+	unsigned long rejected;
+	unsigned long max_rejected;	// by a single draw
+	double gap_ns;				// since the previous draw, summed
+};
+
+typedef unordered_map<SiteKey, SiteStats, SiteKeyHash> SiteTable;
+
+void
+merge_sites(SiteTable &to, const SiteTable &from)
+{
+	for (SiteTable::const_iterator i = from.begin(); i != from.end(); ++i) {
+		SiteStats &s = to[i->first];
+		s.draws += i->second.draws;
+		s.rejected += i->second.rejected;
+		s.max_rejected = max(s.max_rejected, i->second.max_rejected);
+		s.gap_ns += i->second.gap_ns;
+	}
+}
+
+mutex merged_mutex;
+SiteTable merged_sites;
+string report_filename;
+
+struct ThreadSites {
+	ThreadSites(void) : site(0), started(false) {}
+	~ThreadSites(void) {
+		lock_guard<mutex> lock(merged_mutex);
+		merge_sites(merged_sites, sites);
+	}
+
+	SiteTable sites;
+	const void *site;		// of the current draw, see DrawSite in random.cpp
+	bool started;
+	Clock::time_point last;	// of the previous draw
+};
+
+thread_local ThreadSites thread_sites;
+
+string
+demangle(const char *name)
+{
+#ifndef WIN32
+	int status;
+	char *s = abi::__cxa_demangle(name, 0, 0, &status);
+	if (s) {
+		string rv = s;
+		free(s);
+		return rv;
+	}
+#endif
+	return name;
+}
+
+/*
+ * "function+0x1c", or "module+0x4a2c0" if the function has no symbol.
+ * The latter can be resolved with addr2line.
+ */
+string
+describe_site(const void *site)
+{
+	if (!site) {
+		return "(unknown)";
+	}
+	char offset[32];
+#ifndef WIN32
+	Dl_info info;
+	if (dladdr(site, &info)) {
+		const char *base = static_cast<const char*>(info.dli_saddr);
+		if (info.dli_sname && base) {
+			sprintf(offset, "+0x%lx", (unsigned long)(static_cast<const char*>(site) - base));
+			return demangle(info.dli_sname) + offset;
+		}
+		if (info.dli_fname && info.dli_fbase) {
+			string module = info.dli_fname;
+			module = module.substr(module.rfind('/') + 1);
+			sprintf(offset, "+0x%lx", (unsigned long)(static_cast<const char*>(site) - static_cast<const char*>(info.dli_fbase)));
+			return module + offset;
+		}
+	}
+#endif
+	sprintf(offset, "%p", site);
+	return offset;
+}
+
+bool
+by_total_draws(const pair<SiteKey, SiteStats> &a, const pair<SiteKey, SiteStats> &b)
+{
+	return a.second.draws + a.second.rejected > b.second.draws + b.second.rejected;
+}
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+DrawProfiler::enable(const string &filename)
+{
+	enabled_ = true;
+	report_filename = filename;
+}
+
+const void *
+DrawProfiler::enter(const void *site)
+{
+	const void *saved = thread_sites.site;
+	if (!saved) {
+		thread_sites.site = site;
+	}
+	return saved;
+}
+
+void
+DrawProfiler::leave(const void *saved)
+{
+	thread_sites.site = saved;
+}
+
+void
+DrawProfiler::record(const Filter *f, unsigned int rejected)
+{
+	ThreadSites &t = thread_sites;
+	Clock::time_point now = Clock::now();
+	SiteKey key = { t.site, f ? &typeid(*f) : 0 };
+	SiteStats &s = t.sites[key];
+	s.draws++;
+	s.rejected += rejected;
+	s.max_rejected = max(s.max_rejected, (unsigned long)rejected);
+	if (t.started) {
+		s.gap_ns += chrono::duration<double, nano>(now - t.last).count();
+	}
+	t.started = true;
+	t.last = now;
+}
+
+bool
+DrawProfiler::report(unsigned long programs)
+{
+	vector<pair<SiteKey, SiteStats> > sites;
+	{
+		lock_guard<mutex> lock(merged_mutex);
+		merge_sites(merged_sites, thread_sites.sites);
+		thread_sites.sites.clear();
+		sites.assign(merged_sites.begin(), merged_sites.end());
+	}
+	sort(sites.begin(), sites.end(), by_total_draws);
+
+	unsigned long draws = 0, rejected = 0;
+	for (size_t i = 0; i < sites.size(); i++) {
+		draws += sites[i].second.draws;
+		rejected += sites[i].second.rejected;
+	}
+	if (programs == 0) {
+		programs = 1;
+	}
+
+	ofstream file;
+	if (report_filename != "-") {
+		file.open(report_filename.c_str());
+	}
+	ostream &out = report_filename == "-" ? cerr : file;
+	out << "# " << programs << " programs, " << draws << " draws, "
+		<< rejected << " rejected by filters" << endl;
+	out << "# draws/program rejected/program max-rejected avg-gap-us site filter" << endl;
+	out << fixed;
+	for (size_t i = 0; i < sites.size(); i++) {
+		const SiteStats &s = sites[i].second;
+		out << setprecision(1) << (double)s.draws / programs << ' '
+			<< (double)s.rejected / programs << ' '
+			<< s.max_rejected << ' '
+			<< setprecision(2) << s.gap_ns / s.draws / 1000 << ' '
+			<< describe_site(sites[i].first.site) << ' '
+			<< (sites[i].first.filter ? demangle(sites[i].first.filter->name()) : "-")
+			<< endl;
+	}
+	return (bool)out;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
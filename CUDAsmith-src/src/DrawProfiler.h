@@ -0,0 +1,82 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DRAW_PROFILER_H
+#define DRAW_PROFILER_H
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+class Filter;
+
+/*
+ * Counts the random draws made by each call site of rnd_upto and
+ * rnd_flipcoin, how many values the site's filter rejected, and the time
+ * spent since the previous draw. Sites are told apart by the return
+ * address of the call and the type of the filter. The report lists the
+ * sites with the most draws (including rejected ones) first.
+ *
+ * The profiler is off unless enable() is called before generating. Each
+ * thread counts on its own; the counts are merged when the thread exits
+ * and when the report is written.
+ */
+class DrawProfiler
+{
+public:
+	static void enable(const std::string &filename);
+	static bool is_enabled(void) { return enabled_; }
+
+	// called by the wrappers in random.cpp around a draw: enter() sets the
+	// site of the draw, unless one is set already (e.g. by pure_rnd_upto),
+	// and returns the site that leave() restores when the wrapper returns,
+	// whichever generator served the draw
+	static const void *enter(const void *site);
+	static void leave(const void *saved);
+
+	// called by the generator once per draw
+	static void record(const Filter *f, unsigned int rejected);
+
+	// writes the report; 'programs' is the number of programs generated
+	static bool report(unsigned long programs);
+
+private:
+	static bool enabled_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // DRAW_PROFILER_H
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
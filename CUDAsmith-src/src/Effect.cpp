@@ -48,21 +48,21 @@ const Effect Effect::empty_effect;
 ///////////////////////////////////////////////////////////////////////////////
 
 /*
- * Stuff that so badly wants to be rewritten using decent STL containers and
- * algorithms.
+ * whether one of vars is a field (at any depth) of a struct/union in ids,
+ * which Variable::match counts as a match
  */
 static bool
-non_empty_intersection(const vector<const Variable *> &va,
-					   const vector<const Variable *> &vb)
+has_container_in(const vector<const Variable *> &vars, const VariableIdSet &ids)
 {
-	vector<const Variable *>::size_type va_len = va.size();
-	vector<const Variable *>::size_type vb_len = vb.size();
+	vector<const Variable *>::size_type len = vars.size();
 	vector<const Variable *>::size_type i;
-	vector<const Variable *>::size_type j;
-	
-	for (i = 0; i < va_len; ++i) {
-		for (j = 0; j < vb_len; ++j) {
-			if (va[i]->match(vb[j]) || vb[j]->match(va[i])) {
+
+	for (i = 0; i < len; ++i) {
+		if (!vars[i]->type) {
+			continue;
+		}
+		for (const Variable *p = vars[i]->field_var_of; p; p = p->field_var_of) {
+			if (p->type && p->type->is_aggregate() && ids.contains(p->id)) {
 				return true;
 			}
 		}
@@ -70,6 +70,17 @@ non_empty_intersection(const vector<const Variable *> &va,
 	return false;
 }
 
+/*
+ * whether a variable of one set matches (see Variable::match) a variable
+ * of the other
+ */
+static bool
+non_empty_intersection(const vector<const Variable *> &va, const VariableIdSet &ida,
+					   const vector<const Variable *> &vb, const VariableIdSet &idb)
+{
+	return ida.intersects(idb) || has_container_in(va, idb) || has_container_in(vb, ida);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /*
@@ -79,7 +90,8 @@ Effect::Effect(void) :
 	read_vars(0),
 	write_vars(0),
 	pure(true),
-	side_effect_free(true)
+	side_effect_free(true),
+	undo_(0)
 {
 	// Nothing else to do.
 }
@@ -90,8 +102,11 @@ Effect::Effect(void) :
 Effect::Effect(const Effect &e) :
 	read_vars(e.read_vars),
 	write_vars(e.write_vars),
+	read_ids(e.read_ids),
+	write_ids(e.write_ids),
 	pure(e.pure),
-	side_effect_free(e.side_effect_free)
+	side_effect_free(e.side_effect_free),
+	undo_(0)
 {
 	// Nothing else to do.
 }
@@ -101,7 +116,7 @@ Effect::Effect(const Effect &e) :
  */
 Effect::~Effect(void)
 {
-	// Nothing else to do.
+	delete undo_;
 }
 
 /*
@@ -114,8 +129,13 @@ Effect::operator=(const Effect &e)
 		return *this;
 	}
 
+	if (undo_) {
+		record(true);
+	}
 	read_vars = e.read_vars;
 	write_vars = e.write_vars;
+	read_ids = e.read_ids;
+	write_ids = e.write_ids;
 	pure = e.pure;
 	side_effect_free = e.side_effect_free;
 
@@ -129,7 +149,7 @@ void
 Effect::read_var(const Variable *v)
 {
 	if (!is_read(v)) {
-		read_vars.push_back(v);
+		add_read_var(v);
 	}
 	pure &= (v->is_const() && !v->is_volatile() && !v->is_access_once());
 	side_effect_free &= (!v->is_volatile() && !v->is_access_once());
@@ -154,7 +174,7 @@ void
 Effect::write_var(const Variable *v)
 {
 	if (!is_written(v)) {
-		write_vars.push_back(v);
+		add_write_var(v);
 	}
 	// pure = pure;
 	// TODO: not quite correct below ---
@@ -191,14 +211,14 @@ Effect::add_effect(const Effect &e, bool include_lhs_effects)
 	for (i = 0; i < len; ++i) {
 		// this->read_var(e.read_vars[i]);
 		if (!is_read(e.read_vars[i])) {
-			this->read_vars.push_back(e.read_vars[i]);
+			add_read_var(e.read_vars[i]);
 		}
 	}
 	len = e.write_vars.size();
 	for (i = 0; i < len; ++i) {
 		// this->write_var(e.write_vars[i]);
 		if (!is_written(e.write_vars[i])) {
-			this->write_vars.push_back(e.write_vars[i]);
+			add_write_var(e.write_vars[i]);
 		}
 	}
 
@@ -298,19 +318,49 @@ Effect::add_external_effect(const Effect &e, std::vector<const Block*> call_chai
 }
 
 /*
- * TODO: tried doing this with `find', but I couldn't get all the `const's
- * right.  Gave up; wrote it by hand!
+ *
+ */
+void
+Effect::add_read_var(const Variable *v)
+{
+	read_vars.push_back(v);
+	read_ids.insert(v->id);
+}
+
+/*
+ *
+ */
+void
+Effect::add_write_var(const Variable *v)
+{
+	write_vars.push_back(v);
+	write_ids.insert(v->id);
+}
+
+/*
+ * drop the variables added after the sets had these sizes
+ */
+void
+Effect::truncate(vector<const Variable *>::size_type reads, vector<const Variable *>::size_type writes)
+{
+	while (read_vars.size() > reads) {
+		read_ids.erase(read_vars.back()->id);
+		read_vars.pop_back();
+	}
+	while (write_vars.size() > writes) {
+		write_ids.erase(write_vars.back()->id);
+		write_vars.pop_back();
+	}
+}
+
+/*
+ *
  */
 bool
 Effect::is_read(const Variable *v) const
 {
-	vector<Variable *>::size_type len = read_vars.size();
-	vector<Variable *>::size_type i;
-
-	for (i = 0; i < len; ++i) {
-		if (read_vars[i] == v) {
-			return true;
-		}
+	if (read_ids.contains(v->id)) {
+		return true;
 	}
 	// if we read a struct, presumingly all the fields are read too
 	// however we can not say the same thing for unions: reading a particular
@@ -369,13 +419,8 @@ Effect::is_read(string vname) const
 bool
 Effect::is_written(const Variable *v) const
 {
-	vector<Variable *>::size_type len = write_vars.size();
-	vector<Variable *>::size_type i;
-
-	for (i = 0; i < len; ++i) {
-		if (write_vars[i] == v) {
-			return true;
-		}
+	if (write_ids.contains(v->id)) {
+		return true;
 	}
 	// if we write a struct/union, presumingly all the fields are written too
 	if (v->field_var_of) {
@@ -509,11 +554,15 @@ Effect::is_written_partially(const Variable* v) const
 void
 Effect::consolidate(void) 
 {
+	if (undo_) {
+		record(true);
+	}
 	size_t i;
 	size_t len = read_vars.size();
 	for (i=0; i<len; i++) {
 		const Variable* tmp = read_vars[i];
 		if (tmp->is_field_var() && is_read(tmp->field_var_of)) {
+			read_ids.erase(tmp->id);
 			read_vars.erase(read_vars.begin() + i);
 			i--;
 			len--;
@@ -523,6 +572,7 @@ Effect::consolidate(void)
 	for (i=0; i<len; i++) {
 		const Variable* tmp = write_vars[i];
 		if (tmp->is_field_var() && is_written(tmp->field_var_of)) {
+			write_ids.erase(tmp->id);
 			write_vars.erase(write_vars.begin() + i);
 			i--;
 			len--;
@@ -536,9 +586,9 @@ Effect::consolidate(void)
 bool
 Effect::has_race_with(const Effect &e) const
 {
-	return (non_empty_intersection(this->read_vars,  e.write_vars)
-			|| non_empty_intersection(this->write_vars, e.read_vars)
-			|| non_empty_intersection(this->write_vars, e.write_vars));
+	return (non_empty_intersection(this->read_vars, this->read_ids, e.write_vars, e.write_ids)
+			|| non_empty_intersection(this->write_vars, this->write_ids, e.read_vars, e.read_ids)
+			|| non_empty_intersection(this->write_vars, this->write_ids, e.write_vars, e.write_ids));
 }
 
 /*
@@ -556,11 +606,94 @@ Effect::is_empty(void) const
 void
 Effect::clear(void) 
 {
+	if (undo_) {
+		record(true);
+	}
 	read_vars.clear();
 	write_vars.clear();
+	read_ids.clear();
+	write_ids.clear();
 	pure = side_effect_free = true;
 }
 
+/*
+ *
+ */
+void
+Effect::record(bool rewrite)
+{
+	undo_->entries.push_back(Undo());
+	Undo &u = undo_->entries.back();
+	u.rewrite = rewrite;
+	u.reads = read_vars.size();
+	u.writes = write_vars.size();
+	u.pure = pure;
+	u.side_effect_free = side_effect_free;
+	if (rewrite) {
+		u.saved_reads = read_vars;
+		u.saved_writes = write_vars;
+		u.saved_read_ids = read_ids;
+		u.saved_write_ids = write_ids;
+	}
+}
+
+/*
+ *
+ */
+size_t
+Effect::checkpoint(void)
+{
+	if (undo_ == 0) {
+		undo_ = new UndoLog;
+		undo_->depth = 0;
+	}
+	undo_->depth++;
+	record(false);
+	return undo_->entries.size() - 1;
+}
+
+/*
+ *
+ */
+void
+Effect::commit(size_t cp)
+{
+	assert(undo_ && cp < undo_->entries.size());
+	if (--undo_->depth == 0) {
+		delete undo_;
+		undo_ = 0;
+	}
+}
+
+/*
+ * undo the rewrites since cp, newest first, then drop whatever was
+ * added to the sets after cp was taken
+ */
+void
+Effect::rollback(size_t cp)
+{
+	assert(undo_ && cp < undo_->entries.size());
+	while (undo_->entries.size() > cp + 1) {
+		Undo &u = undo_->entries.back();
+		if (u.rewrite) {
+			read_vars.swap(u.saved_reads);
+			write_vars.swap(u.saved_writes);
+			read_ids = u.saved_read_ids;
+			write_ids = u.saved_write_ids;
+		}
+		undo_->entries.pop_back();
+	}
+	const Undo &u = undo_->entries.back();
+	truncate(u.reads, u.writes);
+	pure = u.pure;
+	side_effect_free = u.side_effect_free;
+	undo_->entries.pop_back();
+	if (--undo_->depth == 0) {
+		delete undo_;
+		undo_ = 0;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /*
@@ -34,6 +34,7 @@
 
 #include <ostream>
 #include <vector>
+#include "VariableIdSet.h"
 
 class Variable;
 class Block;
@@ -77,6 +78,12 @@ public:
 	bool is_empty(void) const;
 	void consolidate(void);
 
+	// undo log, the same as FactVec::checkpoint. Rolling back restores what
+	// assigning a saved copy would: the read/write sets and purity flags.
+	size_t checkpoint(void);
+	void commit(size_t cp);
+	void rollback(size_t cp);
+
 	static const Effect &get_empty_effect(void)	{ return Effect::empty_effect; }
 
 	const std::vector<const Variable *>& get_read_vars(void) const { return read_vars;}
@@ -93,13 +100,44 @@ public:
 	void update_purity(void);
 	
 private:	
+	void add_read_var(const Variable *v);
+	void add_write_var(const Variable *v);
+	void truncate(std::vector<const Variable *>::size_type reads, std::vector<const Variable *>::size_type writes);
+
+	// in the order they were added, the ids sets are for lookups
 	std::vector<const Variable *> read_vars;
 	std::vector<const Variable *> write_vars;
 	std::vector<const Variable *> lhs_write_vars;
+	VariableIdSet read_ids;
+	VariableIdSet write_ids;
 
 	bool pure;
 	bool side_effect_free;
 
+	// read/write sets only grow between rewrites (assignment, clear,
+	// consolidate), so a checkpoint just remembers their sizes, and each
+	// rewrite saves the sets it overwrites
+	struct Undo {
+		bool rewrite;
+		std::vector<const Variable *>::size_type reads;
+		std::vector<const Variable *>::size_type writes;
+		bool pure;
+		bool side_effect_free;
+		std::vector<const Variable *> saved_reads;
+		std::vector<const Variable *> saved_writes;
+		VariableIdSet saved_read_ids;
+		VariableIdSet saved_write_ids;
+	};
+	struct UndoLog {
+		std::vector<Undo> entries;
+		int depth;
+	};
+
+	void record(bool rewrite);
+
+	// NULL unless a checkpoint is open
+	UndoLog *undo_;
+
 	static const Effect empty_effect;
 };
 
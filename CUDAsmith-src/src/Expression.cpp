@@ -63,14 +63,15 @@ namespace CUDASmith {
 Expression *make_random(CGContext &cg_context, const Type *type, const CVQualifiers* qfer); // Hook
 }  // namespace CUDASmith
 
-int eid = 0;
+thread_local int eid = 0;
 
-DistributionTable Expression::exprTable_;
-DistributionTable Expression::paramTable_;
+thread_local DistributionTable Expression::exprTable_;
+thread_local DistributionTable Expression::paramTable_;
 
 void
 Expression::InitExprProbabilityTable()
 { 
+	exprTable_ = DistributionTable();
 	exprTable_.add_entry((int)eFunction, 70);  
 	exprTable_.add_entry((int)eVariable, 20);
 	exprTable_.add_entry((int)eConstant, 10);
@@ -86,6 +87,7 @@ Expression::InitExprProbabilityTable()
 void
 Expression::InitParamProbabilityTable()
 {
+	paramTable_ = DistributionTable();
 	paramTable_.add_entry((int)eFunction, 40);  
 	paramTable_.add_entry((int)eVariable, 40);
 	// constant parameters lead to non-interesting code 
@@ -105,6 +107,12 @@ Expression::InitProbabilityTables()
 	Expression::InitParamProbabilityTable();
 }
 
+void
+Expression::doFinalization(void)
+{
+	eid = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /*
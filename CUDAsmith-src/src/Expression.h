@@ -45,6 +45,7 @@
 #include "CGContext.h"
 #include "CVQualifiers.h"
 #include "ProbabilityTable.h"
+#include "NodeArena.h"
 #include <vector>
 #include <string>
 using namespace std;
@@ -101,11 +102,18 @@ public:
 
 	static void InitProbabilityTables();
 
+	static void doFinalization(void);
+
 	Expression(eTermType e);
 
 	Expression(const Expression &expr);
 
 	virtual ~Expression(void);
+
+	// allocated from the per-program NodeArena
+	static void *operator new(size_t size) { return NodeArena::allocate(size); }
+	static void operator delete(void *p, size_t size) { NodeArena::deallocate(p, size); }
+
 	
 	virtual Expression *clone() const = 0;
 
@@ -119,7 +127,7 @@ public:
 
 	virtual const FunctionInvocation* get_invoke(void) const {return NULL;};
 
-	virtual bool visit_facts(vector<const Fact*>& /*inputs*/, CGContext& /*cg_context*/) const {return true;};
+	virtual bool visit_facts(FactVec& /*inputs*/, CGContext& /*cg_context*/) const {return true;};
 
 	virtual std::vector<const ExpressionVariable*> get_dereferenced_ptrs(void) const;
 	virtual void get_referenced_ptrs(std::vector<const Variable*>& ptrs) const = 0;
@@ -163,8 +171,8 @@ private:
 	static void InitExprProbabilityTable();
 	static void InitParamProbabilityTable();
 
-	static DistributionTable exprTable_;
-	static DistributionTable paramTable_;
+	static thread_local DistributionTable exprTable_;
+	static thread_local DistributionTable paramTable_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
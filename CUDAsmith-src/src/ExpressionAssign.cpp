@@ -121,7 +121,7 @@ ExpressionAssign::get_eval_to_subexps(vector<const Expression*>& subs) const
 }
 
 bool 
-ExpressionAssign::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const 
+ExpressionAssign::visit_facts(FactVec& inputs, CGContext& cg_context) const 
 {
 	return assign->visit_facts(inputs, cg_context);
 }
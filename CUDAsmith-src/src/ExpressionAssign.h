@@ -61,7 +61,7 @@ public:
 
 	virtual void get_called_funcs(std::vector<const FunctionInvocationUser*>& funcs) const { assign->get_called_funcs(funcs);}
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual bool has_uncertain_call_recursive(void) const { return assign->has_uncertain_call_recursive();} 
  
@@ -89,7 +89,7 @@ ExpressionComma::clone(void) const
 }
 
 bool 
-ExpressionComma::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const 
+ExpressionComma::visit_facts(FactVec& inputs, CGContext& cg_context) const 
 {
 	if (!lhs.visit_facts(inputs, cg_context)) {
 		return false;
@@ -74,23 +74,19 @@ ExpressionFuncall::make_random(CGContext &cg_context, const Type* type, const CV
 	if (type && ((type->eType != eSimple && type->eType != eVector) || type->simple_type == eVoid))
 		std_func = false;
 
-	Effect effect_accum = cg_context.get_accum_effect();
-	Effect effect_stm = cg_context.get_effect_stm(); 
-	FactMgr* fm = get_fact_mgr(&cg_context);
-	vector<const Fact*> facts_copy = fm->global_facts; 
+	AttemptCheckpoint attempt(cg_context, true, get_fact_mgr(&cg_context));
 	FunctionInvocation *fi = FunctionInvocation::make_random(std_func, cg_context, type, qfer);
 	ERROR_GUARD(NULL);
 
 	if (fi->failed) { 
 		// if it's a invalid invocation, (see FunctionInvocationUser::revisit) 
 		// restore the env, and replace invocation with a simple var
-		cg_context.reset_effect_accum(effect_accum);
-		cg_context.reset_effect_stm(effect_stm);
-		fm->restore_facts(facts_copy);
+		attempt.rollback();
 		e = ExpressionVariable::make_random(cg_context, type, qfer);
 		delete fi;
 	}
 	else {
+		attempt.commit();
 		e = new ExpressionFuncall(*fi);
 	}
 	return e;
@@ -155,7 +151,7 @@ ExpressionFuncall::get_complexity(void) const
 }
 
 bool 
-ExpressionFuncall::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+ExpressionFuncall::visit_facts(FactVec& inputs, CGContext& cg_context) const
 { 
 	return invoke.visit_facts(inputs, cg_context);
 }
@@ -68,7 +68,7 @@ public:
 
 	virtual unsigned int get_complexity(void) const;
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual bool has_uncertain_call_recursive(void) const; 
 
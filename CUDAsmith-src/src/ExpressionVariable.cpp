@@ -58,9 +58,8 @@ ExpressionVariable::make_random(CGContext &cg_context, const Type* type, const C
 	FactMgr* fm = get_fact_mgr_for_func(curr_func);
 	vector<const Variable*> dummy; 
 
-	// save current effects, in case we need to reset 
-	Effect eff_accum = cg_context.get_accum_effect();
-	Effect eff_stmt = cg_context.get_effect_stm();
+	// checkpoint current effects, in case we need to reset 
+	AttemptCheckpoint attempt(cg_context, true);
   
 	ExpressionVariable *ev = 0;
 	do {
@@ -98,11 +97,11 @@ ExpressionVariable::make_random(CGContext &cg_context, const Type* type, const C
 			if (tmp.visit_facts(fm->global_facts, cg_context)) { 
 				ev = tmp.get_indirect_level() == 0 ? new ExpressionVariable(*var) : new ExpressionVariable(*var, type); 
 				cg_context.curr_blk = cg_context.get_current_block();
+				attempt.commit();
 				break;
 			}  
 			else {
-				cg_context.reset_effect_accum(eff_accum);
-				cg_context.reset_effect_stm(eff_stmt);
+				attempt.retry();
 			}
 		}
 		dummy.push_back(var);
@@ -244,7 +243,7 @@ ExpressionVariable::get_referenced_ptrs(std::vector<const Variable*>& ptrs) cons
 }
 
 bool 
-ExpressionVariable::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+ExpressionVariable::visit_facts(FactVec& inputs, CGContext& cg_context) const
 { 
 	int deref_level = get_indirect_level();
 	const Variable* v = get_var();   
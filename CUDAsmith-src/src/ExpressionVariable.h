@@ -70,7 +70,7 @@ public:
 
 	virtual unsigned int get_complexity(void) const { return 1;}
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual const Type &get_type(void) const;
 
@@ -37,7 +37,7 @@
 #include "StatementReturn.h"
 
 using namespace std; 
-std::vector<Fact*> Fact::facts_;
+thread_local std::vector<Fact*> Fact::facts_;
  
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -75,28 +75,28 @@ Fact::OutputAssertion(std::ostream &out, const Statement* s) const
     }
 }
 
-std::vector<const Fact*>
-Fact::abstract_fact_for_return(const std::vector<const Fact*>& facts, const ExpressionVariable* expr, const Function* func)
+FactVec
+Fact::abstract_fact_for_return(const FactVec& facts, const ExpressionVariable* expr, const Function* func)
 { 
 	Lhs lhs(*func->rv);
 	return abstract_fact_for_assign(facts, &lhs, expr);
 }
 
-vector<const Fact*>
+FactVec
 Fact::abstract_fact_for_var_init(const Variable* v)
 {
-	vector<const Fact*> empty;
+	FactVec empty;
 	// only consider points-to facts and union-write-field facts for now
 	if (v->type == NULL || (v->type->eType != ePointer && v->type->eType != eUnion)) return empty;
 
 	Lhs lhs(*v);
-	vector<const Fact*> facts = abstract_fact_for_assign(empty, &lhs, v->init);
+	FactVec facts = abstract_fact_for_assign(empty, &lhs, v->init);
 	if (v->isArray) {
 		const ArrayVariable* av = dynamic_cast<const ArrayVariable*>(v); 
 		assert(av);
 		for (size_t i=0; i<av->get_more_init_values().size(); i++) {
 			const Expression* init = av->get_more_init_values()[i];
-			vector<const Fact*> more_facts = abstract_fact_for_assign(empty, &lhs, init); 
+			FactVec more_facts = abstract_fact_for_assign(empty, &lhs, init); 
 			merge_facts(facts, more_facts);
 		}
 	}
@@ -113,6 +113,208 @@ Fact::doFinalization()
 	facts_.clear();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Below this size a linear scan is cheaper than maintaining the index.
+static const size_t FACTVEC_INDEX_THRESHOLD = 8;
+
+FactVec::~FactVec(void)
+{
+	delete undo_;
+}
+
+FactVec&
+FactVec::operator=(const FactVec& facts)
+{
+	if (this != &facts) {
+		if (undo_) {
+			record(Undo::uAssign, 0, facts_.size(), 0);
+		}
+		facts_ = facts.facts_;
+		index_.clear();
+		index_valid_ = false;
+	}
+	return *this;
+}
+
+FactVec::Key
+FactVec::key_of(const Fact* f)
+{
+	return Key(f->eCat, f->get_var());
+}
+
+void
+FactVec::build_index(void) const
+{
+	index_.clear();
+	for (size_type i = 0; i < facts_.size(); i++) {
+		index_.insert(std::make_pair(key_of(facts_[i]), i));
+	}
+	index_valid_ = true;
+}
+
+void
+FactVec::push_back(const Fact* f)
+{
+	if (undo_) {
+		record(Undo::uInsert, facts_.size(), 1, 0);
+	}
+	facts_.push_back(f);
+	if (index_valid_) {
+		// keeps the earlier position if there is already a related fact
+		index_.insert(std::make_pair(key_of(f), facts_.size() - 1));
+	}
+}
+
+void
+FactVec::set(size_type i, const Fact* f)
+{
+	if (index_valid_ && !(key_of(facts_[i]) == key_of(f))) {
+		index_valid_ = false;
+	}
+	if (undo_) {
+		record(Undo::uSet, i, 1, facts_[i]);
+	}
+	facts_[i] = f;
+}
+
+FactVec::const_iterator
+FactVec::erase(const_iterator pos)
+{
+	size_type i = pos - facts_.begin();
+	if (undo_) {
+		record(Undo::uErase, i, 1, 0);
+	}
+	if (index_valid_) {
+		if (i + 1 == facts_.size()) {
+			std::unordered_map<Key, size_type, KeyHash>::iterator k = index_.find(key_of(facts_[i]));
+			if (k != index_.end() && k->second == i) {
+				index_.erase(k);
+			}
+		}
+		else {
+			index_valid_ = false;
+		}
+	}
+	return facts_.erase(facts_.begin() + i);
+}
+
+FactVec::const_iterator
+FactVec::erase(const_iterator first, const_iterator last)
+{
+	if (undo_) {
+		record(Undo::uErase, first - facts_.begin(), last - first, 0);
+	}
+	index_valid_ = false;
+	return facts_.erase(facts_.begin() + (first - facts_.begin()), facts_.begin() + (last - facts_.begin()));
+}
+
+void
+FactVec::clear(void)
+{
+	if (undo_) {
+		record(Undo::uAssign, 0, facts_.size(), 0);
+	}
+	facts_.clear();
+	index_.clear();
+	index_valid_ = false;
+}
+
+int
+FactVec::find_related(const Fact* f) const
+{
+	if (facts_.size() < FACTVEC_INDEX_THRESHOLD) {
+		for (size_type i = 0; i < facts_.size(); i++) {
+			if (f->is_related(*facts_[i])) {
+				return i;
+			}
+		}
+		return -1;
+	}
+	if (!index_valid_) {
+		build_index();
+	}
+	std::unordered_map<Key, size_type, KeyHash>::const_iterator k = index_.find(key_of(f));
+	return k == index_.end() ? -1 : static_cast<int>(k->second);
+}
+
+void
+FactVec::record(Undo::Op op, size_type pos, size_type count, const Fact* fact)
+{
+	Undo u;
+	u.op = op;
+	u.pos = pos;
+	u.count = count;
+	u.saved = undo_->saved.size();
+	u.fact = fact;
+	if (op == Undo::uErase || op == Undo::uAssign) {
+		undo_->saved.insert(undo_->saved.end(), facts_.begin() + pos, facts_.begin() + pos + count);
+	}
+	undo_->entries.push_back(u);
+}
+
+size_t
+FactVec::checkpoint(void)
+{
+	if (undo_ == 0) {
+		undo_ = new UndoLog;
+		undo_->depth = 0;
+	}
+	undo_->depth++;
+	return undo_->entries.size();
+}
+
+void
+FactVec::close_checkpoint(void)
+{
+	// the changes of a nested checkpoint stay in the log for the outer ones
+	if (--undo_->depth == 0) {
+		delete undo_;
+		undo_ = 0;
+	}
+}
+
+void
+FactVec::commit(size_t cp)
+{
+	assert(undo_ && cp <= undo_->entries.size());
+	close_checkpoint();
+}
+
+void
+FactVec::rollback(size_t cp)
+{
+	assert(undo_ && cp <= undo_->entries.size());
+	if (undo_->entries.size() > cp) {
+		index_.clear();
+		index_valid_ = false;
+	}
+	while (undo_->entries.size() > cp) {
+		Undo u = undo_->entries.back();
+		undo_->entries.pop_back();
+		std::vector<const Fact*>::iterator saved = undo_->saved.begin() + u.saved;
+		switch (u.op) {
+		case Undo::uInsert:
+			facts_.erase(facts_.begin() + u.pos, facts_.begin() + u.pos + u.count);
+			break;
+		case Undo::uErase:
+			facts_.insert(facts_.begin() + u.pos, saved, saved + u.count);
+			undo_->saved.erase(saved, undo_->saved.end());
+			break;
+		case Undo::uSet:
+			facts_[u.pos] = u.fact;
+			break;
+		case Undo::uAssign:
+			facts_.assign(saved, saved + u.count);
+			undo_->saved.erase(saved, undo_->saved.end());
+			break;
+		}
+	}
+	close_checkpoint();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 // fact manipulating functions
 int 
 find_fact(const FactVec& facts, const Fact* fact)
@@ -129,13 +331,8 @@ find_fact(const FactVec& facts, const Fact* fact)
 const Fact* 
 find_related_fact(const FactVec& facts, const Fact* new_fact)
 {
-    size_t i; 
-    for (i=0; i<facts.size(); i++) {
-        if (new_fact->is_related(*facts[i])) {
-            return facts[i];
-        }
-    }
-    return 0;
+    int i = facts.find_related(new_fact);
+    return i < 0 ? 0 : facts[i];
 }
 
 const Fact* 
@@ -156,24 +353,21 @@ bool
 merge_fact(FactVec& facts, const Fact* new_fact)
 { 
     bool changed = false; 
-    size_t i; 
-    for (i=0; i<facts.size(); i++) {
+    int i = facts.find_related(new_fact);
+    if (i >= 0) {
         const Fact* f = facts[i]; 
-        if (f->is_related(*new_fact)) {
-            if (!f->imply(*new_fact)) {
-				Fact* copy_fact = new_fact->clone();
-                copy_fact->join(*f);    
-                facts[i] = copy_fact;
-                changed = true;
-				// TODO: release the memory for f???
-            } 
-            else {
-                //delete new_fact;   // new fact is useless, unsafe to do so???
-            }
-            break;
+        if (!f->imply(*new_fact)) {
+			Fact* copy_fact = new_fact->clone();
+            copy_fact->join(*f);    
+            facts.set(i, copy_fact);
+            changed = true;
+			// TODO: release the memory for f???
+        } 
+        else {
+            //delete new_fact;   // new fact is useless, unsafe to do so???
         }
     }  
-    if (i == facts.size()) {// if not found 
+    else {// if not found 
         facts.push_back(new_fact);
         changed = true;
     } 
@@ -183,18 +377,15 @@ merge_fact(FactVec& facts, const Fact* new_fact)
 bool
 renew_fact(FactVec& facts, const Fact* new_fact)
 { 
-    size_t i; 
-    for (i=0; i<facts.size(); i++) {
-        if (new_fact->is_related(*facts[i])) { 
-            if (new_fact->equal(*facts[i])) {
-                return false;
-            }
-            facts[i] = new_fact; 
-            break;
+    int i = facts.find_related(new_fact);
+    if (i >= 0) { 
+        if (new_fact->equal(*facts[i])) {
+            return false;
         }
+        facts.set(i, new_fact); 
     } 
     // if not found, append the new fact
-    if (i==facts.size()) {
+    else {
         facts.push_back(new_fact);
     }
     return true;
@@ -32,7 +32,10 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <cstddef>
 #include <ostream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 using namespace std;
 
@@ -54,6 +57,110 @@ class Expression;
 class Lhs;
 class Function;
 class ExpressionVariable;
+class Fact;
+
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+ * A facts environment: an ordered list of facts with an index from
+ * (fact category, variable) to the first related fact, so that
+ * find_related_fact does not have to scan the whole list. The index is
+ * only built for environments large enough to benefit from it, and is
+ * rebuilt lazily after facts are removed or replaced by unrelated ones.
+ */
+class FactVec
+{
+public:
+	typedef std::vector<const Fact*>::const_iterator iterator;
+	typedef std::vector<const Fact*>::const_iterator const_iterator;
+	typedef std::vector<const Fact*>::size_type size_type;
+	typedef const Fact* value_type;
+
+	FactVec(void) : index_valid_(false), undo_(0) {}
+	FactVec(const FactVec& facts) : facts_(facts.facts_), index_valid_(false), undo_(0) {}
+	template <class InputIterator>
+	FactVec(InputIterator first, InputIterator last) : facts_(first, last), index_valid_(false), undo_(0) {}
+	~FactVec(void);
+
+	FactVec& operator=(const FactVec& facts);
+
+	size_type size(void) const { return facts_.size(); }
+	bool empty(void) const { return facts_.empty(); }
+	const Fact* operator[](size_type i) const { return facts_[i]; }
+	const Fact* back(void) const { return facts_.back(); }
+	const_iterator begin(void) const { return facts_.begin(); }
+	const_iterator end(void) const { return facts_.end(); }
+
+	void push_back(const Fact* f);
+	void set(size_type i, const Fact* f);
+	const_iterator erase(const_iterator pos);
+	const_iterator erase(const_iterator first, const_iterator last);
+	template <class InputIterator>
+	void insert(const_iterator pos, InputIterator first, InputIterator last) {
+		size_type i = pos - facts_.begin();
+		size_type n = facts_.size();
+		index_valid_ = false;
+		facts_.insert(facts_.begin() + i, first, last);
+		if (undo_) {
+			record(Undo::uInsert, i, facts_.size() - n, 0);
+		}
+	}
+	void clear(void);
+
+	/*
+	 * Undo log: between checkpoint() and the matching commit() or
+	 * rollback(), changes to this environment are recorded, so that
+	 * rollback() can take it back without the caller having to copy it
+	 * beforehand. Checkpoints nest; copies of a FactVec never share the log.
+	 */
+	size_t checkpoint(void);
+	void commit(size_t cp);
+	void rollback(size_t cp);
+
+	/* position of the first fact related to f (see Fact::is_related), or -1 */
+	int find_related(const Fact* f) const;
+
+	bool operator==(const FactVec& facts) const { return facts_ == facts.facts_; }
+	bool operator!=(const FactVec& facts) const { return facts_ != facts.facts_; }
+
+private:
+	typedef std::pair<int, const Variable*> Key;
+	struct KeyHash {
+		size_t operator()(const Key& k) const {
+			return std::hash<const Variable*>()(k.second) * 31 + k.first;
+		}
+	};
+
+	static Key key_of(const Fact* f);
+
+	void build_index(void) const;
+
+	// one recorded change, and how to undo it
+	struct Undo {
+		enum Op { uInsert, uErase, uSet, uAssign } op;
+		size_type pos;
+		size_type count;
+		size_type saved;		// uErase, uAssign: where the removed facts are in UndoLog::saved
+		const Fact* fact;		// uSet: the replaced fact
+	};
+	struct UndoLog {
+		std::vector<Undo> entries;
+		std::vector<const Fact*> saved;
+		int depth;
+	};
+
+	void record(Undo::Op op, size_type pos, size_type count, const Fact* fact);
+	void close_checkpoint(void);
+
+	std::vector<const Fact*> facts_;
+
+	// position of the first fact for each (category, variable)
+	mutable std::unordered_map<Key, size_type, KeyHash> index_;
+	mutable bool index_valid_;
+
+	// NULL unless a checkpoint is open
+	UndoLog* undo_;
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -80,6 +187,8 @@ public:
 	
 	virtual bool is_assertable(const Statement* s) const = 0;
 
+	// FactVec indexes facts by (eCat, get_var()): facts with a different
+	// category or variable must never be related.
 	virtual bool is_related(const Fact& fact) const { return eCat == fact.eCat && get_var() == fact.get_var();}
 
 	virtual bool equal(const Fact& fact) const { return this == &fact; };
@@ -90,11 +199,11 @@ public:
 
 	virtual const Variable* get_var(void) const { return 0;};
 
-	virtual std::vector<const Fact*> abstract_fact_for_assign(const std::vector<const Fact*>& /*facts*/, const Lhs* /*lhs*/, const Expression* /*rhs*/) = 0;
+	virtual FactVec abstract_fact_for_assign(const FactVec& /*facts*/, const Lhs* /*lhs*/, const Expression* /*rhs*/) = 0;
 
-	virtual vector<const Fact*> abstract_fact_for_return(const std::vector<const Fact*>& facts, const ExpressionVariable* expr, const Function* func);
+	virtual FactVec abstract_fact_for_return(const FactVec& facts, const ExpressionVariable* expr, const Function* func);
 
-	vector<const Fact*> abstract_fact_for_var_init(const Variable* v);
+	FactVec abstract_fact_for_var_init(const Variable* v);
 
 	static void doFinalization();
 
@@ -102,11 +211,10 @@ public:
 
 protected: 
 	// keep track all created facts. used for releasing memory in doFinalization
-	static std::vector<Fact*> facts_;
+	static thread_local std::vector<Fact*> facts_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
-typedef std::vector<const Fact*> FactVec;
 typedef FactVec* FactVecP;
 
 /******************* Fact Manipulating Functions **********************/
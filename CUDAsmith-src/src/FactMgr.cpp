@@ -61,7 +61,7 @@
 
 using namespace std; 
  
-std::vector<Fact*> FactMgr::meta_facts;
+thread_local std::vector<Fact*> FactMgr::meta_facts;
 
 void
 FactMgr::add_new_var_fact_and_update_inout_maps(const Block* blk, const Variable* var)
@@ -81,20 +81,22 @@ FactMgr::add_new_var_fact_and_update_inout_maps(const Block* blk, const Variable
 				global_facts.push_back(f);
 			} 
 
-			map<const Statement*, FactVec>::iterator iter;
-			for(iter = map_facts_in.begin(); iter != map_facts_in.end(); ++iter) {  
-				const Statement* stm = iter->first;
+			size_t slot;
+			for(slot = 0; slot < map_facts_in.slot_count(); ++slot) {  
+				if (!map_facts_in.has_slot(slot)) continue;
+				const Statement* stm = map_facts_in.slot_stm(slot);
 				if (stm && (stm->in_block(blk) || blk == NULL)) {
-					iter->second.push_back(f);
+					map_facts_in.slot_facts(slot).push_back(f);
 				}
 			}
-			for(iter = map_facts_out.begin(); iter != map_facts_out.end(); ++iter) {  
-				const Statement* stm = iter->first;
+			for(slot = 0; slot < map_facts_out.slot_count(); ++slot) {  
+				if (!map_facts_out.has_slot(slot)) continue;
+				const Statement* stm = map_facts_out.slot_stm(slot);
 				assert(stm);
 				if (blk) {
 					add_fact_out(stm, f);
 				} else {
-					iter->second.push_back(f);
+					map_facts_out.slot_facts(slot).push_back(f);
 				}
 			} 
 		}
@@ -143,20 +145,22 @@ FactMgr::update_facts_for_oos_vars(const vector<const Variable*>& vars, FactVec&
 {
 	//print_facts(facts);
 	size_t i, j;
-	// remove all facts related to vars, as they become irrelevant going out of scope
-	for (i=0; i<vars.size(); i++) {
-		const Variable* var = vars[i];
-		size_t len = facts.size();
-		for (j=0; j<len; j++) {
-			//print_facts(facts);
-			// remove all facts related to this variable
-			const Fact* f = facts[j];
-			if (var->match(f->get_var())) {
-				facts.erase(facts.begin() + j);
-				len--;
-				j--;
+	// remove all facts related to vars, as they become irrelevant going out of scope.
+	// Done in one pass over the facts rather than erasing them one by one.
+	FactVec kept;
+	for (j=0; j<facts.size(); j++) {
+		const Fact* f = facts[j];
+		for (i=0; i<vars.size(); i++) {
+			if (vars[i]->match(f->get_var())) {
+				break;
 			}
 		}
+		if (i == vars.size()) {
+			kept.push_back(f);
+		}
+	}
+	if (kept.size() != facts.size()) {
+		facts = kept;
 	}
 	// mark any remaining facts that may point to a out-of-scope variable as "point to garbage"
 	for (i=0; i<vars.size(); i++) {
@@ -166,7 +170,7 @@ FactMgr::update_facts_for_oos_vars(const vector<const Variable*>& vars, FactVec&
 				FactPointTo* f = (FactPointTo*)(facts[j]);
 				FactPointTo* new_fact = f->mark_dead_var(var);
 				if (new_fact) {
-					facts[j] = new_fact;
+					facts.set(j, new_fact);
 				}
 			}
 		}
@@ -178,23 +182,24 @@ FactMgr::update_facts_for_oos_vars(const vector<const Variable*>& vars, FactVec&
  * hint: relevant facts are those concerns variable visible at the end of this function
  */
 void 
-FactMgr::remove_function_local_facts(std::vector<const Fact*>& inputs, const Statement* stm)
+FactMgr::remove_function_local_facts(FactVec& inputs, const Statement* stm)
 {
 	size_t i;
-	size_t len = inputs.size();
 	assert(stm->func);
 	const Function* func = stm->func;
 	// remove irrelevant facts
-	for (i=0; i<len; i++) {
+	FactVec kept;
+	for (i=0; i<inputs.size(); i++) {
 		const Variable* v = inputs[i]->get_var();
 		// if it's fact for a local variable of this function, or return variable
 		// of another function, we are not interested in them after exit function
-		if (func->is_var_on_stack(v, stm) || (v->is_rv() && !func->rv->match(v))) { 
-			inputs.erase(inputs.begin() + i);
-			i--;
-			len--; 
+		if (!(func->is_var_on_stack(v, stm) || (v->is_rv() && !func->rv->match(v)))) { 
+			kept.push_back(inputs[i]);
 		}
 	}
+	if (kept.size() != inputs.size()) {
+		inputs = kept;
+	}
 	// mark any remaining facts that may point to a local vars of this 
 	// function as "point to garbage"  
 	for (i=0; i<inputs.size(); i++) {
@@ -202,7 +207,7 @@ FactMgr::remove_function_local_facts(std::vector<const Fact*>& inputs, const Sta
 			FactPointTo* f = (FactPointTo*)(inputs[i]);
 			FactPointTo* new_fact = f->mark_func_end(stm);
 			if (new_fact) {
-				inputs[i] = new_fact;
+				inputs.set(i, new_fact);
 			}
 		}
 	}
@@ -213,15 +218,17 @@ FactMgr::setup_in_out_maps(bool first_time)
 {
 	if (first_time) {
 		// first time revisit, create map_facts_in_final and map_facts_out_final with cloned facts 
-		map<const Statement*, vector<const Fact*> >::const_iterator iter;
-		for(iter = map_facts_in.begin(); iter != map_facts_in.end(); ++iter) {
-			const Statement* stm = iter->first;
-			const vector<const Fact*>& facts1 = iter->second;
+		size_t slot;
+		for(slot = 0; slot < map_facts_in.slot_count(); ++slot) {
+			if (!map_facts_in.has_slot(slot)) continue;
+			const Statement* stm = map_facts_in.slot_stm(slot);
+			const FactVec& facts1 = map_facts_in.get(stm);
 			map_facts_in_final[stm] = copy_facts(facts1);
 		}    
-		for(iter = map_facts_out.begin(); iter != map_facts_out.end(); ++iter) {
-			const Statement* stm = iter->first;
-			const vector<const Fact*>& facts1 = iter->second; 
+		for(slot = 0; slot < map_facts_out.slot_count(); ++slot) {
+			if (!map_facts_out.has_slot(slot)) continue;
+			const Statement* stm = map_facts_out.slot_stm(slot);
+			const FactVec& facts1 = map_facts_out.get(stm); 
 			map_facts_out_final[stm] = copy_facts(facts1);
 		}    
 	}
@@ -232,13 +239,13 @@ FactMgr::setup_in_out_maps(bool first_time)
 		for(iter = map_facts_in_final.begin(); iter != map_facts_in_final.end(); ++iter) {
 			const Statement* stm = iter->first;
 			vector<Fact*>& facts1 = iter->second;
-			const FactVec& facts2 = map_facts_in[stm]; 
+			const FactVec& facts2 = map_facts_in.get(stm); 
 			combine_facts(facts1, facts2);
 		}    
 		for(iter = map_facts_out_final.begin(); iter != map_facts_out_final.end(); ++iter) {
 			const Statement* stm = iter->first;
 			vector<Fact*>& facts1 = iter->second;
-			const FactVec& facts2 = map_facts_out[stm];
+			const FactVec& facts2 = map_facts_out.get(stm);
 			combine_facts(facts1, facts2);
 		}     
 	}
@@ -318,13 +325,13 @@ FactMgr::add_fact_out(const Statement* stm, const Fact* fact)
  *				for example: { int i; func(&i)}. The facts of i will not be removed
  */
 void 
-FactMgr::caller_to_callee_handover(const FunctionInvocationUser* fiu, std::vector<const Fact*>& inputs)
+FactMgr::caller_to_callee_handover(const FunctionInvocationUser* fiu, FactVec& inputs)
 {
 	// add parameter facts
 	add_param_facts(fiu->param_value, inputs);
 
 	size_t i, j, cnt;
-	std::vector<const Fact*> keep_facts;
+	FactVec keep_facts;
 	size_t len = inputs.size();
 	// move global facts and parameter facts to a separate "keep" list
 	for (i=0; i<len; i++) {
@@ -382,7 +389,7 @@ FactMgr::update_fact_for_assign(const Lhs* lhs, const Expression* rhs, FactVec&
 {
 	bool changed = false;
     for (size_t i=0; i<FactMgr::meta_facts.size(); i++) {
-        vector<const Fact*> facts = FactMgr::meta_facts[i]->abstract_fact_for_assign(inputs, lhs, rhs);
+        FactVec facts = FactMgr::meta_facts[i]->abstract_fact_for_assign(inputs, lhs, rhs);
 		if (facts.size() == 1 && !facts[0]->get_var()->isArray) { 
 			// for must-point-to fact concerning no-array variable, just renew the old fact
 			renew_fact(inputs, facts[0]); 
@@ -416,7 +423,7 @@ FactMgr::update_fact_for_return(const StatementReturn* sr, FactVec& inputs)
 {
 	size_t i, j;
     for (i=0; i<FactMgr::meta_facts.size(); i++) {
-        std::vector<const Fact*> facts = FactMgr::meta_facts[i]->abstract_fact_for_return(inputs, sr->get_var(), sr->func);
+        FactVec facts = FactMgr::meta_facts[i]->abstract_fact_for_return(inputs, sr->get_var(), sr->func);
 		for (j=0; j<facts.size(); j++) {
 			// merge with other return statements
 			if (merge_fact(inputs, facts[j])) {
@@ -466,11 +473,97 @@ FactMgr::update_facts_for_dest(const FactVec& facts_in, FactVec& facts_out, cons
 
 ///////////////////////////////////////////////////////////////////////////////
 
+size_t
+StmSlots::slot_of(const Statement* stm)
+{
+	if (stm && stm->fact_slot >= 0) {
+		size_t slot = stm->fact_slot;
+		if (slot < stms_.size() && stms_[slot] == stm) {
+			return slot;
+		}
+	}
+	else if (stm) {
+		stm->fact_slot = stms_.size();
+		stms_.push_back(stm);
+		return stm->fact_slot;
+	}
+	map<const Statement*, size_t>::iterator iter = others_.find(stm);
+	if (iter != others_.end()) {
+		return iter->second;
+	}
+	others_[stm] = stms_.size();
+	stms_.push_back(stm);
+	return stms_.size() - 1;
+}
+
+std::shared_ptr<FactVec>&
+StmFactMap::entry(const Statement* stm)
+{
+	assert(slots_);
+	size_t slot = slots_->slot_of(stm);
+	if (table_.use_count() > 1) {
+		table_ = std::make_shared<Table>(*table_);
+	}
+	if (slot >= table_->size()) {
+		table_->resize(slot + 1);
+	}
+	std::shared_ptr<FactVec>& facts = (*table_)[slot];
+	if (!facts) {
+		facts = std::make_shared<FactVec>();
+	}
+	return facts;
+}
+
+FactVec&
+StmFactMap::operator[](const Statement* stm)
+{
+	std::shared_ptr<FactVec>& facts = entry(stm);
+	if (facts.use_count() > 1) {
+		facts = std::make_shared<FactVec>(*facts);
+	}
+	return *facts;
+}
+
+const FactVec&
+StmFactMap::get(const Statement* stm)
+{
+	if (slots_ && stm && stm->fact_slot >= 0) {
+		size_t slot = stm->fact_slot;
+		if (slot < table_->size() && (*table_)[slot] && slots_->stm_at(slot) == stm) {
+			return *(*table_)[slot];
+		}
+	}
+	return *entry(stm);
+}
+
+void
+StmFactMap::assign(const Statement* stm, const StmFactMap& other)
+{
+	std::shared_ptr<FactVec>& facts = entry(stm);
+	size_t slot = slots_->slot_of(stm);
+	if (slot < other.table_->size() && (*other.table_)[slot]) {
+		facts = (*other.table_)[slot];
+	}
+	else {
+		facts = std::make_shared<FactVec>();
+	}
+}
+
+FactVec&
+StmFactMap::slot_facts(size_t slot)
+{
+	return (*this)[slots_->stm_at(slot)];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 /*
  * 
  */
 FactMgr::FactMgr(const Function* f)
-: func(f)
+: map_facts_in(&stm_slots),
+  map_facts_out(&stm_slots),
+  func(f)
 { 
 }
 
@@ -503,14 +596,25 @@ FactMgr::add_interested_facts(int interests)
 } 
 
 void 
-FactMgr::restore_facts(vector<const Fact*>& old_facts)
+FactMgr::restore_facts(FactVec& old_facts)
 {
 	makeup_new_var_facts(old_facts, global_facts);
 	global_facts = old_facts;
 }
 
+/*
+ * like restore_facts, for a checkpoint of global_facts
+ */
+void 
+FactMgr::rollback_facts(size_t cp)
+{
+	FactVec new_facts = global_facts;
+	global_facts.rollback(cp);
+	makeup_new_var_facts(global_facts, new_facts);
+}
+
 void 
-FactMgr::makeup_new_var_facts(vector<const Fact*>& old_facts, const vector<const Fact*>& new_facts)
+FactMgr::makeup_new_var_facts(FactVec& old_facts, const FactVec& new_facts)
 {
     size_t i; 
     for (i=0; i<new_facts.size(); i++) { 
@@ -536,38 +640,53 @@ FactMgr::clear_map_visited(void)
 	}
 }
 
+/*
+ * make sure this statement and all statements included have (possibly empty) entries
+ */
 void
-FactMgr::backup_stm_fact_maps(const Statement* stm, map<const Statement*, FactVec>& facts_in, map<const Statement*, FactVec>& facts_out)
+FactMgr::touch_stm_fact_maps(const Statement* stm)
 {
 	vector<const Block*> blks;
 	stm->get_blocks(blks);
 	for (size_t i=0; i<blks.size(); i++) { 
 		const Block* b = blks[i];
-		facts_in[b] = map_facts_in[b];
-		facts_out[b] = map_facts_out[b];
+		map_facts_in.get(b);
+		map_facts_out.get(b);
 		for (size_t j=0; j<b->stms.size(); j++) {
-			backup_stm_fact_maps(b->stms[j], facts_in, facts_out);
+			touch_stm_fact_maps(b->stms[j]);
 		}
 	}
-	facts_in[stm] = map_facts_in[stm];
-	facts_out[stm] = map_facts_out[stm];
+	map_facts_in.get(stm);
+	map_facts_out.get(stm);
+}
+
+/*
+ * the backups are snapshots of the whole maps, which share the facts with
+ * the maps until they are modified
+ */
+void
+FactMgr::backup_stm_fact_maps(const Statement* stm, StmFactMap& facts_in, StmFactMap& facts_out)
+{
+	touch_stm_fact_maps(stm);
+	facts_in = map_facts_in;
+	facts_out = map_facts_out;
 }
 
 void
-FactMgr::restore_stm_fact_maps(const Statement* stm, map<const Statement*, FactVec>& facts_in, map<const Statement*, FactVec>& facts_out)
+FactMgr::restore_stm_fact_maps(const Statement* stm, const StmFactMap& facts_in, const StmFactMap& facts_out)
 {
 	vector<const Block*> blks;
 	stm->get_blocks(blks);
 	for (size_t i=0; i<blks.size(); i++) { 
 		const Block* b = blks[i];
-		map_facts_in[b] = facts_in[b];
-		map_facts_out[b] = facts_out[b];
+		map_facts_in.assign(b, facts_in);
+		map_facts_out.assign(b, facts_out);
 		for (size_t j=0; j<b->stms.size(); j++) {
 			restore_stm_fact_maps(b->stms[j], facts_in, facts_out);
 		}
 	}
-	map_facts_in[stm] = facts_in[stm];
-	map_facts_out[stm] = facts_out[stm];
+	map_facts_in.assign(stm, facts_in);
+	map_facts_out.assign(stm, facts_out);
 }
 
 /*
@@ -678,10 +797,10 @@ FactMgr::output_assertions(std::ostream &out, const Statement* stm, int indent,
 }
 
 void 
-FactMgr::find_updated_facts(const Statement* stm, vector<const Fact*>& facts)
+FactMgr::find_updated_facts(const Statement* stm, FactVec& facts)
 {
-	const FactVec& facts_in = map_facts_in[stm]; 
-	const FactVec& facts_out = map_facts_out[stm]; 
+	const FactVec& facts_in = map_facts_in.get(stm); 
+	const FactVec& facts_out = map_facts_out.get(stm); 
 	  
 	for (size_t i=0; i<facts_out.size(); i++) {
 		const Fact* f = facts_out[i];
@@ -735,10 +854,11 @@ FactMgr::find_dangling_global_ptrs(Function* f)
 void
 FactMgr::sanity_check_map() const
 {
-	map<const Statement*, vector<const Fact*> >::const_iterator iter; 
-	for(iter = map_facts_in.begin(); iter != map_facts_in.end(); ++iter) {
-		const Statement* stm = iter->first;
-		const vector<const Fact*>& facts = iter->second;
+	size_t slot;
+	for(slot = 0; slot < map_facts_in.slot_count(); ++slot) {
+		if (!map_facts_in.has_slot(slot)) continue;
+		const Statement* stm = map_facts_in.slot_stm(slot);
+		const FactVec& facts = map_facts_in.slot_facts(slot);
 		for (size_t i=0; i<facts.size(); i++) {
 			const Variable* v = facts[i]->get_var();
 			if (!v->is_visible(stm->parent)) {
@@ -751,9 +871,10 @@ FactMgr::sanity_check_map() const
 		}
 	} 
 		
-	for(iter = map_facts_out.begin(); iter != map_facts_out.end(); ++iter) {
-		const Statement* stm = iter->first;
-		const vector<const Fact*>& facts = iter->second;
+	for(slot = 0; slot < map_facts_out.slot_count(); ++slot) {
+		if (!map_facts_out.has_slot(slot)) continue;
+		const Statement* stm = map_facts_out.slot_stm(slot);
+		const FactVec& facts = map_facts_out.slot_facts(slot);
 		for (size_t i=0; i<facts.size(); i++) {
 			const Variable* v = facts[i]->get_var();
 			if (!v->is_visible(stm->parent) && !func->rv->match(v)) {
@@ -763,7 +884,7 @@ FactMgr::sanity_check_map() const
 	}
 }
 
-const vector<const Fact*>&
+const FactVec&
 FactMgr::get_program_end_facts(void)
 {
 	FactMgr* fm = get_fact_mgr_for_func(GetFirstFunction());
@@ -774,6 +895,7 @@ void
 FactMgr::doFinalization()
 {
 	Fact::doFinalization();
+	FactPointTo::doFinalization();
 	meta_facts.clear();
 }
 
@@ -56,12 +56,77 @@ class CFGEdge;
 #include <ostream>
 #include <vector>
 #include <map>
+#include <memory>
 #include "Effect.h"
 #include "Fact.h"
 using namespace std; 
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/*
+ * Dense slot numbers for the statements of one function, handed out the
+ * first time a statement is used as a key of one of its fact maps.
+ */
+class StmSlots
+{
+public:
+	size_t slot_of(const Statement* stm);
+
+	const Statement* stm_at(size_t slot) const { return stms_[slot]; }
+
+private:
+	std::vector<const Statement*> stms_;
+
+	// NULL and statements that already have a slot in another function
+	std::map<const Statement*, size_t> others_;
+};
+
+/*
+ * Facts environments keyed by statement, kept in a flat table indexed by
+ * the statement slots. Copies share the table and the environments in it
+ * until one side modifies them, so backing up the maps is O(1).
+ *
+ * Like std::map, looking up a statement without facts creates an empty
+ * entry. operator[] returns an environment that may be modified; use get()
+ * when only reading, it doesn't unshare the environment.
+ */
+class StmFactMap
+{
+public:
+	StmFactMap(void) : slots_(0), table_(new Table) {}
+
+	explicit StmFactMap(StmSlots* slots) : slots_(slots), table_(new Table) {}
+
+	FactVec& operator[](const Statement* stm);
+
+	const FactVec& get(const Statement* stm);
+
+	/* set the facts of stm to what they are in other (empty if absent) */
+	void assign(const Statement* stm, const StmFactMap& other);
+
+	/* slots may be absent, see has_slot */
+	size_t slot_count(void) const { return table_->size(); }
+
+	bool has_slot(size_t slot) const { return (*table_)[slot] != 0; }
+
+	const Statement* slot_stm(size_t slot) const { return slots_->stm_at(slot); }
+
+	FactVec& slot_facts(size_t slot);
+
+	const FactVec& slot_facts(size_t slot) const { return *(*table_)[slot]; }
+
+private:
+	typedef std::vector<std::shared_ptr<FactVec> > Table;
+
+	std::shared_ptr<FactVec>& entry(const Statement* stm);
+
+	StmSlots* slots_;
+
+	std::shared_ptr<Table> table_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class FactMgr
 {
 public:
@@ -81,9 +146,11 @@ public:
 
 	bool validate_assign(const Lhs* v, const Expression* e);
 
-	void restore_facts(vector<const Fact*>& old_facts);
+	void restore_facts(FactVec& old_facts);
+
+	void rollback_facts(size_t cp);
 
-	void makeup_new_var_facts(vector<const Fact*>& old_facts, const vector<const Fact*>& new_facts);
+	void makeup_new_var_facts(FactVec& old_facts, const FactVec& new_facts);
  
 	void add_new_var_fact_and_update_inout_maps(const Block* blk, const Variable* var); 
 
@@ -96,30 +163,30 @@ public:
 	void create_cfg_edge(const Statement* src, const Statement* dest, bool post_stm_edge, bool back_link);
 
 	void clear_map_visited(void);
-	void backup_stm_fact_maps(const Statement* stm, map<const Statement*, FactVec>& facts_in, map<const Statement*, FactVec>& facts_out);
-	void restore_stm_fact_maps(const Statement* stm, map<const Statement*, FactVec>& facts_in, map<const Statement*, FactVec>& facts_out);
+	void backup_stm_fact_maps(const Statement* stm, StmFactMap& facts_in, StmFactMap& facts_out);
+	void restore_stm_fact_maps(const Statement* stm, const StmFactMap& facts_in, const StmFactMap& facts_out);
 	void reset_stm_fact_maps(const Statement* stm);
 
 	void output_assertions(std::ostream &out, const Statement* stm, int indent, bool post_condition);
 	void find_updated_final_facts(const Statement* stm, vector<Fact*>& facts);
-	void find_updated_facts(const Statement* stm, vector<const Fact*>& facts);
+	void find_updated_facts(const Statement* stm, FactVec& facts);
 
 	void find_dangling_global_ptrs(Function* f);
 
 	/* add paramters facts to env */
 	void add_param_facts(const vector<const Expression*>& param_values, FactVec& facts);
-	void caller_to_callee_handover(const FunctionInvocationUser* fiu, std::vector<const Fact*>& inputs);
+	void caller_to_callee_handover(const FunctionInvocationUser* fiu, FactVec& inputs);
 
 	/* remove facts related to return variables (except rv of this function) from env */
 	void remove_rv_facts(FactVec& facts);
 
 	static void remove_loop_local_facts(const Statement* s, FactVec& facts);	
 	/* remove facts localized to a given function up to a given return statement */
-	static void remove_function_local_facts(std::vector<const Fact*>& inputs, const Statement* stm);
+	static void remove_function_local_facts(FactVec& inputs, const Statement* stm);
 	static bool merge_jump_facts(FactVec& facts, const FactVec& jump_facts);
 	/* add a new variable fact to env */
 	static void add_new_var_fact(const Variable* v, FactVec& facts);
-	static const vector<const Fact*>& get_program_end_facts(void);
+	static const FactVec& get_program_end_facts(void);
 
 	/* remove facts related to certain variables from env */
 	static void update_facts_for_oos_vars(const vector<Variable*>& vars, FactVec& facts);
@@ -137,12 +204,14 @@ public:
 	
 	void sanity_check_map() const;
 
-	static std::vector<Fact*> meta_facts; 
+	static thread_local std::vector<Fact*> meta_facts; 
+
+	StmSlots stm_slots;
 
 	// maps to track facts and effects at historical generation points.
 	// they are used for bypassing analyzing statements if possible 
-	std::map<const Statement*, FactVec> map_facts_in;
-	std::map<const Statement*, FactVec> map_facts_out;
+	StmFactMap map_facts_in;
+	StmFactMap map_facts_out;
 	std::map<const Statement*, std::vector<Fact*> > map_facts_in_final;
 	std::map<const Statement*, std::vector<Fact*> > map_facts_out_final;
 	std::map<const Statement*, Effect> map_stm_effect;
@@ -153,6 +222,13 @@ public:
 	FactVec global_facts; 
 
 	const Function* func;
+
+private:
+	void touch_stm_fact_maps(const Statement* stm);
+
+	// Don't implement them: the fact maps refer to stm_slots
+	FactMgr(const FactMgr& fm);
+	FactMgr& operator=(const FactMgr& fm);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -59,8 +59,8 @@ using namespace std;
 const Variable* FactPointTo::null_ptr = VariableSelector::make_dummy_static_variable("null");
 const Variable* FactPointTo::garbage_ptr = VariableSelector::make_dummy_static_variable("garbage");
 const Variable* FactPointTo::tbd_ptr = VariableSelector::make_dummy_static_variable("tbd");
-vector<const Variable*> FactPointTo::all_ptrs;
-vector<vector<const Variable*> > FactPointTo::all_aliases;
+thread_local vector<const Variable*> FactPointTo::all_ptrs;
+thread_local vector<vector<const Variable*> > FactPointTo::all_aliases;
 
 bool
 FactPointTo::is_null() const 
@@ -169,10 +169,10 @@ FactPointTo::size() const
 	return point_to_vars.size();
 }
 
-vector<const Fact*>
-FactPointTo::rhs_to_lhs_transfer(const vector<const Fact*>& facts, const vector<const Variable*>& lvars, const Expression* rhs)
+FactVec
+FactPointTo::rhs_to_lhs_transfer(const FactVec& facts, const vector<const Variable*>& lvars, const Expression* rhs)
 {
-	vector<const Fact*> empty;
+	FactVec empty;
 	if (lvars.size()==0) return empty;
 	// assert all possible LHS are pointers
 	for (size_t i=0; i<lvars.size(); i++) {
@@ -269,10 +269,10 @@ FactPointTo::rhs_to_lhs_transfer(const vector<const Fact*>& facts, const vector<
 	return empty;
 }
 
-std::vector<const Fact*>
-FactPointTo::abstract_fact_for_assign(const std::vector<const Fact*>& facts, const Lhs* lhs, const Expression* rhs)
+FactVec
+FactPointTo::abstract_fact_for_assign(const FactVec& facts, const Lhs* lhs, const Expression* rhs)
 {   
-	std::vector<const Fact*> ret_facts;
+	FactVec ret_facts;
 	
 	// find all the pointed variables on LHS
 	vector<const Variable*> lvars = merge_pointees_of_pointer(lhs->get_var()->get_collective(), lhs->get_indirect_level(), facts); 
@@ -329,11 +329,11 @@ FactPointTo::make_fact(const Variable* v, const Variable* point_to)
 	return fact;
 }
 
-vector<const Fact*>
+FactVec
 FactPointTo::make_facts(vector<const Variable*> vars, const vector<const Variable*>& set)
 {
 	size_t i;
-	vector<const Fact*> facts;
+	FactVec facts;
 	for (i=0; i<vars.size(); i++) {
 		// if type is null, means they are special variables (most likely tbd_ptr) we don't care
 		if (vars[i]->type != 0) {
@@ -343,11 +343,11 @@ FactPointTo::make_facts(vector<const Variable*> vars, const vector<const Variabl
 	return facts;
 }
 
-vector<const Fact*>
+FactVec
 FactPointTo::make_facts(vector<const Variable*> vars, const Variable* point_to)
 {
 	size_t i;
-	vector<const Fact*> facts;
+	FactVec facts;
 	for (i=0; i<vars.size(); i++) {
 		// if type is null, means they are special variables (most likely tbd_ptr) we don't care
 		if (vars[i]->type != 0) {
@@ -428,7 +428,7 @@ FactPointTo::point_to(const Variable* v) const
  * tell the analyzer sometimes it's ok to dereference null/dead pointers
  */ 
 bool 
-FactPointTo::is_valid_ptr(const Variable* p, const std::vector<const Fact*>& facts)
+FactPointTo::is_valid_ptr(const Variable* p, const FactVec& facts)
 { 
 	FactPointTo fp(p); 
 	const FactPointTo* fact = (const FactPointTo*)find_related_fact(facts, &fp); 
@@ -441,7 +441,7 @@ FactPointTo::is_valid_ptr(const Variable* p, const std::vector<const Fact*>& fac
  * return true if ptr is either null nore dangling in the given context
  */ 
 bool 
-FactPointTo::is_valid_ptr(const char* name, const std::vector<const Fact*>& facts)
+FactPointTo::is_valid_ptr(const char* name, const FactVec& facts)
 { 
 	size_t i;
 	for (i=0; i<facts.size(); i++) {
@@ -461,7 +461,7 @@ FactPointTo::is_valid_ptr(const char* name, const std::vector<const Fact*>& fact
  *  are used to test static analyzers (not compilers)
  */
 int
-FactPointTo::opportunistic_validate(const Variable* var, const Type* type, const std::vector<const Fact*>& facts)
+FactPointTo::opportunistic_validate(const Variable* var, const Type* type, const FactVec& facts)
 {  
 	if (var->type->get_indirect_level() <= type->get_indirect_level()) {
 		return 1;
@@ -493,7 +493,7 @@ FactPointTo::opportunistic_validate(const Variable* var, const Type* type, const
  * return true if ptr is dangling in the given context
  */ 
 bool 
-FactPointTo::is_dangling_ptr(const Variable* p, const std::vector<const Fact*>& facts)
+FactPointTo::is_dangling_ptr(const Variable* p, const FactVec& facts)
 {
 	FactPointTo fp(p);
 	const FactPointTo* fact = (const FactPointTo*)find_related_fact(facts, &fp);
@@ -501,7 +501,7 @@ FactPointTo::is_dangling_ptr(const Variable* p, const std::vector<const Fact*>&
 }
 
 /* return true if the variable has any chance to be a local variable after dereference */
-bool FactPointTo::is_pointing_to_locals(const Variable* v, const Block* b, int indirection, const vector<const Fact*>& facts)
+bool FactPointTo::is_pointing_to_locals(const Variable* v, const Block* b, int indirection, const FactVec& facts)
 {
 	if (indirection == -1) {
 		return v->is_visible_local(b);
@@ -700,7 +700,7 @@ FactPointTo::is_assertable(const Statement* stm) const
 }
 
 std::vector<const Variable*>
-FactPointTo::merge_pointees_of_pointer(const Variable* ptr, int indirect, const std::vector<const Fact*>& facts)
+FactPointTo::merge_pointees_of_pointer(const Variable* ptr, int indirect, const FactVec& facts)
 {
 	vector<const Variable*> tmp;
 	tmp.push_back(ptr);
@@ -712,7 +712,7 @@ FactPointTo::merge_pointees_of_pointer(const Variable* ptr, int indirect, const
 }
 
 std::vector<const Variable*> 
-FactPointTo::merge_pointees_of_pointers(const std::vector<const Variable*>& ptrs, const std::vector<const Fact*>& facts)
+FactPointTo::merge_pointees_of_pointers(const std::vector<const Variable*>& ptrs, const FactVec& facts)
 {
 	size_t i, j;
 	vector<const Variable*> pointee_vars;
@@ -783,7 +783,7 @@ FactPointTo::update_with_modified_index(const Variable* index_var) const
 }
 
 void
-FactPointTo::update_facts_with_modified_index(std::vector<const Fact*>& facts, const Variable* index_var)
+FactPointTo::update_facts_with_modified_index(FactVec& facts, const Variable* index_var)
 {
 	size_t i;
 	for (i=0; i<facts.size(); i++) {
@@ -791,7 +791,7 @@ FactPointTo::update_facts_with_modified_index(std::vector<const Fact*>& facts, c
 			const FactPointTo* fp = (const FactPointTo*)facts[i];
 			const FactPointTo* new_fp = fp->update_with_modified_index(index_var);
 			if (new_fp != fp) {
-				facts[i] = new_fp;
+				facts.set(i, new_fp);
 			}
 		}
 	}
@@ -827,6 +827,13 @@ FactPointTo::update_ptr_aliases(const vector<Fact*>& facts, vector<const Variabl
 	}
 }
 
+void
+FactPointTo::doFinalization(void)
+{
+	all_ptrs.clear();
+	all_aliases.clear();
+}
+
 void
 FactPointTo::aggregate_all_pointto_sets(void) 
 {
@@ -846,7 +853,7 @@ FactPointTo::aggregate_all_pointto_sets(void)
 
 /* find union fields that are referred to by this expression */
 int 
-FactPointTo::find_union_pointees(const vector<const Fact*>& facts, const Expression* e, vector<const Variable*>& unions)
+FactPointTo::find_union_pointees(const FactVec& facts, const Expression* e, vector<const Variable*>& unions)
 {
 	unions.clear();
 	vector<const Variable*> vars;
@@ -54,8 +54,8 @@ public:
  	static FactPointTo *make_fact(const Variable* v);  
 	static FactPointTo *make_fact(const Variable* v, const vector<const Variable*>& set);
 	static FactPointTo *make_fact(const Variable* v, const Variable* point_to);
-	static vector<const Fact*> make_facts(vector<const Variable*> vars, const vector<const Variable*>& set);
-	static vector<const Fact*> make_facts(vector<const Variable*> vars, const Variable* point_to);
+	static FactVec make_facts(vector<const Variable*> vars, const vector<const Variable*>& set);
+	static FactVec make_facts(vector<const Variable*> vars, const Variable* point_to);
 	static void doFinalization();
 
 	explicit FactPointTo(const Variable* v);
@@ -69,8 +69,8 @@ public:
 	bool is_dead(void) const;
 	bool has_invisible(const Statement* stm) const;
 	int  size() const;
-	std::vector<const Fact*> rhs_to_lhs_transfer(const std::vector<const Fact*>& facts, const vector<const Variable*>& lvars, const Expression* rhs);
-	virtual vector<const Fact*> abstract_fact_for_assign(const std::vector<const Fact*>& facts, const Lhs* lhs, const Expression* rhs);
+	FactVec rhs_to_lhs_transfer(const FactVec& facts, const vector<const Variable*>& lvars, const Expression* rhs);
+	virtual FactVec abstract_fact_for_assign(const FactVec& facts, const Lhs* lhs, const Expression* rhs);
 	
 	FactPointTo* mark_dead_var(const Variable* v);
 	FactPointTo* mark_func_end(const Statement* stm);
@@ -91,18 +91,18 @@ public:
 	virtual void Output(std::ostream &out) const;
 	virtual bool is_assertable(const Statement* s) const;
 
-	static std::vector<const Variable*> merge_pointees_of_pointer(const Variable* ptr, int indirect, const std::vector<const Fact*>& facts);
-	static std::vector<const Variable*> merge_pointees_of_pointers(const std::vector<const Variable*>& ptrs, const std::vector<const Fact*>& facts);
-	static void update_facts_with_modified_index(std::vector<const Fact*>& facts, const Variable* var);
+	static std::vector<const Variable*> merge_pointees_of_pointer(const Variable* ptr, int indirect, const FactVec& facts);
+	static std::vector<const Variable*> merge_pointees_of_pointers(const std::vector<const Variable*>& ptrs, const FactVec& facts);
+	static void update_facts_with_modified_index(FactVec& facts, const Variable* var);
 	static void aggregate_all_pointto_sets(void);
 
-	static int opportunistic_validate(const Variable* var, const Type* type, const std::vector<const Fact*>& facts);
-	static bool is_valid_ptr(const Variable* p, const std::vector<const Fact*>& facts);
-	static bool is_valid_ptr(const char* name, const std::vector<const Fact*>& facts);
-	static bool is_dangling_ptr(const Variable* p, const std::vector<const Fact*>& facts);
+	static int opportunistic_validate(const Variable* var, const Type* type, const FactVec& facts);
+	static bool is_valid_ptr(const Variable* p, const FactVec& facts);
+	static bool is_valid_ptr(const char* name, const FactVec& facts);
+	static bool is_dangling_ptr(const Variable* p, const FactVec& facts);
 	static bool is_special_ptr(const Variable* p) { return p==null_ptr || p==garbage_ptr || p==tbd_ptr;}
-	static bool is_pointing_to_locals(const Variable* v, const Block* b, int indirection, const vector<const Fact*>& facts); 
-	static int  find_union_pointees(const vector<const Fact*>& facts, const Expression* e, vector<const Variable*>& unions);
+	static bool is_pointing_to_locals(const Variable* v, const Block* b, int indirection, const FactVec& facts); 
+	static int  find_union_pointees(const FactVec& facts, const Expression* e, vector<const Variable*>& unions);
 
 	static std::string point_to_str(const Variable* v);
 
@@ -110,8 +110,8 @@ public:
 	static const Variable* garbage_ptr;
 	static const Variable* tbd_ptr;
 	
-	static vector<const Variable*> all_ptrs;
-	static vector<vector<const Variable*> > all_aliases;
+	static thread_local vector<const Variable*> all_ptrs;
+	static thread_local vector<vector<const Variable*> > all_aliases;
 private:  
 	FactPointTo(const Variable* v, const vector<const Variable*>& set);
 	FactPointTo(const Variable* v, const Variable* point_to);
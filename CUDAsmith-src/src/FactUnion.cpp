@@ -74,10 +74,10 @@ FactUnion::get_last_written_type(void) const
 	return var->field_vars[last_written_fid]->type;
 }
 
-std::vector<const Fact*>
-FactUnion::rhs_to_lhs_transfer(const std::vector<const Fact*>& facts, const vector<const Variable*>& lvars, const Expression* rhs)
+FactVec
+FactUnion::rhs_to_lhs_transfer(const FactVec& facts, const vector<const Variable*>& lvars, const Expression* rhs)
 {
-	vector<const Fact*> empty;
+	FactVec empty;
 	// assert all possible LHS are unions
 	for (size_t i=0; i<lvars.size(); i++) {
 		assert(lvars[i]->type->eType == eUnion);
@@ -119,10 +119,10 @@ FactUnion::rhs_to_lhs_transfer(const std::vector<const Fact*>& facts, const vect
 }
 
 /* draw facts from an assignment */
-std::vector<const Fact*>
-FactUnion::abstract_fact_for_assign(const std::vector<const Fact*>& facts, const Lhs* lhs, const Expression* rhs)
+FactVec
+FactUnion::abstract_fact_for_assign(const FactVec& facts, const Lhs* lhs, const Expression* rhs)
 {   
-	std::vector<const Fact*> ret_facts; 
+	FactVec ret_facts; 
 	if (rhs == NULL) return ret_facts;
 	// find all the pointed variables on LHS
 	std::vector<const Variable*> lvars = FactPointTo::merge_pointees_of_pointer(lhs->get_var()->get_collective(), lhs->get_indirect_level(), facts);
@@ -169,11 +169,11 @@ FactUnion::make_fact(const Variable* v, int fid)
 	return fact;
 } 
 
-vector<const Fact*>
+FactVec
 FactUnion::make_facts(const vector<const Variable*>& vars, int fid)
 {
 	size_t i;
-	vector<const Fact*> facts;
+	FactVec facts;
 	for (i=0; i<vars.size(); i++) { 
 		facts.push_back(make_fact(vars[i], fid));
 	}
@@ -181,7 +181,7 @@ FactUnion::make_facts(const vector<const Variable*>& vars, int fid)
 } 
 
 bool 
-FactUnion::is_nonreadable_field(const Variable *v, const std::vector<const Fact*>& facts)
+FactUnion::is_nonreadable_field(const Variable *v, const FactVec& facts)
 {
 	if (v->is_inside_union_field()) {
 		for (; v && !v->is_union_field(); v = v->field_var_of) {
@@ -229,7 +229,7 @@ FactUnion::join(const Fact& f)
  * join facts about a list of vars, return the merged facts 
  */
 Fact* 
-FactUnion::join_var_facts(const vector<const Fact*>& facts, const vector<const Variable*>& vars) const
+FactUnion::join_var_facts(const FactVec& facts, const vector<const Variable*>& vars) const
 { 
 	FactUnion* fu = 0;
 	for (size_t i=0; i<vars.size(); i++) {
@@ -287,7 +287,7 @@ FactUnion::imply(const Fact& f) const
 }
  
 bool
-FactUnion::is_field_readable(const Variable* v, int fid, const vector<const Fact*>& facts)
+FactUnion::is_field_readable(const Variable* v, int fid, const FactVec& facts)
 {
 	assert(v->type->eType == eUnion && fid >=0 && fid < (int)(v->type->fields.size()));
 	FactUnion tmp(v, fid);
@@ -50,9 +50,9 @@ class FactUnion : public Fact
 {
 public: 
 	static FactUnion *make_fact(const Variable* v, int fid = 0);  
-	static vector<const Fact*> make_facts(const vector<const Variable*>& vars, int fid);  
+	static FactVec make_facts(const vector<const Variable*>& vars, int fid);  
 	static void doFinalization();
-	static bool is_nonreadable_field(const Variable *v, const std::vector<const Fact*>& facts);
+	static bool is_nonreadable_field(const Variable *v, const FactVec& facts);
  
 	virtual ~FactUnion(void) {}; 
 
@@ -60,7 +60,7 @@ public:
 	void set_var(const Variable* v) { var = v;}
 	const Type* get_last_written_type(void) const;
 	int   get_last_written_fid(void) const { return last_written_fid; };
-	static bool is_field_readable(const Variable* v, int fid, const vector<const Fact*>& facts);
+	static bool is_field_readable(const Variable* v, int fid, const FactVec& facts);
 	
 	// lattice functions
 	virtual bool is_top(void) const { return last_written_fid == TOP;}
@@ -72,10 +72,10 @@ public:
 	virtual int join(const Fact& fact);  
 
 	// transfer functions
-	vector<const Fact*> rhs_to_lhs_transfer(const vector<const Fact*>& facts, const vector<const Variable*>& lvars, const Expression* rhs);
-	virtual vector<const Fact*> abstract_fact_for_assign(const std::vector<const Fact*>& facts, const Lhs* lhs, const Expression* /*rhs*/);
-	//virtual vector<const Fact*> abstract_fact_for_return(const std::vector<const Fact*>& facts, const ExpressionVariable* rv, const Function* func);
-	virtual Fact* join_var_facts(const vector<const Fact*>& facts, const vector<const Variable*>& vars) const;
+	FactVec rhs_to_lhs_transfer(const FactVec& facts, const vector<const Variable*>& lvars, const Expression* rhs);
+	virtual FactVec abstract_fact_for_assign(const FactVec& facts, const Lhs* lhs, const Expression* /*rhs*/);
+	//virtual FactVec abstract_fact_for_return(const FactVec& facts, const ExpressionVariable* rv, const Function* func);
+	virtual Fact* join_var_facts(const FactVec& facts, const vector<const Variable*>& vars) const;
 	virtual Fact* clone(void) const;
 
 	// output functions
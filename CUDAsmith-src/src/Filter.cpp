@@ -63,6 +63,23 @@ void Filter::disable(FilterKind kind)
 	kinds_[kind] = false;
 }
 
+bool
+Filter::accepted_values(unsigned int, std::vector<unsigned int> &) const
+{
+	return false;
+}
+
+bool
+Filter::test_all_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	values.clear();
+	for (unsigned int v = 0; v < n; v++) {
+		if (!filter(v))
+			values.push_back(v);
+	}
+	return true;
+}
+
 /*
  *
  */
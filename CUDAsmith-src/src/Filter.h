@@ -31,6 +31,7 @@
 #define FILTER_H
 
 #include <bitset>
+#include <vector>
 
 enum FilterKind {
 	fDefault,
@@ -48,6 +49,11 @@ public:
 
 	virtual bool filter(int v) const = 0;
 
+	// Collects the values in [0, n) that pass the filter, so that one of
+	// them can be drawn directly instead of by rejection. Returns false if
+	// the filter cannot list them, which is the default.
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
+
 	void enable(FilterKind kind);
 
 	void disable(FilterKind kind);
@@ -55,6 +61,10 @@ public:
 protected:
 	bool valid_filter() const;
 
+	// accepted_values() by calling filter() on every value, for filters
+	// without side effects
+	bool test_all_values(unsigned int n, std::vector<unsigned int> &values) const;
+
 	// What kind of mode this filter can apply to
 	// By default, it can work for all modes. 
 	std::bitset<MAX_FILTER_KIND_SIZE> kinds_;
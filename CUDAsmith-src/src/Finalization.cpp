@@ -38,6 +38,12 @@
 #include "Probabilities.h"
 #include "StatementGoto.h"
 #include "ExtensionMgr.h"
+#include "Error.h"
+#include "Expression.h"
+#include "SafeOpFlags.h"
+#include "Statement.h"
+#include "NodeArena.h"
+#include "util.h"
 
 void
 Finalization::doFinalization()
@@ -51,5 +57,12 @@ Finalization::doFinalization()
 	Probabilities::DestroyInstance();
 	StatementGoto::doFinalization();
 	ExtensionMgr::DestroyExtension();
+	Statement::doFinalization();
+	Expression::doFinalization();
+	Bookkeeper::doFinalization();
+	SafeOpFlags::wrapper_names.clear();
+	Error::set_error(SUCCESS);
+	reset_gensym();
+	NodeArena::release();
 }
 
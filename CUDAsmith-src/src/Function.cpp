@@ -67,11 +67,11 @@ using namespace std;
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static vector<Function*> FuncList;		// List of all functions in the program
-static vector<FactMgr*>  FMList;        // list of fact managers for each function
-static long cur_func_idx;				// Index into FuncList that we are currently working on
-static bool param_first=true;			// Flag to track output of commas 
-static int builtin_functions_cnt;
+static thread_local vector<Function*> FuncList;		// List of all functions in the program
+static thread_local vector<FactMgr*>  FMList;        // list of fact managers for each function
+static thread_local long cur_func_idx;				// Index into FuncList that we are currently working on
+static thread_local bool param_first=true;			// Flag to track output of commas 
+static thread_local int builtin_functions_cnt;
 
 /*
  * find FactMgr for a function
@@ -468,7 +468,7 @@ Function::make_first(void)
 	fm->setup_in_out_maps(true);
 		
 	// update global facts to merged facts at all possible function exits
-	fm->global_facts = fm->map_facts_out[f->body];
+	fm->global_facts = fm->map_facts_out.get(f->body);
 	f->body->add_back_return_facts(fm, fm->global_facts);
 
 	// collect info about global dangling pointers
@@ -766,7 +766,7 @@ Function::make_builtin_function(const string &function_string)
 	f->GenerateBody(CGContext::get_empty_context());
 
 	// update global facts to merged facts at all possible function exits
-	fm->global_facts = fm->map_facts_out[f->body];
+	fm->global_facts = fm->map_facts_out.get(f->body);
 	f->body->add_back_return_facts(fm, fm->global_facts);
 
 	// collect info about global dangling pointers
@@ -892,6 +892,10 @@ Function::doFinalization(void)
 	}
 	FMList.clear();
 	FactMgr::doFinalization();
+
+	cur_func_idx = 0;
+	builtin_functions_cnt = 0;
+	param_first = true;
 }
 
 Function::~Function()
@@ -54,6 +54,7 @@ class FactMgr;
 class Statement;
 class CGContext;
 class Fact;
+class FactVec;
 class Constant;
 class CVQualifiers;
 
@@ -91,7 +92,7 @@ public:
 	bool is_effect_known(void) const { return (build_state == BUILT); }
 	const Effect &get_feffect(void) const { return feffect; }
 
-	void remove_irrelevant_facts(std::vector<const Fact*>& inputs) const;
+	void remove_irrelevant_facts(FactVec& inputs) const;
 
 	bool is_var_visible(const Variable* var, const Statement* stm) const;
 	bool is_var_on_stack(const Variable* var, const Statement* stm) const;
@@ -234,7 +234,7 @@ FunctionInvocation::make_random_binary(CGContext &cg_context, const Type* type)
 
 	cg_context.merge_param_context(lhs_cg_context, true);
 	FactMgr* fm = get_fact_mgr(&cg_context);
-	vector<const Fact*> facts_copy = fm->global_facts;
+	FactVec facts_copy = fm->global_facts;
 
 #if 0
 	if (lhs->term_type == eVariable) {
@@ -481,10 +481,10 @@ FunctionInvocation::permute_param_oders(void) const
 }
 
 bool 
-FunctionInvocation::visit_unordered_params(vector<const Fact*>& inputs, CGContext& cg_context) const
+FunctionInvocation::visit_unordered_params(FactVec& inputs, CGContext& cg_context) const
 {
-	vector<const Fact*> inputs_copy = inputs;
-	vector<const Fact*> tmp;
+	FactVec inputs_copy = inputs;
+	FactVec tmp;
 	vector<intvec> orders = permute_param_oders();
 	size_t i, j;
 	assert(orders.size() > 0);
@@ -529,12 +529,12 @@ FunctionInvocation::get_qualifiers(void) const
 }
 
 bool 
-FunctionInvocation::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+FunctionInvocation::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {   
 	bool unordered = false; //has_uncertain_call();  
 	bool ok = false;
 	bool is_func_call = (invoke_type == eFuncCall);
-	static int g = 0;
+	static thread_local int g = 0;
 	Effect running_eff_context(cg_context.get_effect_context());
 	if (!unordered) {  
 		// unsigned int flags = ptr_cmp ? (cg_context.flags | NO_DANGLING_PTR) : cg_context.flags;
@@ -562,7 +562,7 @@ FunctionInvocation::visit_facts(vector<const Fact*>& inputs, CGContext& cg_conte
 	}
 	if (ok && is_func_call) {
 		// make a copy of env
-		vector<const Fact*> inputs_copy = inputs;
+		FactVec inputs_copy = inputs;
 		const FunctionInvocationUser* func_call = dynamic_cast<const FunctionInvocationUser*>(this);
 		Effect effect_accum;  
 		//CGContext new_context(func_call->func, cg_context.get_effect_context(), &effect_accum);
@@ -45,6 +45,7 @@
 #include <vector>
 #include "util.h"
 #include "CVQualifiers.h"
+#include "NodeArena.h"
 using namespace std;
 
 class CGContext;
@@ -53,6 +54,7 @@ class Expression;
 class FunctionInvocationUser;
 class Type;
 class Fact;
+class FactVec;
 class SafeOpFlags;
 class Variable;
 class CVQualifiers;
@@ -113,6 +115,10 @@ public:
 
 	virtual ~FunctionInvocation(void);
 
+	// allocated from the per-program NodeArena
+	static void *operator new(size_t size) { return NodeArena::allocate(size); }
+	static void operator delete(void *p, size_t size) { NodeArena::deallocate(p, size); }
+
 	virtual FunctionInvocation *clone() const = 0;
 
 	static FunctionInvocation *make_random(bool,
@@ -134,7 +140,7 @@ public:
 										   Expression *lhs,
 										   Expression *rhs);
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual void get_called_funcs(std::vector<const FunctionInvocationUser*>& funcs ) const;
 
@@ -142,7 +148,7 @@ public:
 
 	vector<intvec> permute_param_oders(void) const;
 
-	bool visit_unordered_params(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	bool visit_unordered_params(FactVec& inputs, CGContext& cg_context) const;
 
 	bool has_uncertain_call_recursive(void) const;
 
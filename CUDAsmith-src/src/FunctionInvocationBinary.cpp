@@ -51,7 +51,7 @@ const Type *PromoteTypeToVectorType(const Type *type, int size);
 */
 using namespace std;
 
-static vector<bool> needcomma;  // Flag to track output of commas
+static thread_local vector<bool> needcomma;  // Flag to track output of commas
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -468,14 +468,14 @@ FunctionInvocationBinary::indented_output(std::ostream &out, int indent) const
 }
 
 bool 
-FunctionInvocationBinary::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+FunctionInvocationBinary::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {   
 	bool skippable = IsOrderedStandardFunc(eFunc); 
 	assert(param_value.size() == 2); 
 	if (skippable) {
 		const Expression* value = param_value[0];  
 		if (value->visit_facts(inputs, cg_context)) { 
-			vector<const Fact*> inputs_copy = inputs; 
+			FactVec inputs_copy = inputs; 
 			value = param_value[1];   
 			if (value->visit_facts(inputs, cg_context)) {
 				// the second parameter may or may not be evaludated, thus need to 
@@ -69,7 +69,7 @@ public:
 
 	virtual bool safe_invocation() const { return false; }
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	eBinaryOps get_operation(void) const {return eFunc;}
 	void set_operation(eBinaryOps op) { eFunc = op;}
@@ -64,11 +64,11 @@
 
 using namespace std;
 
-static vector<bool> needcomma;  // Flag to track output of commas
+static thread_local vector<bool> needcomma;  // Flag to track output of commas
 
-static vector<const FunctionInvocationUser*> invocations;   // list of function calls
-static vector<const Fact*> return_facts;              // list of return facts
-vector<FunctionInvocationUser*> FunctionInvocationUser::AllFunctionInvocations;    // All function invocations
+static thread_local vector<const FunctionInvocationUser*> invocations;   // list of function calls
+static thread_local vector<const Fact*> return_facts;              // list of return facts
+thread_local vector<FunctionInvocationUser*> FunctionInvocationUser::AllFunctionInvocations;    // All function invocations
 
 const Fact*
 get_return_fact_for_invocation(const FunctionInvocationUser* fiu, const Variable* var, enum eFactCategory cat) 
@@ -225,7 +225,7 @@ FunctionInvocationUser::build_invocation_and_function(CGContext &cg_context, con
 	func->generate_body_with_known_params(cg_context, effect_accum); 
 
 	// post creation processing
-	FactVec ret_facts = fm->map_facts_out[func->body];
+	FactVec ret_facts = fm->map_facts_out.get(func->body);
 	func->body->add_back_return_facts(fm, ret_facts);
 	fiu->save_return_fact(ret_facts);  
 	 
@@ -320,7 +320,7 @@ FunctionInvocationUser::build_invocation(Function *target, CGContext &cg_context
  * side effects: update input facts and FactMgr in cg_context if the invocation is found valid
  */
 bool 
-FunctionInvocationUser::revisit(std::vector<const Fact*>& inputs, CGContext& cg_context) const
+FunctionInvocationUser::revisit(FactVec& inputs, CGContext& cg_context) const
 {
 	FactMgr* fm = get_fact_mgr_for_func(func); 
 	fm->clear_map_visited();
@@ -335,13 +335,13 @@ FunctionInvocationUser::revisit(std::vector<const Fact*>& inputs, CGContext& cg_
 	}
 
 	// make copies so we can back up if fail
-	vector<const Fact*> inputs_copy = inputs;  
+	FactVec inputs_copy = inputs;  
 	
 	// add facts related to pass parameters
 	fm->caller_to_callee_handover(this, inputs);  
 
-	map<const Statement*, FactVec> facts_in_copy = fm->map_facts_in;
-	map<const Statement*, FactVec> facts_out_copy = fm->map_facts_out;
+	StmFactMap facts_in_copy = fm->map_facts_in;
+	StmFactMap facts_out_copy = fm->map_facts_out;
 	map<const Statement*, Effect>  stm_effect_copy = fm->map_stm_effect;
 	map<const Statement*, Effect>  accum_effect_copy = fm->map_accum_effect;
 	// TODO: revisit only if "contingent variable" has been changed? 
@@ -377,7 +377,7 @@ FunctionInvocationUser::revisit(std::vector<const Fact*>& inputs, CGContext& cg_
  * save the return fact for later use
  */
 void
-FunctionInvocationUser::save_return_fact(const vector<const Fact*>& facts) const
+FunctionInvocationUser::save_return_fact(const FactVec& facts) const
 {
 	size_t i;
 	for (i=0; i<facts.size(); i++) {
@@ -395,6 +395,8 @@ FunctionInvocationUser::doFinalization(void)
 {
 	invocations.clear();
 	return_facts.clear();
+	needcomma.clear();
+	AllFunctionInvocations.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
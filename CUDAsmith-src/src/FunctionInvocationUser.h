@@ -78,9 +78,9 @@ public:
 
 	const Function* get_func(void) const { return func; };
 
-	bool revisit(std::vector<const Fact*>& inputs, CGContext& cg_context) const;
+	bool revisit(FactVec& inputs, CGContext& cg_context) const;
 
-	void save_return_fact(const vector<const Fact*>& facts) const;
+	void save_return_fact(const FactVec& facts) const;
 
 	static void doFinalization(void);
 
@@ -101,7 +101,7 @@ private:
 	bool build_invocation(Function *target, CGContext &cg_context);
 
 	// All function calls
-	static vector<FunctionInvocationUser*> AllFunctionInvocations;
+	static thread_local vector<FunctionInvocationUser*> AllFunctionInvocations;
 };
 
 const Fact* get_return_fact_for_invocation(const FunctionInvocationUser* fiu, const Variable* var, enum eFactCategory cat);
@@ -72,9 +72,8 @@ Lhs::make_random(CGContext &cg_context, const Type* t, const CVQualifiers* qfer,
 	vector<const Variable*> dummy;  
 	//static int cnt = 0;				// for debug
 
-	// save effects, in case we need to backtrack
-	Effect effect_accum = cg_context.get_accum_effect();
-	Effect effect_stm = cg_context.get_effect_stm();
+	// checkpoint effects, in case we need to backtrack
+	AttemptCheckpoint attempt(cg_context, true);
 
 	do {
 		DEPTH_GUARD_BY_TYPE_RETURN(dtLhs, NULL);
@@ -152,11 +151,11 @@ Lhs::make_random(CGContext &cg_context, const Type* t, const CVQualifiers* qfer,
 					incr_counter(Bookkeeper::write_dereference_cnts, deref_level); 
 				}
 				Bookkeeper::record_volatile_access(var, deref_level, true);
+				attempt.commit();
 				return new Lhs(*var, t, compound_assign);
 			}
 			// restore the effects
-			cg_context.reset_effect_accum(effect_accum);
-			cg_context.reset_effect_stm(effect_stm);
+			attempt.retry();
 		}
 		dummy.push_back(var);
 	} while (true);
@@ -224,7 +223,7 @@ Lhs::get_type(void) const
 }
 
 void
-Lhs::get_lvars(const vector<const Fact*>& facts, vector<const Variable*>& vars) const
+Lhs::get_lvars(const FactVec& facts, vector<const Variable*>& vars) const
 {
 	vars = FactPointTo::merge_pointees_of_pointer(get_var()->get_collective(), get_indirect_level(), facts); 
 }			
@@ -295,7 +294,7 @@ Lhs::get_referenced_ptrs(std::vector<const Variable*>& ptrs) const
 }
 
 bool 
-Lhs::ptr_modified_in_rhs(vector<const Fact*>& inputs, CGContext& cg_context) const
+Lhs::ptr_modified_in_rhs(FactVec& inputs, CGContext& cg_context) const
 {
 	int indirect = get_indirect_level(); 
 	assert(indirect > 0);
@@ -320,7 +319,7 @@ Lhs::ptr_modified_in_rhs(vector<const Fact*>& inputs, CGContext& cg_context) con
 }
 
 bool 
-Lhs::visit_indices(vector<const Fact*>& inputs, CGContext& cg_context) const
+Lhs::visit_indices(FactVec& inputs, CGContext& cg_context) const
 {
 	string dummy;
 	const ArrayVariable* av = get_var()->get_array(dummy);
@@ -341,7 +340,7 @@ Lhs::visit_indices(vector<const Fact*>& inputs, CGContext& cg_context) const
 
 // conservatively assume two fields overlap if they are both part of the same union variable
 bool
-have_overlapping_fields(const Expression* e1, const Expression* e2, const vector<const Fact*>& facts)
+have_overlapping_fields(const Expression* e1, const Expression* e2, const FactVec& facts)
 { 
 	vector<const Variable*> vars1, vars2;
 	if (FactPointTo::find_union_pointees(facts, e1, vars1)) {
@@ -356,7 +355,7 @@ have_overlapping_fields(const Expression* e1, const Expression* e2, const vector
 }
 
 bool 
-Lhs::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+Lhs::visit_facts(FactVec& inputs, CGContext& cg_context) const
 { 
 	bool valid = false;
 	const Variable* v = get_var();
@@ -63,7 +63,7 @@ public:
 
 	int get_indirect_level(void) const;
 
-	void get_lvars(const vector<const Fact*>& facts, vector<const Variable*>& vars) const;
+	void get_lvars(const FactVec& facts, vector<const Variable*>& vars) const;
 
 	bool is_volatile() const;
 
@@ -73,13 +73,13 @@ public:
 
 	bool compatible(const Expression *c) const;
 
-	bool visit_indices(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	bool visit_indices(FactVec& inputs, CGContext& cg_context) const;
 	//
 	virtual std::vector<const ExpressionVariable*> get_dereferenced_ptrs(void) const;
 	virtual void get_referenced_ptrs(std::vector<const Variable*>& ptrs) const;
 	virtual unsigned int get_complexity(void) const { return 1;}
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual const Type &get_type(void) const;
 
@@ -88,7 +88,7 @@ public:
 private:
 	explicit Lhs(const Lhs &lhs);
 
-	bool ptr_modified_in_rhs(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	bool ptr_modified_in_rhs(FactVec& inputs, CGContext& cg_context) const;
 
 	const Variable &var;
 
@@ -52,6 +52,12 @@ MspBinaryFilter::filter(int v) const
 		return false;
 }
 
+bool
+MspBinaryFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	return test_all_values(n, values);
+}
+
 /////////////////////////////////////////////////////////
 
 MspSafeOpSizeFilter::MspSafeOpSizeFilter(eBinaryOps op)
@@ -84,3 +90,9 @@ MspSafeOpSizeFilter::filter(int v) const
 	}
 }
 
+bool
+MspSafeOpSizeFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	return test_all_values(n, values);
+}
+
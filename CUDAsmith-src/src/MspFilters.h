@@ -41,6 +41,8 @@ public:
 	virtual ~MspBinaryFilter();
 
 	virtual bool filter(int v) const;
+
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
 };
 
 class MspSafeOpSizeFilter : public Filter
@@ -51,6 +53,8 @@ public:
 	virtual ~MspSafeOpSizeFilter();
 	
 	virtual bool filter(int v) const;
+
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
 private:
 	eBinaryOps bin_op_;
 };
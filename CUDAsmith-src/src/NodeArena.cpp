@@ -0,0 +1,217 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "NodeArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+#include <vector>
+
+#if defined(__SANITIZE_ADDRESS__)
+#define NODE_ARENA_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NODE_ARENA_ASAN 1
+#endif
+#endif
+
+#ifdef NODE_ARENA_ASAN
+#include <sanitizer/asan_interface.h>
+#define POISON(p, n) ASAN_POISON_MEMORY_REGION((p), (n))
+#define UNPOISON(p, n) ASAN_UNPOISON_MEMORY_REGION((p), (n))
+#else
+#define POISON(p, n) ((void)(p), (void)(n))
+#define UNPOISON(p, n) ((void)(p), (void)(n))
+#endif
+
+using namespace std;
+
+namespace {
+
+const size_t GRAIN = 16;
+const size_t MAX_SIZE = 1024;		// larger nodes come from the global heap
+const size_t CLASSES = MAX_SIZE / GRAIN;
+const size_t CHUNK_SIZE = 64 * 1024;
+
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+struct ArenaState {
+	ArenaState(void);
+	~ArenaState(void);
+
+	bool owns(const void *p) const;
+	char *new_chunk(void);
+
+	bool is_open;
+	vector<char*> chunks;			// in the order they are used
+	vector<char*> sorted_chunks;	// by address, for owns
+	size_t curr_chunk;
+	char *next;
+	char *end;
+	FreeBlock *free_lists[CLASSES];
+	unsigned long allocations;		// nodes carved out of the chunks
+};
+
+ArenaState::ArenaState(void)
+	: is_open(false),
+	  curr_chunk(0),
+	  next(0),
+	  end(0),
+	  allocations(0)
+{
+	fill(free_lists, free_lists + CLASSES, static_cast<FreeBlock*>(0));
+}
+
+ArenaState::~ArenaState(void)
+{
+	for (size_t i = 0; i < chunks.size(); i++) {
+		UNPOISON(chunks[i], CHUNK_SIZE);
+		::operator delete(chunks[i]);
+	}
+}
+
+bool
+ArenaState::owns(const void *p) const
+{
+	const char *c = static_cast<const char*>(p);
+	vector<char*>::const_iterator i = upper_bound(sorted_chunks.begin(), sorted_chunks.end(), c);
+	return i != sorted_chunks.begin() && c < *(i - 1) + CHUNK_SIZE;
+}
+
+/*
+ * Move on to the next chunk, reusing the ones left over from earlier
+ * programs first.
+ */
+char *
+ArenaState::new_chunk(void)
+{
+	if (next) {
+		curr_chunk++;
+	}
+	if (curr_chunk == chunks.size()) {
+		char *c = static_cast<char*>(::operator new(CHUNK_SIZE));
+		POISON(c, CHUNK_SIZE);
+		chunks.push_back(c);
+		sorted_chunks.insert(upper_bound(sorted_chunks.begin(), sorted_chunks.end(), c), c);
+	}
+	next = chunks[curr_chunk];
+	end = next + CHUNK_SIZE;
+	return next;
+}
+
+thread_local ArenaState arena;
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+NodeArena::open(void)
+{
+	arena.is_open = true;
+}
+
+/*
+ * Drop every node still in the arena. Their destructors are not run: by
+ * now everything reachable has been deleted by the finalizers, and the
+ * rest was leaked.
+ */
+void
+NodeArena::release(void)
+{
+	arena.is_open = false;
+	arena.curr_chunk = 0;
+	arena.next = 0;
+	arena.end = 0;
+	fill(arena.free_lists, arena.free_lists + CLASSES, static_cast<FreeBlock*>(0));
+#ifdef NODE_ARENA_ASAN
+	for (size_t i = 0; i < arena.chunks.size(); i++) {
+		POISON(arena.chunks[i], CHUNK_SIZE);
+	}
+#endif
+}
+
+void *
+NodeArena::allocate(size_t size)
+{
+	if (!arena.is_open || size > MAX_SIZE) {
+		return ::operator new(size);
+	}
+	arena.allocations++;
+	size_t cls = (size + GRAIN - 1) / GRAIN - 1;
+	size_t rounded = (cls + 1) * GRAIN;
+	FreeBlock *b = arena.free_lists[cls];
+	if (b) {
+		UNPOISON(b, rounded);
+		arena.free_lists[cls] = b->next;
+		return b;
+	}
+	if (arena.next == 0 || arena.next + rounded > arena.end) {
+		arena.new_chunk();
+	}
+	char *p = arena.next;
+	arena.next += rounded;
+	UNPOISON(p, size);
+	return p;
+}
+
+unsigned long
+NodeArena::allocations(void)
+{
+	return arena.allocations;
+}
+
+void
+NodeArena::deallocate(void *p, size_t size)
+{
+	if (p == 0) {
+		return;
+	}
+	if (size > MAX_SIZE || !arena.owns(p)) {
+		::operator delete(p);
+		return;
+	}
+	size_t cls = (size + GRAIN - 1) / GRAIN - 1;
+	FreeBlock *b = static_cast<FreeBlock*>(p);
+	b->next = arena.free_lists[cls];
+	arena.free_lists[cls] = b;
+	POISON(b, (cls + 1) * GRAIN);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
@@ -0,0 +1,75 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+
+/*
+ * Storage for the AST nodes (expressions, statements, variables, function
+ * invocations and safe-op flags) of the program being generated. The nodes
+ * get it through their class operator new/delete.
+ *
+ * Each thread has its own arena. Nodes are carved out of large chunks by
+ * bumping a pointer, and deleted nodes go back to a free list for their
+ * size. Between open() and release() the arena owns every node created, so
+ * the nodes a program leaks (rejected attempts, the CUDA buffers and so on)
+ * are reclaimed all at once when the program is finalized. The chunks are
+ * kept for the next program, so generating a batch of programs in one
+ * process does not grow the heap.
+ *
+ * Outside open()/release(), e.g. during static initialization, nodes come
+ * from the global heap as before.
+ */
+class NodeArena
+{
+public:
+	static void open(void);
+	static void release(void);
+
+	static void *allocate(size_t size);
+	static void deallocate(void *p, size_t size);
+
+	// nodes the calling thread has allocated from its arena so far
+	static unsigned long allocations(void);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // NODE_ARENA_H
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
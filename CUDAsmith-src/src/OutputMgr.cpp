@@ -68,7 +68,7 @@ using namespace std;
 
 vector<string> OutputMgr::monitored_funcs_;
 
-std::string OutputMgr::curr_func_ = "";
+thread_local std::string OutputMgr::curr_func_ = "";
 
 void
 OutputMgr::set_curr_func(const std::string &fname)
@@ -360,11 +360,28 @@ OutputMgr::OutputPtrResets(ostream &out, const vector<const Variable*>& ptrs)
 	}
 }
 
+static const int max_tab_run = 16;
+
+static string
+make_tabs(void)
+{
+	string s;
+	for (int i = 0; i < max_tab_run; i++) {
+		s += TAB;
+	}
+	return s;
+}
+
 void
 OutputMgr::output_tab_(ostream &out, int indent)
 {
-	while (indent--) {
-		out << TAB;
+	// indentation is written a run of tabs at a time
+	static const string tabs = make_tabs();
+	static const size_t tab_len = sizeof(TAB) - 1;
+	while (indent > 0) {
+		int run = indent < max_tab_run ? indent : max_tab_run;
+		out.write(tabs.data(), run * tab_len);
+		indent -= run;
 	}
 }
 
@@ -377,7 +394,7 @@ OutputMgr::output_tab(ostream &out, int indent)
 void
 OutputMgr::really_outputln(ostream &out)
 {
-	out << std::endl;
+	out << '\n';
 }
 
 //////////////////////////////////////////////////////////////////
@@ -67,7 +67,7 @@ public:
 
 	virtual void Output() = 0;
 
-	virtual void outputln(ostream &out) {out << std::endl;}
+	virtual void outputln(ostream &out) {out << '\n';}
 
 	virtual void output_comment_line(ostream &out, const std::string &comment);
 
@@ -94,7 +94,7 @@ private:
 
 	static bool is_monitored_func(void);
 
-	static std::string curr_func_;
+	static thread_local std::string curr_func_;
 
 };
 
@@ -33,7 +33,7 @@
 
 using namespace std;
 
-std::map<eStatementType, bool> PartialExpander::expands_;
+thread_local std::map<eStatementType, bool> PartialExpander::expands_;
 
 std::map<eStatementType, bool> PartialExpander::expands_backup_;
 
@@ -145,6 +145,12 @@ PartialExpander::restore_init_values()
 	PartialExpander::copy_expands(PartialExpander::expands_, PartialExpander::expands_backup_);
 }
 
+bool
+PartialExpander::is_expanding(void)
+{
+	return expands_[MAX_STATEMENT_TYPE];
+}
+
 bool
 PartialExpander::direct_expand_check(eStatementType t)
 {
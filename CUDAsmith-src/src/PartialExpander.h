@@ -44,6 +44,9 @@ public:
 
 	static bool direct_expand_check(eStatementType t);
 
+	// expand_check() changes the state while this holds
+	static bool is_expanding(void);
+
 private:
 	PartialExpander();
 	
@@ -59,7 +62,7 @@ private:
 
 	static bool parse_options(const std::string &options, char sep_char);
 
-	static std::map<eStatementType, bool> expands_;
+	static thread_local std::map<eStatementType, bool> expands_;
 
 	static std::map<eStatementType, bool> expands_backup_;
 };
@@ -89,6 +89,12 @@ ProbabilityFilter::filter(int v) const
 	return rv;
 }
 
+bool
+ProbabilityFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	return test_all_values(n, values);
+}
+
 /////////////////////////////////////////////////////////////////
 ProbElem::~ProbElem()
 {
@@ -360,7 +366,7 @@ GroupProbElem::dump_val(std::ostream &out)
 
 /////////////////////////////////////////////////////////////////
 
-Probabilities* Probabilities::instance_ = NULL;
+thread_local Probabilities* Probabilities::instance_ = NULL;
 
 Probabilities *
 Probabilities::GetInstance()
@@ -1111,6 +1117,7 @@ void DistributionTable::add_entry(int key, int prob)
 	keys_.push_back(key); 
 	probs_.push_back(prob);  
 	max_prob_ += prob; 
+	bounds_.push_back(max_prob_);
 }
 
 int DistributionTable::key_to_prob(int key) const 
@@ -1127,14 +1134,11 @@ int DistributionTable::key_to_prob(int key) const
 int DistributionTable::rnd_num_to_key(int rnd) const
 {
 	assert(rnd < max_prob_ && rnd >= 0);
-	assert(keys_.size() == probs_.size());
-	for (size_t i=0; i<probs_.size(); i++) {
-		if (rnd < probs_[i]) {
-			return keys_[i];
-		}
-		rnd -= probs_[i];
-	}
-	assert(0);
-	return -1;
+	assert(keys_.size() == bounds_.size());
+	// the first entry whose running sum exceeds rnd; zero-probability
+	// entries share their predecessor's bound and are never picked
+	size_t i = upper_bound(bounds_.begin(), bounds_.end(), rnd) - bounds_.begin();
+	assert(i < keys_.size());
+	return keys_[i];
 }
 
@@ -240,6 +240,8 @@ public:
 	virtual ~ProbabilityFilter(void);
 
 	virtual bool filter(int v) const;
+
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
 private:
 	const ProbName pname_;
 };
@@ -431,7 +433,7 @@ private:
 
 	void initialize();
 
-	static Probabilities *instance_;
+	static thread_local Probabilities *instance_;
 
 	static const char comment_line_prefix;
 
@@ -32,7 +32,6 @@
 
 #include <vector>
 #include <algorithm>
-#include <functional>
 #include <assert.h>
 #include "Probabilities.h"
 #include "VectorFilter.h"
@@ -41,24 +40,11 @@
 
 using namespace std;
 
-template <class Key, class Value>
-class TableEntry {
-public:
-	TableEntry(Key k, Value v);
-
-	Key get_key() { return key_; }
-
-	Value get_value() { return value_; }
-
-private:
-	Key key_;
-	Value value_;
-};
-
+// Keys are cumulative upper bounds kept sorted in a flat array, so a
+// lookup is a single binary search.  Entries with equal keys keep their
+// insertion order.
 template <class Key, class Value>
 class ProbabilityTable {
-	typedef TableEntry<Key, Value> Entry;
-
 public:
 	ProbabilityTable();
 
@@ -68,36 +54,21 @@ public:
 
 	void add_elem(Key k, Value v);
 
-	void sorted_insert(Entry *t);
-
-	Value get_value(Key k);
+	Value get_value(Key k) const;
 
 private:
-	Key curr_max_key_;
-	std::vector<Entry *> table_; 
+	std::vector<Key> keys_;
+	std::vector<Value> values_;
 };
 
-template <class Key, class Value>
-TableEntry<Key, Value>::TableEntry(Key k, Value v)
-	: key_(k),
-	  value_(v)
-{
-}
-
 template <class Key, class Value>
 ProbabilityTable<Key, Value>::ProbabilityTable()
-	: curr_max_key_(0)
 {
-	table_.clear();
 }
 
 template <class Key, class Value>
 ProbabilityTable<Key, Value>::~ProbabilityTable()
 {
-	typename vector<Entry *>::iterator i;
-	for (i = table_.begin(); i != table_.end(); ++i) 
-		delete (*i);
-	table_.clear();
 }
 
 template <class Key, class Value>
@@ -107,70 +78,25 @@ void ProbabilityTable<Key, Value>::initialize(ProbName pname)
 	impl_->set_prob_table(this, pname);
 }
 
-template <class Key, class Value>
-bool my_less(TableEntry<Key, Value> *t, Key k2)
-{
-	Key k1 = t->get_key();
-	return (k1 < k2);
-}
-
-template <class Key, class Value>
-bool my_greater(TableEntry<Key, Value> *t, Key k2)
-{
-	Key k1 = t->get_key();
-	return (k1 > k2);
-}
-
-template <class Key, class Value>
-void
-ProbabilityTable<Key, Value>::sorted_insert(Entry *t)
-{
-	assert(t);
-	
-	Key k = t->get_key();
-
-	if (table_.empty()) {
-		table_.push_back(t);
-		curr_max_key_ = k;
-		return;
-	}
-	
-	typename vector<Entry *>::iterator i;
-	for (i=table_.begin(); i!=table_.end(); i++) {
-		if (my_greater<Key, Value>(*i, k)) {
-			break;
-		}
-	}
-	//i = find_if(table_.begin(), table_.end(), std::bind2nd(std::ptr_fun(my_greater<Key, Value>), k));
-
-	if (i != table_.end()) {
-		table_.insert(i, t);	
-	}
-	else {
-		table_.push_back(t);
-		curr_max_key_ = k;
-	}
-}
-
 template <class Key, class Value>
 void
 ProbabilityTable<Key, Value>::add_elem(Key k, Value v)
 {
-	Entry *t = new Entry(k, v);
-	sorted_insert(t);
+	size_t pos = std::upper_bound(keys_.begin(), keys_.end(), k) - keys_.begin();
+	keys_.insert(keys_.begin() + pos, k);
+	values_.insert(values_.begin() + pos, v);
 }
 
 template <class Key, class Value>
 Value
-ProbabilityTable<Key, Value>::get_value(Key k)
+ProbabilityTable<Key, Value>::get_value(Key k) const
 {
-	assert(k < curr_max_key_);
-
-	typename vector<Entry *>::iterator i;
-	i = find_if(table_.begin(), table_.end(), std::bind2nd(std::ptr_fun(my_greater<Key, Value>), k));
+	assert(!keys_.empty() && k < keys_.back());
 
-	assert(i != table_.end());
-	return (*i)->get_value();
+	// the first entry whose key is greater than k
+	size_t pos = std::upper_bound(keys_.begin(), keys_.end(), k) - keys_.begin();
+	assert(pos < values_.size());
+	return values_[pos];
 }
 
 class DistributionTable {  
@@ -186,6 +112,7 @@ private:
 	int max_prob_;
 	vector<int> keys_;
 	vector<int> probs_; 
+	vector<int> bounds_;	// running sums of probs_, for rnd_num_to_key
 };
 
 #endif
@@ -0,0 +1,116 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef RANDOM_ENGINE_H
+#define RANDOM_ENGINE_H
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include "CommonMacros.h"
+
+enum RNG_ENGINE {
+	rXoshiroEngine = 0,
+	rLrand48Engine,
+};
+
+/*
+ * The source of raw random numbers behind the random number generators.
+ * Each RandomNumber instance owns one, so generators never share state
+ * with another program being generated.
+ *
+ * rXoshiroEngine is xoshiro256** with unbiased bounded sampling.
+ * rLrand48Engine reproduces the lrand48() sequence and the "% n" reduction
+ * of old versions, so that historic seeds generate the same programs.
+ */
+class RandomEngine
+{
+public:
+	explicit RandomEngine(RNG_ENGINE kind);
+
+	void seed(unsigned long seed);
+
+	// A random number of at least 31 bits.
+	unsigned long next(void) {
+		return kind_ == rLrand48Engine ? next_lrand48() : next_xoshiro() >> 32;
+	}
+
+	// A random number in [0, n).
+	unsigned int upto(const unsigned int n) {
+		if (kind_ == rLrand48Engine)
+			return next_lrand48() % n;
+		// Lemire's multiply-shift method: the product's high word is
+		// uniform once the few low words that would bias it are rejected.
+		uint64_t m = (next_xoshiro() >> 32) * n;
+		uint32_t l = static_cast<uint32_t>(m);
+		if (l < n) {
+			uint32_t t = -n % n;
+			while (l < t) {
+				m = (next_xoshiro() >> 32) * n;
+				l = static_cast<uint32_t>(m);
+			}
+		}
+		return static_cast<unsigned int>(m >> 32);
+	}
+
+	RNG_ENGINE kind(void) const { return kind_; }
+
+private:
+	unsigned long next_lrand48(void) {
+		rand48_ = (rand48_ * 0x5DEECE66DULL + 0xB) & 0xFFFFFFFFFFFFULL;
+		return static_cast<unsigned long>(rand48_ >> 17);
+	}
+
+	uint64_t next_xoshiro(void) {
+		const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+		const uint64_t t = s_[1] << 17;
+		s_[2] ^= s_[0];
+		s_[3] ^= s_[1];
+		s_[1] ^= s_[2];
+		s_[0] ^= s_[3];
+		s_[2] ^= t;
+		s_[3] = rotl(s_[3], 45);
+		return result;
+	}
+
+	static uint64_t rotl(const uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	const RNG_ENGINE kind_;
+
+	uint64_t rand48_;
+
+	uint64_t s_[4];
+
+	// Don't implement them
+	DISALLOW_COPY_AND_ASSIGN(RandomEngine);
+};
+
+#endif //RANDOM_ENGINE_H
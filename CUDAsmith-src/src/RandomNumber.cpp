@@ -32,12 +32,14 @@
 #include <cassert>
 #include <iostream>
 #include "AbsRndNumGenerator.h"
+#include "CGOptions.h"
 #include "Filter.h"
 
-RandomNumber *RandomNumber::instance_ = NULL;
+thread_local RandomNumber *RandomNumber::instance_ = NULL;
 
 RandomNumber::RandomNumber(const unsigned long seed)
-	: seed_(seed)
+	: seed_(seed),
+	  engine_(static_cast<RNG_ENGINE>(CGOptions::rng_engine()))
 {
 	unsigned int count = AbsRndNumGenerator::count();
 
@@ -175,5 +177,6 @@ RandomNumber::doFinalization()
 		}
 	}
 	delete instance_;
+	instance_ = NULL;
 }
 
@@ -36,6 +36,7 @@
 #include <map>
 #include "CommonMacros.h"
 #include "AbsRndNumGenerator.h"
+#include "RandomEngine.h"
 
 class Filter;
 
@@ -64,6 +65,9 @@ public:
 
 	void get_sequence(std::string &sequence);
 
+	// The raw random numbers shared by all the generators of this instance.
+	RandomEngine &engine(void) { return engine_; }
+
 	// Probably it's not a good idea to define those functions with default arguments.
 	// It would have potential problem to be misused. 
 	// I defined them in this way only for compatible to the previous code.
@@ -83,13 +87,15 @@ protected:
 
 	AbsRndNumGenerator *curr_generator_;
 
-	static RandomNumber *instance_;
+	static thread_local RandomNumber *instance_;
 
 	std::map<RNDNUM_GENERATOR, AbsRndNumGenerator*> generators_;
 
 private:
 	const unsigned long seed_;
 
+	RandomEngine engine_;
+
 	explicit RandomNumber(const unsigned long seed);
 
 	explicit RandomNumber(AbsRndNumGenerator *rndnum_generator);
@@ -41,7 +41,7 @@
 
 using namespace std;
 
-vector<string> SafeOpFlags::wrapper_names;
+thread_local vector<string> SafeOpFlags::wrapper_names;
 
 SafeOpFlags::SafeOpFlags()
 {
@@ -33,6 +33,7 @@
 #include <ostream>
 #include "FunctionInvocation.h"
 #include "Type.h"
+#include "NodeArena.h"
 
 enum SafeOpKind {
 	sOpUnary,
@@ -85,7 +86,11 @@ public:
 
 	~SafeOpFlags();
 
-	static std::vector<std::string> wrapper_names;;
+	// allocated from the per-program NodeArena
+	static void *operator new(size_t size) { return NodeArena::allocate(size); }
+	static void operator delete(void *p, size_t size) { NodeArena::deallocate(p, size); }
+
+	static thread_local std::vector<std::string> wrapper_names;;
 private:
 	bool op1_;
 	bool op2_;
@@ -44,7 +44,7 @@
 #include "DefaultRndNumGenerator.h"
 #include "DeltaMonitor.h"
 
-SimpleDeltaRndNumGenerator *SimpleDeltaRndNumGenerator::impl_ = 0;
+thread_local SimpleDeltaRndNumGenerator *SimpleDeltaRndNumGenerator::impl_ = 0;
 
 SimpleDeltaRndNumGenerator::SimpleDeltaRndNumGenerator(Sequence *concrete_seq)
 	: rand_depth_(0),
@@ -188,14 +188,14 @@ unsigned int
 SimpleDeltaRndNumGenerator::pure_rnd_upto(const unsigned int bound)
 {
 	assert(impl_);
-	return impl_->genrand() % bound;
+	return impl_->genrand_upto(bound);
 }
 
 bool
 SimpleDeltaRndNumGenerator::pure_rnd_flipcoin(const unsigned int p)
 {
 	assert(impl_);
-	bool rv = (impl_->genrand() % 100) < p;
+	bool rv = impl_->genrand_upto(100) < p;
 	return rv;
 }
 
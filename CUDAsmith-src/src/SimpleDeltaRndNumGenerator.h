@@ -80,7 +80,7 @@ private:
 	void switch_to_default_generator();
 
 	// ----------------------------------------------------------------------------------------
-	static SimpleDeltaRndNumGenerator *impl_;
+	static thread_local SimpleDeltaRndNumGenerator *impl_;
 
 	unsigned INT64 rand_depth_;
 
@@ -87,7 +87,7 @@ Statement *make_random_st(CGContext& cg_context);
 }  // namespace CUDASmith
 
 using namespace std;
-const Statement* Statement::failed_stm;
+thread_local const Statement* Statement::failed_stm;
 
 ///////////////////////////////////////////////////////////////////////////////
 class StatementFilter : public Filter
@@ -98,6 +98,8 @@ public:
 	virtual ~StatementFilter(void);
 
 	virtual bool filter(int v) const;
+
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
 private:
 	const CGContext &cg_context_;
 };
@@ -115,7 +117,7 @@ StatementFilter::~StatementFilter(void)
 
 // use a table to define probabilities of different kinds of statements
 // Must initialize it before use
-ProbabilityTable<unsigned int, ProbName> *Statement::stmtTable_ = NULL;
+thread_local ProbabilityTable<unsigned int, ProbName> *Statement::stmtTable_ = NULL;
 
 void
 Statement::InitProbabilityTable()
@@ -187,6 +189,14 @@ bool StatementFilter::filter(int value) const
 	return false;
 }
 
+bool
+StatementFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	if (PartialExpander::is_expanding())
+		return false;
+	return test_all_values(n, values);
+}
+
 int find_stm_in_set(const vector<const Statement*>& set, const Statement* s)
 {
     size_t i;
@@ -235,7 +245,15 @@ StatementProbability(const StatementFilter *filter)
 	return Statement::number_to_type(value);
 }
 
-int Statement::sid = 0;
+thread_local int Statement::sid = 0;
+
+void
+Statement::doFinalization(void)
+{
+	sid = 0;
+	failed_stm = NULL;
+}
+
 /*
  *
  */
@@ -389,6 +407,7 @@ Statement::Statement(eStatementType st, Block* b)
 {
 	stm_id = Statement::sid;
 	Statement::sid++;
+	fact_slot = -1;
 }
 
 /*
@@ -559,10 +578,10 @@ Statement::set_accumulated_effect_after_block(Effect& eff, const Block* b, CGCon
  * add back return_facts for skipped statement (see validate_and_update_facts)
  */
 void 
-Statement::add_back_return_facts(FactMgr* fm, std::vector<const Fact*>& facts) const
+Statement::add_back_return_facts(FactMgr* fm, FactVec& facts) const
 {  
 	if (eType == eReturn) { 
-		merge_facts(facts, fm->map_facts_out[this]);
+		merge_facts(facts, fm->map_facts_out.get(this));
 	} else {
 		vector<const Block*> blks;
 		get_blocks(blks);
@@ -580,13 +599,13 @@ Statement::add_back_return_facts(FactMgr* fm, std::vector<const Fact*>& facts) c
  *    2 means there is no shortcut
  */
 int
-Statement::shortcut_analysis(vector<const Fact*>& inputs, CGContext& cg_context) const
+Statement::shortcut_analysis(FactVec& inputs, CGContext& cg_context) const
 {
 	FactMgr* fm = get_fact_mgr_for_func(func);
 	// the output facts of control statement (break/continue/goto) has removed local facts
 	// thus can not take this shortcut. (The facts we get should represent all variables 
 	// visible in subsequent statement)
-	if (same_facts(inputs, fm->map_facts_in[this]) && !is_ctrl_stmt() && !contains_unfixed_goto()) 
+	if (same_facts(inputs, fm->map_facts_in.get(this)) && !is_ctrl_stmt() && !contains_unfixed_goto()) 
 	{
 		//cg_context.get_effect_context().Output(cout);
 		//print_facts(inputs);
@@ -594,7 +613,7 @@ Statement::shortcut_analysis(vector<const Fact*>& inputs, CGContext& cg_context)
 		if (cg_context.in_conflict(fm->map_stm_effect[this])) { 
 			return 1;
 		}
-		inputs = fm->map_facts_out[this];
+		inputs = fm->map_facts_out.get(this);
 		cg_context.add_effect(fm->map_stm_effect[this]);
 		fm->map_accum_effect[this] = *(cg_context.get_effect_accum());
 		return 0;
@@ -609,7 +628,7 @@ Statement::shortcut_analysis(vector<const Fact*>& inputs, CGContext& cg_context)
  * shortcut: if this input env matches previous input env, use previous output env directly 
  ***************************************************************************************/
 bool 
-Statement::validate_and_update_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+Statement::validate_and_update_facts(FactVec& inputs, CGContext& cg_context) const
 {
 	FactMgr* fm = get_fact_mgr_for_func(func);
 	int shortcut = shortcut_analysis(inputs, cg_context);
@@ -634,7 +653,7 @@ Statement::validate_and_update_facts(vector<const Fact*>& inputs, CGContext& cg_
 	}
 	if (shortcut==1) return false;
 	
-	vector<const Fact*> inputs_copy = inputs; 
+	FactVec inputs_copy = inputs; 
 	if (!stm_visit_facts(inputs, cg_context)) {
 		return false;
 	}  
@@ -644,7 +663,7 @@ Statement::validate_and_update_facts(vector<const Fact*>& inputs, CGContext& cg_
 }
 
 bool 
-Statement::stm_visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+Statement::stm_visit_facts(FactVec& inputs, CGContext& cg_context) const
 { 
 	cg_context.get_effect_stm().clear();
 	cg_context.curr_blk = parent;
@@ -843,14 +862,14 @@ Statement::contains_unfixed_goto(void) const
 		}
 		if (edge->src->eType == eGoto && fm->map_visited[edge->src] && contains_stmt(edge->dest)) {
 			// take care the special case caused by StatementGoto::visit_facts
-			if (!fm->map_facts_out[edge->src].empty() && fm->map_facts_in[edge->dest].empty()) {
+			if (!fm->map_facts_out.get(edge->src).empty() && fm->map_facts_in.get(edge->dest).empty()) {
 				return true;
 			}
-			for (j=0; j<fm->map_facts_in[edge->dest].size(); j++) {
-				const Fact* f = fm->map_facts_in[edge->dest][j];
+			for (j=0; j<fm->map_facts_in.get(edge->dest).size(); j++) {
+				const Fact* f = fm->map_facts_in.get(edge->dest)[j];
 				// ignore return variable facts
 				if (!f->get_var()->is_rv()) {
-					const Fact* jump_src_f = find_related_fact(fm->map_facts_out[edge->src], f);
+					const Fact* jump_src_f = find_related_fact(fm->map_facts_out.get(edge->src), f);
 					if (jump_src_f && !f->imply(*jump_src_f)) {
 						return true;
 					}
@@ -862,7 +881,7 @@ Statement::contains_unfixed_goto(void) const
 }
 
 bool 
-Statement::analyze_with_edges_in(vector<const Fact*>& inputs, CGContext& cg_context) const
+Statement::analyze_with_edges_in(FactVec& inputs, CGContext& cg_context) const
 { 
 	FactMgr* fm = get_fact_mgr(&cg_context); 
 	size_t i;
@@ -875,7 +894,7 @@ Statement::analyze_with_edges_in(vector<const Fact*>& inputs, CGContext& cg_cont
 		for (i=0; i<edges.size(); i++) { 
 			const Statement* src = edges[i]->src;
 			if (fm->map_visited[src]) { 
-				FactMgr::merge_jump_facts(inputs, fm->map_facts_out[src]);
+				FactMgr::merge_jump_facts(inputs, fm->map_facts_out.get(src));
 				cg_context.add_effect(fm->map_accum_effect[src]);
 			}
 		}
@@ -886,7 +905,7 @@ Statement::analyze_with_edges_in(vector<const Fact*>& inputs, CGContext& cg_cont
 		for (i=0; i<edges.size(); i++) {
 			const Statement* src = edges[i]->src;
 			if (fm->map_visited[src]) {
-				FactMgr::merge_jump_facts(inputs, fm->map_facts_out[src]); 
+				FactMgr::merge_jump_facts(inputs, fm->map_facts_out.get(src)); 
 				cg_context.add_effect(fm->map_accum_effect[src]);
 			}
 		} 
@@ -901,7 +920,7 @@ Statement::analyze_with_edges_in(vector<const Fact*>& inputs, CGContext& cg_cont
  * statement, we do it here
  ****************************************************************************/
 void 
-Statement::post_creation_analysis(vector<const Fact*>& pre_facts, const Effect& pre_effect, CGContext& cg_context) const
+Statement::post_creation_analysis(FactVec& pre_facts, const Effect& pre_effect, CGContext& cg_context) const
 {
 	FactMgr* fm = get_fact_mgr_for_func(func); 
 	if (eType == eIfElse) {
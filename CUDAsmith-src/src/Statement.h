@@ -43,6 +43,7 @@
 #include <ostream>
 #include <string>
 #include "Probabilities.h"
+#include "NodeArena.h"
 using namespace std;
 
 #ifndef STATEMENT_H
@@ -57,6 +58,7 @@ class FunctionInvocationUser;
 class ExpressionVariable;
 class FactMgr;
 class Fact;
+class FactVec;
 class Block;
 class Effect;
 class CFGEdge;
@@ -99,23 +101,27 @@ public:
 
 	virtual ~Statement(void);
 
+	// allocated from the per-program NodeArena
+	static void *operator new(size_t size) { return NodeArena::allocate(size); }
+	static void operator delete(void *p, size_t size) { NodeArena::deallocate(p, size); }
+
 	eStatementType get_type(void) const { return eType; }
 
 	void get_called_funcs(std::vector<const FunctionInvocationUser*>& funcs) const;
 
 	const FunctionInvocation* get_direct_invocation(void) const;
 
-	virtual bool visit_facts(vector<const Fact*>& /*inputs*/, CGContext& /*cg_context*/) const {return true;};
+	virtual bool visit_facts(FactVec& /*inputs*/, CGContext& /*cg_context*/) const {return true;};
 
 	void output_hash(std::ostream &out, int indent) const;
 
-	bool stm_visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	bool stm_visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
-	bool validate_and_update_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	bool validate_and_update_facts(FactVec& inputs, CGContext& cg_context) const;
 
-	int shortcut_analysis(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	int shortcut_analysis(FactVec& inputs, CGContext& cg_context) const;
 
-	bool analyze_with_edges_in(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	bool analyze_with_edges_in(FactVec& inputs, CGContext& cg_context) const;
 
 	int find_typed_stmts(vector<const Statement*>& stms, const vector<int>& stmt_types) const;
 
@@ -125,9 +131,9 @@ public:
 
 	bool contains_unfixed_goto(void) const;
 
-	void post_creation_analysis(vector<const Fact*>& pre_facts, const Effect& pre_effect,  CGContext& cg_context) const;
+	void post_creation_analysis(FactVec& pre_facts, const Effect& pre_effect,  CGContext& cg_context) const;
 
-	void add_back_return_facts(FactMgr* fm, std::vector<const Fact*>& facts) const;
+	void add_back_return_facts(FactMgr* fm, FactVec& facts) const;
 
 	bool in_block(const Block* b) const; 
 
@@ -185,16 +191,20 @@ public:
 
 	// unique id for each statement
 	int stm_id;
+	// dense id within the fact maps of its function, see StmSlots
+	mutable int fact_slot;
 	Function* func;
 	Block* parent;
-	static const Statement* failed_stm;
+	static thread_local const Statement* failed_stm;
+
+	static thread_local ProbabilityTable<unsigned int, ProbName> *stmtTable_;
 
-	static ProbabilityTable<unsigned int, ProbName> *stmtTable_;
+	static void doFinalization(void);
 protected:
 	Statement(eStatementType st, Block* parent);
 
 private:
-	static int sid;
+	static thread_local int sid;
 
 	Statement &operator=(const Statement &s); // unimplementable
 
@@ -284,7 +284,7 @@ StatementArrayOp::Output(std::ostream &out, FactMgr* fm, int indent) const
 }
 
 bool 
-StatementArrayOp::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementArrayOp::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {   
 	// walk the iterations
 	size_t i;
@@ -306,7 +306,7 @@ StatementArrayOp::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context
 		if (body->must_return()) {
 			inputs = facts_copy;
 		} else {
-			inputs = fm->map_facts_in[body];
+			inputs = fm->map_facts_in.get(body);
 		}
 		// include the facts from "break" statements 
 		// find edges leading to the end of this statement, and merge 
@@ -314,7 +314,7 @@ StatementArrayOp::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context
 		find_edges_in(edges, true, false);
 		for (i=0; i<edges.size(); i++) { 
 			const Statement* src = edges[i]->src;
-			FactMgr::merge_jump_facts(inputs, fm->map_facts_out[src]);
+			FactMgr::merge_jump_facts(inputs, fm->map_facts_out.get(src));
 		}
 		// compute accumulated effect
 		set_accumulated_effect_after_block(eff, body, cg_context);
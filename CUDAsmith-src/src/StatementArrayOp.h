@@ -67,7 +67,7 @@ public:
 	void output_header(std::ostream& out, int& indent) const;
 	virtual void get_exprs(std::vector<const Expression*>& exps) const { if (init_value) exps.push_back(init_value);}
 	virtual void get_blocks(std::vector<const Block*>& blks) const { if (body) blks.push_back(body);}
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const; 
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const; 
 	virtual void Output(std::ostream &out, FactMgr* fm, int indent = 0) const;
  
 	const ArrayVariable* array_var;
@@ -62,11 +62,12 @@ using namespace std;
 //
 // use a table to define probabilities of different kinds of statements
 // Must initialize it before use
-DistributionTable StatementAssign::assignOpsTable_;
+thread_local DistributionTable StatementAssign::assignOpsTable_;
 
 void
 StatementAssign::InitProbabilityTable()
 { 
+	assignOpsTable_ = DistributionTable();
 	assignOpsTable_.add_entry((int)eSimpleAssign, 70);
 	assignOpsTable_.add_entry((int)eBitAndAssign, 10);
 	assignOpsTable_.add_entry((int)eBitXorAssign, 10);
@@ -181,10 +182,10 @@ StatementAssign::make_random(CGContext &cg_context, const Type* type, const CVQu
 	lhs_cg_context.get_effect_stm() = rhs_cg_context.get_effect_stm();
 	lhs_cg_context.curr_rhs = e;
 
-	bool prev_flag = CGOptions::match_exact_qualifiers(); // keep a copy of previous flag
-	if (qf) CGOptions::match_exact_qualifiers(true);      // force exact qualifier match when selecting vars
+	bool prev_flag = false;
+	if (qf) prev_flag = CGOptions::force_exact_qualifiers(true); // force exact qualifier match when selecting vars
 	lhs = Lhs::make_random(lhs_cg_context, type, &qfer, op != eSimpleAssign, need_no_rhs(op));
-	if (qf) CGOptions::match_exact_qualifiers(prev_flag); // restore flag
+	if (qf) CGOptions::force_exact_qualifiers(prev_flag);        // restore flag
 	ERROR_GUARD_AND_DEL2(NULL, e, lhs);
 
 	// typecast, if needed.
@@ -310,9 +311,9 @@ StatementAssign::compound_to_binary_ops(eAssignOps op)
 }
 
 bool 
-StatementAssign::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementAssign::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {
-	vector<const Fact*> inputs_copy = inputs;
+	FactVec inputs_copy = inputs;
 	// LHS and RHS can be evaludated in arbitrary order, try RHS first
 	Effect running_eff_context(cg_context.get_effect_context());
 	Effect rhs_accum, lhs_accum;  
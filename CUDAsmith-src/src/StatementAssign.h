@@ -111,7 +111,7 @@ public:
 
 	virtual void get_blocks(std::vector<const Block*>& /* blks */) const {}; 
 	virtual void get_exprs(std::vector<const Expression*>& exps) const {exps.push_back(&expr); exps.push_back(&lhs);}
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual std::vector<const ExpressionVariable*> get_dereferenced_ptrs(void) const;
 	virtual bool has_uncertain_call_recursive(void) const;
@@ -138,7 +138,7 @@ private:
 	std::string tmp_var1;
 	std::string tmp_var2;
 
-	static DistributionTable assignOpsTable_;
+	static thread_local DistributionTable assignOpsTable_;
 
 	StatementAssign(const StatementAssign &sa);  // unimplemented
 
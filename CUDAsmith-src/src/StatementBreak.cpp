@@ -133,7 +133,7 @@ StatementBreak::Output(std::ostream &out, FactMgr* /*fm*/, int indent) const
 }
 
 bool 
-StatementBreak::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementBreak::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {    
 	// evaludate condition first
 	if (!test.visit_facts(inputs, cg_context)) {
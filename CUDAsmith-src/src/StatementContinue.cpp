@@ -133,7 +133,7 @@ StatementContinue::Output(std::ostream &out, FactMgr* /*fm*/, int indent) const
 }
 
 bool 
-StatementContinue::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementContinue::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {    
 	// evaludate condition first
 	if (!test.visit_facts(inputs, cg_context)) {
@@ -52,18 +52,16 @@ StatementExpr::make_random(CGContext &cg_context)
 {
 	DEPTH_GUARD_BY_TYPE_RETURN(dtStatementExpr, NULL);
 	FunctionInvocation *invoke;
-	// make copies
-	Effect pre_effect = cg_context.get_accum_effect();
-	FactMgr* fm = get_fact_mgr(&cg_context);
-	vector<const Fact*> facts_copy = fm->global_facts; 
+	// open checkpoints
+	AttemptCheckpoint attempt(cg_context, false, get_fact_mgr(&cg_context));
 	invoke = FunctionInvocation::make_random(false, cg_context, 0, 0);  
 	ERROR_GUARD(NULL);
 	if (invoke->failed) {  
-		cg_context.reset_effect_accum(pre_effect);
-		fm->restore_facts(facts_copy); 
+		attempt.rollback();
 		delete invoke; 
 		return 0; 
 	}
+	attempt.commit();
 	return new StatementExpr(cg_context.get_current_block(), *invoke);
 }
 
@@ -108,7 +106,7 @@ StatementExpr::Output(std::ostream &out, FactMgr* /*fm*/, int indent) const
 }
 
 bool 
-StatementExpr::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementExpr::visit_facts(FactVec& inputs, CGContext& cg_context) const
 { 
 	bool ok = expr.visit_facts(inputs, cg_context);
 
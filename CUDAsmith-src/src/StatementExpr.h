@@ -60,7 +60,7 @@ public:
 	const FunctionInvocation* get_invoke(void) const { return expr.get_invoke(); };
 	const ExpressionFuncall* get_call(void) const { return &expr;}
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual std::vector<const ExpressionVariable*> get_dereferenced_ptrs(void) const;
 
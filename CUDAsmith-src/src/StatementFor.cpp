@@ -144,7 +144,7 @@ StatementFor::make_iteration(CGContext& cg_context, StatementAssign*& init, Expr
 	assert(blk);
 
 	// save a copy of facts env and context
-	vector<const Fact*> facts_copy = fm->global_facts;
+	FactVec facts_copy = fm->global_facts;
 	cg_context.get_effect_stm().clear();
 
 	// Select the loop control variable, avoid volatile
@@ -257,7 +257,7 @@ StatementFor::make_random(CGContext &cg_context)
 	const Variable* iv = make_iteration(cg_context, init, test, incr, bound);
 	// record the effect and facts before loop body
 	Effect pre_effects = cg_context.get_effect_stm();
-	vector<const Fact*> pre_facts = fm->global_facts;
+	FactVec pre_facts = fm->global_facts;
 
 	// create CGContext for body
 	CGContext body_cg_context(cg_context, cg_context.rw_directive, iv, bound);  
@@ -307,13 +307,13 @@ StatementFor::make_random_array_loop(const CGContext &cg_context)
 }
 
 void 
-StatementFor::post_loop_analysis(CGContext& cg_context, vector<const Fact*>& pre_facts, Effect& pre_effect)
+StatementFor::post_loop_analysis(CGContext& cg_context, FactVec& pre_facts, Effect& pre_effect)
 {
 	FactMgr* fm = get_fact_mgr(&cg_context);
 	assert(fm);
 	// if the control reached the end of this for-loop with must-return body, it means
 	// the loop is never entered. restore facts to pre-loop env
-	fm->global_facts = fm->map_facts_in[&body];
+	fm->global_facts = fm->map_facts_in.get(&body);
 	if (body.must_return()) {
 		fm->restore_facts(pre_facts);
 	}	
@@ -321,7 +321,7 @@ StatementFor::post_loop_analysis(CGContext& cg_context, vector<const Fact*>& pre
 	for (size_t i=0; i<body.break_stms.size(); i++) {
 		const StatementBreak* stm = dynamic_cast<const StatementBreak*>(body.break_stms[i]);
 		fm->create_cfg_edge(stm, this, true, false);
-		FactMgr::merge_jump_facts(fm->global_facts, fm->map_facts_out[stm]);
+		FactMgr::merge_jump_facts(fm->global_facts, fm->map_facts_out.get(stm));
 	}
 	// compute accumulated effect
 	set_accumulated_effect_after_block(pre_effect, &body, cg_context);
@@ -394,7 +394,7 @@ StatementFor::Output(std::ostream &out, FactMgr* fm, int indent) const
 }
 
 bool 
-StatementFor::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementFor::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {   
 	// walk the initializing statement
 	if (!init.visit_facts(inputs, cg_context)) {
@@ -421,7 +421,7 @@ StatementFor::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) co
 	if (body.must_return()) {
 		inputs = facts_copy;
 	} else {
-		inputs = fm->map_facts_in[&body];
+		inputs = fm->map_facts_in.get(&body);
 	}
 	 
 	// include the facts from "break" statements 
@@ -431,7 +431,7 @@ StatementFor::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) co
 	find_edges_in(edges, true, false);
 	for (i=0; i<edges.size(); i++) { 
 		const Statement* src = edges[i]->src;
-		FactMgr::merge_jump_facts(inputs, fm->map_facts_out[src]);
+		FactMgr::merge_jump_facts(inputs, fm->map_facts_out.get(src));
 	}
 	// compute accumulated effect
 	set_accumulated_effect_after_block(eff, &body, cg_context);
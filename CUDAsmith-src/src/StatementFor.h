@@ -62,7 +62,7 @@ public:
 				 const Block &body);
 	virtual ~StatementFor(void);
 
-	void post_loop_analysis(CGContext& cg_context, vector<const Fact*>& pre_facts, Effect& pre_effect);
+	void post_loop_analysis(CGContext& cg_context, FactVec& pre_facts, Effect& pre_effect);
 	const StatementAssign* get_init(void) const { return &init;};
 	const Expression* get_test(void) const { return &test; };
 	const StatementAssign* get_incr(void) const { return &incr; };
@@ -73,7 +73,7 @@ public:
 
 	virtual void get_exprs(std::vector<const Expression*>& exps) const {exps.push_back(&test);}
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual void Output(std::ostream &out, FactMgr* fm, int indent = 0) const;
 
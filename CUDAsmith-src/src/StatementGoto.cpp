@@ -51,7 +51,7 @@
 
 using namespace std;
 
-std::map<const Statement*, string> StatementGoto::stm_labels;
+thread_local std::map<const Statement*, string> StatementGoto::stm_labels;
 
 ///////////////////////////////////////////////////////////////////////////////
 /*
@@ -119,7 +119,7 @@ StatementGoto::make_random(CGContext &cg_context)
 		} else {
 			// travel in time, find a suitable variable read at generation time of the other statement
 			cond_var = VariableSelector::choose_visible_read_var(ok_blk, 
-				fm->map_accum_effect[other_stm].get_read_vars(), get_int_type(), fm->map_facts_out[other_stm]);
+				fm->map_accum_effect[other_stm].get_read_vars(), get_int_type(), fm->map_facts_out.get(other_stm));
 		}
 		if (cond_var == 0) {
 			return NULL;
@@ -151,28 +151,30 @@ StatementGoto::make_random(CGContext &cg_context)
 			bool ok = true;
 			bool found_new_facts = false;
 			// JYTODO: don't assume facts_in == facts_out for control statements
-			FactVec& goto_in = other_stm->is_ctrl_stmt() ? fm->map_facts_in[other_stm] : fm->map_facts_out[other_stm];
-			FactMgr::update_facts_for_dest(goto_in, goto_out, stm);
-			stm_in = fm->map_facts_in[stm];
-			Effect pre_effect = cg_context.get_accum_effect();
+			// (looked up again each time, visiting "stm" below may change them)
+			StmFactMap& goto_in_map = other_stm->is_ctrl_stmt() ? fm->map_facts_in : fm->map_facts_out;
+			FactMgr::update_facts_for_dest(goto_in_map.get(other_stm), goto_out, stm);
+			stm_in = fm->map_facts_in.get(stm);
+			size_t pre_effect = cg_context.checkpoint_effect_accum();
 			// merge the effect from goto src
 			cg_context.add_effect(fm->map_accum_effect[other_stm]);
 			if (FactMgr::merge_jump_facts(stm_in, goto_out)) {
 				stm_out = stm_in;
 				found_new_facts = true;
-				map<const Statement*, FactVec> facts_in_copy, facts_out_copy;
+				StmFactMap facts_in_copy, facts_out_copy;
 				fm->backup_stm_fact_maps(stm, facts_in_copy, facts_out_copy);
 				ok = stm->stm_visit_facts(stm_out, cg_context);
 				if (!ok) {
 					fm->restore_stm_fact_maps(stm, facts_in_copy, facts_out_copy); 
-					cg_context.reset_effect_accum(pre_effect);
+					cg_context.rollback_effect_accum(pre_effect);
 					return NULL;
 				}
 				// in cases where "stm" contains "other_stm", the above "stm_visit_facts" will cause "map_facts_in[other_stm]" to be updated
 				if (stm->contains_stmt(other_stm)) { 
-					FactMgr::update_facts_for_dest(goto_in, goto_out, stm);
+					FactMgr::update_facts_for_dest(goto_in_map.get(other_stm), goto_out, stm);
 				}
 			} 
+			cg_context.commit_effect_accum(pre_effect);
 			
 			Block* other_blk = other_stm->parent;
 			sg = new StatementGoto(other_blk, *test, stm, skipped_vars);
@@ -185,7 +187,7 @@ StatementGoto::make_random(CGContext &cg_context)
 				}
 			}
 			// take care in/out facts for newly created goto statement, and the jump destination  
-			fm->set_fact_in(sg, goto_in); 
+			fm->set_fact_in(sg, goto_in_map.get(other_stm)); 
 			fm->map_facts_out[sg] = goto_out;
 			fm->map_visited[sg] = true;
 			if (found_new_facts) {
@@ -193,12 +195,12 @@ StatementGoto::make_random(CGContext &cg_context)
 				fm->set_fact_out(stm, stm_out);
 			}
 			fm->create_cfg_edge(sg, stm, false, false);
-			fm->global_facts = fm->map_facts_out[stm];
+			fm->global_facts = fm->map_facts_out.get(stm);
 			// special handling for control statements: their output facts has been altered for oos variables
 			// use the input facts intead (warning: this rely on the assumption that these statements doesn't
 			// change fact env.
 			if (stm->is_ctrl_stmt() || stm->eType == eReturn) {
-				fm->global_facts = fm->map_facts_in[stm];
+				fm->global_facts = fm->map_facts_in.get(stm);
 			}
 			Bookkeeper::forward_jump_cnt++;
 		}
@@ -364,7 +366,7 @@ StatementGoto::must_jump(void) const
 }
 
 bool 
-StatementGoto::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementGoto::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {    
 	// evaludate condition first
 	if (!test.visit_facts(inputs, cg_context)) {
@@ -395,8 +397,8 @@ StatementGoto::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) c
 	 */
 	if (!fm->map_visited[this] &&
 		!fm->map_visited[dest] &&
-		!same_facts(inputs, fm->map_facts_out[this]) && 
-		subset_facts(inputs, fm->map_facts_out[this])) {
+		!same_facts(inputs, fm->map_facts_out.get(this)) && 
+		subset_facts(inputs, fm->map_facts_out.get(this))) {
 			//print_facts(inputs);
 			//cout << endl;
 			//print_facts(fm->map_facts_out[this]);
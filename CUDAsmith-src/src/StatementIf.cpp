@@ -82,7 +82,7 @@ StatementIf::make_random(CGContext &cg_context)
         // generated to be a atomic expression; however, do not generate
         // another atomic expression within an atomic block
         bool build_atomic = CUDASmith::CUDAOptions::atomics() && !cg_context.get_atomic_context() && rnd_flipcoin(30);
-        static int thru = 0;
+        static thread_local int thru = 0;
         thru++;
         if (build_atomic) {
 //           std::cout << "Start atomic block" << std::endl;
@@ -133,7 +133,7 @@ StatementIf::make_random(CGContext &cg_context)
 	ERROR_GUARD_AND_DEL1(NULL, expr);
 
 	// generate false branch with the same env as true branch
-	fm->global_facts = fm->map_facts_in[if_true];  
+	fm->global_facts = fm->map_facts_in.get(if_true);  
         Block *if_false;
         if (build_atomic) {
           if_false = Block::make_dummy_block(cg_context);
@@ -221,9 +221,9 @@ StatementIf::output_branches(std::ostream &out, FactMgr* fm, int indent) const
 }
 
 bool 
-StatementIf::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementIf::visit_facts(FactVec& inputs, CGContext& cg_context) const
 {    
-	vector<const Fact*> inputs_copy = inputs;
+	FactVec inputs_copy = inputs;
 	// evaludate condition first
 	if (!test.visit_facts(inputs, cg_context)) {
 		return false;
@@ -275,12 +275,12 @@ StatementIf::must_jump(void) const
 }
 
 void
-StatementIf::combine_branch_facts(vector<const Fact*>& pre_facts) const
+StatementIf::combine_branch_facts(FactVec& pre_facts) const
 { 
 	FactMgr* fm = get_fact_mgr_for_func(func); 
 	FactVec& outputs = fm->global_facts;
-	fm->makeup_new_var_facts(pre_facts, fm->map_facts_out[&if_true]);
-	fm->makeup_new_var_facts(pre_facts, fm->map_facts_out[&if_false]);
+	fm->makeup_new_var_facts(pre_facts, fm->map_facts_out.get(&if_true));
+	fm->makeup_new_var_facts(pre_facts, fm->map_facts_out.get(&if_false));
 
 	bool true_must_return = if_true.must_return();
 	bool false_must_return = if_false.must_return();
@@ -291,17 +291,17 @@ StatementIf::combine_branch_facts(vector<const Fact*>& pre_facts) const
 	else if (true_must_return) {
 		// since false branch is created after true branch, it's output should 
 		// have all the variables created in true branch already
-		outputs = fm->map_facts_out[&if_false];
+		outputs = fm->map_facts_out.get(&if_false);
 	}
 	else if (false_must_return) {
-		outputs = fm->map_facts_out[&if_true];
+		outputs = fm->map_facts_out.get(&if_true);
 		// if skip the outcome from false branch, don't forget facts of those variables
 		// created in false branch 
-		fm->makeup_new_var_facts(outputs, fm->map_facts_in[&if_false]);
+		fm->makeup_new_var_facts(outputs, fm->map_facts_in.get(&if_false));
 	}
 	else {
-		outputs = fm->map_facts_out[&if_true];
-		merge_facts(outputs, fm->map_facts_out[&if_false]);
+		outputs = fm->map_facts_out.get(&if_true);
+		merge_facts(outputs, fm->map_facts_out.get(&if_false));
 	}
 }
 
@@ -62,12 +62,12 @@ public:
 	const Block* get_false_branch(void) const { return &if_false; };
 	const Expression* get_test(void) const { return &test; };
 
-	void combine_branch_facts(vector<const Fact*>& pre_facts) const;
+	void combine_branch_facts(FactVec& pre_facts) const;
 
 	virtual bool must_return(void) const;
 	virtual bool must_jump(void) const;
 	//
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
 	virtual void Output(std::ostream &out, FactMgr* fm, int indent = 0) const;
 	void output_condition(std::ostream &out, FactMgr* fm, int indent = 0) const;
@@ -75,7 +75,7 @@ StatementReturn::get_dereferenced_ptrs(void) const
 }
 
 bool 
-StatementReturn::visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const
+StatementReturn::visit_facts(FactVec& inputs, CGContext& cg_context) const
 { 
 	if (CGOptions::no_return_dead_ptr()) {
 		const Variable* v = var.get_var();
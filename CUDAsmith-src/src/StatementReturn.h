@@ -66,7 +66,7 @@ public:
 	virtual void get_blocks(std::vector<const Block*>& /* blks */) const {}; 
 	virtual void get_exprs(std::vector<const Expression*>& exps) const {exps.push_back(&var);}
 
-	virtual bool visit_facts(vector<const Fact*>& inputs, CGContext& cg_context) const;
+	virtual bool visit_facts(FactVec& inputs, CGContext& cg_context) const;
 
     const ExpressionVariable* get_var(void) const { return &var;}; 
 
@@ -40,6 +40,8 @@
 #include <sstream>
 #include <assert.h>
 #include <math.h>
+#include <unordered_map>
+#include <unordered_set>
 #include "Common.h"
 #include "CGOptions.h"
 #include "random.h"
@@ -68,14 +70,30 @@ using namespace std;
 /*
  *
  */
-const Type *Type::simple_types[MAX_SIMPLE_TYPES];
+thread_local const Type *Type::simple_types[MAX_SIMPLE_TYPES];
 
-Type *Type::void_type = NULL;
+thread_local Type *Type::void_type = NULL;
 
 // ---------------------------------------------------------------------
 // List of all types used in the program
-static vector<Type *> AllTypes;
-static vector<Type *> derived_types;
+static thread_local vector<Type *> AllTypes;
+static thread_local vector<Type *> derived_types;
+
+// Indices over the lists above, so that each type is looked up in
+// constant time: the members of AllTypes, and the pointer type to each
+// pointee in derived_types
+static thread_local unordered_set<const Type *> all_types_index;
+static thread_local unordered_map<const Type *, Type *> pointer_types;
+
+static void
+add_type(Type *t)
+{
+	AllTypes.push_back(t);
+	all_types_index.insert(t);
+}
+
+// Sequence id of the next struct/union type
+static thread_local unsigned int struct_union_sequence = 0;
 
 //////////////////////////////////////////////////////////////////////
 class NonVoidTypeFilter : public Filter
@@ -87,6 +105,8 @@ class NonVoidTypeFilter : public Filter
 
 	virtual bool filter(int v) const;
 
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
+
 	Type *get_type();
 
   private:
@@ -125,6 +145,20 @@ bool NonVoidTypeFilter::filter(int v) const
 	return false;
 }
 
+// The tests of filter(), without marking the types as used.
+bool NonVoidTypeFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	values.clear();
+	for (unsigned int v = 0; v < n; v++) {
+		const Type *type = AllTypes[v];
+		if (type->eType == eSimple &&
+			(type->simple_type == eVoid || SIMPLE_TYPES_PROB_FILTER->filter(type->simple_type)))
+			continue;
+		values.push_back(v);
+	}
+	return true;
+}
+
 Type *
 NonVoidTypeFilter::get_type()
 {
@@ -141,6 +175,8 @@ class NonVoidNonVolatileTypeFilter : public Filter
 
 	virtual bool filter(int v) const;
 
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
+
 	Type *get_type();
 
   private:
@@ -192,6 +228,25 @@ bool NonVoidNonVolatileTypeFilter::filter(int v) const
 	return false;
 }
 
+// The tests of filter(), without marking the types as used.
+bool NonVoidNonVolatileTypeFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	values.clear();
+	for (unsigned int v = 0; v < n; v++) {
+		const Type *type = AllTypes[v];
+		if (type->eType == eSimple &&
+			(type->simple_type == eVoid || SIMPLE_TYPES_PROB_FILTER->filter(type->simple_type)))
+			continue;
+		if (type->is_aggregate() && type->is_volatile_struct_union())
+			continue;
+		if ((type->eType == eStruct && !CGOptions::arg_structs()) ||
+			(type->eType == eUnion && !CGOptions::arg_unions()))
+			continue;
+		values.push_back(v);
+	}
+	return true;
+}
+
 Type *
 NonVoidNonVolatileTypeFilter::get_type()
 {
@@ -208,6 +263,8 @@ class ChooseRandomTypeFilter : public Filter
 
 	virtual bool filter(int v) const;
 
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
+
 	Type *get_type();
 
 	bool for_field_var_;
@@ -247,6 +304,13 @@ bool ChooseRandomTypeFilter::filter(int v) const
 	return false;
 }
 
+// filter() only remembers the type it was last given, and the one drawn is
+// given to it again.
+bool ChooseRandomTypeFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	return test_all_values(n, values);
+}
+
 Type *
 ChooseRandomTypeFilter::get_type()
 {
@@ -264,7 +328,9 @@ Type::Type(eSimpleType simple_type) : eType(eSimple),
 									  simple_type(simple_type),
 									  used(false),
 									  printed(false),
-									  packed_(false)
+									  packed_(false),
+									  const_struct_union_(false),
+									  volatile_struct_union_(false)
 {
 	// Nothing else to do.
 }
@@ -298,12 +364,13 @@ Type::Type(vector<const Type *> &struct_fields, bool isStruct, bool packed,
 																	  qfers_(qfers),
 																	  bitfields_length_(fields_length)
 {
-	static unsigned int sequence = 0;
 	if (isStruct)
 		eType = eStruct;
 	else
 		eType = eUnion;
-	sid = sequence++;
+	sid = struct_union_sequence++;
+	const_struct_union_ = has_const_member();
+	volatile_struct_union_ = has_volatile_member();
 }
 
 // --------------------------------------------------------------
@@ -313,7 +380,9 @@ Type::Type(const Type *t) : eType(ePointer),
 							ptr_type(t),
 							used(false),
 							printed(false),
-							packed_(false)
+							packed_(false),
+							const_struct_union_(false),
+							volatile_struct_union_(false)
 {
 	// Nothing else to do.
 }
@@ -346,7 +415,7 @@ Type::operator=(const Type& t)
 const Type &
 Type::get_simple_type(eSimpleType st)
 {
-	static bool inited = false;
+	static thread_local bool inited = false;
 
 	if (!inited)
 	{
@@ -372,7 +441,7 @@ Type::get_simple_type(eSimpleType st)
 		{
 			Type *t = new Type(st);
 			Type::simple_types[st] = t;
-			AllTypes.push_back(t);
+			add_type(t);
 		}
 	}
 	return *Type::simple_types[st];
@@ -442,12 +511,9 @@ get_int_type()
 Type *
 Type::find_type(const Type *t)
 {
-	for (size_t i = 0; i < AllTypes.size(); i++)
+	if (all_types_index.count(t))
 	{
-		if (AllTypes[i] == t)
-		{
-			return AllTypes[i];
-		}
+		return const_cast<Type *>(t);
 	}
 	return 0;
 }
@@ -459,23 +525,22 @@ Type::find_type(const Type *t)
 Type *
 Type::find_pointer_type(const Type *t, bool add)
 {
-	for (size_t i = 0; i < derived_types.size(); i++)
+	unordered_map<const Type *, Type *>::const_iterator i = pointer_types.find(t);
+	if (i != pointer_types.end())
 	{
-		if (derived_types[i]->ptr_type == t)
-		{
-			return derived_types[i];
-		}
+		return i->second;
 	}
 	if (add)
 	{
 		Type *ptr_type = new Type(t);
 		derived_types.push_back(ptr_type);
+		pointer_types[t] = ptr_type;
 		return ptr_type;
 	}
 	return 0;
 }
 
-bool Type::is_const_struct_union() const
+bool Type::has_const_member() const
 {
 	if (!is_aggregate())
 		return false;
@@ -495,7 +560,7 @@ bool Type::is_const_struct_union() const
 	return false;
 }
 
-bool Type::is_volatile_struct_union() const
+bool Type::has_volatile_member() const
 {
 	if (!is_aggregate())
 		return false;
@@ -1088,7 +1153,7 @@ void Type::make_all_struct_union_types(void)//此函数没有被执行到
 		make_all_struct_types(level, accum_types);
 		assert(accum_types.size() >= AllTypes.size());
 		for (size_t i = AllTypes.size(); i < accum_types.size(); ++i)
-			AllTypes.push_back(const_cast<Type *>(accum_types[i]));
+			add_type(const_cast<Type *>(accum_types[i]));
 	}
 }
 
@@ -1220,7 +1285,7 @@ void Type::GenerateSimpleTypes(void)
 	unsigned int st;
 	for (st = eChar; st < MAX_SIMPLE_TYPES; st++)
 	{
-		AllTypes.push_back(new Type((enum eSimpleType)st));
+		add_type(new Type((enum eSimpleType)st));
 	}
 	Type::void_type = new Type((enum eSimpleType)eVoid);
 }
@@ -1244,7 +1309,7 @@ void GenerateAllTypes(void)
 		while (MoreTypesProbability())
 		{
 			Type *ty = Type::make_random_struct_type();
-			AllTypes.push_back(ty);
+			add_type(ty);
 		}
 	}
 	if (CGOptions::use_union())
@@ -1252,7 +1317,7 @@ void GenerateAllTypes(void)
 		while (MoreTypesProbability())
 		{
 			Type *ty = Type::make_random_union_type();
-			AllTypes.push_back(ty);
+			add_type(ty);
 		}
 	}
 }
@@ -2080,10 +2145,18 @@ void Type::doFinalization(void)
 	for (j = AllTypes.begin(); j != AllTypes.end(); ++j)
 		delete (*j);
 	AllTypes.clear();
+	all_types_index.clear();
 
 	for (j = derived_types.begin(); j != derived_types.end(); ++j)
 		delete (*j);
 	derived_types.clear();
+	pointer_types.clear();
+
+	for (int i = 0; i < MAX_SIMPLE_TYPES; ++i)
+		simple_types[i] = 0;
+	delete void_type;
+	void_type = NULL;
+	struct_union_sequence = 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -247,8 +247,8 @@ public:
 	bool has_bitfields() const;
 	bool has_padding(void) const;
 	bool contain_pointer_field(void) const;
-	bool is_const_struct_union() const;
-	bool is_volatile_struct_union() const;
+	bool is_const_struct_union() const { return const_struct_union_; }
+	bool is_volatile_struct_union() const { return volatile_struct_union_; }
 	bool is_int(void) const { return eType == eSimple && simple_type != eVoid;}
 	bool is_aggregate(void) const { return eType == eStruct || eType == eUnion;}
 	bool match(const Type* t, enum eMatchType mt) const;
@@ -276,11 +276,17 @@ public:
 
 	int vector_length_;                 // For vectors. Embed the length.
 
-	static Type *void_type;
+	static thread_local Type *void_type;
 private:	
 	DISALLOW_COPY_AND_ASSIGN(Type);
 
-	static const Type *simple_types[MAX_SIMPLE_TYPES];
+	// a struct/union's fields never change, so these are computed once
+	bool has_const_member(void) const;
+	bool has_volatile_member(void) const;
+	bool const_struct_union_;
+	bool volatile_struct_union_;
+
+	static thread_local const Type *simple_types[MAX_SIMPLE_TYPES];
 
 	// Package init.
 	friend void GenerateAllTypes(void);
@@ -68,8 +68,14 @@
 
 using namespace std;
 // Yang: I changed the definition of ctrl_vars, and ReducerMgr might be affected
-std::vector<std::vector<const Variable *> *> Variable::ctrl_vars_vectors;
-unsigned long Variable::ctrl_vars_count;
+thread_local std::vector<std::vector<const Variable *> *> Variable::ctrl_vars_vectors;
+thread_local unsigned long Variable::ctrl_vars_count;
+
+// Ids of the variables that outlive a program (see reserve_id), only
+// handed out during static initialization.
+static unsigned int reserved_ids = 0;
+// Next id for the program being generated, restarted by doFinalization.
+static thread_local unsigned int next_id = 0;
 
 const char Variable::sink_var_name[] = "csmith_sink_";
 
@@ -464,7 +470,8 @@ Variable::Variable(const std::string &name, const Type *type,
       isAuto(isAuto), isStatic(isStatic), isRegister(isRegister),
       isBitfield_(isBitfield), isAddrTaken(false), isAccessOnce(false),
       field_var_of(isFieldVarOf), isArray(false),
-      qfer(isConsts, isVolatiles)
+      qfer(isConsts, isVolatiles),
+      id(new_id())
 {
     // nothing else to do
 }
@@ -478,7 +485,8 @@ Variable::Variable(const std::string &name, const Type *type, const Expression *
       isAuto(false), isStatic(false), isRegister(false), isBitfield_(false),
       isAddrTaken(false), isAccessOnce(false),
       field_var_of(0), isArray(false),
-      qfer(*qfer)
+      qfer(*qfer),
+      id(new_id())
 {
     // nothing else to do
 }
@@ -490,7 +498,8 @@ Variable::Variable(const std::string &name, const Type *type, const Expression *
       isAddrTaken(false), isAccessOnce(false),
       field_var_of(isFieldVarOf),
       isArray(isArray),
-      qfer(*qfer)
+      qfer(*qfer),
+      id(new_id())
 {
     // nothing else to do
 }
@@ -519,12 +528,12 @@ bool Variable::is_global(void) const
     {
 	return field_var_of->is_global();
     }
-    return (name.find("g_") == 0);
+    return (name.compare(0, 2, "g_") == 0);
 }
 
 bool Variable::is_local(void) const
 {
-    return (name.find("l_") == 0);
+    return (name.compare(0, 2, "l_") == 0);
 }
 
 // -------------------------------------------------------------
@@ -563,14 +572,14 @@ bool Variable::is_visible_local(const Block *blk) const
 bool Variable::is_argument(void) const
 {
     // JYTODO: need stronger criteria?
-    return (name.find("p_") == 0);
+    return (name.compare(0, 2, "p_") == 0);
 }
 
 // --------------------------------------------------------------
 bool Variable::is_tmp_var(void) const
 {
     // JYTODO: need stronger criteria?
-    return (name.find("t") == 0);
+    return (name.compare(0, 1, "t") == 0);
 }
 
 bool Variable::is_const(void) const
@@ -1029,6 +1038,28 @@ void Variable::doFinalization(void)
 	delete v;
     }
     ctrl_vars_vectors.clear();
+    ctrl_vars_count = 0;
+    next_id = reserved_ids;
+}
+
+/*
+ * Variable ids are dense per program, so that Effect can keep sets of
+ * variables as bitsets indexed by id.
+ */
+unsigned int Variable::new_id(void)
+{
+    if (next_id < reserved_ids)
+	next_id = reserved_ids;
+    return next_id++;
+}
+
+/*
+ * an id that is never given to another variable, for variables that are
+ * shared by all programs and threads
+ */
+unsigned int Variable::reserve_id(void)
+{
+    return reserved_ids++;
 }
 
 // --------------------------------------------------------------
@@ -1499,7 +1530,7 @@ int Variable::output_value_dump(ostream &out, string prefix, int indent) const
     }
     else if (type->eType == eUnion)
     {
-	const vector<const Fact *> &facts = FactMgr::get_program_end_facts();
+	const FactVec &facts = FactMgr::get_program_end_facts();
 	for (i = 0; i < field_vars.size(); i++)
 	{
 	    if (FactUnion::is_field_readable(this, i, facts))
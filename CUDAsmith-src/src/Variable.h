@@ -51,6 +51,7 @@ using namespace std;
 #include "Type.h"
 #include "CVQualifiers.h"
 #include "StringUtils.h"
+#include "NodeArena.h"
 
 class CGContext;
 class Expression;
@@ -73,8 +74,14 @@ public:
 			 bool isAuto, bool isStatic, bool isRegister, bool isBitfield, const Variable* isFieldVarOf);
 
 	static void doFinalization(void);
+	static unsigned int reserve_id(void);
 
 	virtual ~Variable(void);
+
+	// allocated from the per-program NodeArena
+	static void *operator new(size_t size) { return NodeArena::allocate(size); }
+	static void operator delete(void *p, size_t size) { NodeArena::deallocate(p, size); }
+
 	virtual bool is_global(void) const; 
 	virtual bool is_local(void) const;
 	virtual bool is_visible_local(const Block* blk) const;
@@ -157,6 +164,7 @@ public:
 	const Variable* field_var_of; //expanded from a struct/union
 	const bool isArray;
 	const CVQualifiers qfer;
+	unsigned int id;	// dense within the program being generated, see new_id
 	static std::vector<const Variable*> &get_new_ctrl_vars();
 	static std::vector<const Variable*> &get_last_ctrl_vars();
 
@@ -170,8 +178,9 @@ protected:
 			 bool isAuto, bool isStatic, bool isRegister, bool isBitfield, const Variable* isFieldVarOf);
 
 	static std::vector<const Variable*>& new_ctrl_vars(void);
-	static std::vector< std::vector<const Variable*>* > ctrl_vars_vectors;
-	static unsigned long ctrl_vars_count;
+	static unsigned int new_id(void);
+	static thread_local std::vector< std::vector<const Variable*>* > ctrl_vars_vectors;
+	static thread_local unsigned long ctrl_vars_count;
 
 	void create_field_vars(const Type* type);
 };
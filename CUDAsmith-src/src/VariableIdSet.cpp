@@ -0,0 +1,157 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "VariableIdSet.h"
+
+#include <algorithm>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+VariableIdSet::empty(void) const
+{
+	if (!dense_) {
+		return count_ == 0;
+	}
+	for (size_t i = 0; i < words_.size(); i++) {
+		if (words_[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool
+VariableIdSet::contains(unsigned int id) const
+{
+	if (dense_) {
+		size_t w = id / 64;
+		return w < words_.size() && (words_[w] >> (id % 64) & 1);
+	}
+	for (size_t i = 0; i < count_; i++) {
+		if (ids_[i] == id) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+VariableIdSet::insert(unsigned int id)
+{
+	if (!dense_) {
+		if (contains(id)) {
+			return;
+		}
+		if (count_ < SPARSE_MAX) {
+			ids_[count_++] = id;
+			return;
+		}
+		make_dense();
+	}
+	size_t w = id / 64;
+	if (w >= words_.size()) {
+		words_.resize(w + 1, 0);
+	}
+	words_[w] |= static_cast<uint64_t>(1) << (id % 64);
+}
+
+void
+VariableIdSet::erase(unsigned int id)
+{
+	if (dense_) {
+		size_t w = id / 64;
+		if (w < words_.size()) {
+			words_[w] &= ~(static_cast<uint64_t>(1) << (id % 64));
+		}
+		return;
+	}
+	for (size_t i = 0; i < count_; i++) {
+		if (ids_[i] == id) {
+			ids_[i] = ids_[--count_];
+			return;
+		}
+	}
+}
+
+void
+VariableIdSet::clear(void)
+{
+	dense_ = false;
+	count_ = 0;
+	words_.clear();
+}
+
+void
+VariableIdSet::make_dense(void)
+{
+	dense_ = true;
+	words_.clear();
+	for (size_t i = 0; i < count_; i++) {
+		size_t w = ids_[i] / 64;
+		if (w >= words_.size()) {
+			words_.resize(w + 1, 0);
+		}
+		words_[w] |= static_cast<uint64_t>(1) << (ids_[i] % 64);
+	}
+	count_ = 0;
+}
+
+bool
+VariableIdSet::intersects(const VariableIdSet &s) const
+{
+	if (dense_ && s.dense_) {
+		size_t len = min(words_.size(), s.words_.size());
+		for (size_t i = 0; i < len; i++) {
+			if (words_[i] & s.words_[i]) {
+				return true;
+			}
+		}
+		return false;
+	}
+	const VariableIdSet &sparse = dense_ ? s : *this;
+	const VariableIdSet &other = dense_ ? *this : s;
+	for (size_t i = 0; i < sparse.count_; i++) {
+		if (other.contains(sparse.ids_[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
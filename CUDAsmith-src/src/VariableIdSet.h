@@ -0,0 +1,78 @@
+// -*- mode: C++ -*-
+//
+// Copyright (c) 2007, 2008, 2009, 2010, 2011 The University of Utah
+// All rights reserved.
+//
+// This file is part of `csmith', a random generator of C programs.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistributions in binary form must reproduce the above copyright
+//     notice, this list of conditions and the following disclaimer in the
+//     documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef VARIABLE_ID_SET_H
+#define VARIABLE_ID_SET_H
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+/*
+ * A set of variable ids (see Variable::id). Small sets are kept inline as
+ * a list of ids, so copying them does not allocate; larger ones as a
+ * bitmap, so that intersection tests on them go a word at a time.
+ */
+class VariableIdSet
+{
+public:
+	VariableIdSet(void) : dense_(false), count_(0) {}
+
+	bool empty(void) const;
+	bool contains(unsigned int id) const;
+	void insert(unsigned int id);
+	void erase(unsigned int id);
+	void clear(void);
+
+	bool intersects(const VariableIdSet &s) const;
+
+private:
+	// number of ids kept inline before switching to the bitmap
+	static const size_t SPARSE_MAX = 8;
+
+	void make_dense(void);
+
+	bool dense_;
+	size_t count_;						// unless dense_
+	unsigned int ids_[SPARSE_MAX];		// unless dense_, in no particular order
+	std::vector<uint64_t> words_;		// when dense_
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // VARIABLE_ID_SET_H
+
+// Local Variables:
+// c-basic-offset: 4
+// tab-width: 4
+// End:
+
+// End of file.
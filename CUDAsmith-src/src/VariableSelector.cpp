@@ -90,10 +90,10 @@ using namespace std;
 
 // --------------------------------------------------------------
 // static variables 
-vector<Variable*> VariableSelector::AllVars; 
-vector<Variable*> VariableSelector::GlobalList; 
-vector<Variable*> VariableSelector::GlobalNonvolatilesList; 
-bool VariableSelector::var_created = false;
+thread_local vector<Variable*> VariableSelector::AllVars; 
+thread_local vector<Variable*> VariableSelector::GlobalList; 
+thread_local vector<Variable*> VariableSelector::GlobalNonvolatilesList; 
+thread_local bool VariableSelector::var_created = false;
 
 class VariableSelectFilter : public Filter
 {
@@ -104,6 +104,8 @@ public:
 
 	virtual bool filter(int v) const;
 
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
+
 private:
 	const CGContext &cg_context_;
 
@@ -131,7 +133,13 @@ VariableSelectFilter::filter(int v) const
 	return false;
 }
 
-ProbabilityTable<unsigned int, eVariableScope> *VariableSelector::scopeTable_ = NULL;
+bool
+VariableSelectFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	return test_all_values(n, values);
+}
+
+thread_local ProbabilityTable<unsigned int, eVariableScope> *VariableSelector::scopeTable_ = NULL;
 
 void
 VariableSelector::InitScopeTable()
@@ -321,6 +329,11 @@ VariableSelector::has_eligible_volatile_var(const vector<Variable *>& vars, cons
 { 
 	for (size_t i=0; i<vars.size(); i++) {
 		Variable* var = vars[i];
+		// only volatiles count, and is_eligible_var has no side effect
+		// unless var is an itemized array member (it reads the indices)
+		if (!var->is_volatile() && var->get_collective() == var) {
+			continue;
+		}
 		if (type && !type->match(var->type, eFlexible)) { 
             continue;
 		}
@@ -550,7 +563,7 @@ VariableSelector::create_and_initialize(Effect::Access access, const CGContext &
 	return var;
 }
 
-static int tmp_count = 0;
+static thread_local int tmp_count = 0;
 // --------------------------------------------------------------
  /* Parameter "type"
  * 0 --- To generate any type
@@ -1571,6 +1584,7 @@ VariableSelector::make_dummy_static_variable(const string &name)
 {
 	CVQualifiers dummy;
 	Variable *var = new Variable(name, 0, 0, &dummy);
+	var->id = Variable::reserve_id();
 	return var;
 }
 
@@ -1601,6 +1615,8 @@ VariableSelector::doFinalization(void)
 	AllVars.clear();
 	GlobalList.clear();
 	GlobalNonvolatilesList.clear();
+	var_created = false;
+	tmp_count = 0;
 }
 
 // --------------------------------------------------------------
@@ -1609,11 +1625,9 @@ OutputGlobalVariables(std::ostream &out)
 {
 	output_comment_line(out, "--- GLOBAL VARIABLES ---");
 	vector<Variable *>& vars = *(VariableSelector::GetGlobalVariables());
-	bool access_once = CGOptions::access_once();
-
-	CGOptions::access_once(false);
+	bool access_once = CGOptions::suppress_access_once(true);
 	OutputVariableList(vars, out);
-	CGOptions::access_once(access_once);
+	CGOptions::suppress_access_once(access_once);
 }
 
 void
@@ -1621,10 +1635,9 @@ OutputGlobalVariablesDecls(std::ostream &out, std::string prefix)
 {
 	output_comment_line(out, "--- GLOBAL VARIABLES ---");
 
-	bool access_once = CGOptions::access_once();
-	CGOptions::access_once(false);
+	bool access_once = CGOptions::suppress_access_once(true);
 	OutputVariableDeclList(*VariableSelector::GetGlobalVariables(), out, prefix);
-	CGOptions::access_once(access_once);
+	CGOptions::suppress_access_once(access_once);
 }
 
 void
@@ -44,6 +44,7 @@ class Function;
 class Block;
 class Lhs;
 class Fact;
+class FactVec;
 class CVQualifiers;
 class ArrayVariable;
 
@@ -71,7 +72,7 @@ public:
 			 eVariableScope scope=MAX_VAR_SCOPE);
 	static Variable* choose_ok_var(const vector<Variable *> &vars);
 	static const Variable* choose_ok_var(const vector<const Variable *> &vars);
-	static const Variable* choose_visible_read_var(const Block* b, vector<const Variable*> written_vars, const Type* type, const vector<const Fact*>& facts);
+	static const Variable* choose_visible_read_var(const Block* b, vector<const Variable*> written_vars, const Type* type, const FactVec& facts);
 	static Variable* choose_var(vector<Variable *> vars, Effect::Access access,
 		   const CGContext &cg_context, const Type* type, const CVQualifiers* qfer,
 		   eMatchType mt, const vector<const Variable*>& invalid_vars, bool no_bitfield = false, bool no_expand_struct = false);
@@ -99,7 +100,7 @@ public:
 	static void doFinalization(void); 
 	static void expand_struct_union_vars(vector<const Variable *>& vars, const Type* type);
 
-	static ProbabilityTable<unsigned int, eVariableScope> * scopeTable_;
+	static thread_local ProbabilityTable<unsigned int, eVariableScope> * scopeTable_;
 	static void InitScopeTable();
 
 	static vector<Variable*> find_all_visible_vars(const Block* b); 
@@ -154,16 +155,16 @@ private:
 					const CVQualifiers* qfer, Block *blk, std::string name);
 
 	// all variables generated
-	static vector<Variable*> AllVars;
+	static thread_local vector<Variable*> AllVars;
 
 	// All globals, including volatiles.
-	static vector<Variable*> GlobalList;
+	static thread_local vector<Variable*> GlobalList;
 
 	// All the non-volatile globals.
-	static vector<Variable*> GlobalNonvolatilesList;
+	static thread_local vector<Variable*> GlobalNonvolatilesList;
 
 	// flag that indicates whether a new variable has been created 
-	static bool var_created;
+	static thread_local bool var_created;
 };
 
 void OutputGlobalVariables(std::ostream &);
@@ -73,6 +73,12 @@ VectorFilter::filter(int v) const
 	return (flag_ == FILTER_OUT) ? re : !re;
 }
 
+bool
+VectorFilter::accepted_values(unsigned int n, std::vector<unsigned int> &values) const
+{
+	return test_all_values(n, values);
+}
+
 VectorFilter&
 VectorFilter::add(unsigned int item)
 { 
@@ -57,6 +57,8 @@ public:
 	virtual ~VectorFilter(void);
 
 	virtual bool filter(int v) const;
+
+	virtual bool accepted_values(unsigned int n, std::vector<unsigned int> &values) const;
 private:
 	std::vector<unsigned int> vs_;
 
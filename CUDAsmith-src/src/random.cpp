@@ -39,6 +39,27 @@
 #include "Filter.h"
 #include "CGOptions.h"
 #include "AbsProgramGenerator.h"
+#include "DrawProfiler.h"
+
+// the call site of a draw, for DrawProfiler, until the wrapper returns
+namespace {
+class DrawSite
+{
+public:
+	explicit DrawSite(const void *site)
+		: enabled_(DrawProfiler::is_enabled()),
+		  saved_(enabled_ ? DrawProfiler::enter(site) : 0)
+	{}
+	~DrawSite(void) { if (enabled_) DrawProfiler::leave(saved_); }
+
+private:
+	const bool enabled_;
+	const void * const saved_;
+};
+}
+
+#define ENTER_DRAW_SITE() \
+	DrawSite draw_site(__builtin_return_address(0))
 
 std::string get_prefixed_name(const std::string &name)
 {
@@ -69,6 +90,7 @@ std::string RandomDigits( int num )
 unsigned int
 rnd_upto(const unsigned int n, const Filter *f, const std::string* where)
 {
+	ENTER_DRAW_SITE();
 	RandomNumber *rnd = RandomNumber::GetInstance();
 	return rnd->rnd_upto(n, f, where);
 }
@@ -76,6 +98,7 @@ rnd_upto(const unsigned int n, const Filter *f, const std::string* where)
 bool
 rnd_flipcoin(const unsigned int p, const Filter *f, const std::string* where)
 {
+	ENTER_DRAW_SITE();
 	RandomNumber *rnd = RandomNumber::GetInstance();
 	return rnd->rnd_flipcoin(p, f, where);
 }
@@ -113,6 +136,7 @@ unsigned int
 pure_rnd_upto(const unsigned int n, const Filter *f, const std::string* where)
 {
 	if (n==0) return 0;		// not a random choice, but we still need to handle it though
+	ENTER_DRAW_SITE();
 	if (!CGOptions::is_random()) {
 		RNDNUM_GENERATOR old;
 	    	old = RandomNumber::SwitchRndNumGenerator(rDefaultRndNumGenerator);
@@ -128,6 +152,7 @@ pure_rnd_upto(const unsigned int n, const Filter *f, const std::string* where)
 bool
 pure_rnd_flipcoin(const unsigned int n, const Filter *f, const std::string* where)
 {
+	ENTER_DRAW_SITE();
 	if (!CGOptions::is_random()) {
 		RNDNUM_GENERATOR old;
 	    	old = RandomNumber::SwitchRndNumGenerator(rDefaultRndNumGenerator);
@@ -35,6 +35,7 @@
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <cstdio>
 #include <vector>
 #include "OutputMgr.h"
 #include "AbsProgramGenerator.h"
@@ -43,7 +44,7 @@
 using namespace std; 
 ///////////////////////////////////////////////////////////////////////////////
 
-static int gensym_count = 0;
+static thread_local int gensym_count = 0;
 
 void
 reset_gensym()
@@ -57,10 +58,13 @@ reset_gensym()
 string
 gensym(const char* basename)
 {
-	ostringstream ss; //(basename, ios_base::ate); somehow this yields weird result on windows
-	ss << basename;
-	ss << ++gensym_count;
-	return ss.str(); 
+	// gensym names every variable, label and function, so this avoids
+	// going through a stream
+	char num[16];
+	sprintf(num, "%d", ++gensym_count);
+	string s(basename);
+	s += num;
+	return s;
 }
 
 /*
@@ -69,10 +73,7 @@ gensym(const char* basename)
 string
 gensym(const string& basename)
 {
-	ostringstream ss; //(basename, ios_base::ate);
-	ss << basename;
-	ss << ++gensym_count;
-	return ss.str();
+	return gensym(basename.c_str());
 }
 
 /*
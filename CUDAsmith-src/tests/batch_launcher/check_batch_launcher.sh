@@ -0,0 +1,84 @@
+#!/bin/bash
+#
+# Runs batch_launcher, built against the stub driver of cuda_stub.cpp, over a
+# list of fake cubins, and checks both its results and the calls it makes:
+# one context for the whole list (and one more after a kernel faults), and
+# one set of buffers per context rather than per kernel.
+#
+#   check_batch_launcher.sh BATCH_LAUNCHER
+
+[ $# -eq 1 ] || { echo "usage: check_batch_launcher.sh BATCH_LAUNCHER" >&2; exit 2; }
+launcher=$(readlink -f "$1")
+work=$(mktemp -d) || exit 2
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 2
+
+failed=0
+fail() {
+  echo "FAIL: $*"
+  failed=1
+}
+
+# The stub's kernels add V + i to result[i].
+echo 5 > a.cubin
+echo '// ---fake_divergence -g 4,2,1 -l 2,1,1' > a.cu
+echo 100 > b.cubin
+echo fault > c.cubin
+echo 7 > d.cubin
+cat > kernels.txt <<LIST
+# Options from a.cu.
+a.cubin
+b.cubin -g 16 -l 4
+c.cubin -g 4 -l 4
+missing.cubin -g 4 -l 4
+d.cubin --atomics 3 ---atomic_reductions -g 8 -l 8
+e.cubin -g 3 -l 2
+LIST
+
+CUDA_STUB_LOG=calls.log "$launcher" -o results.txt kernels.txt > stdout.txt
+status=$?
+[ $status -eq 2 ] || fail "exit status $status, expected 2 for the failed kernels"
+
+results() {
+  echo "# $1"
+  for ((i = 0; i < $3; ++i)); do printf '%016x\n' $(($2 + i)); done
+}
+{
+  results a.cubin 5 8
+  results b.cubin 100 16
+  echo "# c.cubin error cuLaunchKernel: CUDA_ERROR_LAUNCH_FAILED"
+  echo "# missing.cubin error cuModuleLoad: CUDA_ERROR_FILE_NOT_FOUND"
+  results d.cubin 7 8
+  echo "# e.cubin error global dimension 0 is not a multiple of the local one"
+} > expected.txt
+cmp -s results.txt expected.txt ||
+  fail "results differ:$(echo; diff expected.txt results.txt)"
+
+for kernel in a b d; do
+  grep -q "^$kernel.cubin ok [0-9]*$" stdout.txt ||
+    fail "no ok line for $kernel.cubin"
+done
+[ "$(grep -c ' error ' stdout.txt)" -eq 3 ] || fail "expected 3 error lines"
+
+count() {
+  local n
+  n=$(grep -c "^$1\( \|$\)" calls.log)
+  [ "$n" -eq "$2" ] || fail "$1 called $n times, expected $2"
+}
+count cuInit 1
+count cuCtxCreate 2
+count cuCtxDestroy 2
+count cuModuleLoad 5
+count cuModuleUnload 4
+count cuLaunchKernel 4
+# result, atomic_input, special_values, atomic_reduction and sequence_input,
+# once per context.
+count cuMemAlloc 10
+count cuMemFree 10
+grep -q '^cuMemAlloc 128$' calls.log ||
+  fail "the result buffer is not sized for the largest kernel"
+grep -q '^cuLaunchKernel 2,2,1 2,1,1$' calls.log ||
+  fail "a.cubin not launched with the options of a.cu"
+
+[ $failed -eq 0 ] && echo "batch_launcher: ok"
+exit $failed
@@ -0,0 +1,243 @@
+// A fake CUDA driver, built as libcuda, for testing batch_launcher without a
+// GPU. Device memory is host memory. Every call is appended to the file named
+// by CUDA_STUB_LOG, one line each, so a test can check what the launcher asks
+// of the driver.
+//
+// A "cubin" is a text file holding a number V: its entry adds V + i to
+// result[i] of every thread i, so results that are not cleared between
+// kernels show. A cubin holding "fault" fails to launch, as a kernel that
+// faults on a GPU, and leaves the context unusable until it is destroyed.
+
+#include "cuda.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <string>
+
+namespace {
+
+struct Module {
+  // The value the entry adds, or -1 if it faults.
+  long value;
+};
+
+bool initialized = false;
+CUcontext current = NULL;
+// Whether a kernel of the current context has faulted.
+bool faulted = false;
+int contexts = 0;
+
+void Log(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+void Log(const char *format, ...) {
+  const char *path = getenv("CUDA_STUB_LOG");
+  if (path == NULL) return;
+  FILE *log = fopen(path, "a");
+  if (log == NULL) return;
+  va_list args;
+  va_start(args, format);
+  vfprintf(log, format, args);
+  va_end(args);
+  fputc('\n', log);
+  fclose(log);
+}
+
+// The state every call but those of the device needs.
+CUresult Check() {
+  if (!initialized) return CUDA_ERROR_NOT_INITIALIZED;
+  if (current == NULL) return CUDA_ERROR_INVALID_CONTEXT;
+  if (faulted) return CUDA_ERROR_LAUNCH_FAILED;
+  return CUDA_SUCCESS;
+}
+
+}  // namespace
+
+extern "C" {
+
+CUresult cuInit(unsigned int flags) {
+  Log("cuInit %u", flags);
+  initialized = true;
+  return CUDA_SUCCESS;
+}
+
+CUresult cuGetErrorName(CUresult error, const char **name) {
+  switch (error) {
+    case CUDA_SUCCESS: *name = "CUDA_SUCCESS"; break;
+    case CUDA_ERROR_INVALID_VALUE: *name = "CUDA_ERROR_INVALID_VALUE"; break;
+    case CUDA_ERROR_OUT_OF_MEMORY: *name = "CUDA_ERROR_OUT_OF_MEMORY"; break;
+    case CUDA_ERROR_NOT_INITIALIZED: *name = "CUDA_ERROR_NOT_INITIALIZED"; break;
+    case CUDA_ERROR_INVALID_CONTEXT: *name = "CUDA_ERROR_INVALID_CONTEXT"; break;
+    case CUDA_ERROR_INVALID_IMAGE: *name = "CUDA_ERROR_INVALID_IMAGE"; break;
+    case CUDA_ERROR_FILE_NOT_FOUND: *name = "CUDA_ERROR_FILE_NOT_FOUND"; break;
+    case CUDA_ERROR_NOT_FOUND: *name = "CUDA_ERROR_NOT_FOUND"; break;
+    case CUDA_ERROR_LAUNCH_FAILED: *name = "CUDA_ERROR_LAUNCH_FAILED"; break;
+    default: *name = NULL; return CUDA_ERROR_INVALID_VALUE;
+  }
+  return CUDA_SUCCESS;
+}
+
+CUresult cuDeviceGetCount(int *count) {
+  Log("cuDeviceGetCount");
+  if (!initialized) return CUDA_ERROR_NOT_INITIALIZED;
+  *count = 1;
+  return CUDA_SUCCESS;
+}
+
+CUresult cuDeviceGet(CUdevice *device, int ordinal) {
+  Log("cuDeviceGet %d", ordinal);
+  if (!initialized) return CUDA_ERROR_NOT_INITIALIZED;
+  if (ordinal != 0) return CUDA_ERROR_INVALID_DEVICE;
+  *device = 0;
+  return CUDA_SUCCESS;
+}
+
+// The limits of a compute capability 5.0 device.
+CUresult cuDeviceGetAttribute(int *value, CUdevice_attribute attribute,
+                              CUdevice device) {
+  if (!initialized) return CUDA_ERROR_NOT_INITIALIZED;
+  if (device != 0) return CUDA_ERROR_INVALID_DEVICE;
+  switch (attribute) {
+    case CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_BLOCK: *value = 1024; break;
+    case CU_DEVICE_ATTRIBUTE_MAX_BLOCK_DIM_X: *value = 1024; break;
+    case CU_DEVICE_ATTRIBUTE_MAX_BLOCK_DIM_Y: *value = 1024; break;
+    case CU_DEVICE_ATTRIBUTE_MAX_BLOCK_DIM_Z: *value = 64; break;
+    case CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_X: *value = 2147483647; break;
+    case CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_Y: *value = 65535; break;
+    case CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_Z: *value = 65535; break;
+    default: return CUDA_ERROR_INVALID_VALUE;
+  }
+  return CUDA_SUCCESS;
+}
+
+CUresult cuCtxCreate(CUcontext *context, unsigned int flags, CUdevice device) {
+  Log("cuCtxCreate %u %d", flags, device);
+  if (!initialized) return CUDA_ERROR_NOT_INITIALIZED;
+  if (current != NULL) return CUDA_ERROR_INVALID_CONTEXT;
+  current = *context = reinterpret_cast<CUcontext>(++contexts);
+  faulted = false;
+  return CUDA_SUCCESS;
+}
+
+CUresult cuCtxDestroy(CUcontext context) {
+  Log("cuCtxDestroy");
+  if (context == NULL || context != current) return CUDA_ERROR_INVALID_CONTEXT;
+  current = NULL;
+  return CUDA_SUCCESS;
+}
+
+CUresult cuCtxSynchronize(void) {
+  Log("cuCtxSynchronize");
+  return Check();
+}
+
+CUresult cuMemAlloc(CUdeviceptr *pointer, size_t bytes) {
+  Log("cuMemAlloc %zu", bytes);
+  CUresult err = Check();
+  if (err != CUDA_SUCCESS) return err;
+  void *memory = calloc(1, bytes ? bytes : 1);
+  if (memory == NULL) return CUDA_ERROR_OUT_OF_MEMORY;
+  *pointer = reinterpret_cast<CUdeviceptr>(memory);
+  return CUDA_SUCCESS;
+}
+
+CUresult cuMemFree(CUdeviceptr pointer) {
+  Log("cuMemFree");
+  // Memory may be freed after a fault, to destroy the context.
+  if (current == NULL) return CUDA_ERROR_INVALID_CONTEXT;
+  free(reinterpret_cast<void *>(pointer));
+  return CUDA_SUCCESS;
+}
+
+CUresult cuMemcpyHtoD(CUdeviceptr to, const void *from, size_t bytes) {
+  Log("cuMemcpyHtoD %zu", bytes);
+  CUresult err = Check();
+  if (err != CUDA_SUCCESS) return err;
+  memcpy(reinterpret_cast<void *>(to), from, bytes);
+  return CUDA_SUCCESS;
+}
+
+CUresult cuMemcpyDtoH(void *to, CUdeviceptr from, size_t bytes) {
+  Log("cuMemcpyDtoH %zu", bytes);
+  CUresult err = Check();
+  if (err != CUDA_SUCCESS) return err;
+  memcpy(to, reinterpret_cast<void *>(from), bytes);
+  return CUDA_SUCCESS;
+}
+
+CUresult cuMemsetD8(CUdeviceptr to, unsigned char value, size_t count) {
+  Log("cuMemsetD8 %u %zu", value, count);
+  CUresult err = Check();
+  if (err != CUDA_SUCCESS) return err;
+  memset(reinterpret_cast<void *>(to), value, count);
+  return CUDA_SUCCESS;
+}
+
+CUresult cuModuleLoad(CUmodule *module, const char *path) {
+  Log("cuModuleLoad %s", path);
+  CUresult err = Check();
+  if (err != CUDA_SUCCESS) return err;
+  std::ifstream in(path);
+  if (!in) return CUDA_ERROR_FILE_NOT_FOUND;
+  std::string text;
+  in >> text;
+  Module *loaded = new Module;
+  if (text == "fault") {
+    loaded->value = -1;
+  } else {
+    char *end;
+    loaded->value = strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || loaded->value < 0) {
+      delete loaded;
+      return CUDA_ERROR_INVALID_IMAGE;
+    }
+  }
+  *module = reinterpret_cast<CUmodule>(loaded);
+  return CUDA_SUCCESS;
+}
+
+CUresult cuModuleUnload(CUmodule module) {
+  Log("cuModuleUnload");
+  if (current == NULL) return CUDA_ERROR_INVALID_CONTEXT;
+  delete reinterpret_cast<Module *>(module);
+  return CUDA_SUCCESS;
+}
+
+CUresult cuModuleGetFunction(CUfunction *function, CUmodule module,
+                             const char *name) {
+  Log("cuModuleGetFunction %s", name);
+  CUresult err = Check();
+  if (err != CUDA_SUCCESS) return err;
+  if (strcmp(name, "entry")) return CUDA_ERROR_NOT_FOUND;
+  *function = reinterpret_cast<CUfunction>(module);
+  return CUDA_SUCCESS;
+}
+
+// Only the first parameter, the result buffer, is touched.
+CUresult cuLaunchKernel(CUfunction function, unsigned int grid_x,
+                        unsigned int grid_y, unsigned int grid_z,
+                        unsigned int block_x, unsigned int block_y,
+                        unsigned int block_z, unsigned int shared_bytes,
+                        CUstream stream, void **params, void **extra) {
+  Log("cuLaunchKernel %u,%u,%u %u,%u,%u", grid_x, grid_y, grid_z, block_x,
+      block_y, block_z);
+  CUresult err = Check();
+  if (err != CUDA_SUCCESS) return err;
+  if (shared_bytes || stream || extra || params == NULL)
+    return CUDA_ERROR_INVALID_VALUE;
+  const Module *module = reinterpret_cast<const Module *>(function);
+  if (module->value < 0) {
+    faulted = true;
+    return CUDA_ERROR_LAUNCH_FAILED;
+  }
+  unsigned long *result = *reinterpret_cast<unsigned long **>(params[0]);
+  const size_t threads = (size_t)grid_x * grid_y * grid_z * block_x * block_y *
+      block_z;
+  for (size_t i = 0; i < threads; ++i) result[i] += module->value + i;
+  return CUDA_SUCCESS;
+}
+
+}  // extern "C"
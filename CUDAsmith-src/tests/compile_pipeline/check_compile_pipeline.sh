@@ -0,0 +1,81 @@
+#!/bin/bash
+#
+# Runs compile_pipeline over a few fake kernels, with the host compiler in
+# place of nvcc and a launcher template that prints its arguments, and checks
+# the binaries, outputs, stdout and structured log it leaves.
+#
+#   check_compile_pipeline.sh COMPILE_PIPELINE CXX
+
+[ $# -eq 2 ] || { echo "usage: check_compile_pipeline.sh COMPILE_PIPELINE CXX" >&2; exit 2; }
+pipeline=$(readlink -f "$1")
+cxx=$2
+template=$(cd "$(dirname "$0")" && pwd)/launcher.template
+work=$(mktemp -d) || exit 2
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 2
+
+failed=0
+fail() {
+  echo "FAIL: $*"
+  failed=1
+}
+
+mkdir kernels jobs
+printf '// ---fake_divergence -g 4,2,1 -l 2,1,1\n#define RESULT 0\n' > kernels/ok.cu
+printf '// -g 4 -l 4\n#error broken\n' > kernels/broken1.cu
+cp kernels/broken1.cu kernels/broken2.cu
+printf '// -g 4 -l 4\n#define RESULT 3\n' > kernels/fails.cu
+cat > kernels/hang.cu <<KERNEL
+// -g 4 -l 4
+static int spin() { volatile int forever = 1; while (forever) {} return 0; }
+#define RESULT spin()
+KERNEL
+cat > kernels/big.cu <<KERNEL
+// -g 4 -l 4
+#include <stdlib.h>
+static int grab() { void *volatile p = malloc((size_t)2 << 30); return p ? 0 : 4; }
+#define RESULT grab()
+KERNEL
+
+"$pipeline" -j 4 -o bin --run --timeout 3 --memory 1024 --work jobs \
+    --template "$template" --compiler "$cxx -x c++ -o {out} -I{include} {src}" \
+    kernels/*.cu > stdout.txt
+status=$?
+[ $status -eq 2 ] || fail "exit status $status, expected 2 for the failed kernels"
+
+expect_line() {
+  grep -q "^kernels/$1.cu $2 [0-9]*$" stdout.txt ||
+    fail "no \"$2\" line for $1.cu:$(echo; cat stdout.txt)"
+}
+expect_line ok ok
+expect_line broken1 'compile exit 1'
+expect_line broken2 'compile exit 1'
+expect_line fails 'run exit 3'
+expect_line hang 'run timeout'
+expect_line big 'run exit 4'
+
+[ -x bin/ok.bin ] || fail "bin/ok.bin missing"
+[ -e bin/broken1.bin ] && fail "bin/broken1.bin written for a failed compile"
+printf '1.cu\n---fake_divergence\n-g\n4,2,1\n-l\n2,1,1\n' > expected.out
+cmp -s bin/ok.out expected.out ||
+  fail "launcher not instantiated with the kernel's options:$(echo; cat bin/ok.out)"
+grep -q broken bin/broken1.log || fail "bin/broken1.log lacks the compiler error"
+[ -z "$(ls jobs)" ] || fail "job directories left behind: $(ls jobs)"
+
+[ "$(wc -l < compile_log.jsonl)" -eq 6 ] || fail "expected 6 lines in the log"
+stderr_hash() {
+  grep "\"kernels/$1.cu\"" compile_log.jsonl |
+    sed 's/.*"compile": {[^}]*"stderr_hash": "\([0-9a-f]*\)".*/\1/'
+}
+[ "$(stderr_hash broken1)" = "$(stderr_hash broken2)" ] ||
+  fail "the same compiler error hashes differently"
+[ "$(stderr_hash broken1)" != "$(stderr_hash ok)" ] ||
+  fail "a failed and a clean compile hash alike"
+grep '"kernels/hang.cu"' compile_log.jsonl | grep -q '"run": {[^}]*"timeout": true' ||
+  fail "the hanging run is not logged as a timeout"
+grep '"kernels/ok.cu"' compile_log.jsonl |
+    grep -q '"compile": {"exit": 0, "signal": 0, "timeout": false, "ms": [0-9]*' ||
+  fail "the compile of ok.cu is not logged"
+
+[ $failed -eq 0 ] && echo "compile_pipeline: ok"
+exit $failed
@@ -0,0 +1,54 @@
+#!/bin/bash
+#
+# Generates every kernel of corpus.txt with --expected-results and again with
+# --host-target, runs the host kernel with test_host, and checks that it
+# prints the expected results the generator wrote.
+#
+#   check_expected_results.sh CUDASMITH CXX
+
+[ $# -eq 2 ] || { echo "usage: check_expected_results.sh CUDASMITH CXX" >&2; exit 2; }
+cudasmith=$(readlink -f "$1")
+cxx=$2
+here=$(cd "$(dirname "$0")" && pwd)
+root=$(cd "$here/../../.." && pwd)
+work=$(mktemp -d) || exit 2
+trap 'rm -rf "$work"' EXIT
+cd "$work" || exit 2
+cp "$root/CUDA_host.h" "$root/host_launcher.cpp" . || exit 2
+
+failed=0
+fail() {
+  echo "FAIL: $*"
+  failed=1
+}
+
+checked=0
+while read -r mode seeds; do
+  case $mode in ''|'#'*) continue ;; esac
+  flags=$(grep "^$mode " "$here/../golden/modes.txt" | cut -d' ' -f2-)
+  [ -n "$flags" ] || { fail "no mode $mode in modes.txt"; continue; }
+  for seed in $seeds; do
+    name="$mode seed $seed"
+    rm -f kernel.cu kernel.expected test.cu test_host
+    "$cudasmith" --seed "$seed" $flags --expected-results -o kernel.cu \
+        > generate.txt 2>&1
+    if [ ! -f kernel.expected ]; then
+      fail "$name: no expected results:$(echo; cat generate.txt)"
+      continue
+    fi
+    "$cudasmith" --seed "$seed" $flags --host-target -o test.cu > /dev/null 2>&1 ||
+      { fail "$name: --host-target failed"; continue; }
+    "$cxx" -std=gnu++11 -O1 -pthread -fpermissive -w -I. -I"$root" -o test_host \
+        host_launcher.cpp 2> build.txt ||
+      { fail "$name: test_host does not build:$(echo; head -n 20 build.txt)"; continue; }
+    ./test_host $(head -n 1 test.cu | cut -d' ' -f2-) > host.txt ||
+      { fail "$name: test_host failed"; continue; }
+    cmp -s host.txt kernel.expected ||
+      fail "$name: test_host and the expected results differ:$(echo;
+          diff host.txt kernel.expected | head -n 5)"
+    checked=$((checked + 1))
+  done
+done < "$here/corpus.txt"
+
+[ $failed -eq 0 ] && echo "expected_results: $checked kernels ok"
+exit $failed
@@ -0,0 +1,246 @@
+#!/bin/bash
+#
+# Checks that CUDASmith still generates the same program for every seed of the
+# golden corpus, the seeds of seeds.txt in each mode of modes.txt with both
+# random number engines. The SHA-256 of every kernel must match the one in
+# manifest.sha256.
+#
+#   check_golden.sh [--jobs N] [--reference BIN] [--keep DIR] CUDASMITH
+#     checks CUDASMITH against the manifest. With --reference, the kernels that
+#     differ are also generated with BIN, a CUDASmith built from a commit that
+#     matches the manifest, and the first line that differs is printed.
+#   check_golden.sh --update [--jobs N] CUDASMITH
+#     rewrites the manifest from CUDASMITH. Only do this for a change that is
+#     meant to change the generated programs.
+#
+# The kernels are generated on N processes at once (default: one per core)
+# in a temporary directory, or in DIR with --keep.
+#
+# When checking, every kernel is then generated a second time in batch mode,
+# which must give the same kernel: each run of consecutive seeds is generated
+# by one process with --seed-range A:B --jobs 2, so that generator state that
+# leaks from one seed to the next, or between threads, shows. A seed that has
+# no neighbour in seeds.txt is generated after the three seeds before it.
+
+usage() {
+  echo "usage: check_golden.sh [--update] [--jobs N] [--reference BIN]" \
+       "[--keep DIR] CUDASMITH" >&2
+  exit 2
+}
+
+GOLDEN_DIR=$(cd "$(dirname "$0")" && pwd)
+MANIFEST=$GOLDEN_DIR/manifest.sha256
+update=0
+jobs=0
+reference=
+keep=
+while [ $# -gt 1 ]; do
+  case $1 in
+    --update) update=1; shift ;;
+    --jobs) jobs=$2; shift 2 ;;
+    --reference) reference=$2; shift 2 ;;
+    --keep) keep=$2; shift 2 ;;
+    *) usage ;;
+  esac
+done
+[ $# -eq 1 ] || usage
+cudasmith=$(readlink -f "$1")
+[ -x "$cudasmith" ] || { echo "error: $1 is not executable" >&2; exit 2; }
+[ -z "$reference" ] || reference=$(readlink -f "$reference")
+[ "$jobs" -gt 0 ] 2>/dev/null || jobs=$(nproc)
+
+if [ -n "$keep" ]; then
+  mkdir -p "$keep" || exit 2
+  work=$(cd "$keep" && pwd)
+else
+  work=$(mktemp -d) || exit 2
+  trap 'rm -rf "$work"' EXIT
+fi
+
+# Every kernel of the corpus, as "<mode> <rng> <seed>".
+corpus() {
+  local seeds
+  seeds=$(grep -v '^#' "$GOLDEN_DIR/seeds.txt")
+  while read -r mode flags; do
+    case $mode in ''|'#'*) continue ;; esac
+    for rng in lrand48 xoshiro; do
+      for seed in $seeds; do
+        echo "$mode $rng $seed"
+      done
+    done
+  done < "$GOLDEN_DIR/modes.txt"
+}
+
+# The flags of a mode.
+mode_flags() {
+  sed -n "s/^$1 //p" "$GOLDEN_DIR/modes.txt"
+}
+
+# generate BIN DIR MODE RNG SEED: writes DIR/MODE.RNG.SEED.cu, and its exit
+# status to DIR/MODE.RNG.SEED.rc.
+generate() {
+  local name=$3.$4.$5
+  (cd "$2" && "$1" --seed "$5" $(mode_flags "$3") --rng "$4" \
+       -o "$name.cu" > "$name.log" 2>&1; echo $? > "$name.rc")
+}
+# generate_batch BIN DIR MODE RNG FIRST LAST: writes DIR/MODE.RNG/k_SEED.cu
+# for every seed from FIRST to LAST, and the exit status to
+# DIR/MODE.RNG/FIRST.rc.
+generate_batch() {
+  local dir=$2/$3.$4
+  mkdir -p "$dir"
+  (cd "$dir" && "$1" --seed-range "$5:$6" --jobs 2 $(mode_flags "$3") \
+       --rng "$4" -o k.cu > "$5.log" 2>&1; echo $? > "$5.rc")
+}
+export GOLDEN_DIR
+export -f mode_flags generate generate_batch
+
+corpus | xargs -P "$jobs" -n 3 bash -c 'generate "$0" "$@"' \
+    "$cudasmith" "$work"
+
+# The SHA-256 of every kernel, in the format of the manifest.
+actual=$work/actual.sha256
+corpus | while read -r mode rng seed; do
+  name=$mode.$rng.$seed.cu
+  if [ "$(cat "$work/$mode.$rng.$seed.rc" 2>/dev/null)" = 0 ] &&
+      [ -f "$work/$name" ]; then
+    echo "$(sha256sum < "$work/$name" | cut -d' ' -f1)  $name"
+  else
+    echo "generation-failed  $name"
+  fi
+done > "$actual"
+
+if [ $update -eq 1 ]; then
+  if grep -q '^generation-failed' "$actual"; then
+    grep '^generation-failed' "$actual" | sed 's/^generation-failed  /failed: /'
+    echo "error: not updating $MANIFEST" >&2
+    exit 1
+  fi
+  cp "$actual" "$MANIFEST"
+  echo "Wrote $(wc -l < "$MANIFEST") kernels to $MANIFEST"
+  exit 0
+fi
+if [ ! -f "$MANIFEST" ]; then
+  echo "error: no $MANIFEST, run with --update" >&2
+  exit 2
+fi
+
+# Prints the first line that differs between the reference kernel and ours.
+first_difference() {
+  local ref=$1 ours=$2 line
+  line=$(cmp "$ref" "$ours" 2>&1 | sed -n 's/.*line \([0-9]*\)$/\1/p')
+  if [ -z "$line" ]; then
+    echo "    (same as the reference kernel; the reference does not match" \
+         "the manifest either)"
+    return
+  fi
+  echo "    first difference at line $line:"
+  echo "    - $(sed -n "${line}p" "$ref")"
+  echo "    + $(sed -n "${line}p" "$ours")"
+}
+
+failed=0
+checked=0
+while read -r hash name; do
+  checked=$((checked + 1))
+  expected=$(awk -v name="$name" '$2 == name { print $1 }' "$MANIFEST")
+  [ "$hash" = "$expected" ] && continue
+  failed=$((failed + 1))
+  IFS=. read -r mode rng seed _ <<< "$name"
+  if [ -z "$expected" ]; then
+    echo "NOT IN MANIFEST $name"
+  elif [ "$hash" = generation-failed ]; then
+    echo "FAILED $name: CUDASmith exited with status" \
+         "$(cat "$work/$mode.$rng.$seed.rc" 2>/dev/null)"
+  else
+    echo "MISMATCH $name: expected $expected, got $hash"
+  fi
+  echo "    CUDASmith --seed $seed $(mode_flags "$mode") --rng $rng"
+  if [ -n "$reference" ] && [ "$hash" != generation-failed ]; then
+    mkdir -p "$work/reference"
+    generate "$reference" "$work/reference" "$mode" "$rng" "$seed"
+    first_difference "$work/reference/$name" "$work/$name"
+  fi
+done < "$actual"
+
+# The runs of consecutive seeds, as "<first> <last>".
+seed_runs() {
+  local seed first= last=
+  for seed in $(grep -v '^#' "$GOLDEN_DIR/seeds.txt" | tr -s ' \t' '\n' |
+                grep . | sort -n -u); do
+    if [ -n "$first" ] && [ "$seed" -eq $((last + 1)) ]; then
+      last=$seed
+      continue
+    fi
+    [ -z "$first" ] || echo "$first $last"
+    first=$seed
+    last=$seed
+  done
+  [ -z "$first" ] || echo "$first $last"
+}
+
+# The batch pass, as "<mode> <rng> <first> <last>" for every range.
+ranges() {
+  local runs first last
+  runs=$(seed_runs)
+  while read -r mode flags; do
+    case $mode in ''|'#'*) continue ;; esac
+    for rng in lrand48 xoshiro; do
+      while read -r first last; do
+        if [ "$first" = "$last" ]; then
+          first=$((first > 3 ? first - 3 : 1))
+        fi
+        echo "$mode $rng $first $last"
+      done <<< "$runs"
+    done
+  done < "$GOLDEN_DIR/modes.txt"
+}
+
+ranges | xargs -P "$jobs" -n 4 bash -c 'generate_batch "$0" "$@"' \
+    "$cudasmith" "$work/batch"
+
+batch_failed=0
+while read -r mode rng first last; do
+  rc=$(cat "$work/batch/$mode.$rng/$first.rc" 2>/dev/null)
+  [ "$rc" = 0 ] && continue
+  batch_failed=$((batch_failed + 1))
+  echo "FAILED batch $mode.$rng.$first-$last: CUDASmith exited with status $rc"
+  echo "    CUDASmith --seed-range $first:$last --jobs 2 $(mode_flags "$mode")" \
+       "--rng $rng"
+done < <(ranges)
+
+corpus | while read -r mode rng seed; do
+  name=$mode.$rng.$seed.cu
+  kernel=$work/batch/$mode.$rng/k_$seed.cu
+  if [ -f "$kernel" ]; then
+    echo "$(sha256sum < "$kernel" | cut -d' ' -f1)  $name"
+  else
+    echo "generation-failed  $name"
+  fi
+done > "$work/batch.sha256"
+
+while read -r hash name; do
+  checked=$((checked + 1))
+  expected=$(awk -v name="$name" '$2 == name { print $1 }' "$MANIFEST")
+  [ "$hash" = "$expected" ] && continue
+  failed=$((failed + 1))
+  if [ "$hash" = generation-failed ]; then
+    echo "FAILED batch $name: no kernel"
+  else
+    IFS=. read -r mode rng seed _ <<< "$name"
+    echo "MISMATCH batch $name: expected $expected, got $hash"
+    echo "    the kernel differs when generated with --seed-range and --jobs;" \
+         "$work/batch/$mode.$rng/k_$seed.cu"
+  fi
+done < "$work/batch.sha256"
+failed=$((failed + batch_failed))
+
+if [ $failed -ne 0 ]; then
+  echo "$failed of $checked golden kernels differ."
+  [ -n "$reference" ] ||
+      echo "Pass --reference with a CUDASmith built before the change to see" \
+           "the first line that differs."
+  [ -z "$keep" ] || echo "The kernels are in $work."
+  exit 1
+fi
+echo "All $checked golden kernels match."
@@ -0,0 +1,516 @@
+// Runs many compiled kernels in one CUDA context. cuda_launcher is rebuilt and
+// sets up the driver, a context and its buffers for every kernel; this loads
+// each kernel as a cubin into the same context instead, and reuses one set of
+// device buffers, sized for the largest kernel of the list.
+//
+//   nvcc -cubin -arch sm_50 -Xptxas -O0 -o 42.cubin 42.cu
+//   make batch && ./batch_launcher -o results.txt kernels.txt
+//
+// Every line of the list names a cubin, optionally followed by the options
+// cuda_launcher takes for it. Without options, they are read from the first
+// line of the kernel next to the cubin (42.cu for 42.cubin). The buffers are
+// initialised as in cuda_launcher.c.template before every launch, and the
+// results of each kernel are appended to the results file, after a line
+//   # <cubin>
+// in cuda_launcher's format. A line per kernel goes to stdout:
+//   <cubin> ok <ms>
+//   <cubin> error <message>
+// A kernel that faults leaves the context unusable, so it is then created
+// again, with its buffers, before the next kernel.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cuda.h>
+
+#ifdef EMBEDDED
+typedef unsigned int RES_TYPE;
+#else
+typedef unsigned long RES_TYPE;
+#endif
+
+#define DEF_LOCAL_SIZE 32
+#define DEF_GLOBAL_SIZE 1024
+
+// A kernel of the list, with the options of cuda_launcher.
+struct Kernel {
+  std::string cubin;
+  bool atomics = false;
+  int atomic_counter_no = 0;
+  bool atomic_reductions = false;
+  bool emi = false;
+  bool tg = false;
+  bool fake_divergence = false;
+  bool inter_thread_comm = false;
+  size_t local_size[3] = {1, 1, 1};
+  size_t global_size[3] = {1, 1, 1};
+  size_t total_threads = 1;
+  size_t no_blocks = 1;
+  size_t max_dimen = 0;
+  // Why the kernel cannot be run, if it cannot.
+  std::string error;
+};
+
+// The device buffers, large enough for every kernel of the list. Buffers that
+// no kernel takes are not allocated.
+struct Pool {
+  CUdeviceptr result = 0;
+  CUdeviceptr atomic_input = 0;
+  CUdeviceptr special_values = 0;
+  CUdeviceptr atomic_reduction = 0;
+  CUdeviceptr emi_input = 0;
+  CUdeviceptr tg_input = 0;
+  CUdeviceptr sequence_input = 0;
+  CUdeviceptr comm_values = 0;
+};
+
+CUdevice device;
+CUcontext context = NULL;
+Pool pool;
+// What the pool holds, the maximum over the kernels. Its atomic_counter_no is
+// the number of counters of all the blocks.
+Kernel pool_size;
+// The host side of comm_values, all ones.
+std::vector<long> comm_ones;
+
+void print_help()
+{
+  printf("Usage: ./batch_launcher [-o RESULTS] [-d IDX] LIST\n");
+  printf("\n");
+  printf("  -o FILE --output FILE                     Append the results to FILE (results.txt by default)\n");
+  printf("  -d IDX  --device_idx IDX                  Target device\n");
+  printf("\n");
+  printf("LIST has a cubin per line, optionally followed by the options of\n");
+  printf("cuda_launcher for it (otherwise the first line of the .cu next to the\n");
+  printf("cubin). LIST may be - for stdin.\n");
+}
+
+std::string error_string(CUresult err)
+{
+  const char *name = NULL;
+  if (cuGetErrorName(err, &name) != CUDA_SUCCESS || name == NULL)
+    return "CUDA error " + std::to_string((int)err);
+  return name;
+}
+
+bool parse_dims(const char *val, size_t *dims)
+{
+  const char *pos = val;
+  int d = 0;
+  while (*pos) {
+    char *end;
+    long dim = strtol(pos, &end, 10);
+    if (end == pos || dim <= 0 || d == 3 || (*end != ',' && *end != '\0'))
+      return false;
+    dims[d++] = dim;
+    pos = *end ? end + 1 : end;
+  }
+  return d > 0;
+}
+
+// Parses the options of a kernel, as cuda_launcher and test_host do.
+bool parse_options(const std::vector<std::string>& args, Kernel *kernel)
+{
+  int l_dim = 0, g_dim = 0;
+  for (size_t arg_no = 0; arg_no < args.size(); ++arg_no) {
+    const char *arg = args[arg_no].c_str();
+    const char *val = arg_no + 1 < args.size() ? args[arg_no + 1].c_str() : NULL;
+    if (!strcmp(arg, "-l") || !strcmp(arg, "--locals")) {
+      if (val == NULL || !parse_dims(val, kernel->local_size)) {
+        kernel->error = "could not parse local size";
+        return false;
+      }
+      l_dim = std::count(val, val + strlen(val), ',') + 1;
+      ++arg_no;
+    } else if (!strcmp(arg, "-g") || !strcmp(arg, "--groups")) {
+      if (val == NULL || !parse_dims(val, kernel->global_size)) {
+        kernel->error = "could not parse global size";
+        return false;
+      }
+      g_dim = std::count(val, val + strlen(val), ',') + 1;
+      ++arg_no;
+    } else if (!strcmp(arg, "--atomics")) {
+      if (val == NULL) {
+        kernel->error = "--atomics takes the number of counters";
+        return false;
+      }
+      kernel->atomics = true;
+      kernel->atomic_counter_no = atoi(val);
+      ++arg_no;
+    } else if (!strcmp(arg, "---atomic_reductions")) {
+      kernel->atomic_reductions = true;
+    } else if (!strcmp(arg, "---emi")) {
+      kernel->emi = true;
+    } else if (!strcmp(arg, "---tg")) {
+      kernel->tg = true;
+    } else if (!strcmp(arg, "---fake_divergence")) {
+      kernel->fake_divergence = true;
+    } else if (!strcmp(arg, "---inter_thread_comm")) {
+      kernel->inter_thread_comm = true;
+    } else {
+      kernel->error = std::string("failed parsing arg ") + arg;
+      return false;
+    }
+  }
+  if (l_dim == 0) {
+    kernel->local_size[0] = DEF_LOCAL_SIZE;
+    l_dim = 1;
+  }
+  if (g_dim == 0) {
+    kernel->global_size[0] = DEF_GLOBAL_SIZE;
+    g_dim = 1;
+  }
+  if (l_dim != g_dim) {
+    kernel->error = "local and global sizes must have same number of dimensions";
+    return false;
+  }
+  for (int d = 0; d < 3; ++d) {
+    if (kernel->global_size[d] % kernel->local_size[d]) {
+      kernel->error = "global dimension " + std::to_string(d) +
+          " is not a multiple of the local one";
+      return false;
+    }
+    kernel->total_threads *= kernel->global_size[d];
+    kernel->no_blocks *= kernel->global_size[d] / kernel->local_size[d];
+    kernel->max_dimen = std::max(kernel->max_dimen, kernel->global_size[d]);
+  }
+  return true;
+}
+
+std::vector<std::string> split(const std::string& line)
+{
+  std::istringstream in(line);
+  std::vector<std::string> words;
+  std::string word;
+  while (in >> word)
+    words.push_back(word);
+  return words;
+}
+
+// Reads a line of the list. The options of a cubin listed alone are those of
+// the first line of its kernel, "// <options>".
+Kernel read_kernel(const std::string& line)
+{
+  std::vector<std::string> words = split(line);
+  Kernel kernel;
+  kernel.cubin = words[0];
+  words.erase(words.begin());
+  if (words.empty()) {
+    std::string source = kernel.cubin;
+    std::string::size_type dot = source.rfind('.');
+    std::string::size_type slash = source.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+      dot = source.size();
+    source = source.substr(0, dot) + ".cu";
+    std::ifstream in(source.c_str());
+    std::string first;
+    if (!std::getline(in, first)) {
+      kernel.error = "can't read the options from " + source;
+      return kernel;
+    }
+    words = split(first);
+    if (!words.empty() && words[0] == "//")
+      words.erase(words.begin());
+  }
+  parse_options(words, &kernel);
+  return kernel;
+}
+
+// Checks the dimensions of a kernel against the limits of the device.
+bool check_limits(Kernel *kernel)
+{
+  static const CUdevice_attribute block_attributes[3] = {
+      CU_DEVICE_ATTRIBUTE_MAX_BLOCK_DIM_X, CU_DEVICE_ATTRIBUTE_MAX_BLOCK_DIM_Y,
+      CU_DEVICE_ATTRIBUTE_MAX_BLOCK_DIM_Z};
+  static const CUdevice_attribute grid_attributes[3] = {
+      CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_X, CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_Y,
+      CU_DEVICE_ATTRIBUTE_MAX_GRID_DIM_Z};
+  for (int d = 0; d < 3; ++d) {
+    int max_block = 0, max_grid = 0;
+    if (cuDeviceGetAttribute(&max_block, block_attributes[d], device) != CUDA_SUCCESS ||
+        cuDeviceGetAttribute(&max_grid, grid_attributes[d], device) != CUDA_SUCCESS) {
+      kernel->error = "can't query the limits of the device";
+      return false;
+    }
+    if (kernel->local_size[d] > (size_t)max_block) {
+      kernel->error = "local work size in dimension " + std::to_string(d) +
+          " exceeds maximum of " + std::to_string(max_block);
+      return false;
+    }
+    if (kernel->global_size[d] / kernel->local_size[d] > (size_t)max_grid) {
+      kernel->error = "grid size in dimension " + std::to_string(d) +
+          " exceeds maximum of " + std::to_string(max_grid);
+      return false;
+    }
+  }
+  return true;
+}
+
+void release_pool()
+{
+  CUdeviceptr *buffers[] = {&pool.result, &pool.atomic_input,
+      &pool.special_values, &pool.atomic_reduction, &pool.emi_input,
+      &pool.tg_input, &pool.sequence_input, &pool.comm_values};
+  for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); ++i) {
+    if (*buffers[i])
+      cuMemFree(*buffers[i]);
+    *buffers[i] = 0;
+  }
+}
+
+// Creates the context and allocates the buffers of pool_size in it. The
+// inputs that are the same for every kernel are uploaded once here.
+CUresult create_context()
+{
+  CUresult err = cuCtxCreate(&context, 0, device);
+  if (err != CUDA_SUCCESS)
+    return err;
+  const Kernel& size = pool_size;
+#define ALLOC(buffer, bytes)                                  \
+  do {                                                       \
+    if ((err = cuMemAlloc(&buffer, bytes)) != CUDA_SUCCESS)  \
+      return err;                                            \
+  } while (0)
+  ALLOC(pool.result, sizeof(RES_TYPE) * size.total_threads);
+  if (size.atomics) {
+    ALLOC(pool.atomic_input, sizeof(unsigned int) * size.atomic_counter_no);
+    ALLOC(pool.special_values, sizeof(unsigned int) * size.atomic_counter_no);
+  }
+  if (size.atomic_reductions)
+    ALLOC(pool.atomic_reduction, sizeof(int) * size.no_blocks);
+  int emi_values[1024], tg_values[1024];
+  for (int i = 0; i < 1024; ++i) {
+    emi_values[i] = i;
+    tg_values[i] = 1024 - i;
+  }
+  if (size.emi) {
+    ALLOC(pool.emi_input, sizeof(emi_values));
+    if ((err = cuMemcpyHtoD(pool.emi_input, emi_values, sizeof(emi_values))))
+      return err;
+  }
+  if (size.tg) {
+    ALLOC(pool.tg_input, sizeof(tg_values));
+    if ((err = cuMemcpyHtoD(pool.tg_input, tg_values, sizeof(tg_values))))
+      return err;
+  }
+  // sequence_input[i] is 10 + i whatever the size, so the largest one serves
+  // every kernel.
+  if (size.fake_divergence) {
+    std::vector<int> sequence_input(size.max_dimen);
+    for (size_t i = 0; i < size.max_dimen; ++i)
+      sequence_input[i] = 10 + i;
+    ALLOC(pool.sequence_input, sizeof(int) * size.max_dimen);
+    if ((err = cuMemcpyHtoD(pool.sequence_input, &sequence_input[0],
+                            sizeof(int) * size.max_dimen)))
+      return err;
+  }
+  if (size.inter_thread_comm)
+    ALLOC(pool.comm_values, sizeof(long) * size.total_threads);
+#undef ALLOC
+  return CUDA_SUCCESS;
+}
+
+void destroy_context()
+{
+  release_pool();
+  if (context)
+    cuCtxDestroy(context);
+  context = NULL;
+}
+
+// Runs a kernel and appends its results. On a failure, *message says what
+// went wrong.
+CUresult run_kernel(const Kernel& kernel, FILE *results, std::string *message)
+{
+  CUmodule module;
+  CUresult err = cuModuleLoad(&module, kernel.cubin.c_str());
+  if (err != CUDA_SUCCESS) {
+    *message = "cuModuleLoad: " + error_string(err);
+    return err;
+  }
+  CUfunction function;
+  std::vector<RES_TYPE> c(kernel.total_threads);
+#define CHECK(function, args)                                \
+  do {                                                       \
+    if ((err = function args) != CUDA_SUCCESS) {             \
+      *message = #function ": " + error_string(err);         \
+      cuModuleUnload(module);                                \
+      return err;                                            \
+    }                                                        \
+  } while (0)
+  CHECK(cuModuleGetFunction, (&function, module, "entry"));
+
+  // The buffers, as setupMemory in cuda_launcher.c.template.
+  void *args[7];
+  int kernel_arg = 0;
+  CHECK(cuMemsetD8, (pool.result, 0, sizeof(RES_TYPE) * kernel.total_threads));
+  args[kernel_arg++] = &pool.result;
+  if (kernel.atomics) {
+    size_t total_counters = kernel.atomic_counter_no * kernel.no_blocks;
+    CHECK(cuMemsetD8, (pool.atomic_input, 0, sizeof(unsigned int) * total_counters));
+    CHECK(cuMemsetD8, (pool.special_values, 0, sizeof(unsigned int) * total_counters));
+    args[kernel_arg++] = &pool.atomic_input;
+    args[kernel_arg++] = &pool.special_values;
+  }
+  if (kernel.atomic_reductions) {
+    CHECK(cuMemsetD8, (pool.atomic_reduction, 0, sizeof(int) * kernel.no_blocks));
+    args[kernel_arg++] = &pool.atomic_reduction;
+  }
+  if (kernel.emi)
+    args[kernel_arg++] = &pool.emi_input;
+  if (kernel.tg)
+    args[kernel_arg++] = &pool.tg_input;
+  if (kernel.fake_divergence)
+    args[kernel_arg++] = &pool.sequence_input;
+  if (kernel.inter_thread_comm) {
+    CHECK(cuMemcpyHtoD, (pool.comm_values, &comm_ones[0],
+                       sizeof(long) * kernel.total_threads));
+    args[kernel_arg++] = &pool.comm_values;
+  }
+
+  CHECK(cuLaunchKernel, (function,
+      kernel.global_size[0] / kernel.local_size[0],
+      kernel.global_size[1] / kernel.local_size[1],
+      kernel.global_size[2] / kernel.local_size[2],
+      kernel.local_size[0], kernel.local_size[1], kernel.local_size[2],
+      0, NULL, args, NULL));
+  CHECK(cuCtxSynchronize, ());
+  CHECK(cuMemcpyDtoH, (&c[0], pool.result, sizeof(RES_TYPE) * kernel.total_threads));
+#undef CHECK
+  cuModuleUnload(module);
+
+  // As cuda_launcher, which prints the low 32 bits of each result.
+  fprintf(results, "# %s\n", kernel.cubin.c_str());
+  for (size_t i = 0; i < kernel.total_threads; ++i)
+    fprintf(results, "%016x\n", (unsigned int)c[i]);
+  fflush(results);
+  return CUDA_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+  const char *output = "results.txt";
+  const char *list = NULL;
+  int device_index = 0;
+  for (int arg_no = 1; arg_no < argc; ++arg_no) {
+    const char *arg = argv[arg_no];
+    const char *val = arg_no + 1 < argc ? argv[arg_no + 1] : NULL;
+    if ((!strcmp(arg, "-o") || !strcmp(arg, "--output")) && val) {
+      output = val;
+      ++arg_no;
+    } else if ((!strcmp(arg, "-d") || !strcmp(arg, "--device_idx")) && val) {
+      device_index = atoi(val);
+      ++arg_no;
+    } else if (list == NULL && (arg[0] != '-' || !strcmp(arg, "-"))) {
+      list = arg;
+    } else {
+      print_help();
+      return 1;
+    }
+  }
+  if (list == NULL) {
+    print_help();
+    return 1;
+  }
+
+  // The whole list is read first, to size the buffers.
+  std::vector<Kernel> kernels;
+  {
+    std::ifstream file;
+    if (strcmp(list, "-"))
+      file.open(list);
+    std::istream& in = strcmp(list, "-") ? file : std::cin;
+    if (!in) {
+      printf("Could not read the list %s\n", list);
+      return 1;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+      if (split(line).empty() || line[0] == '#')
+        continue;
+      kernels.push_back(read_kernel(line));
+    }
+  }
+
+  int device_count = 0;
+  CUresult err = cuInit(0);
+  if (err == CUDA_SUCCESS)
+    err = cuDeviceGetCount(&device_count);
+  if (err != CUDA_SUCCESS || device_count == 0) {
+    printf("Error: no devices supporting CUDA\n");
+    return 1;
+  }
+  if ((err = cuDeviceGet(&device, device_index)) != CUDA_SUCCESS) {
+    printf("Could not get device %d: %s\n", device_index,
+           error_string(err).c_str());
+    return 1;
+  }
+
+  for (size_t i = 0; i < kernels.size(); ++i) {
+    Kernel& kernel = kernels[i];
+    if (!kernel.error.empty() || !check_limits(&kernel))
+      continue;
+    pool_size.atomics |= kernel.atomics;
+    pool_size.atomic_counter_no = std::max<int>(pool_size.atomic_counter_no,
+        kernel.atomic_counter_no * kernel.no_blocks);
+    pool_size.atomic_reductions |= kernel.atomic_reductions;
+    pool_size.emi |= kernel.emi;
+    pool_size.tg |= kernel.tg;
+    pool_size.fake_divergence |= kernel.fake_divergence;
+    pool_size.inter_thread_comm |= kernel.inter_thread_comm;
+    pool_size.total_threads = std::max(pool_size.total_threads,
+                                       kernel.total_threads);
+    pool_size.no_blocks = std::max(pool_size.no_blocks, kernel.no_blocks);
+    pool_size.max_dimen = std::max(pool_size.max_dimen, kernel.max_dimen);
+  }
+  if (pool_size.inter_thread_comm)
+    comm_ones.assign(pool_size.total_threads, 1);
+
+  FILE *results = fopen(output, "a");
+  if (results == NULL) {
+    printf("Could not open %s\n", output);
+    return 1;
+  }
+  bool failed = false;
+  typedef std::chrono::steady_clock Clock;
+  for (size_t i = 0; i < kernels.size(); ++i) {
+    const Kernel& kernel = kernels[i];
+    Clock::time_point start = Clock::now();
+    std::string message = kernel.error;
+    if (message.empty() && context == NULL &&
+        (err = create_context()) != CUDA_SUCCESS) {
+      message = "can't create the context: " + error_string(err);
+      destroy_context();
+    }
+    if (message.empty() &&
+        (err = run_kernel(kernel, results, &message)) != CUDA_SUCCESS &&
+        err != CUDA_ERROR_FILE_NOT_FOUND && err != CUDA_ERROR_INVALID_IMAGE &&
+        err != CUDA_ERROR_NOT_FOUND) {
+      // Anything but a module that does not load may have left the context
+      // unusable.
+      destroy_context();
+    }
+    if (message.empty()) {
+      long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+          Clock::now() - start).count();
+      printf("%s ok %ld\n", kernel.cubin.c_str(), ms);
+    } else {
+      fprintf(results, "# %s error %s\n", kernel.cubin.c_str(), message.c_str());
+      fflush(results);
+      printf("%s error %s\n", kernel.cubin.c_str(), message.c_str());
+      failed = true;
+    }
+    fflush(stdout);
+  }
+  fclose(results);
+  destroy_context();
+  return failed ? 2 : 0;
+}
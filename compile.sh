@@ -1,22 +1,11 @@
-#/bin/sh
-
-i=10001
-#pass=0
-sum=20000
-while [ $i -le $sum ]
-do 
-#tg directory contains the generated kernel in tg mode.
-        cp ./tg/$i.cu test.cu 
-        make clean >> ./compile/clean.log 2>&1
-        ./replace.sh >> ./compile/replace.log 2>&1
-        timeout 60 make  >> ./compile/tg/$i.log 2>&1
-        if [ -f "./test" ];then
-             echo $i.cu
-             mv ./test ./bin/tg/$i.bin
-        fi    
-        i=$(($i+1))
-done
-
-
-
-
+#!/bin/sh
+
+# Compiles tg/10001.cu ... tg/20000.cu to bin/tg/<seed>.bin, on every core.
+# The tg directory contains the generated kernels in tg mode. What each
+# compile printed goes to bin/tg/<seed>.log, and a line per kernel (exit code,
+# compile time, stderr hash) to compile/tg.jsonl; see compile_pipeline.cpp.
+make pipeline || exit 1
+mkdir -p compile
+seq -f 'tg/%g.cu' 10001 20000 > compile/tg.list
+./compile_pipeline --list compile/tg.list -o bin/tg --timeout 60 \
+    --log compile/tg.jsonl
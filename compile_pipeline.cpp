@@ -0,0 +1,475 @@
+// Compiles (and optionally runs) many kernels in parallel, in place of
+// compile.sh and replace.sh. For every kernel, the launcher template is
+// instantiated in memory with the options of the kernel's first line, as
+// replace.sh does with sed, and written with the kernel, as test.cu, to a
+// directory of its own. The compiler then runs there, under a timeout and a
+// memory limit, and the binary is moved to the output directory as
+// <kernel>.bin, as compile.sh does.
+//
+//   make pipeline && ./compile_pipeline -j 8 -o bin/tg tg/*.cu
+//
+// Every kernel gets a line in the log, a JSON object with the exit code (or
+// signal) of the compiler, whether it timed out, the compile time and a hash
+// of its stderr, so that kernels which fail alike can be grouped; with --run,
+// the same for the run of the binary, whose stdout goes to <kernel>.out.
+// Whatever the compiler prints goes to <kernel>.log. A line per kernel goes
+// to stdout too, with the time taken:
+//   <kernel> ok <ms>
+//   <kernel> compile|run exit <status> <ms>
+//   <kernel> compile|run signal <signal> <ms>
+//   <kernel> compile|run timeout <ms>
+//   <kernel> compile no binary <ms>
+//   <kernel> error <message>
+//
+// The compiler command is run by /bin/sh in the directory of the job, with
+// {src} replaced by the instantiated launcher, {out} by the binary to write
+// and {include} by the directory of the template (where CUDA.h is), so that
+// a host compiler can stand in for nvcc.
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DEF_COMPILER \
+  "nvcc -rdc=true -lcuda -Xptxas -O0 -w -arch sm_50 -I{include} -o {out} {src}"
+
+// Options.
+std::string template_path = "cuda_launcher.c.template";
+std::string compiler = DEF_COMPILER;
+std::string output_dir = ".";
+std::string log_path = "compile_log.jsonl";
+std::string work_dir;
+double timeout_s = 60;
+unsigned long memory_mb = 0;
+bool run = false;
+bool keep = false;
+
+std::string launcher_template;
+std::string include_dir;
+
+void print_help()
+{
+  printf("Usage: ./compile_pipeline [options] KERNEL.cu...\n");
+  printf("\n");
+  printf("  -j N    --jobs N                          Compile N kernels at once (one per core by default)\n");
+  printf("  -o DIR  --output DIR                      Write the binaries, outputs and logs to DIR (. by default)\n");
+  printf("          --list FILE                       Also compile the kernels listed in FILE, one per line\n");
+  printf("          --template FILE                   Launcher template (cuda_launcher.c.template by default)\n");
+  printf("          --compiler CMD                    Compiler command, with {src}, {out} and {include}:\n");
+  printf("                                            " DEF_COMPILER "\n");
+  printf("          --timeout SECONDS                 Limit of every compile and run (60 by default)\n");
+  printf("          --memory MB                       Address space limit of every compile and run (none by default)\n");
+  printf("          --log FILE                        Structured log (compile_log.jsonl by default)\n");
+  printf("          --work DIR                        Make the job directories in DIR ($TMPDIR or /tmp by default)\n");
+  printf("          --run                             Run every binary, writing its output to <kernel>.out\n");
+  printf("          --keep                            Keep the job directories\n");
+}
+
+bool read_file(const std::string& path, std::string *text)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in)
+    return false;
+  std::ostringstream out;
+  out << in.rdbuf();
+  *text = out.str();
+  return true;
+}
+
+bool write_file(const std::string& path, const std::string& text)
+{
+  std::ofstream out(path.c_str(), std::ios::binary);
+  out.write(text.data(), text.size());
+  return (bool)out;
+}
+
+void replace_all(std::string *text, const std::string& from,
+    const std::string& to)
+{
+  for (std::string::size_type pos = 0;
+       (pos = text->find(from, pos)) != std::string::npos; pos += to.size())
+    text->replace(pos, from.size(), to);
+}
+
+// The launcher of a kernel, as replace.sh makes it: argv is "1.cu" followed
+// by the words of the kernel's first line after the "//".
+std::string instantiate(const std::string& kernel)
+{
+  std::istringstream first(kernel.substr(0, kernel.find('\n')));
+  std::string word, list = "\"1.cu\"";
+  int count = 1;
+  first >> word;
+  while (first >> word) {
+    list += ",\"";
+    for (size_t i = 0; i < word.size(); ++i) {
+      if (word[i] == '"' || word[i] == '\\')
+        list += '\\';
+      list += word[i];
+    }
+    list += '"';
+    ++count;
+  }
+  std::string launcher = launcher_template;
+  replace_all(&launcher, "PARAMS_COUNT", std::to_string(count));
+  replace_all(&launcher, "PARAMS_LIST", list);
+  return launcher;
+}
+
+// 64-bit FNV-1a.
+std::string hash(const std::string& text)
+{
+  unsigned long long h = 14695981039346656037ULL;
+  for (size_t i = 0; i < text.size(); ++i) {
+    h ^= (unsigned char)text[i];
+    h *= 1099511628211ULL;
+  }
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%016llx", h);
+  return hex;
+}
+
+std::string json_string(const std::string& text)
+{
+  std::string out = "\"";
+  for (size_t i = 0; i < text.size(); ++i) {
+    char c = text[i];
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if ((unsigned char)c < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out += escaped;
+    } else {
+      out += c;
+    }
+  }
+  return out + '"';
+}
+
+// The outcome of a command.
+struct Step {
+  int exit_code = -1;
+  int signal = 0;
+  bool timed_out = false;
+  long ms = 0;
+  std::string stdout_text;
+  std::string stderr_text;
+  bool ok() const { return exit_code == 0; }
+};
+
+// Runs a shell command in dir, under the limits, with its output collected in
+// files of dir. The command runs in a process group of its own, so that a
+// timeout kills whatever it started too.
+Step run_command(const std::string& command, const std::string& dir)
+{
+  typedef std::chrono::steady_clock Clock;
+  Step step;
+  // Everything the child needs is prepared before the fork, since only
+  // async-signal-safe calls may follow it in a threaded program.
+  const std::string out_path = dir + "/.stdout", err_path = dir + "/.stderr";
+  struct rlimit memory = {memory_mb << 20, memory_mb << 20};
+  Clock::time_point start = Clock::now();
+  pid_t pid = fork();
+  if (pid < 0) {
+    step.stderr_text = std::string("fork failed: ") + strerror(errno);
+    return step;
+  }
+  if (pid == 0) {
+    setpgid(0, 0);
+    if (memory_mb)
+      setrlimit(RLIMIT_AS, &memory);
+    int out = open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int err = open(err_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int in = open("/dev/null", O_RDONLY);
+    if (chdir(dir.c_str()) || out < 0 || err < 0 || in < 0)
+      _exit(127);
+    dup2(in, 0);
+    dup2(out, 1);
+    dup2(err, 2);
+    execl("/bin/sh", "sh", "-c", command.c_str(), (char *)NULL);
+    _exit(127);
+  }
+  setpgid(pid, pid);
+
+  int status = -1;
+  Clock::time_point deadline = start + std::chrono::milliseconds(
+      (long)(timeout_s * 1000));
+  for (;;) {
+    pid_t done = waitpid(pid, &status, WNOHANG);
+    if (done == pid)
+      break;
+    if (done < 0 && errno != EINTR) {
+      status = -1;
+      break;
+    }
+    if (!step.timed_out && Clock::now() >= deadline) {
+      step.timed_out = true;
+      kill(-pid, SIGKILL);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  step.ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      Clock::now() - start).count();
+  if (status == -1)
+    step.stderr_text = std::string("waitpid failed: ") + strerror(errno);
+  else if (WIFEXITED(status))
+    step.exit_code = WEXITSTATUS(status);
+  else if (WIFSIGNALED(status))
+    step.signal = WTERMSIG(status);
+  read_file(out_path, &step.stdout_text);
+  read_file(err_path, &step.stderr_text);
+  unlink(out_path.c_str());
+  unlink(err_path.c_str());
+  return step;
+}
+
+std::string step_json(const Step& step)
+{
+  std::ostringstream out;
+  out << "{\"exit\": " << step.exit_code << ", \"signal\": " << step.signal
+      << ", \"timeout\": " << (step.timed_out ? "true" : "false")
+      << ", \"ms\": " << step.ms
+      << ", \"stderr_bytes\": " << step.stderr_text.size()
+      << ", \"stderr_hash\": \"" << hash(step.stderr_text) << "\"}";
+  return out.str();
+}
+
+std::string step_summary(const Step& step)
+{
+  if (step.ok() && !step.timed_out)
+    return "no binary " + std::to_string(step.ms);
+  if (step.timed_out)
+    return "timeout " + std::to_string(step.ms);
+  if (step.signal)
+    return "signal " + std::to_string(step.signal) + ' ' +
+        std::to_string(step.ms);
+  return "exit " + std::to_string(step.exit_code) + ' ' +
+      std::to_string(step.ms);
+}
+
+int remove_entry(const char *path, const struct stat *, int, struct FTW *)
+{
+  return remove(path);
+}
+
+// The name of a kernel's files in the output directory: tg/42.cu -> 42.
+std::string stem(const std::string& kernel)
+{
+  std::string name = kernel.substr(kernel.rfind('/') + 1);
+  std::string::size_type dot = name.rfind('.');
+  return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+std::string shell_quote(const std::string& text)
+{
+  std::string quoted = "'";
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\'')
+      quoted += "'\\''";
+    else
+      quoted += text[i];
+  }
+  return quoted + '\'';
+}
+
+std::mutex output_mutex;
+FILE *log_file;
+
+// Compiles a kernel, and runs it with --run. Returns whether all went well.
+bool process(const std::string& kernel_path)
+{
+  const std::string name = stem(kernel_path);
+  const std::string binary = output_dir + '/' + name + ".bin";
+  std::string kernel, error;
+  Step compile, execution;
+  bool compiled = false;
+  std::string dir = work_dir + "/compile_pipeline.XXXXXX";
+  std::vector<char> dir_buffer(dir.begin(), dir.end());
+  dir_buffer.push_back('\0');
+
+  if (!read_file(kernel_path, &kernel)) {
+    error = "can't read the kernel";
+  } else if (mkdtemp(&dir_buffer[0]) == NULL) {
+    error = std::string("can't make a job directory: ") + strerror(errno);
+  } else {
+    dir = &dir_buffer[0];
+    if (!write_file(dir + "/test.cu", kernel) ||
+        !write_file(dir + "/cuda_launcher.cu", instantiate(kernel))) {
+      error = "can't write the job directory";
+    } else {
+      std::string command = compiler;
+      replace_all(&command, "{src}", "cuda_launcher.cu");
+      replace_all(&command, "{out}", "test");
+      replace_all(&command, "{include}", shell_quote(include_dir));
+      compile = run_command(command, dir);
+      if (!compile.stdout_text.empty() || !compile.stderr_text.empty())
+        write_file(output_dir + '/' + name + ".log",
+                   compile.stdout_text + compile.stderr_text);
+      compiled = compile.ok() && !compile.timed_out &&
+          access((dir + "/test").c_str(), X_OK) == 0;
+      if (compiled && run) {
+        execution = run_command("./test", dir);
+        write_file(output_dir + '/' + name + ".out", execution.stdout_text);
+      }
+      if (compiled && rename((dir + "/test").c_str(), binary.c_str())) {
+        error = std::string("can't move the binary: ") + strerror(errno);
+        compiled = false;
+      }
+    }
+    if (!keep)
+      nftw(dir.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+  }
+
+  bool ok = error.empty() && compiled && (!run || execution.ok());
+  std::ostringstream line;
+  line << "{\"kernel\": " << json_string(kernel_path);
+  if (!error.empty()) {
+    line << ", \"error\": " << json_string(error) << "}";
+  } else {
+    line << ", \"binary\": "
+         << (compiled ? json_string(binary) : std::string("null"))
+         << ", \"compile\": " << step_json(compile);
+    if (compiled && run)
+      line << ", \"run\": " << step_json(execution)
+           << ", \"output_hash\": \"" << hash(execution.stdout_text) << '"';
+    line << "}";
+  }
+
+  std::lock_guard<std::mutex> lock(output_mutex);
+  fprintf(log_file, "%s\n", line.str().c_str());
+  fflush(log_file);
+  if (!error.empty())
+    printf("%s error %s\n", kernel_path.c_str(), error.c_str());
+  else if (!compiled)
+    printf("%s compile %s\n", kernel_path.c_str(),
+           step_summary(compile).c_str());
+  else if (!ok)
+    printf("%s run %s\n", kernel_path.c_str(),
+           step_summary(execution).c_str());
+  else
+    printf("%s ok %ld\n", kernel_path.c_str(), compile.ms + execution.ms);
+  fflush(stdout);
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long jobs = 0;
+  std::vector<std::string> kernels;
+  for (int arg_no = 1; arg_no < argc; ++arg_no) {
+    const std::string arg = argv[arg_no];
+    const char *val = arg_no + 1 < argc ? argv[arg_no + 1] : NULL;
+    bool takes_value = true;
+    if ((arg == "-j" || arg == "--jobs") && val) {
+      jobs = strtoul(val, NULL, 10);
+    } else if ((arg == "-o" || arg == "--output") && val) {
+      output_dir = val;
+    } else if (arg == "--list" && val) {
+      std::ifstream list(val);
+      if (!list) {
+        printf("Could not read the list %s\n", val);
+        return 1;
+      }
+      std::string line;
+      while (std::getline(list, line))
+        if (!line.empty() && line[0] != '#')
+          kernels.push_back(line);
+    } else if (arg == "--template" && val) {
+      template_path = val;
+    } else if (arg == "--compiler" && val) {
+      compiler = val;
+    } else if (arg == "--timeout" && val) {
+      timeout_s = atof(val);
+    } else if (arg == "--memory" && val) {
+      memory_mb = strtoul(val, NULL, 10);
+    } else if (arg == "--log" && val) {
+      log_path = val;
+    } else if (arg == "--work" && val) {
+      work_dir = val;
+    } else if (arg == "--run") {
+      run = true;
+      takes_value = false;
+    } else if (arg == "--keep") {
+      keep = true;
+      takes_value = false;
+    } else if (arg[0] != '-') {
+      kernels.push_back(arg);
+      takes_value = false;
+    } else {
+      print_help();
+      return 1;
+    }
+    if (takes_value)
+      ++arg_no;
+  }
+  if (kernels.empty() || timeout_s <= 0) {
+    print_help();
+    return 1;
+  }
+  if (jobs == 0)
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  if (work_dir.empty())
+    work_dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+  if (!read_file(template_path, &launcher_template)) {
+    printf("Could not read the template %s\n", template_path.c_str());
+    return 1;
+  }
+  {
+    char *resolved = realpath(template_path.c_str(), NULL);
+    include_dir = resolved ? resolved : template_path;
+    free(resolved);
+    include_dir = include_dir.substr(0, include_dir.rfind('/') + 1);
+    if (include_dir.empty())
+      include_dir = ".";
+  }
+  // Jobs run in directories of their own, so the paths the results are
+  // moved to must not be relative.
+  mkdir(output_dir.c_str(), 0755);
+  char *resolved = realpath(output_dir.c_str(), NULL);
+  if (resolved == NULL) {
+    printf("Could not make the output directory %s\n", output_dir.c_str());
+    return 1;
+  }
+  output_dir = resolved;
+  free(resolved);
+  log_file = fopen(log_path.c_str(), "w");
+  if (log_file == NULL) {
+    printf("Could not open %s\n", log_path.c_str());
+    return 1;
+  }
+
+  // Each worker takes the next kernel until there are none left.
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::vector<std::thread> workers;
+  for (unsigned long job = 0; job < std::min<size_t>(jobs, kernels.size());
+       ++job)
+    workers.emplace_back([&]() {
+      size_t idx;
+      while ((idx = next++) < kernels.size())
+        if (!process(kernels[idx]))
+          failed = true;
+    });
+  for (std::thread& worker : workers)
+    worker.join();
+  fclose(log_file);
+  return failed ? 2 : 0;
+}
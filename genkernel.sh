@@ -1,10 +1,9 @@
 #!/bin/bash
 
 echo "CUDA Kernel Generation in All Mode:"
+./CUDASmith --seed-range 1:100 --fake_divergence --group_divergence --vectors --inter_thread_comm --atomics --atomic_reductions || exit 1
 for i in $(seq 1 100)
 do
-	./CUDASmith --seed $i --fake_divergence --group_divergence --vectors --inter_thread_comm --atomics --atomic_reductions
-
-	mv CUDAProg.cu $i.cu
+	mv CUDAProg_$i.cu $i.cu
 	echo "$i.cu generation succeed..."
 done
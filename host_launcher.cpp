@@ -0,0 +1,183 @@
+// Runs a kernel generated with CUDASmith --host-target on the CPU, through
+// CUDA_host.h, and prints its results as cuda_launcher does on a GPU. The
+// kernel is included as test.cu and takes the options of its first line:
+//
+//   make host && ./test_host $(head -n1 test.cu | cut -d' ' -f2-)
+//
+// The buffers are set up as in cuda_launcher.c.template, so the results can
+// be compared with those of the GPU.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "test.cu"
+
+#define DEF_LOCAL_SIZE 32
+#define DEF_GLOBAL_SIZE 1024
+
+// Kernel parameters.
+bool atomics = false;
+int atomic_counter_no = 0;
+bool atomic_reductions = false;
+bool emi = false;
+bool tg = false;
+bool fake_divergence = false;
+bool inter_thread_comm = false;
+std::vector<size_t> local_size;
+std::vector<size_t> global_size;
+
+void print_help()
+{
+  printf("Usage: ./test_host [-g N,N,N] [-l N,N,N] [--atomics N] [flags...]\n");
+  printf("\n");
+  printf("  -l N    --locals N                        A string with comma-separated values representing the number of work-units per group per dimension\n");
+  printf("  -g N    --groups N                        Same as -l, but representing the total number of work-units per dimension\n");
+  printf("          --atomics N                       Test uses atomic sections, with N counters per group\n");
+  printf("                      ---atomic_reductions  Test uses atomic reductions\n");
+  printf("                      ---emi                Test uses EMI\n");
+  printf("                      ---tg                 Test uses true guards\n");
+  printf("                      ---fake_divergence    Test uses fake divergence\n");
+  printf("                      ---inter_thread_comm  Test uses inter-thread communication\n");
+  printf("\n");
+  printf("CUDA_HOST_WORKERS sets the number of threads running blocks, and\n");
+  printf("CUDA_HOST_STACK_KB the stack size of each kernel thread. Setting\n");
+  printf("CUDA_HOST_COROUTINES runs every kernel thread on its own stack.\n");
+}
+
+bool parse_dims(const char *val, std::vector<size_t> *dims)
+{
+  dims->clear();
+  const char *pos = val;
+  while (*pos) {
+    char *end;
+    long dim = strtol(pos, &end, 10);
+    if (end == pos || dim <= 0 || (*end != ',' && *end != '\0'))
+      return false;
+    dims->push_back(dim);
+    pos = *end ? end + 1 : end;
+  }
+  return !dims->empty();
+}
+
+int main(int argc, char **argv)
+{
+  for (int arg_no = 1; arg_no < argc; ++arg_no) {
+    const char *arg = argv[arg_no];
+    const char *val = arg_no + 1 < argc ? argv[arg_no + 1] : NULL;
+    if (!strcmp(arg, "-l") || !strcmp(arg, "--locals")) {
+      if (val == NULL || !parse_dims(val, &local_size)) {
+        printf("Could not parse local size \"%s\"\n", val ? val : "");
+        return 1;
+      }
+      ++arg_no;
+    } else if (!strcmp(arg, "-g") || !strcmp(arg, "--groups")) {
+      if (val == NULL || !parse_dims(val, &global_size)) {
+        printf("Could not parse global size \"%s\"\n", val ? val : "");
+        return 1;
+      }
+      ++arg_no;
+    } else if (!strcmp(arg, "--atomics")) {
+      if (val == NULL) {
+        print_help();
+        return 1;
+      }
+      atomics = true;
+      atomic_counter_no = atoi(val);
+      ++arg_no;
+    } else if (!strcmp(arg, "---atomic_reductions")) {
+      atomic_reductions = true;
+    } else if (!strcmp(arg, "---emi")) {
+      emi = true;
+    } else if (!strcmp(arg, "---tg")) {
+      tg = true;
+    } else if (!strcmp(arg, "---fake_divergence")) {
+      fake_divergence = true;
+    } else if (!strcmp(arg, "---inter_thread_comm")) {
+      inter_thread_comm = true;
+    } else {
+      printf("Failed parsing arg %s.\n", arg);
+      print_help();
+      return 1;
+    }
+  }
+  if (local_size.empty())
+    local_size.push_back(DEF_LOCAL_SIZE);
+  if (global_size.empty())
+    global_size.push_back(DEF_GLOBAL_SIZE);
+  if (global_size.size() != local_size.size()) {
+    printf("Local and global sizes must have same number of dimensions!\n");
+    return 1;
+  }
+  if (local_size.size() > 3) {
+    printf("Cannot have more than 3 dimensions!\n");
+    return 1;
+  }
+  size_t total_threads = 1;
+  size_t no_blocks = 1;
+  for (size_t d = 0; d < local_size.size(); ++d) {
+    if (global_size[d] % local_size[d]) {
+      printf("Global dimension %zu is not a multiple of the local one!\n", d);
+      return 1;
+    }
+    total_threads *= global_size[d];
+    no_blocks *= global_size[d] / local_size[d];
+  }
+  while (local_size.size() < 3) {
+    local_size.push_back(1);
+    global_size.push_back(1);
+  }
+
+  // The buffers, as setupMemory in cuda_launcher.c.template.
+  struct cuda_host_buffers buffers;
+  memset(&buffers, 0, sizeof(buffers));
+  std::vector<long> result(total_threads, 0);
+  buffers.result = &result[0];
+  std::vector<int> atomic_input, special_values;
+  if (atomics) {
+    atomic_input.assign(atomic_counter_no * no_blocks, 0);
+    special_values.assign(atomic_counter_no * no_blocks, 0);
+    buffers.atomic_input = atomic_input.empty() ? NULL : &atomic_input[0];
+    buffers.special_values = special_values.empty() ? NULL : &special_values[0];
+  }
+  std::vector<int> reduction_target;
+  if (atomic_reductions) {
+    reduction_target.assign(no_blocks, 0);
+    buffers.atomic_reduction = &reduction_target[0];
+  }
+  std::vector<int> emi_values(1024), tg_values(1024);
+  for (int i = 0; i < 1024; ++i) {
+    emi_values[i] = i;
+    tg_values[i] = 1024 - i;
+  }
+  if (emi)
+    buffers.emi_input = &emi_values[0];
+  if (tg)
+    buffers.tg_input = &tg_values[0];
+  std::vector<int> sequence_input;
+  if (fake_divergence) {
+    size_t max_dimen = *std::max_element(global_size.begin(),
+                                         global_size.end());
+    for (size_t i = 0; i < max_dimen; ++i)
+      sequence_input.push_back(10 + i);
+    buffers.sequence_input = &sequence_input[0];
+  }
+  std::vector<long> comm_vals;
+  if (inter_thread_comm) {
+    comm_vals.assign(total_threads, 1);
+    buffers.comm_values = &comm_vals[0];
+  }
+
+  dim3 blocks(global_size[0] / local_size[0], global_size[1] / local_size[1],
+              global_size[2] / local_size[2]);
+  dim3 threads(local_size[0], local_size[1], local_size[2]);
+  cuda_host::Launch(blocks, threads, entry_host_independent,
+                    [&buffers]() { entry_host(&buffers); });
+
+  // As cuda_launcher, which prints the low 32 bits of each result.
+  for (size_t i = 0; i < total_threads; ++i)
+    printf("%016x\n", (unsigned int)result[i]);
+  return 0;
+}